@@ -4,4 +4,4 @@ import importlib.metadata
 
 __version__ = importlib.metadata.version("pygribjump")
 
-__min_lib_version__ = "0.10.0" # Latest breaking C-API change
\ No newline at end of file
+__min_lib_version__ = "0.14.0" # Latest breaking C-API change
\ No newline at end of file
@@ -335,6 +335,7 @@ class ExtractionIterator:
         return res
 
     def dump_values(self) -> list[list[np.ndarray]]:
+        # Writable copies, which the caller may modify
         return [result.copy_values() for result in self]
 
 
@@ -445,6 +446,25 @@ class GribJump:
         logctx_c = ffi.new('const char[]', logctx.encode('ascii'))
         return ExtractionIterator(self.ctype, requests, logctx_c)
 
+    def extract_into(self, requests: list[ExtractionRequest], out: np.ndarray, ctx=None) -> int:
+        """
+        Extract a list of requests directly into a preallocated 2-D array, one result per row.
+
+        Each request must have cardinality 1, and the total size of its ranges must equal the number of columns
+        of out. Missing values are NaN. The array must be C-contiguous float64.
+        Returns the number of rows written.
+        """
+        if not isinstance(out, np.ndarray) or out.ndim != 2 or out.dtype != np.float64 or not out.flags.c_contiguous:
+            raise ValueError("out must be a C-contiguous 2-D float64 numpy array")
+        if out.shape[0] < len(requests):
+            raise ValueError(f"out has {out.shape[0]} rows, but {len(requests)} requests were given")
+
+        iterator = self.extract(requests, ctx)
+        nfilled = ffi.new('size_t*')
+        lib.gribjump_extractioniterator_fill(iterator._iterator, ffi.from_buffer('double[]', out),
+                                             out.shape[0], out.shape[1], nfilled)
+        return nfilled[0]
+
     def extract_from_paths(self, requests: list[PathExtractionRequest], ctx=None) -> ExtractionIterator:
         ctx = merge_default_context(ctx, "pygribjump_extract")
         logctx = json.dumps(ctx)
@@ -470,6 +490,89 @@ class GribJump:
         logctx_c = ffi.new('const char[]', logctx.encode('ascii'))
         return ExtractionSingleIterator(self.ctype, request, ranges, gridHash, logctx_c)
 
+    def extract_timeseries(self, request: dict[str, str | list], ranges: list[tuple[int, int]], gridHash: str = None, ctx=None) -> "TimeSeries":
+        """
+        Extract the same ranges from every field of a multi-valued request, e.g. every step and date of a forecast.
+        Parameters
+        ----------
+        request : dict
+            The request, e.g. {"step": [0, 6, 12], ...}. Keys may be multi-valued.
+        ranges : [(lo, hi), (lo, hi), ...]
+            The ranges to extract, in any order and possibly overlapping. Each row holds the values of every
+            range, in the order given.
+        gridHash : str
+            The hash of the grid of the fields.
+
+        Returns a TimeSeries, whose values are a (ntimes, npoints) array.
+        """
+        if not ranges:
+            raise ValueError(f"Must provide at least one range but found {ranges=}")
+
+        ctx = merge_default_context(ctx, "pygribjump_extract_timeseries")
+        logctx = json.dumps(ctx)
+        logctx_c = ffi.new('const char[]', logctx.encode('ascii'))
+
+        reqstr = "retrieve," + multivalued_dic_to_request(request)
+        c_reqstr = ffi.new("char[]", reqstr.encode())
+        c_hash = ffi.NULL if gridHash is None else ffi.new(
+            "char[]", gridHash.encode())
+
+        c_ranges = ffi.new('size_t[]', len(ranges)*2)
+        for i, (lo, hi) in enumerate(ranges):
+            c_ranges[i*2] = lo
+            c_ranges[i*2+1] = hi
+
+        timeseries = ffi.new('gribjump_timeseries_t**')
+        lib.gribjump_extract_timeseries(
+            self.__gribjump, c_reqstr, c_ranges, len(ranges)*2, c_hash, logctx_c, timeseries)
+        return TimeSeries(timeseries[0])
+
+    def nearest_points(self, gridHash: str, latlons: list[tuple[float, float]], ctx=None) -> "GridSelection":
+        """
+        Find the nearest grid point to each of a list of points. The grid must have been indexed when its fields were
+        scanned (see gridIndex.directory).
+        Parameters
+        ----------
+        gridHash : str
+            The hash of the grid.
+        latlons : [(lat, lon), (lat, lon), ...]
+            The points, in degrees.
+
+        Returns a GridSelection, whose ranges can be extracted with gridHash.
+        """
+        if len(latlons) == 0:
+            raise ValueError("Must provide at least one point")
+
+        ctx = merge_default_context(ctx, "pygribjump_nearest_points")
+        logctx = json.dumps(ctx)
+        logctx_c = ffi.new('const char[]', logctx.encode('ascii'))
+
+        c_hash = ffi.new("char[]", gridHash.encode())
+        c_lats = ffi.new('double[]', [float(lat) for lat, _ in latlons])
+        c_lons = ffi.new('double[]', [float(lon) for _, lon in latlons])
+
+        selection = ffi.new('gribjump_grid_selection_t**')
+        lib.gribjump_nearest_points(self.__gribjump, c_hash, c_lats, c_lons, len(latlons), logctx_c, selection)
+        return GridSelection(selection[0])
+
+    def bounding_box(self, gridHash: str, north: float, west: float, south: float, east: float, ctx=None) -> "GridSelection":
+        """
+        Find the grid points inside a bounding box, edges included. Longitudes go eastward from west to east, so
+        west > east selects across the antimeridian. The grid must have been indexed when its fields were scanned
+        (see gridIndex.directory).
+
+        Returns a GridSelection, whose ranges can be extracted with gridHash.
+        """
+        ctx = merge_default_context(ctx, "pygribjump_bounding_box")
+        logctx = json.dumps(ctx)
+        logctx_c = ffi.new('const char[]', logctx.encode('ascii'))
+
+        c_hash = ffi.new("char[]", gridHash.encode())
+
+        selection = ffi.new('gribjump_grid_selection_t**')
+        lib.gribjump_bounding_box(self.__gribjump, c_hash, north, west, south, east, logctx_c, selection)
+        return GridSelection(selection[0])
+
     # Convenience functions for extracting from masks and indices
     def extract_from_mask(self, requests: list[dict[str, str]], mask: np.ndarray, gridHash: str = None, ctx=None) -> ExtractionIterator:
         """
@@ -550,6 +653,13 @@ class GribJump:
         keys = [ffi.string(keys[i]).decode('ascii') for i in range(nkeys[0])]
         return dict(zip(keys, values))
 
+    def cancel(self):
+        """
+        Cancel all calls in progress on this handle.
+        Intended to be called from another thread: the cancelled calls raise GribJumpException.
+        """
+        lib.gribjump_cancel(self.__gribjump)
+
     @property
     def ctype(self):
         return self.__gribjump
@@ -590,28 +700,28 @@ class ExtractionResult:
 
     @property
     def values(self) -> list[np.ndarray]:
-        # Note: This is a view of the data, so must not outlive the result object.
+        # Note: This is a view of the result's storage, not a copy.
         if (self.__view_values is None):
             self.__view_values = self._view_values()
         return self.__view_values
 
     @property
     def masks(self) -> list[np.ndarray]:
-        # Note: This is a view of the data, so must not outlive the result object.
+        # Note: This is a view of the result's storage, not a copy.
         if (self.__view_masks is None):
             self.__view_masks = self._view_masks()
         return self.__view_masks
 
     @property
     def values_flat(self) -> np.ndarray:
-        # Note: This is a view of the data, so must not outlive the result object.
+        # Note: This is a view of the result's storage, not a copy.
         if (self.__view_values_flat is None):
             self.__view_values_flat = self._view_values_flat()
         return self.__view_values_flat
 
     @property
     def masks_flat(self) -> np.ndarray:
-        # Note: This is a view of the data, so must not outlive the result object.
+        # Note: This is a view of the result's storage, not a copy.
         if (self.__view_masks_flat is None):
             self.__view_masks_flat = self._view_masks_flat()
         return self.__view_masks_flat
@@ -645,32 +755,44 @@ class ExtractionResult:
     def copy_masks(self) -> list[np.ndarray]:
         return [m.copy() for m in self.masks]
 
+    def _keep_alive(self, ptr: CData) -> CData:
+        """
+        Return a pointer into the result's storage which keeps the result alive for as long as it (or any
+        buffer or numpy array made from it) is referenced.
+        """
+        owner = self.__result
+        return ffi.gc(ptr, lambda _, owner=owner: None)
+
     def _load_values(self):
         if self.__values_cdata is not None:
             return
 
-        nvalues = sum(self.__shape)
-        self.__values_cdata = ffi.new("double[]", nvalues)
-        values_ptr = ffi.new("double*[1]")
-        values_ptr[0] = self.__values_cdata
+        # Zero-copy: point directly at the result's contiguous values buffer
+        values_ptr = ffi.new('const double**')
+        nvalues = ffi.new('size_t*')
+        lib.gribjump_result_values_view(self.__result, values_ptr, nvalues)
+        assert nvalues[0] == sum(self.__shape), f"Count mismatch: {nvalues[0]} != {sum(self.__shape)}"
 
-        lib.gribjump_result_values(self.__result, values_ptr, nvalues)
+        self.__values_cdata = self._keep_alive(values_ptr[0])
 
     def _view_values_flat(self) -> np.ndarray:
         """
         Return the values as a single flat numpy array.
-        This is a view of the data, so must not outlive the result object.
+        This is a read-only view of the result's storage, which is kept alive for as long as the view exists.
         """
         self._load_values()
 
-        # Create a view of the data
         nvalues = sum(self.__shape)
-        return np.frombuffer(ffi.buffer(self.__values_cdata, nvalues * ffi.sizeof('double')), dtype=np.float64)
+        if nvalues == 0:
+            return np.empty(0, dtype=np.float64)
+
+        view = np.frombuffer(ffi.buffer(self.__values_cdata, nvalues * ffi.sizeof('double')), dtype=np.float64)
+        view.flags.writeable = False  # the result's storage is const
+        return view
 
     def _view_values(self) -> list[np.ndarray]:
         """
-        Return the values as a list of numpy arrays.
-        This is a view of the data, so must not outlive the result object.
+        Return the values as a list of numpy arrays, views of the result's storage.
         """
 
         view = self._view_values_flat()
@@ -683,29 +805,45 @@ class ExtractionResult:
         if self.__mask_cdata is not None:
             return
 
-        # Bit mask is returned as an array of uint64
-        nvalues = sum(self.__mask_shape)
-        self.__mask_cdata = ffi.new('unsigned long long[]', nvalues)
-        mask_ptr = ffi.new('unsigned long long*[1]')
-        mask_ptr[0] = self.__mask_cdata
+        # Bit mask is an array of uint64, viewed in place
+        mask_ptr = ffi.new('const unsigned long long**')
+        nmasks = ffi.new('size_t*')
+        lib.gribjump_result_mask_view(self.__result, mask_ptr, nmasks)
+        assert nmasks[0] == sum(self.__mask_shape), f"Count mismatch: {nmasks[0]} != {sum(self.__mask_shape)}"
 
-        lib.gribjump_result_mask(self.__result, mask_ptr, nvalues)
+        self.__mask_cdata = self._keep_alive(mask_ptr[0])
 
     def _view_masks_flat(self) -> np.ndarray:
         """
         Return the mask as a single flat numpy array.
-        This is a view of the data, so must not outlive the result object.
+        This is a read-only view of the result's storage, which is kept alive for as long as the view exists.
         """
         self._load_masks()
 
-        # Create a view of the data
-        nvalues = sum(self.__mask_shape)
-        return np.frombuffer(ffi.buffer(self.__mask_cdata, nvalues * ffi.sizeof('unsigned long long')), dtype=np.uint64)
+        nmasks = sum(self.__mask_shape)
+        if nmasks == 0:
+            return np.empty(0, dtype=np.uint64)
+
+        view = np.frombuffer(ffi.buffer(self.__mask_cdata, nmasks * ffi.sizeof('unsigned long long')), dtype=np.uint64)
+        view.flags.writeable = False  # the result's storage is const
+        return view
+
+    @property
+    def offsets(self) -> np.ndarray:
+        """
+        Offsets of the ranges into values_flat: range i is values_flat[offsets[i]:offsets[i+1]].
+        """
+        offsets_ptr = ffi.new('const size_t**')
+        nranges = ffi.new('size_t*')
+        lib.gribjump_result_offsets_view(self.__result, offsets_ptr, nranges)
+        buf = ffi.buffer(self._keep_alive(offsets_ptr[0]), (nranges[0] + 1) * ffi.sizeof('size_t'))
+        view = np.frombuffer(buf, dtype=np.uintp)
+        view.flags.writeable = False  # the result's storage is const
+        return view
 
     def _view_masks(self) -> list[np.ndarray]:
         """
-        Return the mask as a list of numpy arrays.
-        This is a view of the data, so must not outlive the result object.
+        Return the mask as a list of numpy arrays, views of the result's storage.
         """
         view = self._view_masks_flat()
 
@@ -713,6 +851,99 @@ class ExtractionResult:
         indices = list(accumulate(self.__mask_shape))[:-1]
         return np.split(view, indices)
 
+
+class TimeSeries:
+    """
+    A class taking ownership of the result of a time-series extraction: the same ranges extracted from every field
+    of a multi-valued request.
+
+    values is a (ntimes, npoints) float64 array, one row per field, ranges concatenated. Missing values, and all the
+    values of fields which were not found, are NaN. requests[t] is the canonical request of row t.
+    """
+
+    def __init__(self, timeseries_in: CData):
+        # Takes ownership of the result
+        self.__timeseries = ffi.gc(timeseries_in, lib.gribjump_delete_timeseries)
+
+        ntimes = ffi.new('size_t*')
+        npoints = ffi.new('size_t*')
+        lib.gribjump_timeseries_shape(self.__timeseries, ntimes, npoints)
+        self.__shape = (ntimes[0], npoints[0])
+
+        self.__view_values = None
+        self.__requests = None
+
+    @property
+    def shape(self) -> tuple[int, int]:
+        return self.__shape
+
+    @property
+    def values(self) -> np.ndarray:
+        # Note: This is a view of the result's storage, not a copy.
+        if self.__view_values is None:
+            self.__view_values = self._view_values()
+        return self.__view_values
+
+    @property
+    def requests(self) -> list[str]:
+        if self.__requests is None:
+            request_c = ffi.new('const char**')
+            self.__requests = []
+            for t in range(self.__shape[0]):
+                lib.gribjump_timeseries_request(self.__timeseries, t, request_c)
+                self.__requests.append(ffi.string(request_c[0]).decode())
+        return self.__requests
+
+    def _view_values(self) -> np.ndarray:
+        """
+        Return the values as a 2-D numpy array.
+        This is a read-only view of the result's storage, which is kept alive for as long as the view exists.
+        """
+        nvalues = self.__shape[0] * self.__shape[1]
+        if nvalues == 0:
+            return np.empty(self.__shape, dtype=np.float64)
+
+        values_ptr = ffi.new('const double**')
+        lib.gribjump_timeseries_values_view(self.__timeseries, values_ptr)
+
+        owner = self.__timeseries
+        values_cdata = ffi.gc(values_ptr[0], lambda _, owner=owner: None)
+        buf = ffi.buffer(values_cdata, nvalues * ffi.sizeof('double'))
+        view = np.frombuffer(buf, dtype=np.float64).reshape(self.__shape)
+        view.flags.writeable = False  # the timeseries' storage is const
+        return view
+
+class GridSelection:
+    """
+    Grid points found by coordinates, as ranges to extract.
+
+    ranges is a list of sorted, disjoint (lo, hi) ranges. For nearest_points, indices[i] is the grid point nearest to
+    point i, and positions[i] the position of its value in the values extracted from the ranges, ranges concatenated.
+    """
+
+    def __init__(self, selection_in: CData):
+        # Copies the selection, which is small, and frees it
+        selection = ffi.gc(selection_in, lib.gribjump_delete_grid_selection)
+
+        range_arr = ffi.new('const size_t**')
+        nranges = ffi.new('size_t*')
+        lib.gribjump_grid_selection_ranges(selection, range_arr, nranges)
+        self.ranges = [(range_arr[0][2*i], range_arr[0][2*i+1]) for i in range(nranges[0])]
+
+        indices = ffi.new('const size_t**')
+        positions = ffi.new('const size_t**')
+        npoints = ffi.new('size_t*')
+        lib.gribjump_grid_selection_points(selection, indices, positions, npoints)
+        n = npoints[0]
+        self.indices = np.array([indices[0][i] for i in range(n)], dtype=np.uint64)
+        self.positions = np.array([positions[0][i] for i in range(n)], dtype=np.uint64)
+
+    def __len__(self) -> int:
+        return sum(hi - lo for lo, hi in self.ranges)
+
+    def __repr__(self) -> str:
+        return f"GridSelection(ranges={self.ranges}, npoints={len(self.indices)})"
+
 # utils
 
 
@@ -219,6 +219,77 @@ def test_extract_iter(read_only_fdb_setup) -> None:
 
     assert i == 3
 
+@pytest.mark.skipif(SKIP_FDB, reason="FDB tests are skipped")
+def test_extract_zero_copy(read_only_fdb_setup) -> None:
+    import gc
+    gribjump = GribJump()
+
+    ranges = [(0, 10), (50, 60)]
+    requests = []
+    for step in [0, 1, 2, 3]:
+        req = {
+            "domain": "g", "levtype": "sfc", "date": "20230508", "time": "1200", "step": str(step),
+            "param": "151130", "class": "od", "type": "fc", "stream": "oper", "expver": "0001",
+        }
+        requests.append(ExtractionRequest(req, ranges))
+    expected = np.concatenate([synthetic_data[lo:hi] for lo, hi in ranges])
+
+    # Views keep their result alive after the result object itself is gone
+    views = []
+    for result in gribjump.extract(requests, ctx=context):
+        assert list(result.offsets) == [0, 10, 20]
+        views.append(result.values_flat)
+    gc.collect()
+    for view in views:
+        assert np.array_equal(view, expected, equal_nan=True)
+        assert not view.flags.writeable
+
+    # Batch API fills a preallocated array, one row per request
+    out = np.full((len(requests), len(expected)), -1.0)
+    assert gribjump.extract_into(requests, out, ctx=context) == len(requests)
+    for row in out:
+        assert np.array_equal(row, expected, equal_nan=True)
+
+    with pytest.raises(ValueError):
+        gribjump.extract_into(requests, np.zeros((1, len(expected))), ctx=context)
+
+
+@pytest.mark.skipif(SKIP_FDB, reason="FDB tests are skipped")
+def test_extract_timeseries(read_only_fdb_setup) -> None:
+    import gc
+    gribjump = GribJump()
+
+    request = {
+        "domain": "g", "levtype": "sfc", "date": "20230508", "time": "1200", "step": ['0', '1', '2', '3'],
+        "param": "151130", "class": "od", "type": "fc", "stream": "oper", "expver": "0001",
+    }
+    ranges = [(0, 10), (50, 60), (99, 100)]
+    expected = np.concatenate([synthetic_data[lo:hi] for lo, hi in ranges])
+
+    series = gribjump.extract_timeseries(request, ranges, ctx=context)
+    assert series.shape == (4, 21)
+    assert len(series.requests) == 4
+    assert all(f"step={step}" in r for step, r in zip(range(4), series.requests))
+
+    # The view keeps the time series alive after the object itself is gone
+    values = series.values
+    del series
+    gc.collect()
+    for row in values:
+        assert np.array_equal(row, expected, equal_nan=True)
+
+    # Ranges in any order, and overlapping: each row holds the values of every range, in the order given
+    ranges = [(50, 60), (0, 10), (55, 65)]
+    expected = np.concatenate([synthetic_data[lo:hi] for lo, hi in ranges])
+    series = gribjump.extract_timeseries(request, ranges, ctx=context)
+    assert series.shape == (4, 30)
+    for row in series.values:
+        assert np.array_equal(row, expected, equal_nan=True)
+
+    with pytest.raises(Exception):
+        gribjump.extract_timeseries(request, [(10, 10)], ctx=context)
+
+
 @pytest.mark.skipif(SKIP_FDB, reason="FDB tests are skipped")
 def test_extract_from_paths(read_only_fdb_setup) -> None:
     import pyfdb
@@ -125,7 +125,6 @@ private:
 };
 
 /// Zero-copy wrapper around gribjump::ExtractionResult.
-/// Values are truly zero-copy; masks are converted lazily from bitset<64>.
 class ExtractionResultHandle {
 public:
 
@@ -149,9 +148,8 @@ public:
     /// Get the number of values in a specific range.
     size_t values_len(size_t range_idx) const;
 
-    /// Get raw pointer to masks for a specific range.
+    /// Get raw pointer to masks for a specific range (zero-copy).
     /// Each mask element is a uint64_t where each bit represents validity.
-    /// Note: Masks are converted from bitset<64> on first access (cached).
     const uint64_t* masks_ptr(size_t range_idx) const;
 
     /// Get the number of mask elements in a specific range.
@@ -160,13 +158,6 @@ public:
 private:
 
     gribjump::ExtractionResult result_;
-    // Cached masks converted from bitset<64> to uint64_t
-    mutable std::vector<std::vector<uint64_t>> masks_cache_;
-    mutable bool masks_converted_ = false;
-
-    /// Convert masks from bitset<64> to uint64_t (lazy, cached).
-    /// Exceptions propagate to the FFI boundary handler.
-    bool try_convert_masks() const;
 };
 
 // ============================================================================
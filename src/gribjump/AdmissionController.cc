@@ -0,0 +1,227 @@
+/*
+ * (C) Copyright 2023- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+/// @author Caragh Bradley
+
+#include "gribjump/AdmissionController.h"
+
+#include <algorithm>
+#include <bitset>
+#include <chrono>
+#include <sstream>
+
+#include "eckit/log/Bytes.h"
+#include "eckit/log/Log.h"
+#include "eckit/log/Timer.h"
+
+#include "gribjump/Config.h"
+#include "gribjump/ExtractionItem.h"
+#include "gribjump/GribJumpException.h"
+#include "gribjump/LibGribJump.h"
+#include "gribjump/Metrics.h"
+
+namespace gribjump {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+AdmissionCost AdmissionCost::estimate(const filemap_t& filemap) {
+    AdmissionCost cost;
+    for (const auto& [fname, items] : filemap) {
+        for (const ExtractionItem* item : items) {
+            cost.nFields++;
+            for (const auto& [start, end] : item->intervals()) {
+                size_t n = end > start ? end - start : 0;
+                cost.nValues += n;
+                cost.bytes += n * sizeof(double) + ((n + 63) / 64) * sizeof(std::bitset<64>);
+            }
+        }
+    }
+    return cost;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+AdmissionTicket::AdmissionTicket(AdmissionController& controller, size_t bytes) :
+    controller_(&controller), bytes_(bytes) {}
+
+AdmissionTicket::AdmissionTicket(AdmissionTicket&& other) noexcept :
+    controller_(other.controller_), bytes_(other.bytes_) {
+    other.controller_ = nullptr;
+}
+
+AdmissionTicket& AdmissionTicket::operator=(AdmissionTicket&& other) noexcept {
+    if (this != &other) {
+        release();
+        controller_       = other.controller_;
+        bytes_            = other.bytes_;
+        other.controller_ = nullptr;
+    }
+    return *this;
+}
+
+AdmissionTicket::~AdmissionTicket() {
+    release();
+}
+
+void AdmissionTicket::release() {
+    if (controller_) {
+        controller_->release(bytes_);
+        controller_ = nullptr;
+    }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+AdmissionController& AdmissionController::instance() {
+    static AdmissionController controller([] {
+        const ConfigOptions& opts = ConfigOptions::instance();
+        AdmissionLimits limits;
+        limits.maxRequests = opts.admissionMaxRequests();
+        limits.maxMemory   = opts.admissionMaxMemory();
+        limits.maxQueued   = opts.admissionMaxQueued();
+        limits.timeout     = opts.admissionTimeout();
+        return limits;
+    }());
+    return controller;
+}
+
+AdmissionController::AdmissionController(const AdmissionLimits& limits) : limits_(limits) {
+    if (enabled()) {
+        eckit::Log::info() << "Admission control enabled: maxRequests=" << limits_.maxRequests
+                           << ", maxMemory=" << eckit::Bytes(limits_.maxMemory) << ", maxQueued=" << limits_.maxQueued
+                           << ", timeout=" << limits_.timeout << "s" << std::endl;
+    }
+}
+
+bool AdmissionController::fits(size_t bytes) const {
+    if (limits_.maxRequests > 0 && inFlightRequests_ >= limits_.maxRequests) {
+        return false;
+    }
+    if (limits_.maxMemory > 0 && inFlightBytes_ + bytes > limits_.maxMemory) {
+        return false;
+    }
+    return true;
+}
+
+void AdmissionController::reject(const std::string& reason, const AdmissionCost& cost) {
+    rejected_++;
+    MetricsManager::instance().set("admission", "rejected");
+    MetricsManager::instance().set("count_admission_rejected", rejected_);
+
+    std::ostringstream ss;
+    ss << reason << " (fields=" << cost.nFields << ", values=" << cost.nValues << ", bytes=" << cost.bytes
+       << ", in-flight requests=" << inFlightRequests_ << ", in-flight bytes=" << inFlightBytes_
+       << ", queued=" << waiting_.size() << ")";
+    eckit::Log::warning() << "Admission rejected: " << ss.str() << std::endl;
+    throw AdmissionRejected(ss.str(), Here());
+}
+
+AdmissionTicket AdmissionController::admit(const AdmissionCost& cost) {
+
+    MetricsManager& metrics = MetricsManager::instance();
+    metrics.set("admission_cost_fields", cost.nFields);
+    metrics.set("admission_cost_values", cost.nValues);
+    metrics.set("admission_cost_bytes", cost.bytes);
+
+    if (!enabled()) {
+        return AdmissionTicket();
+    }
+
+    eckit::Timer timer;
+    std::unique_lock<std::mutex> lock(mutex_);
+    metrics.set("admission_queue_depth", waiting_.size());
+
+    if (limits_.maxMemory > 0 && cost.bytes > limits_.maxMemory) {
+        reject("Request exceeds the server memory budget", cost);
+    }
+
+    if (!waiting_.empty() || !fits(cost.bytes)) {
+
+        if (limits_.maxQueued > 0 && waiting_.size() >= limits_.maxQueued) {
+            reject("Server admission queue is full", cost);
+        }
+        if (limits_.timeout <= 0) {
+            reject("Server is at capacity", cost);
+        }
+
+        const uint64_t ticket = nextTicket_++;
+        waiting_.push_back(ticket);
+
+        LOG_DEBUG_LIB(LibGribJump) << "Admission: queued request with " << eckit::Bytes(cost.bytes) << " at position "
+                                   << waiting_.size() << std::endl;
+
+        auto timeout  = std::chrono::duration<double>(limits_.timeout);
+        auto deadline = std::chrono::steady_clock::now() +
+                        std::chrono::duration_cast<std::chrono::steady_clock::duration>(timeout);
+
+        bool admitted = cv_.wait_until(lock, deadline, [&] { return waiting_.front() == ticket && fits(cost.bytes); });
+
+        if (!admitted) {
+            waiting_.erase(std::find(waiting_.begin(), waiting_.end(), ticket));
+            cv_.notify_all();  // we may have been blocking the head of the queue
+            reject("Timed out waiting for admission", cost);
+        }
+
+        waiting_.pop_front();
+        cv_.notify_all();  // the next waiter may also fit
+    }
+
+    inFlightRequests_++;
+    inFlightBytes_ += cost.bytes;
+    admitted_++;
+
+    metrics.set("admission", "admitted");
+    metrics.set("count_admission_admitted", admitted_);
+    metrics.set("admission_in_flight_requests", inFlightRequests_);
+    metrics.set("admission_in_flight_bytes", inFlightBytes_);
+    metrics.set("elapsed_admission_wait", timer.elapsed());
+
+    return AdmissionTicket(*this, cost.bytes);
+}
+
+void AdmissionController::release(size_t bytes) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        ASSERT(inFlightRequests_ > 0);
+        ASSERT(inFlightBytes_ >= bytes);
+        inFlightRequests_--;
+        inFlightBytes_ -= bytes;
+    }
+    cv_.notify_all();
+}
+
+size_t AdmissionController::inFlightRequests() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return inFlightRequests_;
+}
+
+size_t AdmissionController::inFlightBytes() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return inFlightBytes_;
+}
+
+size_t AdmissionController::queueDepth() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return waiting_.size();
+}
+
+size_t AdmissionController::admitted() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return admitted_;
+}
+
+size_t AdmissionController::rejected() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return rejected_;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace gribjump
@@ -0,0 +1,133 @@
+/*
+ * (C) Copyright 2023- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+/// @author Caragh Bradley
+
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+
+#include "gribjump/Types.h"
+
+namespace gribjump {
+
+class AdmissionController;
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/// Approximate resource cost of an extraction, estimated from its filemap before any task is scheduled.
+struct AdmissionCost {
+
+    static AdmissionCost estimate(const filemap_t& filemap);
+
+    size_t nFields = 0;  //< number of extraction items (i.e. GRIB messages)
+    size_t nValues = 0;  //< total number of values requested across all ranges
+    size_t bytes   = 0;  //< approximate memory needed to hold the results (values and masks)
+};
+
+/// Limits enforced by the AdmissionController. A value of zero means "unlimited".
+struct AdmissionLimits {
+    size_t maxRequests = 0;    //< maximum number of extractions executing at once
+    size_t maxMemory   = 0;    //< maximum total estimated bytes of extractions executing at once
+    size_t maxQueued   = 0;    //< maximum number of extractions waiting for admission
+    double timeout     = 0.0;  //< seconds to wait for admission before rejecting. 0 rejects immediately.
+
+    bool unlimited() const { return maxRequests == 0 && maxMemory == 0; }
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/// Holds the resources granted to an admitted extraction, and returns them to the controller on destruction.
+class AdmissionTicket {
+public:
+
+    AdmissionTicket() = default;
+    AdmissionTicket(AdmissionController& controller, size_t bytes);
+
+    AdmissionTicket(const AdmissionTicket&)            = delete;
+    AdmissionTicket& operator=(const AdmissionTicket&) = delete;
+    AdmissionTicket(AdmissionTicket&& other) noexcept;
+    AdmissionTicket& operator=(AdmissionTicket&& other) noexcept;
+
+    ~AdmissionTicket();
+
+    void release();
+
+private:
+
+    AdmissionController* controller_ = nullptr;
+    size_t bytes_                    = 0;
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/// Bounds the number and estimated memory footprint of extractions a server executes concurrently.
+///
+/// Each extraction is admitted once its filemap is known. If admitting it would exceed the configured limits, it waits
+/// in a FIFO queue until enough in-flight extractions have completed, or is rejected with an AdmissionRejected
+/// exception if the queue is full, the wait times out, or the request could never fit within the memory budget.
+/// Waiters are admitted strictly in arrival order, so a large request is not starved by a stream of small ones.
+class AdmissionController {
+public:
+
+    static AdmissionController& instance();  // singleton, limits from ConfigOptions
+
+    explicit AdmissionController(const AdmissionLimits& limits);
+
+    AdmissionController(const AdmissionController&)            = delete;
+    AdmissionController& operator=(const AdmissionController&) = delete;
+
+    /// Block until the extraction can be admitted. Throws AdmissionRejected if it cannot be.
+    /// Records admission metrics for the current request.
+    AdmissionTicket admit(const AdmissionCost& cost);
+
+    bool enabled() const { return !limits_.unlimited(); }
+
+    const AdmissionLimits& limits() const { return limits_; }
+
+    size_t inFlightRequests() const;
+    size_t inFlightBytes() const;
+    size_t queueDepth() const;
+    size_t admitted() const;
+    size_t rejected() const;
+
+private:
+
+    friend class AdmissionTicket;
+
+    void release(size_t bytes);
+
+    bool fits(size_t bytes) const;  // requires lock
+
+    [[noreturn]] void reject(const std::string& reason, const AdmissionCost& cost);  // requires lock
+
+private:
+
+    const AdmissionLimits limits_;
+
+    mutable std::mutex mutex_;
+    std::condition_variable cv_;
+
+    size_t inFlightRequests_ = 0;
+    size_t inFlightBytes_    = 0;
+    size_t admitted_         = 0;
+    size_t rejected_         = 0;
+
+    uint64_t nextTicket_ = 0;
+    std::deque<uint64_t> waiting_;  //< tickets of queued extractions, in arrival order
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace gribjump
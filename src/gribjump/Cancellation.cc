@@ -0,0 +1,138 @@
+/*
+ * (C) Copyright 2023- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+/// @author Caragh Bradley
+
+#include "gribjump/Cancellation.h"
+
+#include "eckit/log/Log.h"
+
+#include "gribjump/LibGribJump.h"
+
+namespace gribjump {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+struct CancellationToken::Registration::State {
+    std::atomic<bool> cancelled{false};
+
+    std::mutex mutex;            //< guards the members below. Not held while callbacks run.
+    std::condition_variable cv;  //< signalled when a callback returns
+    std::string reason;
+    std::map<uint64_t, Callback> callbacks;
+    uint64_t nextId  = 1;
+    uint64_t running = 0;    //< id of the callback being run, 0 if none
+    std::thread::id runner;  //< thread running the callbacks
+};
+
+CancellationToken::Registration::Registration(std::shared_ptr<State> state, uint64_t id) :
+    state_(std::move(state)), id_(id) {}
+
+CancellationToken::Registration::Registration(Registration&& other) noexcept :
+    state_(std::move(other.state_)), id_(other.id_) {
+    other.state_.reset();
+}
+
+CancellationToken::Registration& CancellationToken::Registration::operator=(Registration&& other) noexcept {
+    if (this != &other) {
+        Registration tmp(std::move(*this));  // unregister our current callback
+        state_ = std::move(other.state_);
+        id_    = other.id_;
+        other.state_.reset();
+    }
+    return *this;
+}
+
+CancellationToken::Registration::~Registration() {
+    if (state_) {
+        std::unique_lock<std::mutex> lock(state_->mutex);
+        state_->callbacks.erase(id_);
+        // Wait for the callback to return if it is running, unless it is the one destroying its registration
+        state_->cv.wait(lock,
+                        [this] { return state_->running != id_ || state_->runner == std::this_thread::get_id(); });
+    }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+CancellationToken::CancellationToken() : state_(std::make_shared<Registration::State>()) {}
+
+void CancellationToken::cancel(const std::string& reason) {
+    std::unique_lock<std::mutex> lock(state_->mutex);
+    if (state_->cancelled) {
+        return;
+    }
+    LOG_DEBUG_LIB(LibGribJump) << "Cancelling operation: " << reason << std::endl;
+    state_->reason = reason;
+    state_->cancelled.store(true);
+    state_->runner = std::this_thread::get_id();
+
+    // Callbacks run without the lock, so that they may take locks of their own which are also held while calling
+    // cancelled() or reason(). A callback unregistered meanwhile is not run.
+    while (!state_->callbacks.empty()) {
+        auto it           = state_->callbacks.begin();
+        Callback callback = std::move(it->second);
+        state_->running   = it->first;
+        state_->callbacks.erase(it);
+
+        lock.unlock();
+        callback();
+        lock.lock();
+
+        state_->running = 0;
+        state_->cv.notify_all();
+    }
+}
+
+bool CancellationToken::cancelled() const {
+    return state_->cancelled.load();
+}
+
+std::string CancellationToken::reason() const {
+    std::lock_guard<std::mutex> lock(state_->mutex);
+    return state_->reason;
+}
+
+CancellationToken::Registration CancellationToken::onCancel(Callback callback) {
+    {
+        std::lock_guard<std::mutex> lock(state_->mutex);
+        if (!state_->cancelled) {
+            uint64_t id = state_->nextId++;
+            state_->callbacks.emplace(id, std::move(callback));
+            return Registration(state_, id);
+        }
+    }
+    callback();
+    return Registration();
+}
+
+CancellationToken& CancellationToken::current() {
+    static thread_local CancellationToken token;
+    return token;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+CancellationScope::CancellationScope() : previous_(CancellationToken::current()) {
+    CancellationToken::current() = token_;
+}
+
+CancellationScope::CancellationScope(const CancellationToken& token) :
+    token_(token), previous_(CancellationToken::current()) {
+    CancellationToken::current() = token_;
+}
+
+CancellationScope::~CancellationScope() {
+    CancellationToken::current() = previous_;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace gribjump
@@ -0,0 +1,116 @@
+/*
+ * (C) Copyright 2023- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+/// @author Caragh Bradley
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+namespace gribjump {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/// Shared, thread-safe cancellation flag for one operation (a client call, or a request being served).
+///
+/// Copies share the same state, so a token can be handed to the threads doing the work while another thread
+/// cancels it. Each thread has a current token, which TaskGroups created on that thread observe; a
+/// CancellationScope installs a fresh one for the duration of an operation.
+class CancellationToken {
+public:
+
+    using Callback = std::function<void()>;
+
+    /// RAII handle for a callback registered with onCancel(). Once destroyed, the callback is guaranteed not to be
+    /// running and never to be called.
+    class Registration {
+    public:
+
+        Registration() = default;
+        Registration(const Registration&)            = delete;
+        Registration& operator=(const Registration&) = delete;
+        Registration(Registration&& other) noexcept;
+        Registration& operator=(Registration&& other) noexcept;
+        ~Registration();
+
+    private:
+
+        friend class CancellationToken;
+
+        struct State;
+        Registration(std::shared_ptr<State> state, uint64_t id);
+
+        std::shared_ptr<State> state_;
+        uint64_t id_ = 0;
+    };
+
+public:
+
+    CancellationToken();
+
+    /// Cancel the operation. Only the first reason is kept. Runs the registered callbacks on the calling thread,
+    /// without holding any lock of the token.
+    void cancel(const std::string& reason);
+
+    bool cancelled() const;
+
+    /// Reason given to the first call to cancel(), or empty if not cancelled.
+    std::string reason() const;
+
+    /// Register a callback to be run when the token is cancelled, e.g. to interrupt blocking I/O.
+    /// If the token is already cancelled, the callback is run immediately.
+    Registration onCancel(Callback callback);
+
+    bool operator==(const CancellationToken& other) const { return state_ == other.state_; }
+
+    /// The token of the operation running on the calling thread.
+    static CancellationToken& current();
+
+private:
+
+    std::shared_ptr<Registration::State> state_;
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/// Installs a token as the calling thread's current token, restoring the previous one on destruction.
+class CancellationScope {
+public:
+
+    /// Install a fresh token
+    CancellationScope();
+
+    /// Install an existing token, e.g. to run part of a request on a worker thread
+    explicit CancellationScope(const CancellationToken& token);
+
+    CancellationScope(const CancellationScope&)            = delete;
+    CancellationScope& operator=(const CancellationScope&) = delete;
+
+    ~CancellationScope();
+
+    CancellationToken& token() { return token_; }
+
+private:
+
+    CancellationToken token_;
+    CancellationToken previous_;
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace gribjump
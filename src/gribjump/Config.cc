@@ -11,8 +11,10 @@
 /// @author Caragh Bradley
 
 #include "gribjump/Config.h"
+#include <map>
 #include "eckit/config/Resource.h"
 #include "eckit/config/YAMLConfiguration.h"
+#include "eckit/exception/Exceptions.h"
 #include "eckit/filesystem/PathName.h"
 #include "gribjump/LibGribJump.h"
 #include "gribjump/LogRouter.h"
@@ -24,12 +26,37 @@ namespace gribjump {
 // or `remote`.
 // - server        // Configuration for gribjump-server.
 //   - port        // The port to listen on for incoming work.
+//   - admission   // Admission control for extraction requests. Limits of 0 mean unlimited. Disabled by default.
+//     - maxRequests // Maximum number of extractions executing concurrently.
+//     - maxMemory   // Maximum estimated result memory, in bytes, of extractions executing concurrently.
+//     - maxQueued   // Maximum number of extractions waiting for admission before new ones are rejected.
+//     - timeout     // Seconds to wait for admission before rejecting. DEFAULT=60. 0 rejects immediately.
+//   - resultCache // Cache of recent extraction results, for repeated identical extractions. Disabled by default.
+//     - maxMemory   // Maximum total bytes of cached results. DEFAULT=0 (disabled).
+//     - ttl         // Seconds a result is served for after it was extracted. DEFAULT=60
+//   - connectionPollInterval // Seconds between checks that the client of a request is connected. DEFAULT=0.1
+//   - metrics     // Aggregated metrics endpoint.
+//     - port      // Port serving GET /metrics in the Prometheus text format. DEFAULT=0 (disabled).
+//     - recordRequests // Record the content of each request in the metrics log, for gribjump-load. DEFAULT=false
+// - scheduler     // Configuration of the worker thread scheduler.
+//   - weights     // Relative share of workers for each priority class (high, normal, low). DEFAULT=8/4/1.
+//   - numa        // Pin workers to NUMA nodes and keep the tasks of a request on its node. DEFAULT=false
 // - uri           // host:port of remote server to forward work to (requires type:remote)
 // - threads       // The number of worker threads for gribjump.extract. Default is 1.
 // - cache         // Configuration of the cache.
 //   - shadowfdb   // If true, the cache files will be stored in the same directory as data files. DEFAULT=true
 //   - directory   // The directory where the cache will be stored, instead of shadowing the FDB.
 //   - enable      // Whether to look at the cache at all. DEFAULT=true
+//   - size        // Number of infos held in memory. DEFAULT=1024
+//   - maxMemory   // Bytes of infos held in memory, in place of size. DEFAULT=0 (use size)
+//   - lazy        // Whether to build the infos missing from the index files on the fly. DEFAULT=true
+//   - writeBack   // Whether to append the infos built on the fly to the index files, in the background. DEFAULT=false
+//   - missingIndexTTL // Seconds for which an index file found missing is not looked for again. DEFAULT=5
+// - gridIndex     // Per-grid indexes for lat/lon point lookups. Disabled by default.
+//   - directory   // Directory where the indexes are stored, one file per grid hash.
+// - trace         // Per-request trace spans. Disabled by default.
+//   - file        // File to which spans are appended.
+//   - format      // `chrome` (Chrome trace events) or `otlp` (OTLP/JSON lines). DEFAULT=chrome
 // - plugin        // Configuration for using GribJump as a plugin to FDB, which generates jumpinfos on the fly for
 // fdb.archive()
 //                 // NOTE Plugin cannot be enabled from config, one must set the envar FDB_ENABLE_GRIBJUMP
@@ -88,12 +115,88 @@ int ConfigOptions::serverPort() const {
     return value;
 }
 
+size_t ConfigOptions::admissionMaxRequests() const {
+    static size_t value =
+        eckit::Resource<size_t>("$GRIBJUMP_ADMISSION_MAX_REQUESTS",
+                                LibGribJump::instance().config().getLong("server.admission.maxRequests", 0));
+    return value;
+}
+
+size_t ConfigOptions::admissionMaxMemory() const {
+    static size_t value = eckit::Resource<size_t>(
+        "$GRIBJUMP_ADMISSION_MAX_MEMORY", LibGribJump::instance().config().getLong("server.admission.maxMemory", 0));
+    return value;
+}
+
+size_t ConfigOptions::admissionMaxQueued() const {
+    static size_t value = eckit::Resource<size_t>(
+        "$GRIBJUMP_ADMISSION_MAX_QUEUED", LibGribJump::instance().config().getLong("server.admission.maxQueued", 0));
+    return value;
+}
+
+double ConfigOptions::admissionTimeout() const {
+    static double value = eckit::Resource<double>(
+        "$GRIBJUMP_ADMISSION_TIMEOUT", LibGribJump::instance().config().getDouble("server.admission.timeout", 60.0));
+    return value;
+}
+
+size_t ConfigOptions::resultCacheMaxMemory() const {
+    static size_t value =
+        eckit::Resource<size_t>("$GRIBJUMP_RESULT_CACHE_MAX_MEMORY",
+                                LibGribJump::instance().config().getLong("server.resultCache.maxMemory", 0));
+    return value;
+}
+
+double ConfigOptions::resultCacheTTL() const {
+    static double value = eckit::Resource<double>(
+        "$GRIBJUMP_RESULT_CACHE_TTL", LibGribJump::instance().config().getDouble("server.resultCache.ttl", 60.0));
+    return value;
+}
+
+int ConfigOptions::metricsPort() const {
+    static int value = eckit::Resource<int>("$GRIBJUMP_METRICS_PORT",
+                                            LibGribJump::instance().config().getInt("server.metrics.port", 0));
+    return value;
+}
+
+bool ConfigOptions::metricsRecordRequests() const {
+    static bool value = eckit::Resource<bool>(
+        "$GRIBJUMP_METRICS_RECORD_REQUESTS",
+        LibGribJump::instance().config().getBool("server.metrics.recordRequests", false));
+    return value;
+}
+
 size_t ConfigOptions::numThreads() const {
     static size_t value = eckit::Resource<size_t>("$GRIBJUMP_THREADS;gribjumpThreads",
                                                   LibGribJump::instance().config().getInt("threads", 1));
     return value;
 }
 
+size_t ConfigOptions::priorityWeight(const std::string& priority) const {
+    static const std::map<std::string, long> defaults = {{"high", 8}, {"normal", 4}, {"low", 1}};
+
+    auto it = defaults.find(priority);
+    ASSERT(it != defaults.end());
+    long value = LibGribJump::instance().config().getLong("scheduler.weights." + priority, it->second);
+    if (value <= 0) {
+        throw eckit::UserError("scheduler.weights." + priority + " must be positive, got " + std::to_string(value));
+    }
+    return value;
+}
+
+double ConfigOptions::connectionPollInterval() const {
+    static double value = eckit::Resource<double>(
+        "$GRIBJUMP_SERVER_CONNECTION_POLL_INTERVAL",
+        LibGribJump::instance().config().getDouble("server.connectionPollInterval", 0.1));
+    return value;
+}
+
+bool ConfigOptions::schedulerNuma() const {
+    static bool value = eckit::Resource<bool>("$GRIBJUMP_SCHEDULER_NUMA",
+                                              LibGribJump::instance().config().getBool("scheduler.numa", false));
+    return value;
+}
+
 bool ConfigOptions::ignoreGrid() const {
     static bool value = eckit::Resource<bool>("$GRIBJUMP_IGNORE_GRID",
                                               LibGribJump::instance().config().getBool("ignoreGridHash", false));
@@ -148,12 +251,47 @@ int ConfigOptions::cacheSize() const {
     return value;
 }
 
+size_t ConfigOptions::cacheMaxMemory() const {
+    static size_t value = eckit::Resource<size_t>("$GRIBJUMP_CACHE_MAX_MEMORY",
+                                                  LibGribJump::instance().config().getLong("cache.maxMemory", 0));
+    return value;
+}
+
 bool ConfigOptions::cacheLazy() const {
     static bool value =
         eckit::Resource<bool>("gribjumpLazyInfo", LibGribJump::instance().config().getBool("cache.lazy", true));
     return value;
 }
 
+bool ConfigOptions::cacheWriteBack() const {
+    static bool value = eckit::Resource<bool>("$GRIBJUMP_CACHE_WRITE_BACK",
+                                              LibGribJump::instance().config().getBool("cache.writeBack", false));
+    return value;
+}
+
+double ConfigOptions::cacheMissingIndexTTL() const {
+    static double value = eckit::Resource<double>(
+        "$GRIBJUMP_CACHE_MISSING_INDEX_TTL", LibGribJump::instance().config().getDouble("cache.missingIndexTTL", 5.0));
+    return value;
+}
+
+std::string ConfigOptions::gridIndexDirectory() const {
+    return eckit::Resource<std::string>("$GRIBJUMP_GRID_INDEX_DIR",
+                                        LibGribJump::instance().config().getString("gridIndex.directory", ""));
+}
+
+std::string ConfigOptions::traceFile() const {
+    static std::string value = eckit::Resource<std::string>(
+        "$GRIBJUMP_TRACE_FILE", LibGribJump::instance().config().getString("trace.file", ""));
+    return value;
+}
+
+std::string ConfigOptions::traceFormat() const {
+    static std::string value = eckit::Resource<std::string>(
+        "$GRIBJUMP_TRACE_FORMAT", LibGribJump::instance().config().getString("trace.format", "chrome"));
+    return value;
+}
+
 bool ConfigOptions::scanCorrupted() const {
     static bool value = eckit::Resource<bool>("$GRIBJUMP_SCAN_CORRUPTED", false);
     return value;
@@ -173,4 +311,16 @@ std::string ConfigOptions::pluginSelect() const {
     return LibGribJump::instance().config().getString("plugin.select", "");
 }
 
+size_t ConfigOptions::pluginThreads() const {
+    static size_t value = eckit::Resource<size_t>("$GRIBJUMP_PLUGIN_THREADS",
+                                                  LibGribJump::instance().config().getLong("plugin.threads", 2));
+    return value;
+}
+
+size_t ConfigOptions::pluginQueueSize() const {
+    static size_t value = eckit::Resource<size_t>("$GRIBJUMP_PLUGIN_QUEUE_SIZE",
+                                                  LibGribJump::instance().config().getLong("plugin.queueSize", 256));
+    return value;
+}
+
 }  // namespace gribjump
@@ -71,11 +71,58 @@ public:
     /// Server port. Env: GRIBJUMP_SERVER_PORT. YAML: server.port. Default: 9777.
     int serverPort() const;
 
+    /// Maximum number of extractions executing concurrently on the server, 0 for unlimited.
+    /// Env: GRIBJUMP_ADMISSION_MAX_REQUESTS. YAML: server.admission.maxRequests. Default: 0.
+    size_t admissionMaxRequests() const;
+
+    /// Maximum total estimated result memory (bytes) of extractions executing concurrently, 0 for unlimited.
+    /// Env: GRIBJUMP_ADMISSION_MAX_MEMORY. YAML: server.admission.maxMemory. Default: 0.
+    size_t admissionMaxMemory() const;
+
+    /// Maximum number of extractions waiting for admission before new ones are rejected, 0 for unlimited.
+    /// Env: GRIBJUMP_ADMISSION_MAX_QUEUED. YAML: server.admission.maxQueued. Default: 0.
+    size_t admissionMaxQueued() const;
+
+    /// Seconds an extraction may wait for admission before it is rejected. 0 rejects immediately when at capacity.
+    /// Env: GRIBJUMP_ADMISSION_TIMEOUT. YAML: server.admission.timeout. Default: 60.
+    double admissionTimeout() const;
+
+    /// Maximum total bytes of results kept to serve repeated identical extractions, 0 to disable the result cache.
+    /// Env: GRIBJUMP_RESULT_CACHE_MAX_MEMORY. YAML: server.resultCache.maxMemory. Default: 0.
+    size_t resultCacheMaxMemory() const;
+
+    /// Seconds a cached result is served for after it was extracted.
+    /// Env: GRIBJUMP_RESULT_CACHE_TTL. YAML: server.resultCache.ttl. Default: 60.
+    double resultCacheTTL() const;
+
+    /// Port of the HTTP endpoint serving aggregated metrics in the Prometheus text format, 0 to disable.
+    /// Env: GRIBJUMP_METRICS_PORT. YAML: server.metrics.port. Default: 0.
+    int metricsPort() const;
+
+    /// If true, the server adds the full content of each extract, axes and scan request to its line in the metrics
+    /// log, under "workload", so that gribjump-load can replay the recorded request mix.
+    /// Env: GRIBJUMP_METRICS_RECORD_REQUESTS. YAML: server.metrics.recordRequests. Default: false.
+    bool metricsRecordRequests() const;
+
+    /// Seconds between checks that the client of a request being executed is still connected, 0 to disable them.
+    /// Each request executing is watched by a thread of its own, which wakes at this interval.
+    /// Env: GRIBJUMP_SERVER_CONNECTION_POLL_INTERVAL. YAML: server.connectionPollInterval. Default: 0.1.
+    double connectionPollInterval() const;
+
     // -- Worker options --
 
     /// Number of worker threads. Env: GRIBJUMP_THREADS. Resource: gribjumpThreads. YAML: threads. Default: 1.
     size_t numThreads() const;
 
+    /// Share of worker threads given to the named priority class ("high", "normal" or "low") when several classes
+    /// have queued tasks. YAML: scheduler.weights.<class>. Default: high=8, normal=4, low=1.
+    size_t priorityWeight(const std::string& priority) const;
+
+    /// If true, and the machine has several NUMA nodes, pin the worker threads and the connection threads of the server
+    /// to the nodes, and queue the tasks of a request on the node of its connection. Env: GRIBJUMP_SCHEDULER_NUMA.
+    /// YAML: scheduler.numa. Default: false.
+    bool schedulerNuma() const;
+
     // -- Extraction options --
 
     /// If true, ignore grid hash checks during extraction. Env: GRIBJUMP_IGNORE_GRID. YAML: ignoreGridHash.
@@ -119,13 +166,44 @@ public:
     /// Default: true when cache.directory is empty.
     bool cacheShadowFdb() const;
 
-    /// In-memory LRU cache size. Resource: gribjumpCacheSize. YAML: cache.size. Default: 1024.
+    /// In-memory LRU cache size, in infos. Resource: gribjumpCacheSize. YAML: cache.size. Default: 1024.
     int cacheSize() const;
 
+    /// Approximate memory, in bytes, the in-memory LRU cache may hold, in place of cache.size. 0 sizes the cache by
+    /// cache.size instead. Env: GRIBJUMP_CACHE_MAX_MEMORY. YAML: cache.maxMemory. Default: 0.
+    size_t cacheMaxMemory() const;
+
     /// If true, construct JumpInfo on the fly on cache miss. Resource: gribjumpLazyInfo. YAML: cache.lazy.
     /// Default: true.
     bool cacheLazy() const;
 
+    /// If true, the infos built on a cache miss are also appended to the index file of their data file, in the
+    /// background, so that they are not built again by the next process. Requires cache.lazy.
+    /// Env: GRIBJUMP_CACHE_WRITE_BACK. YAML: cache.writeBack. Default: false.
+    bool cacheWriteBack() const;
+
+    /// Seconds for which an index file found missing is assumed to still be missing, rather than looked for on every
+    /// cache miss. 0 looks for it every time. Env: GRIBJUMP_CACHE_MISSING_INDEX_TTL. YAML: cache.missingIndexTTL.
+    /// Default: 5.
+    double cacheMissingIndexTTL() const;
+
+    // -- Grid index options --
+
+    /// Directory in which the server keeps one point-lookup index per grid (md5GridSection), built the first time a
+    /// field on that grid is scanned. Empty disables lat/lon lookups.
+    /// Env: GRIBJUMP_GRID_INDEX_DIR. YAML: gridIndex.directory. Default: "" (empty).
+    std::string gridIndexDirectory() const;
+
+    // -- Tracing options --
+
+    /// File to which trace spans of each request are appended, or empty to disable tracing.
+    /// Env: GRIBJUMP_TRACE_FILE. YAML: trace.file. Default: "" (empty).
+    std::string traceFile() const;
+
+    /// Format of the trace file: "chrome" (Chrome trace events) or "otlp" (OTLP/JSON lines).
+    /// Env: GRIBJUMP_TRACE_FORMAT. YAML: trace.format. Default: "chrome".
+    std::string traceFormat() const;
+
     // -- Scan options --
 
     /// If true, attempt to scan corrupted GRIB files. Env: GRIBJUMP_SCAN_CORRUPTED. Default: false.
@@ -145,6 +223,14 @@ public:
     /// Plugin select expression for filtering FDB keys. YAML: plugin.select. Default: "" (empty).
     std::string pluginSelect() const;
 
+    /// Number of threads building the infos of archived messages in the background.
+    /// Env: GRIBJUMP_PLUGIN_THREADS. YAML: plugin.threads. Default: 2.
+    size_t pluginThreads() const;
+
+    /// Maximum number of archived messages waiting for their infos to be built, beyond which archiving blocks.
+    /// Env: GRIBJUMP_PLUGIN_QUEUE_SIZE. YAML: plugin.queueSize. Default: 256.
+    size_t pluginQueueSize() const;
+
 private:
 
     ConfigOptions() = default;
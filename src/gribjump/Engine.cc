@@ -15,11 +15,16 @@
 #include "gribjump/LogRouter.h"
 #include "metkit/mars/MarsParser.h"
 
+#include <optional>
 #include <sstream>
 #include "gribjump/Config.h"
 #include "gribjump/Engine.h"
 #include "gribjump/ExtractionItem.h"
 #include "gribjump/Forwarder.h"
+#include "gribjump/GridIndex.h"
+#include "gribjump/ResultCache.h"
+#include "gribjump/Tracing.h"
+#include "gribjump/jumper/DecodePlan.h"
 
 
 namespace gribjump {
@@ -152,6 +157,28 @@ filemap_t Engine::buildFileMapfromPaths(ExItemMap& keyToExtractionItem) {
 
 TaskReport Engine::scheduleExtractionTasks(filemap_t& filemap, bool forward) {
 
+    // Serve repeated extractions from the result cache, and extract only the others. Forwarded extractions are cached
+    // by the servers they are forwarded to.
+    ResultCache& cache = ResultCache::instance();
+    const bool cached  = !forward && cache.enabled();
+    filemap_t misses;
+    if (cached) {
+        size_t nhits = 0;
+        misses       = cache.lookup(filemap, nhits);
+        MetricsManager::instance().set("count_result_cache_hits", nhits);
+    }
+    if (cached && misses.empty()) {
+        return TaskReport();
+    }
+    filemap_t& pending = cached ? misses : filemap;
+
+    // Block (or throw) until the server has capacity to hold the results of this extraction.
+    AdmissionController& admission = AdmissionController::instance();
+    if (admission.enabled()) {
+        TraceSpan span("admission_wait");
+        admission_ = admission.admit(AdmissionCost::estimate(pending));
+    }
+
     if (forward) {
         Forwarder forwarder;
         return forwarder.extract(filemap);
@@ -161,7 +188,7 @@ TaskReport Engine::scheduleExtractionTasks(filemap_t& filemap, bool forward) {
 
     TaskGroup taskGroup;
 
-    for (auto& [fname, extractionItems] : filemap) {
+    for (auto& [fname, extractionItems] : pending) {
         if (extractionItems[0]->isRemote()) {
             if (inefficientExtraction) {
                 taskGroup.enqueueTask<InefficientFileExtractionTask>(fname, extractionItems);
@@ -181,20 +208,58 @@ TaskReport Engine::scheduleExtractionTasks(filemap_t& filemap, bool forward) {
 TaskOutcome<ResultsMap> Engine::extract(ExtractionRequests& requests) {
 
     eckit::Timer timer("Engine::extract", LogRouter::instance().get("timer"));
+    std::optional<TraceSpan> phase(std::in_place, "build_filemap");
 
     ExItemMap keyToExtractionItem;
     metkit::mars::MarsRequest unionreq = buildRequestMap(requests, keyToExtractionItem);
 
+    return extractItems(unionreq, keyToExtractionItem, timer, phase);
+}
+
+TaskOutcome<ResultsMap> Engine::extractTimeSeries(const metkit::mars::MarsRequest& request,
+                                                  const std::vector<std::string>& fields,
+                                                  const std::vector<Range>& ranges, const std::string& gridHash) {
+
+    eckit::Timer timer("Engine::extractTimeSeries", LogRouter::instance().get("timer"));
+    std::optional<TraceSpan> phase(std::in_place, "build_filemap");
+
+    // The fields are already canonical, and the request is their union: no need to split and re-parse strings
+    // Every field has the same ranges: plan their decoding once, for all of them
+    auto plan = std::make_shared<const DecodePlan>(ranges);
+    ExItemMap keyToExtractionItem;
+    for (const auto& field : fields) {
+        auto extractionRequest = std::make_unique<ExtractionRequest>(field, ranges, gridHash);
+        auto extractionItem    = std::make_unique<ExtractionItem>(std::move(extractionRequest));
+        extractionItem->plan(plan);
+        bool inserted = keyToExtractionItem.emplace(field, std::move(extractionItem)).second;
+        ASSERT(inserted);
+    }
+
+    static bool ignoreYearMonth = ConfigOptions::instance().ignoreYearMonth();
+    metkit::mars::MarsRequest unionreq(request);
+    if (ignoreYearMonth && unionreq.has("date")) {
+        unionreq.unsetValues("year");
+        unionreq.unsetValues("month");
+    }
+
+    return extractItems(unionreq, keyToExtractionItem, timer, phase);
+}
+
+TaskOutcome<ResultsMap> Engine::extractItems(const metkit::mars::MarsRequest& unionreq, ExItemMap& keyToExtractionItem,
+                                             eckit::Timer& timer, std::optional<TraceSpan>& phase) {
+
     // Build file map
     filemap_t filemap = buildFileMap(unionreq, keyToExtractionItem);
     MetricsManager::instance().set("elapsed_build_filemap", timer.elapsed());
     timer.reset("Gribjump Engine: Built file map");
+    phase.emplace("tasks");
 
     // Schedule tasks
     bool forward      = ConfigOptions::instance().forwardExtraction();
     TaskReport report = scheduleExtractionTasks(filemap, forward);
     MetricsManager::instance().set("elapsed_tasks", timer.elapsed());
     timer.reset("Gribjump Engine: All tasks finished");
+    phase.emplace("collect_results");
 
     // Collect results
     ResultsMap results = collectResults(keyToExtractionItem);
@@ -204,10 +269,10 @@ TaskOutcome<ResultsMap> Engine::extract(ExtractionRequests& requests) {
     return {std::move(results), std::move(report)};
 }
 
-
 TaskOutcome<ResultsMap> Engine::extract(PathExtractionRequests& requests) {
 
     eckit::Timer timer("Engine::extract", LogRouter::instance().get("timer"));
+    std::optional<TraceSpan> phase(std::in_place, "build_filemap");
 
     ExItemMap keyToExtractionItem;  // Will collect path str uris -> extraction items
     buildRequestURIsMap(requests, keyToExtractionItem);
@@ -217,6 +282,7 @@ TaskOutcome<ResultsMap> Engine::extract(PathExtractionRequests& requests) {
     filemap_t filemap = buildFileMapfromPaths(keyToExtractionItem);
     MetricsManager::instance().set("elapsed_build_filemap", timer.elapsed());
     timer.reset("Gribjump Engine: Built file map");
+    phase.emplace("tasks");
 
     // Schedule tasks: if there is no host and port, set forward to false, otherwise set to true
     bool forward = true;
@@ -226,6 +292,7 @@ TaskOutcome<ResultsMap> Engine::extract(PathExtractionRequests& requests) {
     TaskReport report = scheduleExtractionTasks(filemap, forward);
     MetricsManager::instance().set("elapsed_tasks", timer.elapsed());
     timer.reset("Gribjump Engine: All tasks finished");
+    phase.emplace("collect_results");
 
     // Collect results
     ResultsMap results = collectResults(keyToExtractionItem);
@@ -302,6 +369,10 @@ std::map<std::string, std::unordered_set<std::string>> Engine::axes(const std::s
     return FDBLister::instance().axes(request, level);
 }
 
+GridSelection Engine::selectPoints(const GridQuery& query) {
+    return GridIndexCache::instance().get(query.gridHash())->select(query);
+}
+
 //----------------------------------------------------------------------------------------------------------------------
 
 }  // namespace gribjump
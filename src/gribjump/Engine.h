@@ -12,11 +12,17 @@
 
 #pragma once
 
+#include <optional>
+
+#include "eckit/log/Timer.h"
 #include "eckit/serialisation/Stream.h"
+#include "gribjump/AdmissionController.h"
 #include "gribjump/ExtractionItem.h"
+#include "gribjump/GridSelection.h"
 #include "gribjump/Lister.h"
 #include "gribjump/Metrics.h"
 #include "gribjump/Task.h"
+#include "gribjump/Tracing.h"
 #include "gribjump/Types.h"
 #include "metkit/mars/MarsRequest.h"
 
@@ -48,6 +54,8 @@ public:
     virtual std::map<std::string, std::unordered_set<std::string> > axes(const std::string& request, int level = 3) = 0;
 
     virtual TaskReport scheduleExtractionTasks(filemap_t& filemap, bool forward = false) = 0;
+
+    virtual GridSelection selectPoints(const GridQuery& query) = 0;
 };
 
 //----------------------------------------------------------------------------------------------------------------------
@@ -61,6 +69,12 @@ public:
     TaskOutcome<ResultsMap> extract(ExtractionRequests& requests) override;
     TaskOutcome<ResultsMap> extract(PathExtractionRequests& requests);
 
+    /// Extract the same ranges from every field of a multi-valued request. The fields are the canonical strings of
+    /// timeSeriesFields(request), which are the keys of the results.
+    TaskOutcome<ResultsMap> extractTimeSeries(const metkit::mars::MarsRequest& request,
+                                              const std::vector<std::string>& fields, const std::vector<Range>& ranges,
+                                              const std::string& gridHash);
+
     // byfiles: scan entire file, not just fields matching request
     TaskOutcome<size_t> scan(const MarsRequests& requests, bool byfiles = false) override;
     TaskOutcome<size_t> scan(std::vector<eckit::PathName> files);
@@ -70,15 +84,24 @@ public:
 
     TaskReport scheduleExtractionTasks(filemap_t& filemap, bool forward = false) override;
 
+    /// Look up grid points by coordinates, in the index of the grid (see GridIndexCache)
+    GridSelection selectPoints(const GridQuery& query) override;
+
 private:
 
     filemap_t buildFileMap(const metkit::mars::MarsRequest& unionrequest, ExItemMap& keyToExtractionItem);
     filemap_t buildFileMapfromPaths(ExItemMap& keyToExtractionItem);
     ResultsMap collectResults(ExItemMap& keyToExtractionItem);
+    TaskOutcome<ResultsMap> extractItems(const metkit::mars::MarsRequest& unionrequest, ExItemMap& keyToExtractionItem,
+                                         eckit::Timer& timer, std::optional<TraceSpan>& phase);
     metkit::mars::MarsRequest buildRequestMap(ExtractionRequests& requests, ExItemMap& keyToExtractionItem);
     void buildRequestURIsMap(PathExtractionRequests& requests, ExItemMap& keyToExtractionItem);
 
 private:
+
+    /// Resources granted by the AdmissionController to this engine's extraction. Held until the engine is destroyed,
+    /// i.e. until the results have been returned to the caller (or sent to the client).
+    AdmissionTicket admission_;
 };
 
 
@@ -37,40 +37,6 @@ std::vector<T> decodeVector(eckit::Stream& s) {
     return std::vector<T>(data, data + size);
 }
 
-template <typename T>
-void encodeVectorVector(eckit::Stream& s, const std::vector<std::vector<T>>& vv) {
-    std::vector<size_t> sizes;
-    sizes.reserve(vv.size());
-    size_t totalSize = 0;
-    for (auto& v : vv) {
-        sizes.push_back(v.size());
-        totalSize += v.size();
-    }
-    encodeVector(s, sizes);
-
-    // Make a flat vector
-    std::vector<T> flat;
-    flat.reserve(totalSize);
-    for (auto& v : vv) {
-        flat.insert(flat.end(), v.begin(), v.end());
-    }
-    encodeVector(s, flat);
-}
-
-template <typename T>
-std::vector<std::vector<T>> decodeVectorVector(eckit::Stream& s) {
-    std::vector<size_t> sizes = decodeVector<size_t>(s);
-    std::vector<T> flat       = decodeVector<T>(s);
-
-    std::vector<std::vector<T>> vv;
-    size_t pos = 0;
-    for (auto& size : sizes) {
-        vv.push_back(std::vector<T>(flat.begin() + pos, flat.begin() + pos + size));
-        pos += size;
-    }
-    return vv;
-}
-
 void encodeRanges(eckit::Stream& s, const std::vector<Range>& ranges) {
     size_t size = ranges.size();
     s << size;
@@ -93,70 +59,132 @@ std::vector<Range> decodeRanges(eckit::Stream& s) {
     return ranges;
 }
 
-void encodeMask(eckit::Stream& s, const std::vector<std::vector<std::bitset<64>>>& mask) {
-
-    size_t totalSize = 0;
+/// Sizes of the ranges delimited by an offset table
+std::vector<size_t> sizesFromOffsets(const std::vector<size_t>& offsets) {
     std::vector<size_t> sizes;
-    for (auto& v : mask) {
-        totalSize += v.size();
-        sizes.push_back(v.size());
+    if (offsets.empty()) {
+        return sizes;
     }
-    std::vector<uint64_t> flat;
-    flat.reserve(totalSize);
-    for (auto& v : mask) {
-        for (auto& b : v) {
-            flat.push_back(b.to_ullong());
-        }
+    sizes.reserve(offsets.size() - 1);
+    for (size_t i = 1; i < offsets.size(); i++) {
+        sizes.push_back(offsets[i] - offsets[i - 1]);
     }
-    encodeVector(s, sizes);
-    encodeVector(s, flat);
+    return sizes;
 }
 
-std::vector<std::vector<std::bitset<64>>> decodeMask(eckit::Stream& s) {
-
-    std::vector<size_t> sizes  = decodeVector<size_t>(s);
-    std::vector<uint64_t> flat = decodeVector<uint64_t>(s);
-
-    std::vector<std::vector<std::bitset<64>>> mask;
-    size_t pos = 0;
-    for (auto& size : sizes) {
-        std::vector<std::bitset<64>> maskBitset;
-        for (size_t i = 0; i < size; i++) {
-            maskBitset.push_back(std::bitset<64>(flat[pos + i]));
-        }
-        mask.push_back(maskBitset);
-        pos += size;
+/// Offset table for consecutive ranges of the given sizes
+std::vector<size_t> offsetsFromSizes(const std::vector<size_t>& sizes) {
+    std::vector<size_t> offsets;
+    offsets.reserve(sizes.size() + 1);
+    offsets.push_back(0);
+    for (size_t size : sizes) {
+        offsets.push_back(offsets.back() + size);
     }
-    return mask;
+    return offsets;
 }
+
 }  // namespace
 
-ExtractionResult::ExtractionResult() {}
+ExtractionResult::ExtractionResult() : valueOffsets_{0}, maskOffsets_{0} {}
+
+ExtractionResult::ExtractionResult(const std::vector<size_t>& rangeSizes) :
+    valueOffsets_(offsetsFromSizes(rangeSizes)) {
+    std::vector<size_t> maskSizes;
+    maskSizes.reserve(rangeSizes.size());
+    for (size_t size : rangeSizes) {
+        maskSizes.push_back((size + 63) / 64);
+    }
+    maskOffsets_ = offsetsFromSizes(maskSizes);
+
+    values_.resize(valueOffsets_.back());
+    mask_.resize(maskOffsets_.back());
+}
 
 ExtractionResult::ExtractionResult(std::vector<std::vector<double>>&& values,
                                    std::vector<std::vector<std::bitset<64>>>&& mask) :
-    values_(std::move(values)), mask_(std::move(mask)) {}
+    valueOffsets_{0}, maskOffsets_{0} {
+    for (const auto& v : values) {
+        valueOffsets_.push_back(valueOffsets_.back() + v.size());
+    }
+    for (const auto& m : mask) {
+        maskOffsets_.push_back(maskOffsets_.back() + m.size());
+    }
+
+    values_.reserve(valueOffsets_.back());
+    for (const auto& v : values) {
+        values_.insert(values_.end(), v.begin(), v.end());
+    }
+    mask_.reserve(maskOffsets_.back());
+    for (const auto& m : mask) {
+        for (const auto& b : m) {
+            mask_.push_back(b.to_ullong());
+        }
+    }
+}
 
+std::unique_ptr<ExtractionResult> ExtractionResult::clone() const {
+    auto copy           = std::make_unique<ExtractionResult>();
+    copy->values_       = values_;
+    copy->valueOffsets_ = valueOffsets_;
+    copy->mask_         = mask_;
+    copy->maskOffsets_  = maskOffsets_;
+    return copy;
+}
+
+// Wire format: range sizes and flat values, then mask sizes (in words) and flat mask words.
 ExtractionResult::ExtractionResult(eckit::Stream& s) {
-    values_ = decodeVectorVector<double>(s);
-    mask_   = decodeMask(s);
+    valueOffsets_ = offsetsFromSizes(decodeVector<size_t>(s));
+    values_       = decodeVector<double>(s);
+    maskOffsets_  = offsetsFromSizes(decodeVector<size_t>(s));
+    mask_         = decodeVector<uint64_t>(s);
+    ASSERT(values_.size() == valueOffsets_.back());
+    ASSERT(mask_.size() == maskOffsets_.back());
 }
 
 void ExtractionResult::encode(eckit::Stream& s) const {
-    encodeVectorVector(s, values_);
-    encodeMask(s, mask_);
+    encodeVector(s, sizesFromOffsets(valueOffsets_));
+    encodeVector(s, values_);
+    encodeVector(s, sizesFromOffsets(maskOffsets_));
+    encodeVector(s, mask_);
+}
+
+const std::vector<std::vector<double>>& ExtractionResult::values() const {
+    if (!legacyValues_) {
+        legacyValues_ = std::make_unique<std::vector<std::vector<double>>>();
+        legacyValues_->reserve(nrange());
+        for (size_t i = 0; i < nrange(); i++) {
+            legacyValues_->push_back(values(i).toVector());
+        }
+    }
+    return *legacyValues_;
+}
+
+const std::vector<std::vector<std::bitset<64>>>& ExtractionResult::mask() const {
+    if (!legacyMask_) {
+        legacyMask_ = std::make_unique<std::vector<std::vector<std::bitset<64>>>>();
+        legacyMask_->reserve(nrange());
+        for (size_t i = 0; i < nrange(); i++) {
+            Span<const uint64_t> words = mask(i);
+            legacyMask_->emplace_back(words.begin(), words.end());
+        }
+    }
+    return *legacyMask_;
 }
 
 void ExtractionResult::print(std::ostream& s) const {
     s << "ExtractionResult[Values:[";
-    for (auto& v : values_) {
-        s << v << ", ";
+    for (size_t i = 0; i < nrange(); i++) {
+        s << "[";
+        for (double v : values(i)) {
+            s << v << ", ";
+        }
+        s << "], ";
     }
     s << "]; Masks:[";
-    for (auto& v : mask_) {
+    for (size_t i = 0; i < nrange(); i++) {
         s << "[";
-        for (auto& b : v) {
-            s << std::hex << b.to_ullong() << std::dec << ", ";
+        for (uint64_t w : mask(i)) {
+            s << std::hex << w << std::dec << ", ";
         }
         s << "], ";
     }
@@ -14,19 +14,34 @@
 #pragma once
 
 #include <bitset>
+#include <cstdint>
+#include <memory>
 #include <vector>
 
 #include "eckit/serialisation/Stream.h"
+#include "gribjump/Span.h"
 #include "gribjump/Types.h"
 
 namespace gribjump {
 
 //----------------------------------------------------------------------------------------------------------------------
 
+/// Values and masks extracted from one field, for each of the requested ranges.
+///
+/// All values are stored in a single contiguous array, and all mask words in another, with offset tables locating
+/// each range. Range i has nvalues(i) values, values(i), and a mask of (nvalues(i) + 63) / 64 words, mask(i), in which
+/// bit j of word k is set if value 64k + j is present (i.e. not missing).
+///
+/// The vector-of-vector accessors values() and mask() are kept for compatibility. They build a copy on first use, which
+/// is discarded by the mutable accessors, so prefer the per-range accessors.
 class ExtractionResult {
 public:  // methods
 
     ExtractionResult();
+
+    /// Allocate storage for ranges of the given number of values. Values are zero and masks are unset.
+    explicit ExtractionResult(const std::vector<size_t>& rangeSizes);
+
     ExtractionResult(std::vector<std::vector<double>>&& values, std::vector<std::vector<std::bitset<64>>>&& mask);
     explicit ExtractionResult(eckit::Stream& s);
 
@@ -37,21 +52,46 @@ public:  // methods
     ExtractionResult(ExtractionResult&&)            = default;
     ExtractionResult& operator=(ExtractionResult&&) = default;
 
-    std::vector<std::vector<double>>& mutable_values() { return values_; }
-    std::vector<std::vector<std::bitset<64>>>& mutable_mask() { return mask_; }
-    const std::vector<std::vector<double>>& values() const { return values_; }
-    const std::vector<std::vector<std::bitset<64>>>& mask() const { return mask_; }
-
-    size_t nrange() const { return values_.size(); }
-    size_t nvalues(size_t i) const { return values_[i].size(); }
-    size_t total_values() const {
-        size_t total = 0;
-        for (auto& v : values_) {
-            total += v.size();
-        }
-        return total;
+    /// Deep copy, e.g. to serve a cached result
+    std::unique_ptr<ExtractionResult> clone() const;
+
+    size_t nrange() const { return valueOffsets_.empty() ? 0 : valueOffsets_.size() - 1; }
+    size_t nvalues(size_t i) const { return valueOffsets_[i + 1] - valueOffsets_[i]; }
+    size_t total_values() const { return values_.size(); }
+    size_t total_mask_words() const { return mask_.size(); }
+
+    Span<const double> values(size_t i) const { return {values_.data() + valueOffsets_[i], nvalues(i)}; }
+    Span<const uint64_t> mask(size_t i) const {
+        return {mask_.data() + maskOffsets_[i], maskOffsets_[i + 1] - maskOffsets_[i]};
     }
 
+    /// Values of all ranges, in order
+    Span<const double> allValues() const { return {values_.data(), values_.size()}; }
+    /// Mask words of all ranges, in order
+    Span<const uint64_t> allMasks() const { return {mask_.data(), mask_.size()}; }
+    /// nrange() + 1 offsets into allValues(): range i is [offsets()[i], offsets()[i+1])
+    Span<const size_t> offsets() const { return {valueOffsets_.data(), valueOffsets_.size()}; }
+
+    /// Writable views. Discard the copies made by values() and mask(), which would otherwise be stale.
+    Span<double> mutable_values(size_t i) {
+        legacyValues_.reset();
+        return {values_.data() + valueOffsets_[i], nvalues(i)};
+    }
+    Span<uint64_t> mutable_mask(size_t i) {
+        legacyMask_.reset();
+        return {mask_.data() + maskOffsets_[i], maskOffsets_[i + 1] - maskOffsets_[i]};
+    }
+    Span<double> mutable_values() {
+        legacyValues_.reset();
+        return {values_.data(), values_.size()};
+    }
+
+    /// @deprecated Copies the values on first use, until the next call to mutable_values(). Not thread-safe.
+    const std::vector<std::vector<double>>& values() const;
+
+    /// @deprecated Copies the masks on first use, until the next call to mutable_mask(). Not thread-safe.
+    const std::vector<std::vector<std::bitset<64>>>& mask() const;
+
 private:  // methods
 
     void encode(eckit::Stream& s) const;
@@ -62,8 +102,14 @@ private:  // methods
 
 private:  // members
 
-    std::vector<std::vector<double>> values_;
-    std::vector<std::vector<std::bitset<64>>> mask_;
+    std::vector<double> values_;
+    std::vector<size_t> valueOffsets_;  //< nrange + 1 entries. Range i is [valueOffsets_[i], valueOffsets_[i+1])
+    std::vector<uint64_t> mask_;
+    std::vector<size_t> maskOffsets_;  //< nrange + 1 entries, as valueOffsets_
+
+    // Built on demand by the compatibility accessors
+    mutable std::unique_ptr<std::vector<std::vector<double>>> legacyValues_;
+    mutable std::unique_ptr<std::vector<std::vector<std::bitset<64>>>> legacyMask_;
 };
 
 //----------------------------------------------------------------------------------------------------------------------
@@ -23,6 +23,8 @@
 #include "gribjump/URIHelper.h"
 namespace gribjump {
 
+struct DecodePlan;
+
 // An object for grouping request, uri and result information together.
 /// @todo: Recently reworked. Code which uses this object could be refactored to have less moving of vectors to and from
 /// this object.
@@ -59,8 +61,12 @@ public:
     const Ranges& intervals() const { return request_->ranges(); }
     const std::string& request() const { return request_->requestString(); }
     const std::string& gridHash() const { return request_->gridHash(); }
+    /// The decode plan of the intervals, if it was built ahead of extraction and shared with other items
+    const std::shared_ptr<const DecodePlan>& plan() const { return plan_; }
 
     std::unique_ptr<ExtractionResult> result() { return std::move(result_); }
+    /// The result, still owned by this item
+    const ExtractionResult* peekResult() const { return result_.get(); }
 
     /// @note alternatively we could store the offset directly instead of the uri.
     eckit::Offset offset() const {
@@ -79,7 +85,11 @@ public:
 
     // Setters
     void URI(const eckit::URI& uri) { uri_ = uri; }
-    void request(std::unique_ptr<ExtractionRequest> request) { request_ = std::move(request); }
+    void request(std::unique_ptr<ExtractionRequest> request) {
+        request_ = std::move(request);
+        plan_.reset();
+    }
+    void plan(std::shared_ptr<const DecodePlan> plan) { plan_ = std::move(plan); }
     void result(std::unique_ptr<ExtractionResult> result) { result_ = std::move(result); }
 
     bool isRemote() const { return URIHelper::isRemote(uri_); }
@@ -95,6 +105,7 @@ public:
 private:
 
     std::unique_ptr<ExtractionRequest> request_;
+    std::shared_ptr<const DecodePlan> plan_;
 
     // Set on Listing
     eckit::URI uri_;
@@ -76,7 +76,13 @@ void FDBPlugin::addFDB(fdb5::CallbackRegistry& fdb) {
         if (!aggregator)
             return;  // It's possible that no keys ever matched, so the aggregator was never created.
         LOG_DEBUG_LIB(LibGribJump) << "Flush callback" << std::endl;
-        aggregator->flush();
+        try {
+            aggregator->flush();
+        }
+        catch (...) {
+            aggregator.reset();  // The queue is closed: start afresh on the next archive
+            throw;
+        }
         aggregator.reset();
     });
 }
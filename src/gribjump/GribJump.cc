@@ -16,7 +16,9 @@
 #include "gribjump/ExtractionData.h"
 #include "gribjump/GribJump.h"
 #include "gribjump/GribJumpBase.h"
+#include "gribjump/GribJumpException.h"
 #include "gribjump/GribJumpFactory.h"
+#include "gribjump/Tracing.h"
 #include "gribjump/Types.h"
 #include "gribjump/api/ExtractionIterator.h"
 #include "gribjump/tools/ToolUtils.h"
@@ -24,6 +26,51 @@
 
 namespace gribjump {
 
+//----------------------------------------------------------------------------------------------------------------------
+
+/// An operation in progress on a GribJump handle. Installs a fresh cancellation token on the calling thread, and
+/// registers it with the handle so that GribJump::cancel() can reach it. The operation is the root trace span of the
+/// work it does, unless the caller's LogContext already names a parent span.
+class GribJump::Operation {
+public:
+
+    Operation(GribJump& gj, const std::string& name) : gj_(gj), span_(name) {
+        std::lock_guard<std::mutex> lock(gj_.operationsMutex_);
+        it_ = gj_.operations_.insert(gj_.operations_.end(), scope_.token());
+    }
+
+    ~Operation() {
+        std::lock_guard<std::mutex> lock(gj_.operationsMutex_);
+        gj_.operations_.erase(it_);
+    }
+
+    /// Run f, reporting any failure caused by cancellation as RequestCancelled.
+    template <typename F>
+    auto run(F&& f) {
+        try {
+            return f();
+        }
+        catch (const RequestCancelled&) {
+            throw;
+        }
+        catch (...) {
+            if (scope_.token().cancelled()) {
+                throw RequestCancelled(scope_.token().reason(), Here());
+            }
+            throw;
+        }
+    }
+
+private:
+
+    GribJump& gj_;
+    TraceSpan span_;
+    CancellationScope scope_;
+    std::list<CancellationToken>::iterator it_;
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+
 GribJump::GribJump() {
     impl_ = std::unique_ptr<GribJumpBase>(GribJumpFactory::build());
 }
@@ -37,7 +84,8 @@ size_t GribJump::scan(const std::vector<eckit::PathName>& paths, const LogContex
         throw eckit::UserError("Paths must not be empty", Here());
     }
 
-    size_t ret = impl_->scan(paths);
+    Operation op(*this, "GribJump::scan");
+    size_t ret = op.run([&] { return impl_->scan(paths); });
     return ret;
 }
 
@@ -48,7 +96,8 @@ size_t GribJump::scan(const std::vector<metkit::mars::MarsRequest> requests, boo
         throw eckit::UserError("Requests must not be empty", Here());
     }
 
-    size_t ret = impl_->scan(requests, byfiles);
+    Operation op(*this, "GribJump::scan");
+    size_t ret = op.run([&] { return impl_->scan(requests, byfiles); });
     return ret;
 }
 
@@ -63,7 +112,8 @@ ExtractionIterator GribJump::extract(std::vector<ExtractionRequest>& requests, c
     if (requests.empty()) {
         throw eckit::UserError("Requests must not be empty", Here());
     }
-    return ExtractionIterator{std::make_unique<VectorSource>(impl_->extract(requests))};
+    Operation op(*this, "GribJump::extract");
+    return ExtractionIterator{std::make_unique<VectorSource>(op.run([&] { return impl_->extract(requests); }))};
 }
 
 ExtractionIterator GribJump::extract(std::vector<PathExtractionRequest>& requests, const LogContext& ctx) {
@@ -72,7 +122,8 @@ ExtractionIterator GribJump::extract(std::vector<PathExtractionRequest>& request
     if (requests.empty()) {
         throw eckit::UserError("Requests must not be empty", Here());
     }
-    return ExtractionIterator{std::make_unique<VectorSource>(impl_->extract(requests))};
+    Operation op(*this, "GribJump::extract");
+    return ExtractionIterator{std::make_unique<VectorSource>(op.run([&] { return impl_->extract(requests); }))};
 }
 
 ExtractionIterator GribJump::extract(const metkit::mars::MarsRequest& request, const std::vector<Range>& ranges,
@@ -103,9 +154,20 @@ ExtractionIterator GribJump::extract(const eckit::PathName& path, const std::vec
         throw eckit::UserError("Offsets and ranges must be the same size", Here());
     }
 
-    return ExtractionIterator{std::make_unique<VectorSource>(impl_->extract(path, offsets, ranges))};
+    Operation op(*this, "GribJump::extract");
+    return ExtractionIterator{
+        std::make_unique<VectorSource>(op.run([&] { return impl_->extract(path, offsets, ranges); }))};
 }
 
+TimeSeriesResult GribJump::extractTimeSeries(const metkit::mars::MarsRequest& request, const std::vector<Range>& ranges,
+                                             const std::string& gridHash, const LogContext& ctx) {
+    ContextManager::instance().set(ctx);
+
+    validateTimeSeriesRanges(ranges);
+
+    Operation op(*this, "GribJump::extractTimeSeries");
+    return op.run([&] { return impl_->extractTimeSeries(request, ranges, gridHash); });
+}
 
 std::map<std::string, std::unordered_set<std::string>> GribJump::axes(const std::string& request, int level,
                                                                       const LogContext& ctx) {
@@ -115,12 +177,40 @@ std::map<std::string, std::unordered_set<std::string>> GribJump::axes(const std:
         throw eckit::UserError("Request string must not be empty", Here());
     }
 
-    auto out = impl_->axes(request, level);
+    Operation op(*this, "GribJump::axes");
+    auto out = op.run([&] { return impl_->axes(request, level); });
     return out;
 }
 
+GridSelection GribJump::nearestPoints(const std::string& gridHash, const std::vector<LatLon>& points,
+                                      const LogContext& ctx) {
+    ContextManager::instance().set(ctx);
+
+    GridQuery query = GridQuery::nearest(gridHash, points);
+
+    Operation op(*this, "GribJump::nearestPoints");
+    return op.run([&] { return impl_->selectPoints(query); });
+}
+
+GridSelection GribJump::boundingBox(const std::string& gridHash, double north, double west, double south, double east,
+                                    const LogContext& ctx) {
+    ContextManager::instance().set(ctx);
+
+    GridQuery query = GridQuery::boundingBox(gridHash, north, west, south, east);
+
+    Operation op(*this, "GribJump::boundingBox");
+    return op.run([&] { return impl_->selectPoints(query); });
+}
+
 void GribJump::stats() {
     impl_->stats();
 }
 
+void GribJump::cancel() {
+    std::lock_guard<std::mutex> lock(operationsMutex_);
+    for (auto& token : operations_) {
+        token.cancel("Cancelled by client");
+    }
+}
+
 }  // namespace gribjump
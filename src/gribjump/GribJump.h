@@ -14,15 +14,20 @@
 #pragma once
 
 #include <cstddef>
+#include <list>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <unordered_set>
 #include <vector>
 
 #include "metkit/mars/MarsRequest.h"
 
+#include "gribjump/Cancellation.h"
 #include "gribjump/ExtractionData.h"
 #include "gribjump/GribJumpBase.h"
+#include "gribjump/GridSelection.h"
+#include "gribjump/TimeSeries.h"
 #include "gribjump/api/ExtractionIterator.h"
 
 namespace gribjump {
@@ -58,14 +63,42 @@ public:
     ExtractionIterator extract(const eckit::PathName& path, const std::vector<eckit::Offset>& offsets,
                                const std::vector<std::vector<Range>>& ranges, const LogContext& ctx = LogContext());
 
+    // Extract the same ranges from every field of a multi-valued request, e.g. every step and date of a forecast, into
+    // a dense [time x points] array. Ranges may be in any order and may overlap: each row holds the values of every
+    // range, in the order given.
+    TimeSeriesResult extractTimeSeries(const metkit::mars::MarsRequest& request, const std::vector<Range>& ranges,
+                                       const std::string& gridHash = "", const LogContext& ctx = LogContext());
+
     std::map<std::string, std::unordered_set<std::string>> axes(const std::string& request, int level = 3,
                                                                 const LogContext& ctx = LogContext());
 
+    // Grid points by coordinates, as ranges to extract. The grid is identified by its hash, and must have been indexed
+    // when its fields were scanned (see gridIndex.directory).
+
+    /// The nearest grid point to each point. positions() maps each point to its value in the extracted ranges.
+    GridSelection nearestPoints(const std::string& gridHash, const std::vector<LatLon>& points,
+                                const LogContext& ctx = LogContext());
+
+    /// The grid points inside a bounding box, edges included. west > east selects across the antimeridian.
+    GridSelection boundingBox(const std::string& gridHash, double north, double west, double south, double east,
+                              const LogContext& ctx = LogContext());
+
     void stats();
 
+    /// Cancel all operations in progress on this handle. Intended to be called from another thread while an
+    /// extraction, scan or axes call is blocked: queued work is skipped, running work stops at the next field, and the
+    /// blocked call throws RequestCancelled. For remote handles, the connection to the server is closed, and the
+    /// server cancels the request in turn. Operations started after cancel() returns are not affected.
+    void cancel();
+
 private:
 
+    class Operation;
+
     std::unique_ptr<GribJumpBase> impl_;
+
+    std::mutex operationsMutex_;
+    std::list<CancellationToken> operations_;  //< tokens of operations in progress, reachable from cancel()
 };
 
 }  // namespace gribjump
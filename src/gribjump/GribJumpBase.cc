@@ -20,6 +20,29 @@ GribJumpBase::GribJumpBase() {}
 
 GribJumpBase::~GribJumpBase() {}
 
+TimeSeriesResult GribJumpBase::extractTimeSeries(const metkit::mars::MarsRequest& request,
+                                                 const std::vector<Range>& ranges, const std::string& gridHash) {
+    std::vector<std::string> fields = timeSeriesFields(request);
+
+    std::vector<ExtractionRequest> requests;
+    requests.reserve(fields.size());
+    for (const auto& field : fields) {
+        requests.emplace_back(field, ranges, gridHash);
+    }
+
+    std::vector<std::unique_ptr<ExtractionResult>> results = extract(requests);
+    ASSERT(results.size() == fields.size());
+
+    TimeSeriesResult series(std::move(fields), ranges);
+    for (size_t t = 0; t < results.size(); ++t) {
+        // Fields which were not found have no values
+        if (results[t] && results[t]->nrange() == ranges.size()) {
+            series.fill(t, *results[t]);
+        }
+    }
+    return series;
+}
+
 void GribJumpBase::stats() {
     stats_.report(eckit::Log::debug<LibGribJump>(), "Extraction stats: ");
 }
@@ -20,9 +20,11 @@
 #include "gribjump/Config.h"
 #include "gribjump/ExtractionData.h"
 #include "gribjump/ExtractionItem.h"
+#include "gribjump/GridSelection.h"
 #include "gribjump/LibGribJump.h"
 #include "gribjump/Metrics.h"
 #include "gribjump/Stats.h"
+#include "gribjump/TimeSeries.h"
 #include "gribjump/Types.h"
 
 namespace fdb5 {
@@ -59,8 +61,16 @@ public:
                                                                    const std::vector<eckit::Offset>& offsets,
                                                                    const std::vector<std::vector<Range>>& ranges) = 0;
 
+    /// Extract the same ranges from every field of a multi-valued request, one row per field. By default, expands the
+    /// request into one ExtractionRequest per field.
+    virtual TimeSeriesResult extractTimeSeries(const metkit::mars::MarsRequest& request,
+                                               const std::vector<Range>& ranges, const std::string& gridHash);
+
     virtual std::map<std::string, std::unordered_set<std::string>> axes(const std::string& request, int level) = 0;
 
+    /// Look up grid points by coordinates, in the index of the grid built when its fields were scanned
+    virtual GridSelection selectPoints(const GridQuery& query) = 0;
+
     virtual void stats();
 
 protected:  // members
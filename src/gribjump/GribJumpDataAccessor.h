@@ -12,6 +12,7 @@
 
 #include "eckit/exception/Exceptions.h"
 #include "eckit/io/DataHandle.h"
+#include "gribjump/MetricsRegistry.h"
 #include "gribjump/compression/DataAccessor.h"
 
 namespace gribjump {
@@ -35,6 +36,10 @@ public:
             throw eckit::Exception("Failed to seek to offset in datahandle", Here());
         if (dh_.read(reinterpret_cast<char*>(buf.data()), size) != size)
             throw eckit::Exception("Failed to read from datahandle", Here());
+
+        static Counter& bytesRead =
+            MetricsRegistry::instance().counter("gribjump_read_bytes_total", "Bytes of GRIB data read for extraction.");
+        bytesRead.increment(size);
         return buf;
     }
 
@@ -47,5 +47,25 @@ public:
         GribJumpException("Lazy JumpInfo extraction has been disabled. " + msg, here) {}
 };
 
+// For operations cancelled by the client, or because the client disconnected
+class RequestCancelled : public GribJumpException {
+public:
+
+    RequestCancelled(const std::string& msg) : GribJumpException("Request cancelled. " + msg) {}
+
+    RequestCancelled(const std::string& msg, const eckit::CodeLocation& here) :
+        GribJumpException("Request cancelled. " + msg, here) {}
+};
+
+// For requests refused by the server's admission control
+class AdmissionRejected : public GribJumpException {
+public:
+
+    AdmissionRejected(const std::string& msg) : GribJumpException("Request not admitted. " + msg) {}
+
+    AdmissionRejected(const std::string& msg, const eckit::CodeLocation& here) :
+        GribJumpException("Request not admitted. " + msg, here) {}
+};
+
 
 }  // namespace gribjump
@@ -0,0 +1,385 @@
+/*
+ * (C) Copyright 2023- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+/// @author Caragh Bradley
+
+#include "gribjump/GridIndex.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include "eckit/exception/Exceptions.h"
+#include "eckit/log/Log.h"
+#include "eckit/serialisation/FileStream.h"
+#include "metkit/codes/api/CodesAPI.h"
+
+#include "gribjump/Config.h"
+#include "gribjump/GribJumpException.h"
+#include "gribjump/LibGribJump.h"
+#include "gribjump/info/InternTable.h"
+
+namespace gribjump {
+
+namespace {
+
+constexpr double DEG = M_PI / 180.;
+
+/// Tolerance of index arithmetic, in units of the longitude spacing, so that points on the edges of a box are selected
+constexpr double EPSILON = 1e-6;
+
+/// In [0, 360)
+double normalise(double lon) {
+    double x = std::fmod(lon, 360.);
+    if (x < 0) {
+        x += 360.;
+    }
+    return x >= 360. ? 0. : x;
+}
+
+/// Great-circle distance, in radians
+double distance(double lat1, double lon1, double lat2, double lon2) {
+    const double sdlat = std::sin((lat2 - lat1) * DEG / 2);
+    const double sdlon = std::sin((lon2 - lon1) * DEG / 2);
+    const double h     = sdlat * sdlat + std::cos(lat1 * DEG) * std::cos(lat2 * DEG) * sdlon * sdlon;
+    return 2 * std::asin(std::sqrt(std::min(1., h)));
+}
+
+}  // namespace
+
+//----------------------------------------------------------------------------------------------------------------------
+
+GridIndex::GridIndex(const std::vector<double>& latitudes, const std::vector<double>& longitudes) {
+    build(latitudes, longitudes);
+}
+
+GridIndex::GridIndex(const metkit::codes::CodesHandle& h) {
+    if (h.has("gridType") && h.getString("gridType") == "sh") {
+        throw eckit::UserError("Cannot index a spectral field: it has no grid points", Here());
+    }
+    build(h.getDoubleArray("latitudes"), h.getDoubleArray("longitudes"));
+}
+
+GridIndex::GridIndex(eckit::Stream& s) {
+    uint16_t version;
+    s >> version;
+    if (version != currentVersion_) {
+        throw eckit::SeriousBug("Unsupported grid index version " + std::to_string(version), Here());
+    }
+    s >> numberOfPoints_;
+    s >> descending_;
+
+    size_t nrows;
+    s >> nrows;
+    rows_.resize(nrows);
+    size_t first = 0;
+    for (auto& row : rows_) {
+        s >> row.lat;
+        s >> row.lon0;
+        s >> row.dlon;
+        s >> row.first;
+        s >> row.count;
+
+        // The lookups divide by dlon and index from first: a corrupt file must not reach them
+        if (row.count == 0 || row.first != first || (row.count > 1 && !(row.dlon > 0))) {
+            throw eckit::SeriousBug("Corrupt grid index: invalid row at latitude " + std::to_string(row.lat), Here());
+        }
+        first += row.count;
+    }
+    if (nrows == 0 || first != numberOfPoints_) {
+        throw eckit::SeriousBug("Corrupt grid index: rows have " + std::to_string(first) + " points, expected " +
+                                    std::to_string(numberOfPoints_),
+                                Here());
+    }
+}
+
+void GridIndex::encode(eckit::Stream& s) const {
+    s << currentVersion_;
+    s << numberOfPoints_;
+    s << descending_;
+    s << rows_.size();
+    for (const auto& row : rows_) {
+        s << row.lat;
+        s << row.lon0;
+        s << row.dlon;
+        s << row.first;
+        s << row.count;
+    }
+}
+
+void GridIndex::build(const std::vector<double>& latitudes, const std::vector<double>& longitudes) {
+    ASSERT(latitudes.size() == longitudes.size());
+    if (latitudes.empty()) {
+        throw eckit::UserError("Cannot index a grid with no points", Here());
+    }
+    numberOfPoints_ = latitudes.size();
+
+    // Group consecutive points of equal latitude into rows
+    size_t i = 0;
+    while (i < numberOfPoints_) {
+        size_t j = i + 1;
+        while (j < numberOfPoints_ && latitudes[j] == latitudes[i]) {
+            ++j;
+        }
+
+        Row row{latitudes[i], normalise(longitudes[i]), 0, i, j - i};
+        if (row.count > 1) {
+            row.dlon = normalise(longitudes[i + 1] - longitudes[i]);
+            if (row.dlon == 0 || row.count * row.dlon > 360 * (1 + EPSILON)) {
+                throw eckit::UserError("Cannot index grid: row at latitude " + std::to_string(row.lat) +
+                                           " does not have increasing longitudes",
+                                       Here());
+            }
+            for (size_t k = 2; k < row.count; ++k) {
+                double error = normalise(longitudes[i + k] - row.lon0 - k * row.dlon);
+                if (std::min(error, 360 - error) > 1e-3 * row.dlon) {
+                    throw eckit::UserError("Cannot index grid: row at latitude " + std::to_string(row.lat) +
+                                               " does not have equally spaced longitudes",
+                                           Here());
+                }
+            }
+        }
+        rows_.push_back(row);
+        i = j;
+    }
+
+    descending_ = rows_.size() < 2 || rows_[1].lat < rows_[0].lat;
+    for (size_t r = 1; r < rows_.size(); ++r) {
+        if ((rows_[r].lat < rows_[r - 1].lat) != descending_) {
+            throw eckit::UserError("Cannot index grid: rows are not monotonic in latitude", Here());
+        }
+    }
+}
+
+void GridIndex::nearestInRow(const Row& row, double lat, double lon, size_t& best, double& bestDistance) const {
+
+    auto consider = [&](size_t k) {
+        double d = distance(lat, lon, row.lat, row.lon0 + k * row.dlon);
+        if (d < bestDistance) {
+            bestDistance = d;
+            best         = row.first + k;
+        }
+    };
+
+    if (row.count == 1) {
+        consider(0);
+        return;
+    }
+
+    const double x     = normalise(lon - row.lon0) / row.dlon;
+    const size_t below = static_cast<size_t>(std::floor(x));
+    const bool global  = row.count * row.dlon >= 360 - row.dlon / 2;
+
+    if (global) {
+        consider(below % row.count);
+        consider((below + 1) % row.count);
+    }
+    else {
+        // Beyond the end of the row, the nearest point is at either end
+        consider(std::min(below, row.count - 1));
+        consider(std::min(below + 1, row.count - 1));
+        consider(0);
+        consider(row.count - 1);
+    }
+}
+
+size_t GridIndex::nearest(double lat, double lon) const {
+
+    // First row on the far side of lat
+    auto beyond = [&](const Row& row) { return descending_ ? row.lat > lat : row.lat < lat; };
+    const long nrows = rows_.size();
+    long hi          = std::partition_point(rows_.begin(), rows_.end(), beyond) - rows_.begin();
+    long lo          = hi - 1;
+
+    // Search rows outward from lat, until they are further in latitude alone than the best point so far
+    size_t best         = 0;
+    double bestDistance = std::numeric_limits<double>::infinity();
+    while (lo >= 0 || hi < nrows) {
+        const double dlo = lo >= 0 ? std::abs(rows_[lo].lat - lat) * DEG : std::numeric_limits<double>::infinity();
+        const double dhi = hi < nrows ? std::abs(rows_[hi].lat - lat) * DEG : std::numeric_limits<double>::infinity();
+        if (std::min(dlo, dhi) > bestDistance) {
+            break;
+        }
+        if (dlo <= dhi) {
+            nearestInRow(rows_[lo--], lat, lon, best, bestDistance);
+        }
+        else {
+            nearestInRow(rows_[hi++], lat, lon, best, bestDistance);
+        }
+    }
+    return best;
+}
+
+std::vector<Range> GridIndex::boundingBox(double north, double west, double south, double east) const {
+
+    const bool allLongitudes = east - west >= 360;
+    const double width       = allLongitudes ? 360 : normalise(east - west);
+
+    std::vector<Range> ranges;
+    for (const auto& row : rows_) {
+        if (row.lat > north || row.lat < south) {
+            continue;
+        }
+        if (allLongitudes) {
+            ranges.emplace_back(row.first, row.first + row.count);
+            continue;
+        }
+        if (row.count == 1) {
+            if (normalise(row.lon0 - west) <= width) {
+                ranges.emplace_back(row.first, row.first + 1);
+            }
+            continue;
+        }
+
+        // Point k is selected if (k * dlon - a) mod 360 is in [0, width]. As 0 <= k * dlon < 360, that is k * dlon in
+        // [a, a + width] or in [a - 360, a - 360 + width].
+        const double a = normalise(west - row.lon0);
+        for (double shift : {0., -360.}) {
+            double first = std::ceil((a + shift) / row.dlon - EPSILON);
+            double last  = std::floor((a + shift + width) / row.dlon + EPSILON);
+            first        = std::max(first, 0.);
+            last         = std::min(last, double(row.count - 1));
+            if (first <= last) {
+                ranges.emplace_back(row.first + size_t(first), row.first + size_t(last) + 1);
+            }
+        }
+    }
+    return GridSelection(std::move(ranges)).ranges();
+}
+
+GridSelection GridIndex::select(const GridQuery& query) const {
+    switch (query.type()) {
+        case GridQuery::Type::NEAREST: {
+            std::vector<size_t> indices;
+            indices.reserve(query.points().size());
+            for (const auto& p : query.points()) {
+                indices.push_back(nearest(p.lat, p.lon));
+            }
+            return GridSelection::fromIndices(std::move(indices));
+        }
+        case GridQuery::Type::BOUNDING_BOX:
+            return GridSelection(boundingBox(query.north(), query.west(), query.south(), query.east()));
+        default:
+            throw eckit::SeriousBug("Unknown grid query type", Here());
+    }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+GridIndexCache& GridIndexCache::instance() {
+    static GridIndexCache instance;
+    return instance;
+}
+
+GridIndexCache::GridIndexCache() : directory_(ConfigOptions::instance().gridIndexDirectory()) {
+    if (enabled()) {
+        directory_.mkdir();
+    }
+}
+
+eckit::PathName GridIndexCache::path(const std::string& gridHash) const {
+    // The hash names a file: it may come from a client, so must not be a path
+    Md5 md5;
+    if (!Md5::parse(gridHash, md5)) {
+        throw eckit::UserError("Invalid grid hash '" + gridHash + "': expected 32 lower case hexadecimal digits",
+                               Here());
+    }
+    return directory_ / (gridHash + ".gridindex");
+}
+
+void GridIndexCache::learn(const std::string& gridHash, const metkit::codes::CodesHandle& h) {
+    Md5 md5;
+    if (!enabled() || !Md5::parse(gridHash, md5)) {
+        return;
+    }
+
+    eckit::PathName file = path(gridHash);
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!known_.insert(gridHash).second || file.exists()) {
+            return;
+        }
+    }
+
+    // Build outside the lock: computing the coordinates of a large grid takes a while. Other threads scanning the
+    // same grid skip it, as it is already known.
+    // Indexing is best-effort: it must not fail the build of the field's info, which is why this is called.
+    std::shared_ptr<const GridIndex> index;
+    eckit::PathName tmp = eckit::PathName::unique(file);
+    try {
+        index = std::make_shared<const GridIndex>(h);
+
+        {
+            eckit::FileStream s(tmp, "w");
+            index->encode(s);
+            s.close();
+        }
+        eckit::PathName::rename(tmp, file);
+    }
+    catch (const eckit::UserError& e) {
+        // The grid is not one that can be indexed, e.g. not a reduced or regular grid: do not try again
+        eckit::Log::warning() << "Grid " << gridHash << " cannot be indexed for point lookups: " << e.what()
+                              << std::endl;
+        return;
+    }
+    catch (const std::exception& e) {
+        // e.g. ecCodes cannot give the coordinates of the field, or the directory cannot be written: try again with
+        // the next field on this grid
+        eckit::Log::warning() << "Failed to index grid " << gridHash << " for point lookups: " << e.what()
+                              << std::endl;
+        if (tmp.exists()) {
+            tmp.unlink(false);
+        }
+        std::lock_guard<std::mutex> lock(mutex_);
+        known_.erase(gridHash);
+        return;
+    }
+    LOG_DEBUG_LIB(LibGribJump) << "Indexed grid " << gridHash << ": " << index->numberOfPoints() << " points in "
+                               << index->numberOfRows() << " rows" << std::endl;
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    indexes_[gridHash] = index;
+}
+
+std::shared_ptr<const GridIndex> GridIndexCache::get(const std::string& gridHash) {
+    if (!enabled()) {
+        throw eckit::UserError("Grid lookups are disabled: gridIndex.directory is not set on the server", Here());
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = indexes_.find(gridHash);
+    if (it != indexes_.end()) {
+        return it->second;
+    }
+
+    eckit::PathName file = path(gridHash);
+    if (!file.exists()) {
+        throw DataNotFoundException("No index of grid " + gridHash + ": no field on this grid has been scanned",
+                                    Here());
+    }
+
+    eckit::FileStream s(file, "r");
+    auto index = std::make_shared<const GridIndex>(s);
+    s.close();
+
+    indexes_[gridHash] = index;
+    known_.insert(gridHash);
+    return index;
+}
+
+void GridIndexCache::clear() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    indexes_.clear();
+    known_.clear();
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace gribjump
@@ -0,0 +1,127 @@
+/*
+ * (C) Copyright 2023- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+/// @author Caragh Bradley
+
+#pragma once
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "eckit/filesystem/PathName.h"
+#include "eckit/serialisation/Stream.h"
+
+#include "gribjump/GridSelection.h"
+#include "gribjump/Types.h"
+
+namespace metkit::codes {
+class CodesHandle;
+}
+
+namespace gribjump {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/// Point lookup table of a grid made of rows of constant latitude with equally spaced longitudes, in index order:
+/// regular and reduced Gaussian grids (including octahedral) and regular lat/lon grids, global or not. A row table is a
+/// few bytes per row, so the index of an O2560 grid is about 200 KiB, and lookups are analytical within a row.
+class GridIndex {
+public:
+
+    /// From the coordinates of every grid point, in index order. Throws eckit::UserError if the grid is not made of
+    /// rows of constant latitude, monotonic in latitude, with equally spaced longitudes.
+    GridIndex(const std::vector<double>& latitudes, const std::vector<double>& longitudes);
+
+    /// From the coordinates of the grid of a GRIB message
+    explicit GridIndex(const metkit::codes::CodesHandle& h);
+
+    explicit GridIndex(eckit::Stream& s);
+
+    size_t numberOfPoints() const { return numberOfPoints_; }
+    size_t numberOfRows() const { return rows_.size(); }
+
+    /// Grid index of the nearest grid point (great-circle distance)
+    size_t nearest(double lat, double lon) const;
+
+    /// Ranges of the grid points inside a bounding box, edges included. Longitudes go eastward from west to east.
+    std::vector<Range> boundingBox(double north, double west, double south, double east) const;
+
+    /// Answer a query on this grid
+    GridSelection select(const GridQuery& query) const;
+
+    void encode(eckit::Stream& s) const;
+
+private:
+
+    struct Row {
+        double lat;
+        double lon0;   //< longitude of the first point, in [0, 360)
+        double dlon;   //< spacing, 0 if the row has a single point
+        size_t first;  //< grid index of the first point
+        size_t count;
+    };
+
+    void build(const std::vector<double>& latitudes, const std::vector<double>& longitudes);
+
+    /// Best point of row r for (lat, lon), and its angular distance
+    void nearestInRow(const Row& row, double lat, double lon, size_t& best, double& bestDistance) const;
+
+private:
+
+    static constexpr uint16_t currentVersion_ = 1;
+
+    std::vector<Row> rows_;
+    size_t numberOfPoints_ = 0;
+    bool descending_       = true;  //< rows go north to south
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/// Grid indexes by grid hash (md5GridSection), persisted to the directory gridIndex.directory. An index is built once,
+/// the first time a field on its grid is scanned, and loaded from disk on first use.
+class GridIndexCache {
+public:
+
+    static GridIndexCache& instance();
+
+    bool enabled() const { return !directory_.asString().empty(); }
+
+    /// Build and persist the index of the grid of this message, unless one exists. Grids which cannot be indexed are
+    /// remembered and skipped.
+    void learn(const std::string& gridHash, const metkit::codes::CodesHandle& h);
+
+    /// The index of a grid. Throws DataNotFoundException if no field on this grid has been scanned.
+    std::shared_ptr<const GridIndex> get(const std::string& gridHash);
+
+    /// Forget the indexes held in memory, e.g. to reload them from disk
+    void clear();
+
+private:
+
+    GridIndexCache();
+
+    eckit::PathName path(const std::string& gridHash) const;
+
+private:
+
+    eckit::PathName directory_;
+
+    std::mutex mutex_;
+    std::map<std::string, std::shared_ptr<const GridIndex>> indexes_;
+    std::set<std::string> known_;  //< grids with an index on disk, or which cannot be indexed
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace gribjump
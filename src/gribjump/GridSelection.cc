@@ -0,0 +1,179 @@
+/*
+ * (C) Copyright 2023- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+/// @author Caragh Bradley
+
+#include "gribjump/GridSelection.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "eckit/exception/Exceptions.h"
+
+#include "gribjump/info/InternTable.h"
+
+namespace gribjump {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+GridQuery::GridQuery(Type type, const std::string& gridHash) : type_(type), gridHash_(gridHash) {
+    if (gridHash_.empty()) {
+        throw eckit::UserError("Grid lookups require a grid hash", Here());
+    }
+    Md5 md5;
+    if (!Md5::parse(gridHash_, md5)) {
+        throw eckit::UserError("Invalid grid hash '" + gridHash_ + "': expected 32 lower case hexadecimal digits",
+                               Here());
+    }
+}
+
+GridQuery GridQuery::nearest(const std::string& gridHash, const std::vector<LatLon>& points) {
+    if (points.empty()) {
+        throw eckit::UserError("Points must not be empty", Here());
+    }
+    for (const auto& p : points) {
+        if (!(p.lat >= -90 && p.lat <= 90) || !std::isfinite(p.lon)) {
+            throw eckit::UserError("Invalid point (" + std::to_string(p.lat) + ", " + std::to_string(p.lon) + ")",
+                                   Here());
+        }
+    }
+    GridQuery query(Type::NEAREST, gridHash);
+    query.points_ = points;
+    return query;
+}
+
+GridQuery GridQuery::boundingBox(const std::string& gridHash, double north, double west, double south, double east) {
+    if (!(south >= -90 && north <= 90 && south <= north) || !std::isfinite(west) || !std::isfinite(east)) {
+        throw eckit::UserError("Invalid bounding box: expected -90 <= south <= north <= 90", Here());
+    }
+    GridQuery query(Type::BOUNDING_BOX, gridHash);
+    query.box_[0] = north;
+    query.box_[1] = west;
+    query.box_[2] = south;
+    query.box_[3] = east;
+    return query;
+}
+
+GridQuery::GridQuery(eckit::Stream& s) {
+    uint16_t type;
+    s >> type;
+    type_ = static_cast<Type>(type);
+    s >> gridHash_;
+
+    size_t npoints;
+    s >> npoints;
+    points_.resize(npoints);
+    for (auto& p : points_) {
+        s >> p.lat;
+        s >> p.lon;
+    }
+    for (auto& b : box_) {
+        s >> b;
+    }
+}
+
+void GridQuery::encode(eckit::Stream& s) const {
+    s << static_cast<uint16_t>(type_);
+    s << gridHash_;
+    s << points_.size();
+    for (const auto& p : points_) {
+        s << p.lat;
+        s << p.lon;
+    }
+    for (const auto& b : box_) {
+        s << b;
+    }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+GridSelection::GridSelection(std::vector<Range> ranges) {
+    std::sort(ranges.begin(), ranges.end());
+    for (const auto& r : ranges) {
+        if (r.first >= r.second) {
+            continue;
+        }
+        if (!ranges_.empty() && r.first <= ranges_.back().second) {
+            ranges_.back().second = std::max(ranges_.back().second, r.second);
+        }
+        else {
+            ranges_.push_back(r);
+        }
+    }
+}
+
+GridSelection GridSelection::fromIndices(std::vector<size_t> indices) {
+    std::vector<size_t> sorted(indices);
+    std::sort(sorted.begin(), sorted.end());
+    sorted.erase(std::unique(sorted.begin(), sorted.end()), sorted.end());
+
+    GridSelection selection;
+    for (size_t i : sorted) {
+        if (!selection.ranges_.empty() && selection.ranges_.back().second == i) {
+            selection.ranges_.back().second++;
+        }
+        else {
+            selection.ranges_.emplace_back(i, i + 1);
+        }
+    }
+
+    // Each selected grid point contributes one value, in index order
+    selection.positions_.reserve(indices.size());
+    for (size_t i : indices) {
+        selection.positions_.push_back(std::lower_bound(sorted.begin(), sorted.end(), i) - sorted.begin());
+    }
+    selection.indices_ = std::move(indices);
+    return selection;
+}
+
+GridSelection::GridSelection(eckit::Stream& s) {
+    size_t nranges;
+    s >> nranges;
+    ranges_.resize(nranges);
+    for (auto& r : ranges_) {
+        s >> r.first;
+        s >> r.second;
+    }
+
+    size_t npoints;
+    s >> npoints;
+    indices_.resize(npoints);
+    positions_.resize(npoints);
+    for (size_t i = 0; i < npoints; ++i) {
+        s >> indices_[i];
+        s >> positions_[i];
+    }
+}
+
+void GridSelection::encode(eckit::Stream& s) const {
+    s << ranges_.size();
+    for (const auto& r : ranges_) {
+        s << r.first;
+        s << r.second;
+    }
+
+    s << indices_.size();
+    for (size_t i = 0; i < indices_.size(); ++i) {
+        s << indices_[i];
+        s << positions_[i];
+    }
+}
+
+size_t GridSelection::size() const {
+    size_t n = 0;
+    for (const auto& r : ranges_) {
+        n += r.second - r.first;
+    }
+    return n;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace gribjump
@@ -0,0 +1,124 @@
+/*
+ * (C) Copyright 2023- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+/// @author Caragh Bradley
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "eckit/serialisation/Stream.h"
+
+#include "gribjump/Types.h"
+
+namespace gribjump {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+struct LatLon {
+    double lat;
+    double lon;
+};
+
+/// Points of a grid to look up, by coordinates: either the nearest grid point to each of a list of points, or all the
+/// grid points inside a bounding box. The grid is identified by its hash, as in ExtractionRequest.
+class GridQuery {
+public:
+
+    enum class Type : uint16_t {
+        NEAREST = 0,
+        BOUNDING_BOX
+    };
+
+    static GridQuery nearest(const std::string& gridHash, const std::vector<LatLon>& points);
+
+    /// Longitudes go eastward from west to east, so west > east selects across the antimeridian.
+    static GridQuery boundingBox(const std::string& gridHash, double north, double west, double south, double east);
+
+    explicit GridQuery(eckit::Stream& s);
+
+    Type type() const { return type_; }
+    const std::string& gridHash() const { return gridHash_; }
+
+    /// For NEAREST queries
+    const std::vector<LatLon>& points() const { return points_; }
+
+    /// For BOUNDING_BOX queries
+    double north() const { return box_[0]; }
+    double west() const { return box_[1]; }
+    double south() const { return box_[2]; }
+    double east() const { return box_[3]; }
+
+private:
+
+    GridQuery(Type type, const std::string& gridHash);
+
+    void encode(eckit::Stream& s) const;
+    friend eckit::Stream& operator<<(eckit::Stream& s, const GridQuery& q) {
+        q.encode(s);
+        return s;
+    }
+
+private:
+
+    Type type_;
+    std::string gridHash_;
+    std::vector<LatLon> points_;
+    double box_[4] = {0, 0, 0, 0};
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/// The answer to a GridQuery, as ranges ready to be extracted.
+class GridSelection {
+public:
+
+    GridSelection() = default;
+
+    /// Ranges of the given ranges, merged. For BOUNDING_BOX queries.
+    explicit GridSelection(std::vector<Range> ranges);
+
+    /// Ranges covering the given grid points, one per query point, which may repeat. For NEAREST queries.
+    static GridSelection fromIndices(std::vector<size_t> indices);
+
+    explicit GridSelection(eckit::Stream& s);
+
+    /// Sorted and disjoint
+    const std::vector<Range>& ranges() const { return ranges_; }
+
+    /// For NEAREST queries, the grid index of the nearest grid point to each query point
+    const std::vector<size_t>& indices() const { return indices_; }
+
+    /// For NEAREST queries, the position of the value of each query point in the values extracted from ranges(),
+    /// ranges concatenated
+    const std::vector<size_t>& positions() const { return positions_; }
+
+    /// Total number of grid points in ranges()
+    size_t size() const;
+
+private:
+
+    void encode(eckit::Stream& s) const;
+    friend eckit::Stream& operator<<(eckit::Stream& s, const GridSelection& sel) {
+        sel.encode(s);
+        return s;
+    }
+
+private:
+
+    std::vector<Range> ranges_;
+    std::vector<size_t> indices_;
+    std::vector<size_t> positions_;
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace gribjump
@@ -138,10 +138,35 @@ std::vector<std::unique_ptr<ExtractionResult>> LocalGribJump::extract(PathExtrac
     return extractionResults;
 }
 
+TimeSeriesResult LocalGribJump::extractTimeSeries(const MarsRequest& request, const std::vector<Range>& ranges,
+                                                  const std::string& gridHash) {
+
+    std::vector<std::string> fields = timeSeriesFields(request);
+
+    auto [results, report] = Engine().extractTimeSeries(request, fields, ranges, gridHash);
+    report.raiseErrors();
+
+    TimeSeriesResult series(std::move(fields), ranges);
+    for (size_t t = 0; t < series.ntimes(); ++t) {
+        auto it = results.find(series.requests()[t]);
+        ASSERT(it != results.end());
+        std::unique_ptr<ExtractionResult> res = it->second->result();
+        // Fields which were not found have no values
+        if (res && res->nrange() == ranges.size()) {
+            series.fill(t, *res);
+        }
+    }
+    return series;
+}
+
 std::map<std::string, std::unordered_set<std::string>> LocalGribJump::axes(const std::string& request, int level) {
     return Engine().axes(request, level);
 }
 
+GridSelection LocalGribJump::selectPoints(const GridQuery& query) {
+    return Engine().selectPoints(query);
+}
+
 static GribJumpBuilder<LocalGribJump> builder("local");
 
 }  // namespace gribjump
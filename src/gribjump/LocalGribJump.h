@@ -42,8 +42,13 @@ public:
                                                            const std::vector<eckit::Offset>& offsets,
                                                            const std::vector<std::vector<Range>>& ranges) override;
 
+    TimeSeriesResult extractTimeSeries(const MarsRequest& request, const std::vector<Range>& ranges,
+                                       const std::string& gridHash) override;
+
     std::map<std::string, std::unordered_set<std::string>> axes(const std::string& request, int level) override;
 
+    GridSelection selectPoints(const GridQuery& query) override;
+
 private:
 };
 
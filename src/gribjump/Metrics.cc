@@ -14,6 +14,7 @@
 #include "eckit/log/Log.h"
 #include "eckit/runtime/Main.h"
 #include "gribjump/LibGribJump.h"
+#include "gribjump/MetricsRegistry.h"
 #include "metkit/mars/MarsRequest.h"
 
 namespace {
@@ -86,6 +87,15 @@ MetricsManager::~MetricsManager() {}
 
 void MetricsManager::set(const std::string& name, const eckit::Value& value) {
     metrics().add(name, value);
+
+    // Stage timings are also aggregated across requests, for latency percentiles
+    static const std::string elapsed = "elapsed_";
+    if (value.isDouble() && name.compare(0, elapsed.size(), elapsed) == 0) {
+        MetricsRegistry::instance()
+            .histogram("gribjump_stage_duration_seconds", "Time spent in each stage of a request.",
+                       {"stage", name.substr(elapsed.size())})
+            .observe(double(value));
+    }
 }
 
 void MetricsManager::addRequest(const metkit::mars::MarsRequest& request) {
@@ -40,6 +40,9 @@ public:
 
     void json(eckit::JSON& s) const { s << eckit::JSONParser::decodeString(context_); }
 
+    /// Parsed context, for reading well-known keys such as "priority" and "deadline".
+    eckit::Value value() const { return eckit::JSONParser::decodeString(context_); }
+
     ~LogContext() {}
 
 private:
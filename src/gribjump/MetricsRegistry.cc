@@ -0,0 +1,226 @@
+/*
+ * (C) Copyright 2023- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+/// @author Caragh Bradley
+
+#include "gribjump/MetricsRegistry.h"
+
+#include <algorithm>
+#include <functional>
+#include <iomanip>
+#include <ostream>
+#include <sstream>
+#include <tuple>
+#include <vector>
+
+#include "eckit/exception/Exceptions.h"
+
+namespace gribjump {
+
+namespace {
+
+std::string escape(const std::string& value) {
+    std::string out;
+    for (char c : value) {
+        switch (c) {
+            case '\\':
+                out += "\\\\";
+                break;
+            case '"':
+                out += "\\\"";
+                break;
+            case '\n':
+                out += "\\n";
+                break;
+            default:
+                out += c;
+        }
+    }
+    return out;
+}
+
+/// Label set in exposition syntax, with an optional extra label (used for the histogram "le").
+std::string labels(const MetricsRegistry::Label& label, const std::string& le = "") {
+    std::vector<std::string> parts;
+    if (!label.first.empty()) {
+        parts.push_back(label.first + "=\"" + escape(label.second) + "\"");
+    }
+    if (!le.empty()) {
+        parts.push_back("le=\"" + le + "\"");
+    }
+    if (parts.empty()) {
+        return "";
+    }
+    std::string out = "{" + parts[0];
+    for (size_t i = 1; i < parts.size(); ++i) {
+        out += "," + parts[i];
+    }
+    return out + "}";
+}
+
+}  // namespace
+
+//----------------------------------------------------------------------------------------------------------------------
+
+const std::array<double, Histogram::nBounds>& Histogram::bounds() {
+    static const std::array<double, nBounds> bounds = {0.0005, 0.001, 0.0025, 0.005, 0.01, 0.025, 0.05, 0.1, 0.25,
+                                                       0.5,    1,     2.5,    5,     10,   25,    60,   120};
+    return bounds;
+}
+
+void Histogram::observe(double value) {
+    const auto& b = bounds();
+    size_t i      = std::lower_bound(b.begin(), b.end(), value) - b.begin();
+    buckets_[i].fetch_add(1, std::memory_order_relaxed);
+
+    double sum = sum_.load(std::memory_order_relaxed);
+    while (!sum_.compare_exchange_weak(sum, sum + value, std::memory_order_relaxed)) {
+    }
+}
+
+uint64_t Histogram::count() const {
+    uint64_t total = 0;
+    for (const auto& b : buckets_) {
+        total += b.load(std::memory_order_relaxed);
+    }
+    return total;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+struct MetricsRegistry::Series {
+    std::string key;
+    std::string name;
+    std::string help;
+    Label label;
+    std::unique_ptr<Counter> counter;
+    std::unique_ptr<Gauge> gauge;
+    std::unique_ptr<Histogram> histogram;
+};
+
+MetricsRegistry& MetricsRegistry::instance() {
+    static MetricsRegistry instance;
+    return instance;
+}
+
+MetricsRegistry::MetricsRegistry() {
+    for (auto& slot : slots_) {
+        slot.store(nullptr);
+    }
+}
+
+// Series are deliberately not freed: worker threads may still be updating them while the process exits.
+MetricsRegistry::~MetricsRegistry() {}
+
+Counter& MetricsRegistry::counter(const std::string& name, const std::string& help, const Label& label) {
+    return *find(name, help, label, Type::Counter).counter;
+}
+
+Gauge& MetricsRegistry::gauge(const std::string& name, const std::string& help, const Label& label) {
+    return *find(name, help, label, Type::Gauge).gauge;
+}
+
+Histogram& MetricsRegistry::histogram(const std::string& name, const std::string& help, const Label& label) {
+    return *find(name, help, label, Type::Histogram).histogram;
+}
+
+MetricsRegistry::Series& MetricsRegistry::find(const std::string& name, const std::string& help, const Label& label,
+                                               Type type) {
+    const std::string key = name + labels(label);
+
+    std::unique_ptr<Series> created;
+    size_t start = std::hash<std::string>{}(key) % capacity_;
+
+    for (size_t probe = 0; probe < capacity_; ++probe) {
+        std::atomic<Series*>& slot = slots_[(start + probe) % capacity_];
+        Series* series             = slot.load(std::memory_order_acquire);
+
+        if (!series) {
+            if (!created) {
+                created            = std::make_unique<Series>();
+                created->key       = key;
+                created->name      = name;
+                created->help      = help;
+                created->label     = label;
+                created->counter   = type == Type::Counter ? std::make_unique<Counter>() : nullptr;
+                created->gauge     = type == Type::Gauge ? std::make_unique<Gauge>() : nullptr;
+                created->histogram = type == Type::Histogram ? std::make_unique<Histogram>() : nullptr;
+            }
+            if (slot.compare_exchange_strong(series, created.get(), std::memory_order_acq_rel)) {
+                return *created.release();
+            }
+            // Lost the race: series now holds whoever won the slot
+        }
+
+        if (series->key == key) {
+            if (!!series->counter != (type == Type::Counter) || !!series->gauge != (type == Type::Gauge)) {
+                throw eckit::BadParameter("Metric " + key + " is already registered with a different type", Here());
+            }
+            return *series;
+        }
+    }
+
+    throw eckit::SeriousBug("MetricsRegistry is full, cannot register " + key, Here());
+}
+
+void MetricsRegistry::exposition(std::ostream& out) const {
+
+    std::vector<const Series*> series;
+    for (const auto& slot : slots_) {
+        if (const Series* s = slot.load(std::memory_order_acquire)) {
+            series.push_back(s);
+        }
+    }
+    std::sort(series.begin(), series.end(), [](const Series* a, const Series* b) {
+        return std::tie(a->name, a->key) < std::tie(b->name, b->key);
+    });
+
+    const auto& bounds = Histogram::bounds();
+    std::string family;
+
+    for (const Series* s : series) {
+        if (s->name != family) {
+            family = s->name;
+            out << "# HELP " << s->name << " " << s->help << "\n";
+            out << "# TYPE " << s->name << " " << (s->histogram ? "histogram" : s->gauge ? "gauge" : "counter") << "\n";
+        }
+
+        if (s->counter) {
+            out << s->name << labels(s->label) << " " << s->counter->value() << "\n";
+            continue;
+        }
+        if (s->gauge) {
+            out << s->name << labels(s->label) << " " << s->gauge->value() << "\n";
+            continue;
+        }
+
+        // Read each bucket once, so that the cumulative counts and the total agree
+        uint64_t cumulative = 0;
+        for (size_t i = 0; i <= bounds.size(); ++i) {
+            cumulative += s->histogram->bucket(i);
+            std::ostringstream le;
+            if (i < bounds.size()) {
+                le << bounds[i];
+            }
+            else {
+                le << "+Inf";
+            }
+            out << s->name << "_bucket" << labels(s->label, le.str()) << " " << cumulative << "\n";
+        }
+        std::ostringstream sum;
+        sum << std::setprecision(12) << s->histogram->sum();
+        out << s->name << "_sum" << labels(s->label) << " " << sum.str() << "\n";
+        out << s->name << "_count" << labels(s->label) << " " << cumulative << "\n";
+    }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace gribjump
@@ -0,0 +1,127 @@
+/*
+ * (C) Copyright 2023- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+/// @author Caragh Bradley
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <iosfwd>
+#include <memory>
+#include <string>
+#include <utility>
+
+namespace gribjump {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/// Monotonically increasing count, e.g. of bytes read.
+class Counter {
+public:
+
+    void increment(uint64_t n = 1) { value_.fetch_add(n, std::memory_order_relaxed); }
+
+    uint64_t value() const { return value_.load(std::memory_order_relaxed); }
+
+private:
+
+    std::atomic<uint64_t> value_{0};
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/// Value which may go up and down, e.g. the bytes held by a cache.
+class Gauge {
+public:
+
+    void set(int64_t value) { value_.store(value, std::memory_order_relaxed); }
+    void add(int64_t n) { value_.fetch_add(n, std::memory_order_relaxed); }
+
+    int64_t value() const { return value_.load(std::memory_order_relaxed); }
+
+private:
+
+    std::atomic<int64_t> value_{0};
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/// Distribution of durations in seconds, over fixed buckets from 0.5ms to 2 minutes.
+class Histogram {
+public:
+
+    static constexpr size_t nBounds = 17;
+
+    /// Upper bounds of the finite buckets. A final bucket holds everything larger.
+    static const std::array<double, nBounds>& bounds();
+
+    void observe(double value);
+
+    /// Number of observations in bucket i (not cumulative). Bucket nBounds is the overflow bucket.
+    uint64_t bucket(size_t i) const { return buckets_[i].load(std::memory_order_relaxed); }
+
+    uint64_t count() const;
+    double sum() const { return sum_.load(std::memory_order_relaxed); }
+
+private:
+
+    std::array<std::atomic<uint64_t>, nBounds + 1> buckets_{};
+    std::atomic<double> sum_{0};
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/// Process-wide counters, gauges and histograms aggregated over all requests, exposed in the Prometheus text format.
+///
+/// Complements Metrics, which reports one JSON line per request. Series are created on first use and never
+/// destroyed, so references may be kept (e.g. in function-local statics). Both lookups and updates are lock-free.
+class MetricsRegistry {
+public:
+
+    /// Optional label of a series, e.g. {"type", "extract"}
+    using Label = std::pair<std::string, std::string>;
+
+    static MetricsRegistry& instance();
+
+    MetricsRegistry(const MetricsRegistry&)            = delete;
+    MetricsRegistry& operator=(const MetricsRegistry&) = delete;
+
+    Counter& counter(const std::string& name, const std::string& help, const Label& label = {});
+
+    Gauge& gauge(const std::string& name, const std::string& help, const Label& label = {});
+
+    Histogram& histogram(const std::string& name, const std::string& help, const Label& label = {});
+
+    /// Write all series in the Prometheus text exposition format (version 0.0.4).
+    void exposition(std::ostream& out) const;
+
+private:
+
+    MetricsRegistry();
+    ~MetricsRegistry();
+
+    struct Series;
+
+    enum class Type { Counter, Gauge, Histogram };
+
+    Series& find(const std::string& name, const std::string& help, const Label& label, Type type);
+
+private:
+
+    static constexpr size_t capacity_ = 1024;
+
+    std::array<std::atomic<Series*>, capacity_> slots_;  //< open-addressed hash table, insert-only
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace gribjump
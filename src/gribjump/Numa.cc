@@ -0,0 +1,173 @@
+/*
+ * (C) Copyright 2023- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+/// @author Caragh Bradley
+
+#include "gribjump/Numa.h"
+
+#include <algorithm>
+#include <cctype>
+#include <fstream>
+#include <sstream>
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+#include "eckit/exception/Exceptions.h"
+#include "eckit/log/Log.h"
+
+#include "gribjump/LibGribJump.h"
+
+namespace gribjump {
+
+namespace {
+
+const char* sysfsNodes = "/sys/devices/system/node";
+
+#if defined(__linux__)
+/// Affinity of the calling thread before its first call to pin(), restored by unpin()
+thread_local bool savedAffinity = false;
+thread_local cpu_set_t originalAffinity;
+#endif
+
+bool readLine(const std::string& path, std::string& line) {
+    std::ifstream in(path);
+    return in && std::getline(in, line);
+}
+
+}  // namespace
+
+//----------------------------------------------------------------------------------------------------------------------
+
+const NumaTopology& NumaTopology::instance() {
+    static NumaTopology topology;
+    return topology;
+}
+
+NumaTopology::NumaTopology() {
+    std::string online;
+    if (readLine(std::string(sysfsNodes) + "/online", online)) {
+        for (int node : parseList(online)) {
+            std::string list;
+            if (!readLine(std::string(sysfsNodes) + "/node" + std::to_string(node) + "/cpulist", list)) {
+                continue;
+            }
+            std::vector<int> cpus = parseList(list);
+            if (cpus.empty()) {
+                continue;  // memory only, e.g. CXL memory
+            }
+            for (int cpu : cpus) {
+                if (size_t(cpu) >= nodeOfCpu_.size()) {
+                    nodeOfCpu_.resize(cpu + 1, -1);
+                }
+                nodeOfCpu_[cpu] = cpus_.size();
+            }
+            cpus_.push_back(std::move(cpus));
+        }
+    }
+
+    if (cpus_.empty()) {
+        cpus_.emplace_back();
+        nodeOfCpu_.clear();
+    }
+
+    LOG_DEBUG_LIB(LibGribJump) << "NUMA nodes with CPUs: " << cpus_.size() << std::endl;
+}
+
+const std::vector<int>& NumaTopology::cpus(size_t node) const {
+    ASSERT(node < cpus_.size());
+    return cpus_[node];
+}
+
+size_t NumaTopology::currentNode() const {
+#if defined(__linux__)
+    if (cpus_.size() > 1) {
+        const int cpu = sched_getcpu();
+        if (cpu >= 0 && size_t(cpu) < nodeOfCpu_.size() && nodeOfCpu_[cpu] >= 0) {
+            return nodeOfCpu_[cpu];
+        }
+    }
+#endif
+    return 0;
+}
+
+bool NumaTopology::pin(size_t node) const {
+    ASSERT(node < cpus_.size());
+    if (cpus_.size() <= 1) {
+        return false;
+    }
+#if defined(__linux__)
+    if (!savedAffinity) {
+        savedAffinity = pthread_getaffinity_np(pthread_self(), sizeof(originalAffinity), &originalAffinity) == 0;
+    }
+#endif
+    return setAffinity(cpus_[node]);
+}
+
+void NumaTopology::unpin() const {
+#if defined(__linux__)
+    if (!savedAffinity) {
+        return;
+    }
+    const int err = pthread_setaffinity_np(pthread_self(), sizeof(originalAffinity), &originalAffinity);
+    if (err != 0) {
+        eckit::Log::warning() << "Could not restore the CPU affinity of a thread: error " << err << std::endl;
+    }
+    savedAffinity = false;
+#endif
+}
+
+bool NumaTopology::setAffinity(const std::vector<int>& cpus) const {
+#if defined(__linux__)
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (int cpu : cpus) {
+        if (cpu < CPU_SETSIZE) {
+            CPU_SET(cpu, &set);
+        }
+    }
+    const int err = pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+    if (err != 0) {
+        eckit::Log::warning() << "Could not set the CPU affinity of a thread: error " << err << std::endl;
+        return false;
+    }
+    return true;
+#else
+    return false;
+#endif
+}
+
+std::vector<int> NumaTopology::parseList(const std::string& list) {
+    std::vector<int> cpus;
+    std::istringstream in(list);
+    std::string range;
+    while (std::getline(in, range, ',')) {
+        range.erase(std::remove_if(range.begin(), range.end(), ::isspace), range.end());
+        if (range.empty()) {
+            continue;
+        }
+        const size_t dash = range.find('-');
+        const int first   = std::stoi(range.substr(0, dash));
+        const int last    = dash == std::string::npos ? first : std::stoi(range.substr(dash + 1));
+        if (first < 0 || last < first) {
+            throw eckit::BadValue("Invalid CPU list: " + list, Here());
+        }
+        for (int cpu = first; cpu <= last; ++cpu) {
+            cpus.push_back(cpu);
+        }
+    }
+    return cpus;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace gribjump
@@ -0,0 +1,65 @@
+/*
+ * (C) Copyright 2023- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+/// @author Caragh Bradley
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+namespace gribjump {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/// NUMA nodes of the machine and their CPUs, read from /sys/devices/system/node on Linux. Elsewhere, or if that cannot
+/// be read, the machine is a single node and pinning does nothing.
+///
+/// Linux allocates the pages of memory on the node of the CPU which first writes them, so a thread pinned to a node
+/// allocates its results on that node without any other change.
+class NumaTopology {
+public:
+
+    static const NumaTopology& instance();
+
+    /// Number of nodes with CPUs, at least 1
+    size_t nodes() const { return cpus_.size(); }
+
+    /// CPUs of node. Empty on machines whose topology is unknown.
+    const std::vector<int>& cpus(size_t node) const;
+
+    /// Node of the CPU the calling thread is running on, 0 if unknown
+    size_t currentNode() const;
+
+    /// Restrict the calling thread to the CPUs of node. False if the machine is a single node, or on failure, e.g. if
+    /// none of the CPUs of node are allowed by the cpuset of the process.
+    bool pin(size_t node) const;
+
+    /// Restore the affinity the calling thread had before it was first pinned, e.g. as restricted by taskset
+    void unpin() const;
+
+    /// CPUs of a list in the sysfs format, e.g. "0-3,8,10-11"
+    static std::vector<int> parseList(const std::string& list);
+
+private:
+
+    NumaTopology();
+
+    bool setAffinity(const std::vector<int>& cpus) const;
+
+private:
+
+    std::vector<std::vector<int>> cpus_;  //< by node, only the nodes with CPUs
+    std::vector<int> nodeOfCpu_;          //< by CPU, -1 if unknown
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace gribjump
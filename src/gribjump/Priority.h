@@ -0,0 +1,59 @@
+/*
+ * (C) Copyright 2023- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+/// @author Caragh Bradley
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "eckit/exception/Exceptions.h"
+
+namespace gribjump {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/// Scheduling class of a request. Requests set it with the "priority" key of their LogContext, e.g.
+/// {"priority": "high"}. The WorkQueue shares worker threads between classes in proportion to their weights.
+enum class Priority : uint8_t {
+    HIGH = 0,
+    NORMAL,
+    LOW,
+};
+
+constexpr size_t NPRIORITIES = 3;
+
+inline const char* priorityName(Priority p) {
+    switch (p) {
+        case Priority::HIGH:
+            return "high";
+        case Priority::NORMAL:
+            return "normal";
+        case Priority::LOW:
+            return "low";
+    }
+    throw eckit::SeriousBug("Unknown priority " + std::to_string(static_cast<int>(p)));
+}
+
+inline Priority priorityFromString(const std::string& s) {
+    for (size_t i = 0; i < NPRIORITIES; ++i) {
+        Priority p = static_cast<Priority>(i);
+        if (s == priorityName(p)) {
+            return p;
+        }
+    }
+    throw eckit::BadValue("Unknown priority '" + s + "'. Expected one of: high, normal, low");
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace gribjump
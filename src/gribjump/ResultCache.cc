@@ -0,0 +1,182 @@
+/*
+ * (C) Copyright 2023- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+/// @author Caragh Bradley
+
+#include "gribjump/ResultCache.h"
+
+#include <cstdint>
+
+#include "eckit/exception/Exceptions.h"
+#include "eckit/log/Bytes.h"
+#include "eckit/log/Log.h"
+
+#include "gribjump/Config.h"
+#include "gribjump/ExtractionItem.h"
+#include "gribjump/MetricsRegistry.h"
+
+namespace gribjump {
+
+namespace {
+
+Counter& evictions(const std::string& reason) {
+    return MetricsRegistry::instance().counter("gribjump_result_cache_evictions_total",
+                                               "Results dropped from the result cache, by reason.", {"reason", reason});
+}
+
+size_t footprint(const ExtractionResult& result) {
+    return result.total_values() * sizeof(double) + result.total_mask_words() * sizeof(uint64_t) +
+           2 * (result.nrange() + 1) * sizeof(size_t);
+}
+
+}  // namespace
+
+//----------------------------------------------------------------------------------------------------------------------
+
+ResultCache& ResultCache::instance() {
+    static ResultCache cache([] {
+        const ConfigOptions& opts = ConfigOptions::instance();
+        ResultCacheLimits limits;
+        limits.maxMemory = opts.resultCacheMaxMemory();
+        limits.ttl       = opts.resultCacheTTL();
+        return limits;
+    }());
+    return cache;
+}
+
+ResultCache::ResultCache(const ResultCacheLimits& limits) : limits_(limits) {
+    if (enabled()) {
+        eckit::Log::info() << "Result cache enabled: maxMemory=" << eckit::Bytes(limits_.maxMemory)
+                           << ", ttl=" << limits_.ttl << "s" << std::endl;
+    }
+}
+
+std::string ResultCache::key(const ExtractionItem& item) {
+    // FNV-1a of the ranges: entries keep their ranges, so that colliding keys are told apart
+    uint64_t hash = 14695981039346656037ull;
+    for (const auto& [start, end] : item.intervals()) {
+        for (uint64_t v : {uint64_t(start), uint64_t(end)}) {
+            hash = (hash ^ v) * 1099511628211ull;
+        }
+    }
+    return item.URI().asString() + "|" + item.gridHash() + "|" + std::to_string(hash);
+}
+
+filemap_t ResultCache::lookup(const filemap_t& filemap, size_t& hits) {
+    filemap_t misses;
+    hits = 0;
+    for (const auto& [fname, items] : filemap) {
+        for (ExtractionItem* item : items) {
+            std::unique_ptr<ExtractionResult> result = item->isRemote() ? nullptr : get(*item);
+            if (result) {
+                item->result(std::move(result));
+                ++hits;
+            }
+            else {
+                misses[fname].push_back(item);
+            }
+        }
+    }
+    return misses;
+}
+
+std::unique_ptr<ExtractionResult> ResultCache::get(const ExtractionItem& item) {
+    static Counter& hits   = MetricsRegistry::instance().counter("gribjump_result_cache_hits_total",
+                                                                 "Extractions served from the result cache.");
+    static Counter& misses = MetricsRegistry::instance().counter("gribjump_result_cache_misses_total",
+                                                                 "Extractions not found in the result cache.");
+    static Counter& saved  = MetricsRegistry::instance().counter(
+        "gribjump_result_cache_saved_microseconds_total", "Decode time saved by serving results from the cache.");
+
+    if (!enabled()) {
+        return nullptr;
+    }
+
+    std::shared_ptr<const ExtractionResult> result;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = entries_.find(key(item));
+        if (it != entries_.end() && Clock::now() >= it->second.expiry) {
+            erase(it, "ttl");
+            it = entries_.end();
+        }
+        if (it == entries_.end() || it->second.ranges != item.intervals()) {
+            misses.increment();
+            return nullptr;
+        }
+
+        lru_.splice(lru_.begin(), lru_, it->second.lru);
+        result = it->second.result;
+        saved.increment(static_cast<uint64_t>(it->second.decodeTime * 1e6));
+    }
+    hits.increment();
+
+    // Copy outside the lock: the entry may be evicted meanwhile, but the result is kept alive by this reference
+    return result->clone();
+}
+
+void ResultCache::put(const ExtractionItem& item, const ExtractionResult& result, double decodeTime) {
+    if (!enabled() || item.isRemote()) {
+        return;
+    }
+    const size_t size = footprint(result);
+    if (size > limits_.maxMemory) {
+        return;
+    }
+
+    std::shared_ptr<const ExtractionResult> copy(result.clone());
+    const std::string k = key(item);
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = entries_.find(k);
+    if (it != entries_.end()) {
+        erase(it, "replaced");
+    }
+
+    lru_.push_front(k);
+    Entry entry{item.intervals(), std::move(copy), size, decodeTime,
+                Clock::now() + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(limits_.ttl)),
+                lru_.begin()};
+    entries_.emplace(k, std::move(entry));
+    bytes_ += size;
+
+    while (bytes_ > limits_.maxMemory) {
+        erase(entries_.find(lru_.back()), "memory");
+    }
+}
+
+void ResultCache::erase(std::unordered_map<std::string, Entry>::iterator it, const char* reason) {
+    ASSERT(it != entries_.end());
+    bytes_ -= it->second.bytes;
+    lru_.erase(it->second.lru);
+    entries_.erase(it);
+    evictions(reason).increment();
+}
+
+void ResultCache::clear() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    entries_.clear();
+    lru_.clear();
+    bytes_ = 0;
+}
+
+size_t ResultCache::size() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return entries_.size();
+}
+
+size_t ResultCache::bytes() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return bytes_;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace gribjump
@@ -0,0 +1,102 @@
+/*
+ * (C) Copyright 2023- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+/// @author Caragh Bradley
+
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#include "gribjump/ExtractionData.h"
+#include "gribjump/Types.h"
+
+namespace gribjump {
+
+class ExtractionItem;
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/// Limits of the ResultCache. A maxMemory of zero disables the cache.
+struct ResultCacheLimits {
+    size_t maxMemory = 0;   //< maximum total bytes of cached results
+    double ttl       = 60;  //< seconds a result is served for after it was extracted
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/// Results of recent extractions, to serve repeated identical extractions (same field, same ranges) without decoding.
+///
+/// Results are keyed by the location of the field (URI, i.e. file and offset), its ranges and the grid hash of the
+/// request. FDB never rewrites a field in place: a field archived again is written to a new location, which the
+/// listing of later requests returns, so replaced fields are never served from the cache. Results expire after the
+/// TTL, and the least recently used are evicted to stay within the memory budget.
+class ResultCache {
+public:
+
+    static ResultCache& instance();  // singleton, limits from ConfigOptions
+
+    explicit ResultCache(const ResultCacheLimits& limits);
+
+    ResultCache(const ResultCache&)            = delete;
+    ResultCache& operator=(const ResultCache&) = delete;
+
+    bool enabled() const { return limits_.maxMemory > 0; }
+
+    /// Set the result of each item of filemap found in the cache, and return a filemap of the other items, which must
+    /// be extracted. hits receives the number of items found. Items of remote fields are never cached.
+    filemap_t lookup(const filemap_t& filemap, size_t& hits);
+
+    /// Copy of the cached result of an item, or null
+    std::unique_ptr<ExtractionResult> get(const ExtractionItem& item);
+
+    /// Cache the result of an item, which took decodeTime seconds to extract
+    void put(const ExtractionItem& item, const ExtractionResult& result, double decodeTime);
+
+    void clear();
+
+    size_t size() const;
+    size_t bytes() const;
+
+private:
+
+    using Clock = std::chrono::steady_clock;
+
+    struct Entry {
+        Ranges ranges;
+        std::shared_ptr<const ExtractionResult> result;
+        size_t bytes;
+        double decodeTime;
+        Clock::time_point expiry;
+        std::list<std::string>::iterator lru;
+    };
+
+    static std::string key(const ExtractionItem& item);
+
+    void erase(std::unordered_map<std::string, Entry>::iterator it, const char* reason);  // requires lock
+
+private:
+
+    const ResultCacheLimits limits_;
+
+    mutable std::mutex mutex_;
+    std::unordered_map<std::string, Entry> entries_;
+    std::list<std::string> lru_;  //< keys, most recently used first
+    size_t bytes_ = 0;
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace gribjump
@@ -0,0 +1,61 @@
+/*
+ * (C) Copyright 2023- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+/// @author Caragh Bradley
+
+#pragma once
+
+#include <cstddef>
+#include <type_traits>
+#include <vector>
+
+#include "eckit/exception/Exceptions.h"
+
+namespace gribjump {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/// Non-owning view of a contiguous array, in the manner of C++20's std::span.
+template <typename T>
+class Span {
+public:
+
+    Span() = default;
+    Span(T* data, size_t size) : data_(data), size_(size) {}
+
+    /// A Span<const T> can be made from a Span<T>
+    template <typename U>
+    Span(const Span<U>& other) : data_(other.data()), size_(other.size()) {}
+
+    T* data() const { return data_; }
+    size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+
+    T& operator[](size_t i) const { return data_[i]; }
+
+    T* begin() const { return data_; }
+    T* end() const { return data_ + size_; }
+
+    Span subspan(size_t offset, size_t count) const {
+        ASSERT(offset + count <= size_);
+        return Span(data_ + offset, count);
+    }
+
+    std::vector<std::remove_const_t<T>> toVector() const { return {begin(), end()}; }
+
+private:
+
+    T* data_     = nullptr;
+    size_t size_ = 0;
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace gribjump
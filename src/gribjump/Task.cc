@@ -8,11 +8,17 @@
  * does it submit to any jurisdiction.
  */
 
+#include <algorithm>
+#include <array>
+#include <optional>
+#include <sstream>
+
 #include "eckit/io/AutoCloser.h"
 #include "eckit/io/Length.h"
 #include "eckit/io/MemoryHandle.h"
 #include "eckit/log/Log.h"
 #include "eckit/log/Plural.h"
+#include "eckit/log/Timer.h"
 #include "eckit/message/Message.h"
 #include "eckit/message/Reader.h"
 
@@ -21,9 +27,13 @@
 #include "gribjump/Config.h"
 #include "gribjump/LibGribJump.h"
 #include "gribjump/LogRouter.h"
+#include "gribjump/MetricsRegistry.h"
+#include "gribjump/Numa.h"
+#include "gribjump/ResultCache.h"
 #include "gribjump/Task.h"
 #include "gribjump/info/InfoCache.h"
 #include "gribjump/info/InfoFactory.h"
+#include "gribjump/info/InternTable.h"
 #include "gribjump/jumper/JumperFactory.h"
 #include "gribjump/remote/Protocol.h"
 #include "gribjump/remote/RemoteGribJump.h"
@@ -55,13 +65,26 @@ void Task::notifyCancelled() {
 }
 
 void Task::execute() {
+    // If the request has been cancelled or its deadline has passed, this cancels all pending tasks in the group. This
+    // task is cancelled too, as it may have been enqueued after the group was cancelled.
+    if (taskGroup_.cancelled()) {
+        cancel();
+    }
+
     // atomically set status to executing, but only if it is currently pending (i.e. not cancelled)
     Status expected = Status::PENDING;
     if (!status_.compare_exchange_strong(expected, Status::EXECUTING)) {
+        if (expected == Status::CANCELLED) {
+            notifyCancelled();
+        }
         return;
     }
     info();
-    executeImpl();
+    {
+        TraceSpan span("task", taskGroup_.trace());
+        span.attribute("task_id", std::to_string(taskid_));
+        executeImpl();
+    }
     notify();
 }
 
@@ -73,6 +96,110 @@ void Task::cancel() {
 
 //----------------------------------------------------------------------------------------------------------------------
 
+TaskGroup::TaskGroup() :
+    ctx_{ContextManager::instance().context()},
+    token_{CancellationToken::current()},
+    trace_{Tracer::instance().enabled() ? Tracer::instance().current() : TraceContext{}},
+    node_{ConfigOptions::instance().schedulerNuma() ? NumaTopology::instance().currentNode() : 0} {
+    // Cancel the pending tasks as soon as the token is, rather than when a worker next reaches one of them
+    onCancel_ = token_.onCancel([this] { cancel(token_.reason()); });
+
+    eckit::Value ctx = ctx_.value();
+    if (!ctx.isMap()) {
+        return;
+    }
+
+    if (ctx.contains("priority")) {
+        priority_ = priorityFromString(std::string(ctx["priority"]));
+    }
+
+    if (ctx.contains("deadline")) {
+        eckit::Value deadline = ctx["deadline"];
+        if (deadline.isDouble()) {
+            deadlineSeconds_ = static_cast<double>(deadline);
+        }
+        else if (deadline.isNumber()) {
+            deadlineSeconds_ = static_cast<long long>(deadline);
+        }
+        else {
+            std::ostringstream ss;
+            ss << "Request deadline must be a number of seconds, got: " << deadline;
+            throw eckit::BadValue(ss.str(), Here());
+        }
+        auto duration = std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+            std::chrono::duration<double>(deadlineSeconds_));
+        deadline_ = std::chrono::steady_clock::now() + duration;
+    }
+}
+
+bool TaskGroup::cancelled() {
+    if (cancelled_) {
+        return true;
+    }
+
+    bool expired = deadline_ && std::chrono::steady_clock::now() >= *deadline_;
+    if (!expired && !token_.cancelled()) {
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(m_);
+    if (cancelled_) {
+        return true;
+    }
+    if (token_.cancelled()) {
+        doCancel(token_.reason());
+    }
+    else {
+        std::ostringstream ss;
+        ss << "Request deadline of " << deadlineSeconds_ << "s exceeded";
+        deadlineExceeded_ = true;
+        doCancel(ss.str());
+    }
+    return true;
+}
+
+void TaskGroup::cancel(const std::string& reason) {
+    std::lock_guard<std::mutex> lock(m_);
+    doCancel(reason);
+}
+
+// NB: Requires the lock on m_.
+void TaskGroup::doCancel(const std::string& reason) {
+    if (cancelled_) {
+        return;
+    }
+    cancelReason_ = reason;
+    cancelled_    = true;
+    errors_.push_back(reason + ". Cancelled remaining tasks.");
+    cancelTasks();
+
+    // Tasks still queued will not run: count them as cancelled now, so that waitForTasks() need not wait for workers
+    // busy with other groups to reach them.
+    if (!tasks_.empty()) {
+        size_t removed = WorkQueue::instance().remove(this);
+        nComplete_ += removed;
+        nCancelledTasks_ += removed;
+        cv_.notify_one();
+    }
+}
+
+void TaskGroup::recordQueueWait(double seconds) {
+    static const std::array<Histogram*, NPRIORITIES> waits = [] {
+        std::array<Histogram*, NPRIORITIES> histograms;
+        for (size_t c = 0; c < NPRIORITIES; ++c) {
+            histograms[c] = &MetricsRegistry::instance().histogram(
+                "gribjump_queue_wait_seconds", "Time tasks spent in the work queue, by priority class.",
+                {"priority", priorityName(static_cast<Priority>(c))});
+        }
+        return histograms;
+    }();
+    waits[static_cast<size_t>(priority_)]->observe(seconds);
+
+    std::lock_guard<std::mutex> lock(m_);
+    queueWaitTotal_ += seconds;
+    queueWaitMax_ = std::max(queueWaitMax_, seconds);
+}
+
 void TaskGroup::notify(size_t taskid) {
     std::lock_guard<std::mutex> lock(m_);
     nComplete_++;
@@ -152,6 +279,16 @@ void TaskGroup::waitForTasks() {
     MetricsManager::instance().set("count_tasks", tasks_.size());
     MetricsManager::instance().set("count_failed_tasks", errors_.size());
     MetricsManager::instance().set("count_cancelled_tasks", nCancelledTasks_);
+    MetricsManager::instance().set("priority", priorityName(priority_));
+    MetricsManager::instance().set("elapsed_queue_wait_mean", queueWaitTotal_ / tasks_.size());
+    MetricsManager::instance().set("elapsed_queue_wait_max", queueWaitMax_);
+    if (deadline_) {
+        MetricsManager::instance().set("deadline", deadlineSeconds_);
+        MetricsManager::instance().set("deadline_exceeded", deadlineExceeded_);
+    }
+    if (cancelled_) {
+        MetricsManager::instance().set("cancelled", cancelReason_);
+    }
 
     if (errors_.size() > 0) {
         MetricsManager::instance().set("first_error", errors_[0]);
@@ -205,15 +342,26 @@ void FileExtractionTask::extract() {
         offsets.push_back(extractionItem->offset());
     }
 
+    std::optional<TraceSpan> phase(std::in_place, "load_info");
+    phase->attribute("file", fname_);
+
     std::vector<std::shared_ptr<JumpInfo>> infos = InfoCache::instance().get(fname_, offsets);
 
+    phase.emplace("decode");
+
     // Extract
+    ResultCache& cache = ResultCache::instance();
     eckit::FileHandle fh(fname_);
 
     fh.openForRead();
     eckit::AutoCloser<eckit::FileHandle> closer(fh);
 
     for (size_t i = 0; i < extractionItems_.size(); i++) {
+        if (taskGroup_.cancelled()) {
+            // The group has recorded the reason; results of the remaining items would be discarded anyway.
+            return;
+        }
+
         ExtractionItem* extractionItem = extractionItems_[i];
         const JumpInfo& info           = *infos[i];
 
@@ -223,7 +371,8 @@ void FileExtractionTask::extract() {
             throw eckit::BadValue("Grid hash was not specified in request but is required. (Extraction item " +
                                   std::to_string(i) + " in file " + fname_ + ")");
         }
-        if (!ignoreGrid_ && (expectedHash != info.md5GridSection())) {
+        // A hash which was never interned is not the hash of any info
+        if (!ignoreGrid_ && InternTable::gridHashes().find(expectedHash) != info.gridHashId()) {
             throw eckit::BadValue("Grid hash mismatch for extraction item " + std::to_string(i) + " in file " + fname_ +
                                   ". Request specified: " + expectedHash +
                                   ", JumpInfo contains: " + info.md5GridSection());
@@ -231,7 +380,12 @@ void FileExtractionTask::extract() {
 
         std::unique_ptr<Jumper> jumper(
             JumperFactory::instance().build(info));  // todo, dont build a new jumper for each info.
+        eckit::Timer timer;
         jumper->extract(fh, offsets[i], info, *extractionItem);
+
+        if (cache.enabled()) {
+            cache.put(*extractionItem, *extractionItem->peekResult(), timer.elapsed());
+        }
     }
 }
 
@@ -249,6 +403,7 @@ ForwardExtractionTask::ForwardExtractionTask(TaskGroup& taskgroup, const size_t
 void ForwardExtractionTask::executeImpl() {
 
     ContextManager::instance().set(taskGroup_.context());
+    CancellationScope cancellation(taskGroup_.token());  // cancelling the request closes the forwarded connection
 
     RemoteGribJump remoteGribJump(endpoint_);
     remoteGribJump.forwardExtract(filemap_);
@@ -267,6 +422,7 @@ ForwardScanTask::ForwardScanTask(TaskGroup& taskgroup, const size_t id, eckit::n
 void ForwardScanTask::executeImpl() {
 
     ContextManager::instance().set(taskGroup_.context());
+    CancellationScope cancellation(taskGroup_.token());
 
     RemoteGribJump remoteGribJump(endpoint_);
     nfields_ += remoteGribJump.forwardScan(scanmap_);
@@ -288,6 +444,10 @@ void InefficientFileExtractionTask::extract() {
 
     // One message at a time
     for (auto& extractionItem : extractionItems_) {
+        if (taskGroup_.cancelled()) {
+            return;
+        }
+
         eckit::URI uri = extractionItem->URI();
 
         if (uri.scheme() != "fdb") {
@@ -354,4 +514,17 @@ void FileScanTask::info() const {
 
 //----------------------------------------------------------------------------------------------------------------------
 
+IndexFlushTask::IndexFlushTask(TaskGroup& taskgroup, const size_t id, std::shared_ptr<IndexFile> file, bool append) :
+    Task(taskgroup, id), file_(std::move(file)), append_(append) {}
+
+void IndexFlushTask::executeImpl() {
+    file_->flush(append_);
+}
+
+void IndexFlushTask::info() const {
+    eckit::Log::status() << "Flush index file " << file_->path_ << std::endl;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
 }  // namespace gribjump
\ No newline at end of file
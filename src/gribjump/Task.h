@@ -11,15 +11,22 @@
 #pragma once
 
 #include <atomic>
+#include <chrono>
 #include <condition_variable>
+#include <memory>
 #include <mutex>
+#include <optional>
 #include "eckit/serialisation/Stream.h"
 
+#include "gribjump/Cancellation.h"
 #include "gribjump/ExtractionItem.h"
 #include "gribjump/GribJump.h"
+#include "gribjump/Priority.h"
+#include "gribjump/Tracing.h"
 
 namespace gribjump {
 
+class IndexFile;
 class TaskGroup;
 
 //----------------------------------------------------------------------------------------------------------------------
@@ -43,7 +50,7 @@ public:
 
     size_t id() const { return taskid_; }
 
-    /// executes the task to completion
+    /// executes the task to completion, or notifies its cancellation if it was cancelled while queued
     virtual void execute() final;
 
     /// notifies the completion of the task
@@ -97,7 +104,10 @@ private:
 class TaskGroup {
 public:
 
-    TaskGroup() : ctx_{ContextManager::instance().context()} {}
+    /// Scheduling priority and deadline are read from the "priority" and "deadline" keys of the current LogContext.
+    /// The deadline is given in seconds, relative to the creation of the TaskGroup.
+    /// The group is cancelled as soon as the calling thread's current CancellationToken is cancelled.
+    TaskGroup();
 
     /// Notify that a task has been completed
     void notify(size_t taskid);
@@ -139,12 +149,36 @@ public:
 
     const LogContext& context() const { return ctx_; }
 
+    /// Trace span of the code that created the group, the parent of the spans of its tasks.
+    const TraceContext& trace() const { return trace_; }
+
+    Priority priority() const { return priority_; }
+
+    /// NUMA node of the thread that created the group, whose queue its tasks join when the scheduler is NUMA-aware.
+    size_t node() const { return node_; }
+
+    /// Returns true if the group has been cancelled, its CancellationToken has been cancelled, or its deadline has
+    /// passed. The first call to observe this records an error and cancels all pending tasks.
+    /// Running tasks should check this between units of work, and stop early if it returns true.
+    bool cancelled();
+
+    /// Cancel all pending tasks, recording the reason as an error, and remove them from the WorkQueue. Tasks already
+    /// executing run until they next check cancelled().
+    void cancel(const std::string& reason);
+
+    const CancellationToken& token() const { return token_; }
+
+    /// Record the time a task of this group spent in the WorkQueue before being picked up by a worker.
+    void recordQueueWait(double seconds);
+
 private:
 
     void enqueueTask(Task* task);
 
     void cancelTasks();
 
+    void doCancel(const std::string& reason);  // requires lock
+
 private:
 
     int nComplete_       = 0;      //< incremented when a task completes
@@ -161,6 +195,22 @@ private:
     std::vector<std::string> errors_;  //< stores error messages, empty if no errors
 
     const LogContext& ctx_;  //< required for propagating context in forwarding tasks.
+
+    CancellationToken token_;                                        //< of the operation that created the group
+    TraceContext trace_;                                             //< span of the operation that created the group
+    std::optional<std::chrono::steady_clock::time_point> deadline_;  //< unset if the request has no deadline
+    std::atomic<bool> cancelled_{false};
+
+    Priority priority_      = Priority::NORMAL;
+    size_t node_            = 0;
+    double deadlineSeconds_ = 0;  //< deadline as requested, for reporting
+    bool deadlineExceeded_  = false;
+    std::string cancelReason_;
+
+    double queueWaitTotal_ = 0;  //< sum of time tasks spent queued, in seconds
+    double queueWaitMax_   = 0;  //< longest time a task spent queued, in seconds
+
+    CancellationToken::Registration onCancel_;  //< last, so that it is unregistered before the rest is destroyed
 };
 
 //----------------------------------------------------------------------------------------------------------------------
@@ -260,5 +310,23 @@ private:
     std::atomic<size_t>& nfields_;
 };
 
+//----------------------------------------------------------------------------------------------------------------------
+
+/// Writes the staged entries of one index file, when InfoCache::flush writes several in parallel.
+class IndexFlushTask : public Task {
+public:
+
+    IndexFlushTask(TaskGroup& taskgroup, const size_t id, std::shared_ptr<IndexFile> file, bool append);
+
+    void executeImpl() override;
+
+    virtual void info() const override;
+
+private:
+
+    std::shared_ptr<IndexFile> file_;
+    bool append_;
+};
+
 
 }  // namespace gribjump
\ No newline at end of file
@@ -0,0 +1,98 @@
+/*
+ * (C) Copyright 2023- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+/// @author Caragh Bradley
+
+#include "gribjump/TimeSeries.h"
+
+#include <algorithm>
+#include <limits>
+
+#include "eckit/exception/Exceptions.h"
+
+#include "gribjump/Config.h"
+#include "gribjump/tools/ToolUtils.h"
+
+namespace gribjump {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+TimeSeriesResult::TimeSeriesResult(std::vector<std::string> requests, const std::vector<Range>& ranges) :
+    requests_(std::move(requests)), npoints_(0) {
+    for (const auto& range : ranges) {
+        npoints_ += range.second - range.first;
+    }
+    values_.assign(requests_.size() * npoints_, std::numeric_limits<double>::quiet_NaN());
+    found_.assign(requests_.size(), false);
+}
+
+void TimeSeriesResult::fill(size_t t, const ExtractionResult& result) {
+    ASSERT(t < ntimes());
+    ASSERT(result.total_values() == npoints_);
+
+    double* row = values_.data() + t * npoints_;
+    for (size_t i = 0; i < result.nrange(); ++i) {
+        Span<const double> values  = result.values(i);
+        Span<const uint64_t> masks = result.mask(i);
+        for (size_t j = 0; j < values.size(); ++j) {
+            *row++ = (masks[j / 64] >> (j % 64)) & 1 ? values[j] : std::numeric_limits<double>::quiet_NaN();
+        }
+    }
+    found_[t] = true;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+void validateTimeSeriesRanges(const std::vector<Range>& ranges) {
+    if (ranges.empty()) {
+        throw eckit::UserError("Time series ranges must not be empty", Here());
+    }
+    for (const auto& [begin, end] : ranges) {
+        if (begin >= end) {
+            throw eckit::UserError("Invalid time series range [" + std::to_string(begin) + ", " + std::to_string(end) +
+                                       "): expected begin < end",
+                                   Here());
+        }
+    }
+}
+
+std::vector<std::string> timeSeriesFields(const metkit::mars::MarsRequest& request) {
+    static bool ignoreYearMonth = ConfigOptions::instance().ignoreYearMonth();
+
+    std::vector<std::string> fields;
+    for (const auto& field : flattenRequest(request)) {
+        std::vector<std::string> keys = field.params();
+        std::sort(keys.begin(), keys.end());
+
+        // As FDB keys, drop year and month which are aliases of date
+        const bool hasDate = std::find(keys.begin(), keys.end(), "date") != keys.end();
+
+        std::string canonical;
+        for (const auto& key : keys) {
+            if (ignoreYearMonth && hasDate && (key == "year" || key == "month")) {
+                continue;
+            }
+            canonical += (canonical.empty() ? "" : ",") + key + "=" + field.values(key).at(0);
+        }
+        fields.push_back(canonical);
+    }
+
+    std::vector<std::string> sorted(fields);
+    std::sort(sorted.begin(), sorted.end());
+    auto duplicate = std::adjacent_find(sorted.begin(), sorted.end());
+    if (duplicate != sorted.end()) {
+        throw eckit::UserError("Time series request names the field " + *duplicate + " more than once", Here());
+    }
+    return fields;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace gribjump
@@ -0,0 +1,71 @@
+/*
+ * (C) Copyright 2023- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+/// @author Caragh Bradley
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "gribjump/ExtractionData.h"
+#include "gribjump/Span.h"
+#include "gribjump/Types.h"
+#include "metkit/mars/MarsRequest.h"
+
+namespace gribjump {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/// The same ranges extracted from every field of a multi-valued request, e.g. every step of a forecast, as a dense
+/// row-major [ntimes x npoints] array. Row t holds the values of the field requests()[t], ranges concatenated.
+/// Missing values, and all the values of fields which were not found, are NaN.
+class TimeSeriesResult {
+public:
+
+    /// One row per request, of the total length of the ranges. All values start as NaN.
+    TimeSeriesResult(std::vector<std::string> requests, const std::vector<Range>& ranges);
+
+    size_t ntimes() const { return requests_.size(); }
+    size_t npoints() const { return npoints_; }
+
+    /// Canonical request of each row
+    const std::vector<std::string>& requests() const { return requests_; }
+
+    Span<const double> values() const { return {values_.data(), values_.size()}; }
+    Span<const double> row(size_t t) const { return {values_.data() + t * npoints_, npoints_}; }
+
+    /// Whether the field of row t was found
+    bool found(size_t t) const { return found_[t]; }
+
+    /// Copy the result extracted from the field of row t into that row
+    void fill(size_t t, const ExtractionResult& result);
+
+private:
+
+    std::vector<std::string> requests_;
+    size_t npoints_;
+    std::vector<double> values_;
+    std::vector<bool> found_;
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/// Throws eckit::UserError unless the ranges are non-empty, sorted and disjoint. Time series check their ranges once,
+/// rather than once per field.
+void validateTimeSeriesRanges(const std::vector<Range>& ranges);
+
+/// The fields of a time series request, in the order of its values, each as a canonical request string: keys in
+/// alphabetical order and no verb, as FDB keys are matched.
+std::vector<std::string> timeSeriesFields(const metkit::mars::MarsRequest& request);
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace gribjump
@@ -0,0 +1,308 @@
+/*
+ * (C) Copyright 2023- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+/// @author Caragh Bradley
+
+#include "gribjump/Tracing.h"
+
+#include <unistd.h>
+#include <functional>
+#include <iomanip>
+#include <random>
+#include <sstream>
+#include <thread>
+
+#include "eckit/exception/Exceptions.h"
+#include "eckit/log/JSON.h"
+#include "eckit/log/Log.h"
+#include "eckit/runtime/Main.h"
+
+#include "gribjump/Config.h"
+#include "gribjump/LibGribJump.h"
+
+namespace gribjump {
+
+namespace {
+
+std::string randomHex(size_t nbytes) {
+    static thread_local std::mt19937_64 rng(std::random_device{}() ^
+                                            std::hash<std::thread::id>{}(std::this_thread::get_id()));
+    std::ostringstream oss;
+    oss << std::hex << std::setfill('0');
+    for (size_t i = 0; i < nbytes; i += 8) {
+        oss << std::setw(16) << rng();
+    }
+    return oss.str().substr(0, 2 * nbytes);
+}
+
+Tracer::Format formatFromString(const std::string& format) {
+    if (format == "chrome") {
+        return Tracer::Format::CHROME;
+    }
+    if (format == "otlp") {
+        return Tracer::Format::OTLP;
+    }
+    throw eckit::UserError("Unknown trace format '" + format + "'. Expected 'chrome' or 'otlp'.", Here());
+}
+
+std::string processName() {
+    try {
+        return eckit::Main::instance().name();
+    }
+    catch (...) {
+        return "gribjump";  // e.g. when loaded from python, without an eckit::Main
+    }
+}
+
+}  // namespace
+
+//----------------------------------------------------------------------------------------------------------------------
+
+Tracer& Tracer::instance() {
+    static Tracer instance;
+    return instance;
+}
+
+Tracer::Tracer() : steadyEpoch_(Clock::now()), systemEpoch_(std::chrono::system_clock::now()) {
+    std::string path = ConfigOptions::instance().traceFile();
+    if (!path.empty()) {
+        open(path, formatFromString(ConfigOptions::instance().traceFormat()));
+    }
+}
+
+void Tracer::open(const std::string& path, Format format) {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    enabled_ = false;
+    if (file_.is_open()) {
+        file_.close();
+    }
+    if (path.empty()) {
+        return;
+    }
+
+    std::ifstream existing(path, std::ios::binary | std::ios::ate);
+    bool empty = !existing || existing.tellg() == 0;
+
+    file_.open(path, std::ios::app);
+    if (!file_) {
+        throw eckit::CantOpenFile(path, Here());
+    }
+
+    // The closing bracket of a Chrome trace is optional, which lets several processes append to the same file.
+    if (format == Format::CHROME && empty) {
+        file_ << "[" << std::endl;
+    }
+
+    format_  = format;
+    enabled_ = true;
+    LOG_DEBUG_LIB(LibGribJump) << "Writing trace spans to " << path << std::endl;
+}
+
+TraceContext& Tracer::threadCurrent() {
+    static thread_local TraceContext current;
+    return current;
+}
+
+TraceContext Tracer::current() const {
+    const TraceContext& current = threadCurrent();
+    if (!current.empty()) {
+        return current;
+    }
+
+    eckit::Value ctx = ContextManager::instance().context().value();
+    if (ctx.isMap() && ctx.contains("trace")) {
+        eckit::Value trace = ctx["trace"];
+        if (trace.isMap() && trace.contains("trace_id") && trace.contains("span_id")) {
+            return {std::string(trace["trace_id"]), std::string(trace["span_id"])};
+        }
+    }
+    return {};
+}
+
+LogContext Tracer::inject(const LogContext& context) const {
+    if (!enabled_) {
+        return context;
+    }
+    TraceContext span = current();
+    if (span.empty()) {
+        return context;
+    }
+
+    eckit::Value ctx = context.value();
+    if (!ctx.isMap()) {
+        return context;
+    }
+    eckit::ValueMap values = ctx;
+    eckit::ValueMap trace;
+    trace["trace_id"] = span.traceId;
+    trace["span_id"]  = span.spanId;
+    values["trace"]   = eckit::Value(trace);
+
+    std::ostringstream oss;
+    eckit::JSON j(oss, false);
+    j << eckit::Value(values);
+    return LogContext(oss.str());
+}
+
+TraceContext Tracer::child(const TraceContext& parent) {
+    return {parent.empty() ? randomHex(16) : parent.traceId, randomHex(8)};
+}
+
+void Tracer::record(const std::string& name, const TraceContext& parent, Clock::time_point start,
+                    Clock::time_point end, const Attributes& attributes) {
+    if (!enabled_) {
+        return;
+    }
+    write(name, child(parent), parent.spanId, start, end, attributes);
+}
+
+void Tracer::write(const std::string& name, const TraceContext& context, const std::string& parentSpanId,
+                   Clock::time_point start, Clock::time_point end, const Attributes& attributes) {
+
+    using namespace std::chrono;
+    auto toUnixNanos = [this](Clock::time_point t) {
+        auto wall = systemEpoch_ + duration_cast<system_clock::duration>(t - steadyEpoch_);
+        return static_cast<long long>(duration_cast<nanoseconds>(wall.time_since_epoch()).count());
+    };
+    long long startNanos = toUnixNanos(start);
+    long long endNanos   = toUnixNanos(end);
+
+    Format format = format_;
+
+    std::ostringstream oss;
+    eckit::JSON j(oss, false);
+
+    if (format == Format::CHROME) {
+        // Complete ("X") event. Timestamps are in microseconds.
+        j.startObject();
+        j << "name" << name;
+        j << "cat" << "gribjump";
+        j << "ph" << "X";
+        j << "ts" << startNanos / 1000;
+        j << "dur" << (endNanos - startNanos) / 1000;
+        j << "pid" << static_cast<long long>(::getpid());
+        j << "tid" << static_cast<long long>(std::hash<std::thread::id>{}(std::this_thread::get_id()) % 1000000);
+        j << "args";
+        j.startObject();
+        j << "trace_id" << context.traceId;
+        j << "span_id" << context.spanId;
+        j << "parent_span_id" << parentSpanId;
+        for (const auto& [key, value] : attributes) {
+            j << key << value;
+        }
+        j.endObject();
+        j.endObject();
+    }
+    else {
+        auto attribute = [&j](const std::string& key, const std::string& value) {
+            j.startObject();
+            j << "key" << key;
+            j << "value";
+            j.startObject();
+            j << "stringValue" << value;
+            j.endObject();
+            j.endObject();
+        };
+
+        j.startObject();
+        j << "resourceSpans";
+        j.startList();
+        j.startObject();
+        j << "resource";
+        j.startObject();
+        j << "attributes";
+        j.startList();
+        attribute("service.name", processName());
+        j.endList();
+        j.endObject();
+        j << "scopeSpans";
+        j.startList();
+        j.startObject();
+        j << "scope";
+        j.startObject();
+        j << "name" << "gribjump";
+        j.endObject();
+        j << "spans";
+        j.startList();
+        j.startObject();
+        j << "traceId" << context.traceId;
+        j << "spanId" << context.spanId;
+        if (!parentSpanId.empty()) {
+            j << "parentSpanId" << parentSpanId;
+        }
+        j << "name" << name;
+        j << "kind" << 1;  // SPAN_KIND_INTERNAL
+        j << "startTimeUnixNano" << std::to_string(startNanos);
+        j << "endTimeUnixNano" << std::to_string(endNanos);
+        j << "attributes";
+        j.startList();
+        for (const auto& [key, value] : attributes) {
+            attribute(key, value);
+        }
+        j.endList();
+        j.endObject();
+        j.endList();
+        j.endObject();
+        j.endList();
+        j.endObject();
+        j.endList();
+        j.endObject();
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!file_.is_open()) {
+        return;
+    }
+    file_ << oss.str() << (format == Format::CHROME ? ",\n" : "\n");
+    file_.flush();
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+TraceSpan::TraceSpan(const std::string& name) :
+    TraceSpan(name, Tracer::instance().enabled() ? Tracer::instance().current() : TraceContext{}) {}
+
+TraceSpan::TraceSpan(const std::string& name, const TraceContext& parent) {
+    if (!Tracer::instance().enabled()) {
+        return;
+    }
+    active_       = true;
+    name_         = name;
+    context_      = Tracer::child(parent);
+    parentSpanId_ = parent.spanId;
+    previous_     = Tracer::threadCurrent();
+    start_        = Tracer::Clock::now();
+
+    Tracer::threadCurrent() = context_;
+}
+
+TraceSpan::~TraceSpan() {
+    if (!active_) {
+        return;
+    }
+    Tracer::threadCurrent() = previous_;
+    try {
+        Tracer::instance().write(name_, context_, parentSpanId_, start_, Tracer::Clock::now(), attributes_);
+    }
+    catch (const std::exception& e) {
+        eckit::Log::warning() << "Failed to record trace span " << name_ << ": " << e.what() << std::endl;
+    }
+}
+
+void TraceSpan::attribute(const std::string& key, const std::string& value) {
+    if (active_) {
+        attributes_.emplace_back(key, value);
+    }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace gribjump
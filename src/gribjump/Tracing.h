@@ -0,0 +1,139 @@
+/*
+ * (C) Copyright 2023- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+/// @author Caragh Bradley
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "gribjump/Metrics.h"
+
+namespace gribjump {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/// Identifies a span, and the trace it belongs to. Empty when there is no span to refer to.
+struct TraceContext {
+    std::string traceId;  //< 32 hex digits, shared by all spans of a trace
+    std::string spanId;   //< 16 hex digits
+
+    bool empty() const { return traceId.empty(); }
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/// Records trace spans of the stages of each request, and writes them to a file as they finish.
+///
+/// Spans started on a thread become the parents of later spans on that thread. Work handed to other threads refers to
+/// its parent explicitly, and requests sent to a server carry the current span under the "trace" key of their
+/// LogContext, so that the spans of a forwarded extraction on the client, front-end and back-end servers form one
+/// trace.
+///
+/// Disabled unless a trace file is configured, in which case spans are appended to it either as Chrome trace events
+/// (viewable in chrome://tracing or Perfetto), or as OTLP/JSON lines (one ExportTraceServiceRequest per span).
+class Tracer {
+public:
+
+    using Clock = std::chrono::steady_clock;
+
+    using Attributes = std::vector<std::pair<std::string, std::string>>;
+
+    enum class Format {
+        CHROME,
+        OTLP
+    };
+
+    static Tracer& instance();
+
+    bool enabled() const { return enabled_; }
+
+    /// The calling thread's current span or, if there is none, the span carried by its current LogContext.
+    TraceContext current() const;
+
+    /// Copy of context recording the calling thread's current span, for sending to a server.
+    LogContext inject(const LogContext& context) const;
+
+    /// Record a span that has already finished, e.g. time spent waiting in a queue.
+    void record(const std::string& name, const TraceContext& parent, Clock::time_point start, Clock::time_point end,
+                const Attributes& attributes = {});
+
+    /// Start writing spans to path, or stop tracing if path is empty. Tracing is normally configured by
+    /// ConfigOptions::traceFile(); this is for tools and tests.
+    void open(const std::string& path, Format format);
+
+private:
+
+    friend class TraceSpan;
+
+    Tracer();
+
+    /// New child of parent, or the root of a new trace if parent is empty.
+    static TraceContext child(const TraceContext& parent);
+
+    static TraceContext& threadCurrent();
+
+    void write(const std::string& name, const TraceContext& context, const std::string& parentSpanId,
+               Clock::time_point start, Clock::time_point end, const Attributes& attributes);
+
+private:
+
+    std::atomic<bool> enabled_{false};
+    std::atomic<Format> format_{Format::CHROME};
+
+    std::mutex mutex_;  //< guards file_
+    std::ofstream file_;
+
+    // Spans are timed with the steady clock, and converted to wall-clock time when written.
+    Clock::time_point steadyEpoch_;
+    std::chrono::system_clock::time_point systemEpoch_;
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/// RAII span, which is the calling thread's current span until it is destroyed. Does nothing if tracing is disabled.
+class TraceSpan {
+public:
+
+    /// Child of the calling thread's current span (see Tracer::current)
+    explicit TraceSpan(const std::string& name);
+
+    /// Child of parent, e.g. a task running on a worker thread on behalf of a request
+    TraceSpan(const std::string& name, const TraceContext& parent);
+
+    TraceSpan(const TraceSpan&)            = delete;
+    TraceSpan& operator=(const TraceSpan&) = delete;
+
+    ~TraceSpan();
+
+    void attribute(const std::string& key, const std::string& value);
+
+    const TraceContext& context() const { return context_; }
+
+private:
+
+    bool active_ = false;
+    std::string name_;
+    TraceContext context_;
+    std::string parentSpanId_;
+    TraceContext previous_;
+    Tracer::Clock::time_point start_;
+    Tracer::Attributes attributes_;
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace gribjump
@@ -14,8 +14,8 @@
 #include "Range.h"
 
 #include <eckit/io/Buffer.h>
+#include <algorithm>
 #include <memory>
-#include <unordered_map>
 #include <vector>
 
 namespace gribjump::mc {
@@ -54,34 +54,39 @@ public:
 
     virtual void decode(const std::shared_ptr<DataAccessor>& accessor, const std::vector<mc::Block>& ranges,
                         std::vector<Values>& result) {
-        using Values = typename NumericDecompressor<ValueType>::Values;
+        decode_ranges(accessor, ranges, [&result](size_t, const ValueType* data, size_t size) {
+            result.push_back(Values(data, data + size));
+        });
+    }
 
-        std::unordered_map<Block, std::pair<Block, std::shared_ptr<Values>>> ranges_map;
+    /// Decode the ranges into a single contiguous array, one range after another. out must have room for the sum of
+    /// the range sizes.
+    virtual void decode(const std::shared_ptr<DataAccessor>& accessor, const std::vector<mc::Block>& ranges,
+                        ValueType* out) {
+        decode_ranges(accessor, ranges, [&out](size_t, const ValueType* data, size_t size) {
+            out = std::copy(data, data + size, out);
+        });
+    }
 
-        // find which sub_ranges are in which buckets
-        BlockBuckets buckets;
-        for (const auto& range : ranges) {
-            buckets << range;
-        }
+private:
 
-        // inverse buckets and associate data with ranges
-        for (const auto& [bucket_range, bucket_sub_ranges] : buckets) {
-            auto decoded = std::make_shared<Values>(decode(accessor, bucket_range));
-            for (const auto& bucket_sub_range : bucket_sub_ranges) {
-                ranges_map[bucket_sub_range] = std::make_pair(bucket_range, decoded);
-            }
-        }
+    /// Decode each block of overlapping or adjacent ranges once, and pass each range's values to sink(index, data,
+    /// size), in order.
+    template <typename Sink>
+    void decode_ranges(const std::shared_ptr<DataAccessor>& accessor, const std::vector<mc::Block>& ranges,
+                       Sink&& sink) {
+        const Coalesced coalesced = coalesce(ranges);
 
-        // assign data to ranges
-        for (const auto& user_range : ranges) {
-            const auto& [bucket_range, decoded]                  = ranges_map[user_range];
-            const auto& [bucket_range_offset, bucket_range_size] = bucket_range;
-            const auto& [user_range_offset, user_range_size]     = user_range;
+        std::vector<Values> decoded;
+        decoded.reserve(coalesced.blocks.size());
+        for (const auto& block : coalesced.blocks) {
+            decoded.push_back(decode(accessor, block));
+        }
 
-            ValueType* data_start =
-                reinterpret_cast<ValueType*>(decoded->data()) + (user_range_offset - bucket_range_offset);
-            Values values(data_start, data_start + user_range_size);
-            result.push_back(std::move(values));
+        for (size_t i = 0; i < ranges.size(); i++) {
+            const size_t b                   = coalesced.block[i];
+            const auto& [range_offset, size] = ranges[i];
+            sink(i, decoded[b].data() + (range_offset - coalesced.blocks[b].first), size);
         }
     }
 };
@@ -0,0 +1,123 @@
+/*
+ * (C) Copyright 2023- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+/// @author Caragh Bradley
+
+#include "gribjump/compression/OffsetTable.h"
+
+#include <algorithm>
+#include <limits>
+
+#include "eckit/exception/Exceptions.h"
+#include "eckit/serialisation/Stream.h"
+
+namespace gribjump::mc {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+OffsetTable::OffsetTable(const Offsets& offsets) : size_(offsets.size()) {
+    if (offsets.empty()) {
+        return;
+    }
+
+    step_ = size_ > 1 ? std::numeric_limits<uint64_t>::max() : 0;
+    for (size_t i = 1; i < size_; ++i) {
+        ASSERT(offsets[i] >= offsets[i - 1]);
+        step_ = std::min<uint64_t>(step_, offsets[i] - offsets[i - 1]);
+    }
+
+    std::vector<uint64_t> values(size_);
+    uint64_t largest = 0;
+    anchors_.reserve((size_ + blockSize_ - 1) / blockSize_);
+    for (size_t i = 0; i < size_; ++i) {
+        if (i % blockSize_ == 0) {
+            anchors_.push_back(offsets[i]);
+        }
+        values[i] = offsets[i] - anchors_.back() - (i % blockSize_) * step_;
+        largest   = std::max(largest, values[i]);
+    }
+    while (width_ < 64 && (largest >> width_) != 0) {
+        ++width_;
+    }
+    if (width_ == 0) {
+        return;
+    }
+
+    packed_.assign((size_ * width_ + 63) / 64, 0);
+    for (size_t i = 0; i < size_; ++i) {
+        const size_t bit   = i * width_;
+        const size_t shift = bit % 64;
+        packed_[bit / 64] |= values[i] << shift;
+        if (shift + width_ > 64) {
+            packed_[bit / 64 + 1] |= values[i] >> (64 - shift);
+        }
+    }
+}
+
+OffsetTable::OffsetTable(eckit::Stream& s) {
+    s >> size_;
+    s >> step_;
+    s >> width_;
+    s >> anchors_;
+    s >> packed_;
+
+    if (width_ > 64 || anchors_.size() != (size_ + blockSize_ - 1) / blockSize_ ||
+        packed_.size() != (size_ * width_ + 63) / 64) {
+        throw eckit::SeriousBug("Corrupt offset table", Here());
+    }
+}
+
+void OffsetTable::encode(eckit::Stream& s) const {
+    s << size_;
+    s << step_;
+    s << width_;
+    s << anchors_;
+    s << packed_;
+}
+
+size_t OffsetTable::operator[](size_t i) const {
+    ASSERT(i < size_);
+
+    uint64_t value = 0;
+    if (width_ > 0) {
+        const size_t bit   = i * width_;
+        const size_t shift = bit % 64;
+        value              = packed_[bit / 64] >> shift;
+        if (shift + width_ > 64) {
+            value |= packed_[bit / 64 + 1] << (64 - shift);
+        }
+        if (width_ < 64) {
+            value &= (uint64_t(1) << width_) - 1;
+        }
+    }
+    return anchors_[i / blockSize_] + (i % blockSize_) * step_ + value;
+}
+
+OffsetTable::Offsets OffsetTable::offsets() const {
+    Offsets offsets;
+    offsets.reserve(size_);
+    for (size_t i = 0; i < size_; ++i) {
+        offsets.push_back((*this)[i]);
+    }
+    return offsets;
+}
+
+size_t OffsetTable::footprint() const {
+    return sizeof(*this) + (anchors_.capacity() + packed_.capacity()) * sizeof(uint64_t);
+}
+
+bool OffsetTable::operator==(const OffsetTable& other) const {
+    return size_ == other.size_ && step_ == other.step_ && width_ == other.width_ && anchors_ == other.anchors_ &&
+           packed_ == other.packed_;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace gribjump::mc
@@ -0,0 +1,71 @@
+/*
+ * (C) Copyright 2023- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+/// @author Caragh Bradley
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace eckit {
+class Stream;
+}
+
+namespace gribjump::mc {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/// Compact table of increasing offsets, such as the bit offsets of the RSIs of a CCSDS field, with O(1) random access.
+///
+/// Offsets are grouped in blocks of 64. Each block keeps its first offset (its anchor) in full, and each offset of the
+/// block is stored as offset - anchor - k * step, k being its position in the block and step the smallest difference
+/// between consecutive offsets, bit-packed in the fewest bits that hold the largest. The RSIs of a field compress to
+/// similar sizes, so that is typically 2 to 3 bytes per offset rather than 8.
+class OffsetTable {
+public:
+
+    using Offsets = std::vector<size_t>;
+
+    OffsetTable() = default;
+    explicit OffsetTable(const Offsets& offsets);
+    explicit OffsetTable(eckit::Stream& s);
+
+    void encode(eckit::Stream& s) const;
+
+    size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+
+    size_t operator[](size_t i) const;
+
+    /// All the offsets
+    Offsets offsets() const;
+
+    /// Memory used, in bytes
+    size_t footprint() const;
+
+    bool operator==(const OffsetTable& other) const;
+    bool operator!=(const OffsetTable& other) const { return !(*this == other); }
+
+private:
+
+    static constexpr size_t blockSize_ = 64;
+
+    size_t size_   = 0;
+    uint64_t step_ = 0;
+    uint8_t width_ = 0;  //< bits per packed value
+    std::vector<uint64_t> anchors_;
+    std::vector<uint64_t> packed_;
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace gribjump::mc
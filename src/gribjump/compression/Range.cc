@@ -11,6 +11,7 @@
 #include "Range.h"
 #include <algorithm>
 #include <cassert>
+#include <numeric>
 
 namespace gribjump::mc {
 
@@ -20,6 +21,30 @@ std::pair<size_t, size_t> begin_end(const Block& range) {
 }
 
 
+Coalesced coalesce(const std::vector<Block>& ranges) {
+    std::vector<size_t> order(ranges.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [&ranges](size_t a, size_t b) { return ranges[a].first < ranges[b].first; });
+
+    Coalesced coalesced;
+    coalesced.block.resize(ranges.size());
+    size_t end = 0;
+    for (size_t i : order) {
+        const auto [begin, range_end] = begin_end(ranges[i]);
+        if (coalesced.blocks.empty() || begin > end) {
+            coalesced.blocks.push_back(ranges[i]);
+            end = range_end;
+        }
+        else if (range_end > end) {
+            end                            = range_end;
+            coalesced.blocks.back().second = end - coalesced.blocks.back().first;
+        }
+        coalesced.block[i] = coalesced.blocks.size() - 1;
+    }
+    return coalesced;
+}
+
+
 Block operator+(const Block& r1, const Block& r2) {
     auto [b1, e1] = begin_end(r1);
     auto [b2, e2] = begin_end(r2);
@@ -43,4 +43,13 @@ Block operator+(const Block& r1, const Block& r2);
 
 std::pair<size_t, size_t> begin_end(const Block& range);
 
+/// Ranges merged into blocks that can each be decoded in one go, so that values requested by several overlapping or
+/// adjacent ranges are decoded once. Ranges may be in any order.
+struct Coalesced {
+    std::vector<Block> blocks;  // sorted, disjoint and not adjacent
+    std::vector<size_t> block;  // for each range, the index of the block containing it
+};
+
+Coalesced coalesce(const std::vector<Block>& ranges);
+
 }  // namespace gribjump::mc
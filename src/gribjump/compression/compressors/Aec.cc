@@ -88,6 +88,7 @@ typename NumericCompressor<ValueType>::Values AecDecompressor<ValueType>::decode
     AEC_CALL(aec_decode_end(&strm));
 
     offsets_ = std::move(offsets);
+    table_   = nullptr;
     return decoded;
 }
 
@@ -96,47 +97,87 @@ template <typename ValueType>
 typename NumericCompressor<ValueType>::Values AecDecompressor<ValueType>::decode(
     const std::shared_ptr<DataAccessor> accessor, const Block& range) {
 
-    validateBitsPerSample();
+    Values decoded(range.second);
+    decode(accessor, std::vector<Block>{range}, decoded.data());
+    return decoded;
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+template <typename ValueType>
+void AecDecompressor<ValueType>::decode(const std::shared_ptr<DataAccessor>& accessor, const std::vector<Block>& ranges,
+                                        ValueType* out) {
 
-    ASSERT(!offsets_.empty());
+    validateBitsPerSample();
 
-    auto [range_offset, range_size] = range;
-    auto range_offset_bytes         = range_offset * sizeof(ValueType);
-    auto range_size_bytes           = range_size * sizeof(ValueType);
+    ASSERT(rsi_count() > 0);
 
-    Values decoded(range_size);
+    const size_t rsi_samples = rsi_ * block_size_;
 
-    size_t nbytes = (bits_per_sample_ + 7) / 8;
-    if (nbytes == 3) {
-        nbytes = 4;
+    std::vector<size_t> positions;  // of each range in out
+    std::vector<size_t> order;      // of the non-empty ranges, by offset
+    positions.reserve(ranges.size());
+    size_t position = 0;
+    for (size_t i = 0; i < ranges.size(); ++i) {
+        positions.push_back(position);
+        position += ranges[i].second;
+        if (ranges[i].second > 0) {
+            order.push_back(i);
+        }
     }
-    size_t rsi_size_bytes = rsi_ * block_size_ * nbytes;
-
-    auto start_idx = range_offset_bytes / rsi_size_bytes;
-    auto end_idx   = (range_offset_bytes + range_size_bytes) / rsi_size_bytes + 1;
+    std::sort(order.begin(), order.end(), [&ranges](size_t a, size_t b) { return ranges[a].first < ranges[b].first; });
+
+    // Values of runs of several ranges, reused from one run (and field) to the next
+    thread_local std::vector<ValueType> buffer;
+
+    size_t first = 0;
+    while (first < order.size()) {
+
+        // A run is the ranges in the same or consecutive RSIs: decoding them together decodes each RSI once
+        const size_t begin = ranges[order[first]].first;
+        size_t end         = begin + ranges[order[first]].second;
+        size_t last        = first + 1;
+        while (last < order.size() && ranges[order[last]].first / rsi_samples <= (end - 1) / rsi_samples + 1) {
+            end = std::max(end, ranges[order[last]].first + ranges[order[last]].second);
+            ++last;
+        }
+
+        // A run of one range is decoded straight into out
+        if (last == first + 1) {
+            decode_run(*accessor, begin, end, out + positions[order[first]]);
+        }
+        else {
+            buffer.resize(end - begin);
+            decode_run(*accessor, begin, end, buffer.data());
+            for (size_t k = first; k < last; ++k) {
+                const auto [offset, size] = ranges[order[k]];
+                std::copy_n(buffer.data() + (offset - begin), size, out + positions[order[k]]);
+            }
+        }
+        first = last;
+    }
+}
 
-    ASSERT(start_idx < end_idx);
-    ASSERT(end_idx <= offsets_.size());
+// ---------------------------------------------------------------------------------------------------------------------
+template <typename ValueType>
+void AecDecompressor<ValueType>::decode_run(const DataAccessor& accessor, size_t begin, size_t end, ValueType* out) {
 
-    size_t start_offset_bits  = offsets_[start_idx];
-    size_t start_offset_bytes = start_offset_bits / 8;
-    // size_t end_offset_bits = end_idx == offsets_.size() ? accessor->eof() * 8 : offsets_[end_idx];
-    size_t end_offset_bytes = end_idx == offsets_.size() ? accessor->eof() : (offsets_[end_idx] + 7) / 8;
+    const size_t rsi_samples = rsi_ * block_size_;
+    const size_t start_idx   = begin / rsi_samples;
+    const size_t end_idx     = std::min(end / rsi_samples + 1, rsi_count());
 
-    // The new offset to the RSI may not be aligned to the start of the range, so we need to shift the offsets by the
-    // difference
-    /// @todo It seems unlikely that two copies are required here.
-    std::vector<size_t> new_offsets_tmp;
-    std::vector<size_t> new_offsets;
-    std::copy(offsets_.begin() + start_idx, offsets_.end(), std::back_inserter(new_offsets_tmp));
-    size_t shift = start_offset_bits >> 3 << 3;  // align to byte boundary
-    std::transform(new_offsets_tmp.begin(), new_offsets_tmp.end(), std::back_inserter(new_offsets),
-                   [shift](size_t offset) { return offset - shift; });
+    ASSERT(start_idx < end_idx);
 
-    ASSERT(!new_offsets.empty());
+    // Read the RSIs of the run
+    const size_t start_offset_bytes = rsi_offset(start_idx) / 8;
+    const size_t end_offset_bytes   = end_idx == rsi_count() ? accessor.eof() : (rsi_offset(end_idx) + 7) / 8;
+    CompressedData encoded          = accessor.read({start_offset_bytes, end_offset_bytes - start_offset_bytes});
 
-    // Read RSIs
-    CompressedData encoded = accessor->read({start_offset_bytes, end_offset_bytes - start_offset_bytes});
+    // Offsets of the RSIs read, from the first byte read: only the window of the run is passed to libaec
+    thread_local std::vector<size_t> offsets;
+    offsets.clear();
+    for (size_t i = start_idx; i < end_idx; ++i) {
+        offsets.push_back(rsi_offset(i) - start_offset_bytes * 8);
+    }
 
     struct aec_stream strm;
     strm.rsi             = rsi_;
@@ -145,17 +186,15 @@ typename NumericCompressor<ValueType>::Values AecDecompressor<ValueType>::decode
     strm.flags           = flags_;
     strm.avail_in        = encoded.size();
     strm.next_in         = reinterpret_cast<const unsigned char*>(encoded.data());
-    strm.avail_out       = decoded.size() * sizeof(ValueType);
-    strm.next_out        = reinterpret_cast<unsigned char*>(decoded.data());
+    strm.avail_out       = (end - begin) * sizeof(ValueType);
+    strm.next_out        = reinterpret_cast<unsigned char*>(out);
 
-    size_t new_offset_bytes = range_offset_bytes - rsi_size_bytes * start_idx;
-    size_t new_size_bytes   = range_size_bytes;
+    const size_t offset_bytes = (begin - start_idx * rsi_samples) * sizeof(ValueType);
+    const size_t size_bytes   = (end - begin) * sizeof(ValueType);
 
     AEC_CALL(aec_decode_init(&strm));
-    AEC_CALL(aec_decode_range(&strm, new_offsets.data(), new_offsets.size(), new_offset_bytes, new_size_bytes));
+    AEC_CALL(aec_decode_range(&strm, offsets.data(), offsets.size(), offset_bytes, size_bytes));
     AEC_CALL(aec_decode_end(&strm));
-
-    return decoded;
 }
 
 // ---------------------------------------------------------------------------------------------------------------------
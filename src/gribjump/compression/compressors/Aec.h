@@ -13,6 +13,7 @@
 
 #include <optional>
 #include "gribjump/compression/NumericCompressor.h"
+#include "gribjump/compression/OffsetTable.h"
 namespace gribjump::mc {
 
 class AecParams {
@@ -28,6 +29,12 @@ public:
     std::optional<Offsets> offsets() const {
         return offsets_.size() > 0 ? std::optional<Offsets>(offsets_) : std::nullopt;
     }
+    /// The offsets found by decode(), moved out of the decoder. Empty if there are none.
+    Offsets release_offsets() {
+        Offsets offsets = std::move(offsets_);
+        offsets_.clear();
+        return offsets;
+    }
 
     AecParams& flags(size_t flags) {
         flags_ = flags;
@@ -48,16 +55,28 @@ public:
     AecParams& offsets(const Offsets& offsets) {
         assert(offsets.size() > 0);
         offsets_ = offsets;
+        table_   = nullptr;
+        return *this;
+    }
+    /// Offsets of the RSIs from a compact table, to decode ranges. The table is not copied: it must outlive the
+    /// decoder.
+    AecParams& offsets(const OffsetTable& table) {
+        assert(!table.empty());
+        table_ = &table;
         return *this;
     }
 
 protected:
 
+    size_t rsi_count() const { return table_ ? table_->size() : offsets_.size(); }
+    size_t rsi_offset(size_t i) const { return table_ ? (*table_)[i] : offsets_[i]; }
+
     size_t flags_;
     size_t rsi_;
     size_t block_size_;
     size_t bits_per_sample_;
     std::vector<size_t> offsets_;
+    const OffsetTable* table_ = nullptr;
 };
 
 template <typename ValueType>
@@ -78,6 +97,11 @@ public:  // methods
 
     Values decode(const std::shared_ptr<DataAccessor> accessor, const Block& range) override;
 
+    /// Decode the ranges into out, one range after another. Ranges in the same or consecutive RSIs are decoded in one
+    /// go, so that each RSI is decoded at most once, however many ranges it holds.
+    void decode(const std::shared_ptr<DataAccessor>& accessor, const std::vector<Block>& ranges,
+                ValueType* out) override;
+
     Offsets decode_offsets(const CompressedData& encoded) override;
 
     size_t n_elems() const { return n_elems_; }
@@ -90,6 +114,9 @@ private:  // methods
 
     void validateBitsPerSample();
 
+    /// Decode the values [begin, end) into out
+    void decode_run(const DataAccessor& accessor, size_t begin, size_t end, ValueType* out);
+
 private:  // members
 
     size_t n_elems_;
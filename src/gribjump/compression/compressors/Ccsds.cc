@@ -98,27 +98,33 @@ typename CcsdsDecompressor<ValueType>::Values CcsdsDecompressor<ValueType>::deco
         return Values{};
     }
 
+    Values values(range.second);
+    decode(accessor, std::vector<Block>{range}, values.data());
+    return values;
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+template <typename ValueType>
+void CcsdsDecompressor<ValueType>::decode(const std::shared_ptr<DataAccessor>& accessor,
+                                          const std::vector<Block>& ranges, ValueType* out) {
     auto bscale = codes_power<double>(binary_scale_factor_, 2);
     auto dscale = codes_power<double>(decimal_scale_factor_, -10);
-    Values values;
 
     switch (auto nbytes = sample_nbytes()) {
         case 1:
-            values = decode_range_<uint8_t>(accessor, range, bscale, dscale);
+            decode_ranges_<uint8_t>(accessor, ranges, out, bscale, dscale);
             break;
         case 2:
-            values = decode_range_<uint16_t>(accessor, range, bscale, dscale);
+            decode_ranges_<uint16_t>(accessor, ranges, out, bscale, dscale);
             break;
         case 4:
-            values = decode_range_<uint32_t>(accessor, range, bscale, dscale);
+            decode_ranges_<uint32_t>(accessor, ranges, out, bscale, dscale);
             break;
         default:
             std::stringstream ss;
             ss << nbytes;
             throw eckit::SeriousBug("Invalid number of bytes per sample: " + ss.str(), Here());
     }
-
-    return values;
 }
 
 // ---------------------------------------------------------------------------------------------------------------------
@@ -133,23 +139,30 @@ size_t CcsdsDecompressor<ValueType>::sample_nbytes() const {
 // ---------------------------------------------------------------------------------------------------------------------
 template <typename ValueType>
 template <typename SimpleValueType>
-typename CcsdsDecompressor<ValueType>::Values CcsdsDecompressor<ValueType>::decode_range_(
-    const std::shared_ptr<DataAccessor> accessor, const Block& simple_range, double bscale, double dscale) {
+void CcsdsDecompressor<ValueType>::decode_ranges_(const std::shared_ptr<DataAccessor>& accessor,
+                                                  const std::vector<Block>& ranges, ValueType* out, double bscale,
+                                                  double dscale) {
     AecDecompressor<SimpleValueType> aec{};
     auto flags = modify_aec_flags(flags_);
     aec.flags(flags);
     aec.bits_per_sample(bits_per_sample_);
     aec.block_size(block_size_);
     aec.rsi(rsi_);
-    aec.offsets(offsets_);
+    ASSERT(table_);
+    aec.offsets(*table_);
 
-    typename AecDecompressor<SimpleValueType>::Values simple_values = aec.decode(accessor, simple_range);
+    size_t nvalues = 0;
+    for (const auto& range : ranges) {
+        nvalues += range.second;
+    }
 
-    Values values(simple_values.size());
-    std::transform(simple_values.begin(), simple_values.end(), values.begin(),
-                   [&](const auto& simple_value) { return (simple_value * bscale + reference_value_) * dscale; });
+    // Decoded samples, reused from one field to the next
+    thread_local std::vector<SimpleValueType> samples;
+    samples.resize(nvalues);
+    aec.decode(accessor, ranges, samples.data());
 
-    return values;
+    std::transform(samples.begin(), samples.end(), out,
+                   [&](const auto& simple_value) { return (simple_value * bscale + reference_value_) * dscale; });
 }
 
 // ---------------------------------------------------------------------------------------------------------------------
@@ -183,8 +196,9 @@ typename CcsdsDecompressor<ValueType>::Values CcsdsDecompressor<ValueType>::deco
 
     typename AecDecompressor<SimpleValueType>::Values simple_values = aec.decode(in_buf);
 
-    if (aec.offsets()) {
-        offsets_ = aec.offsets().value();
+    Offsets rsiOffsets = aec.release_offsets();
+    if (!rsiOffsets.empty()) {
+        offsets(rsiOffsets);
     }
 
     Values values(simple_values.size());
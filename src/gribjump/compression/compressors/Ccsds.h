@@ -10,6 +10,7 @@
 
 #pragma once
 
+#include <memory>
 #include <optional>
 
 #include "gribjump/compression/NumericCompressor.h"
@@ -31,8 +32,22 @@ public:
     double reference_value() const { return reference_value_; }
     size_t decimal_scale_factor() const { return decimal_scale_factor_; }
     size_t binary_scale_factor() const { return binary_scale_factor_; }
-    std::optional<Offsets> offsets() const {
-        return offsets_.size() > 0 ? std::optional<Offsets>(offsets_) : std::nullopt;
+    /// Offsets of the RSIs, as given or as found by decode(), or null
+    const OffsetTable* offset_table() const { return table_; }
+
+    /// The table of the offsets found by decode(), moved out of the decoder rather than copied
+    OffsetTable release_offset_table() {
+        ASSERT(owned_ && table_ == owned_.get());
+        OffsetTable table;
+        if (owned_.use_count() == 1) {
+            table = std::move(*owned_);
+        }
+        else {
+            table = *owned_;  // shared with a copy of these parameters
+        }
+        owned_.reset();
+        table_ = nullptr;
+        return table;
     }
 
     CcsdsParams& flags(size_t flags) {
@@ -65,7 +80,15 @@ public:
     }
     CcsdsParams& offsets(const Offsets& offsets) {
         ASSERT(offsets.size() > 0);
-        offsets_ = offsets;
+        owned_ = std::make_shared<OffsetTable>(offsets);
+        table_ = owned_.get();
+        return *this;
+    }
+    /// Offsets of the RSIs from a table which is not copied, e.g. that of a CcsdsInfo: it must outlive the decoder
+    CcsdsParams& offsets(const OffsetTable& table) {
+        ASSERT(!table.empty());
+        owned_.reset();
+        table_ = &table;
         return *this;
     }
 
@@ -78,7 +101,8 @@ protected:
     double reference_value_;
     size_t decimal_scale_factor_;
     size_t binary_scale_factor_;
-    std::vector<size_t> offsets_;
+    const OffsetTable* table_ = nullptr;
+    std::shared_ptr<OffsetTable> owned_;  //< table_, when built from offsets given in full
 };
 
 template <typename ValueType>
@@ -99,6 +123,10 @@ public:  // methods
     /// Decode a range of values
     Values decode(const std::shared_ptr<DataAccessor> accessor, const Block& range) override;
 
+    /// Decode the ranges into out, one range after another, decoding each RSI they touch once
+    void decode(const std::shared_ptr<DataAccessor>& accessor, const std::vector<Block>& ranges,
+                ValueType* out) override;
+
     /// Avoid fully decoding the data, only decode the offsets
     /// @note: libaec will still do its part of the decoding
     Offsets decode_offsets(const eckit::Buffer& in_buf) override;
@@ -116,8 +144,8 @@ private:  // methods
     // Wrappers around aec.decode
 
     template <typename SimpleValueType>
-    Values decode_range_(const std::shared_ptr<DataAccessor> accessor, const Block& simple_range, double bscale,
-                         double dscale);
+    void decode_ranges_(const std::shared_ptr<DataAccessor>& accessor, const std::vector<Block>& ranges,
+                        ValueType* out, double bscale, double dscale);
 
     template <typename SimpleValueType>
     Offsets decode_offsets_(const typename AecDecompressor<SimpleValueType>::CompressedData& in_buf);
@@ -11,6 +11,7 @@
 /// @author Caragh Bradley
 
 #include "gribjump/gribjump_c.h"
+#include <algorithm>
 #include <functional>
 #include <sstream>
 #include "eckit/runtime/Main.h"
@@ -102,6 +103,21 @@ struct gribjump_extractioniterator_t : public ExtractionIterator {
     gribjump_extractioniterator_t(ExtractionIterator&& it) : ExtractionIterator(std::move(it)) {}
 };
 
+struct gribjump_timeseries_t : public TimeSeriesResult {
+    explicit gribjump_timeseries_t(TimeSeriesResult&& result) : TimeSeriesResult(std::move(result)) {}
+};
+
+struct gribjump_grid_selection_t : public GridSelection {
+    explicit gribjump_grid_selection_t(GridSelection&& selection) : GridSelection(std::move(selection)) {
+        for (const auto& range : ranges()) {
+            flatRanges.push_back(range.first);
+            flatRanges.push_back(range.second);
+        }
+    }
+
+    std::vector<size_t> flatRanges;
+};
+
 struct gribjump_axes_t {
 public:
 
@@ -159,6 +175,13 @@ gribjump_error_t gribjump_delete_handle(gribjump_handle_t* handle) {
     return tryCatch([=] { delete handle; });
 }
 
+gribjump_error_t gribjump_cancel(gribjump_handle_t* handle) {
+    return tryCatch([=] {
+        ASSERT(handle);
+        handle->cancel();
+    });
+}
+
 gribjump_error_t gribjump_new_request(gribjump_extraction_request_t** request, const char* reqstr,
                                       const size_t* range_arr, size_t range_arr_size, const char* gridhash) {
     return tryCatch([=] {
@@ -227,14 +250,9 @@ gribjump_error_t gribjump_result_values(gribjump_extraction_result_t* result, do
     return tryCatch([=] {
         ASSERT(result);
         ASSERT(values);
-        size_t count = 0;
         ASSERT(result->total_values() == nvalues);
-        for (auto& vals : result->values()) {
-            for (size_t j = 0; j < vals.size(); j++) {
-                (*values)[count++] = vals[j];
-            }
-        }
-        ASSERT(count == nvalues);
+        Span<const double> all = result->allValues();
+        std::copy(all.begin(), all.end(), *values);
     });
 }
 
@@ -244,13 +262,9 @@ gribjump_error_t gribjump_result_mask(gribjump_extraction_result_t* result, unsi
     return tryCatch([=] {
         ASSERT(result);
         ASSERT(masks);
-        size_t count = 0;
-        for (auto& msk : result->mask()) {
-            for (size_t j = 0; j < msk.size(); j++) {
-                (*masks)[count++] = msk[j].to_ullong();
-            }
-        }
-        ASSERT(count == nmasks);
+        ASSERT(result->total_mask_words() == nmasks);
+        Span<const uint64_t> all = result->allMasks();
+        std::copy(all.begin(), all.end(), *masks);
     });
 }
 
@@ -261,6 +275,42 @@ gribjump_error_t gribjump_delete_result(gribjump_extraction_result_t* result) {
     });
 }
 
+gribjump_error_t gribjump_result_values_view(gribjump_extraction_result_t* result, const double** values,
+                                             size_t* nvalues) {
+    return tryCatch([=] {
+        ASSERT(result);
+        ASSERT(values);
+        ASSERT(nvalues);
+        Span<const double> all = result->allValues();
+        *values                = all.data();
+        *nvalues               = all.size();
+    });
+}
+
+gribjump_error_t gribjump_result_mask_view(gribjump_extraction_result_t* result, const unsigned long long** masks,
+                                           size_t* nmasks) {
+    static_assert(sizeof(unsigned long long) == sizeof(uint64_t));
+    return tryCatch([=] {
+        ASSERT(result);
+        ASSERT(masks);
+        ASSERT(nmasks);
+        Span<const uint64_t> all = result->allMasks();
+        *masks                   = reinterpret_cast<const unsigned long long*>(all.data());
+        *nmasks                  = all.size();
+    });
+}
+
+gribjump_error_t gribjump_result_offsets_view(gribjump_extraction_result_t* result, const size_t** offsets,
+                                              size_t* nranges) {
+    return tryCatch([=] {
+        ASSERT(result);
+        ASSERT(offsets);
+        ASSERT(nranges);
+        *offsets = result->offsets().data();
+        *nranges = result->nrange();
+    });
+}
+
 gribjump_error_t gribjump_extract(gribjump_handle_t* handle, gribjump_extraction_request_t** requests,
                                   unsigned long nrequests, const char* ctx, gribjump_extractioniterator_t** iterator) {
     return tryCatch([=] {
@@ -320,6 +370,145 @@ gribjump_error_t gribjump_extract_single(gribjump_handle_t* handle, const char*
     });
 }
 
+// --------------------------------------------------------------------------------------------
+// gribjump_timeseries_t
+// --------------------------------------------------------------------------------------------
+
+gribjump_error_t gribjump_extract_timeseries(gribjump_handle_t* handle, const char* request, const size_t* range_arr,
+                                             size_t range_arr_size, const char* gridhash, const char* ctx,
+                                             gribjump_timeseries_t** timeseries) {
+    return tryCatch([=] {
+        ASSERT(handle);
+        ASSERT(request);
+        ASSERT(range_arr);
+        ASSERT(range_arr_size % 2 == 0);
+        ASSERT(timeseries);
+
+        std::vector<Range> ranges;
+        for (size_t i = 0; i < range_arr_size; i += 2) {
+            ranges.push_back(std::make_pair(range_arr[i], range_arr[i + 1]));
+        }
+
+        LogContext logctx;
+        if (ctx)
+            logctx = LogContext(ctx);
+
+        std::string gridhash_str = gridhash ? std::string(gridhash) : "";
+
+        metkit::mars::MarsRequest req = parseMarsRequest(request);
+        *timeseries = new gribjump_timeseries_t(handle->extractTimeSeries(req, ranges, gridhash_str, logctx));
+    });
+}
+
+gribjump_error_t gribjump_timeseries_shape(gribjump_timeseries_t* timeseries, size_t* ntimes, size_t* npoints) {
+    return tryCatch([=] {
+        ASSERT(timeseries);
+        ASSERT(ntimes);
+        ASSERT(npoints);
+        *ntimes  = timeseries->ntimes();
+        *npoints = timeseries->npoints();
+    });
+}
+
+gribjump_error_t gribjump_timeseries_values_view(gribjump_timeseries_t* timeseries, const double** values) {
+    return tryCatch([=] {
+        ASSERT(timeseries);
+        ASSERT(values);
+        *values = timeseries->values().data();
+    });
+}
+
+gribjump_error_t gribjump_timeseries_request(gribjump_timeseries_t* timeseries, size_t i, const char** request) {
+    return tryCatch([=] {
+        ASSERT(timeseries);
+        ASSERT(request);
+        ASSERT(i < timeseries->ntimes());
+        *request = timeseries->requests()[i].c_str();
+    });
+}
+
+gribjump_error_t gribjump_delete_timeseries(gribjump_timeseries_t* timeseries) {
+    return tryCatch([=] {
+        ASSERT(timeseries);
+        delete timeseries;
+    });
+}
+
+// --------------------------------------------------------------------------------------------
+// gribjump_grid_selection_t
+// --------------------------------------------------------------------------------------------
+
+gribjump_error_t gribjump_nearest_points(gribjump_handle_t* handle, const char* gridhash, const double* lats,
+                                         const double* lons, size_t npoints, const char* ctx,
+                                         gribjump_grid_selection_t** selection) {
+    return tryCatch([=] {
+        ASSERT(handle);
+        ASSERT(gridhash);
+        ASSERT(lats);
+        ASSERT(lons);
+        ASSERT(selection);
+
+        std::vector<LatLon> points;
+        points.reserve(npoints);
+        for (size_t i = 0; i < npoints; i++) {
+            points.push_back({lats[i], lons[i]});
+        }
+
+        LogContext logctx;
+        if (ctx)
+            logctx = LogContext(ctx);
+
+        *selection = new gribjump_grid_selection_t(handle->nearestPoints(gridhash, points, logctx));
+    });
+}
+
+gribjump_error_t gribjump_bounding_box(gribjump_handle_t* handle, const char* gridhash, double north, double west,
+                                       double south, double east, const char* ctx,
+                                       gribjump_grid_selection_t** selection) {
+    return tryCatch([=] {
+        ASSERT(handle);
+        ASSERT(gridhash);
+        ASSERT(selection);
+
+        LogContext logctx;
+        if (ctx)
+            logctx = LogContext(ctx);
+
+        *selection = new gribjump_grid_selection_t(handle->boundingBox(gridhash, north, west, south, east, logctx));
+    });
+}
+
+gribjump_error_t gribjump_grid_selection_ranges(gribjump_grid_selection_t* selection, const size_t** range_arr,
+                                                size_t* nranges) {
+    return tryCatch([=] {
+        ASSERT(selection);
+        ASSERT(range_arr);
+        ASSERT(nranges);
+        *range_arr = selection->flatRanges.data();
+        *nranges   = selection->ranges().size();
+    });
+}
+
+gribjump_error_t gribjump_grid_selection_points(gribjump_grid_selection_t* selection, const size_t** indices,
+                                                const size_t** positions, size_t* npoints) {
+    return tryCatch([=] {
+        ASSERT(selection);
+        ASSERT(indices);
+        ASSERT(positions);
+        ASSERT(npoints);
+        *indices   = selection->indices().data();
+        *positions = selection->positions().data();
+        *npoints   = selection->indices().size();
+    });
+}
+
+gribjump_error_t gribjump_delete_grid_selection(gribjump_grid_selection_t* selection) {
+    return tryCatch([=] {
+        ASSERT(selection);
+        delete selection;
+    });
+}
+
 // --------------------------------------------------------------------------------------------
 // gribjump_axes_t
 // --------------------------------------------------------------------------------------------
@@ -402,6 +591,44 @@ gribjump_iterator_status_t gribjump_extractioniterator_next(gribjump_extractioni
     }
 }
 
+gribjump_error_t gribjump_extractioniterator_fill(gribjump_extractioniterator_t* it, double* values, size_t nrows,
+                                                  size_t ncols, size_t* nfilled) {
+    return tryCatch([=] {
+        ASSERT(it);
+        ASSERT(values || nrows == 0);
+        ASSERT(nfilled);
+        // Check the shape of every result before writing any, so that values is untouched on error. The iterator is
+        // drained in any case, so that it is left in the same state on error as on success.
+        std::vector<std::unique_ptr<ExtractionResult>> results;
+        std::string error;
+        size_t count = 0;
+        while (std::unique_ptr<ExtractionResult> res = it->next()) {
+            if (error.empty() && count == nrows) {
+                error = "More results than the " + std::to_string(nrows) + " rows provided";
+            }
+            if (error.empty() && res->total_values() != ncols) {
+                error = "Result " + std::to_string(count) + " has " + std::to_string(res->total_values()) +
+                        " values, expected " + std::to_string(ncols);
+            }
+            if (error.empty()) {
+                results.push_back(std::move(res));
+            }
+            else {
+                results.clear();  // not needed any more
+            }
+            ++count;
+        }
+        if (!error.empty()) {
+            throw eckit::UserError(error, Here());
+        }
+        for (size_t row = 0; row < results.size(); ++row) {
+            Span<const double> all = results[row]->allValues();
+            std::copy(all.begin(), all.end(), values + row * ncols);
+        }
+        *nfilled = results.size();
+    });
+}
+
 /*
  * Initialise API
  * @note This is only required if being used from a context where Main()
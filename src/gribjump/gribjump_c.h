@@ -47,9 +47,18 @@ typedef struct gribjump_extractioniterator_t gribjump_extractioniterator_t;
 struct gribjump_axes_t;
 typedef struct gribjump_axes_t gribjump_axes_t;
 
+struct gribjump_timeseries_t;
+typedef struct gribjump_timeseries_t gribjump_timeseries_t;
+
+struct gribjump_grid_selection_t;
+typedef struct gribjump_grid_selection_t gribjump_grid_selection_t;
+
 gribjump_error_t gribjump_new_handle(gribjump_handle_t** gj);
 gribjump_error_t gribjump_delete_handle(gribjump_handle_t* gj);
 
+// Cancel all calls in progress on the handle, e.g. from another thread. The cancelled calls return GRIBJUMP_ERROR.
+gribjump_error_t gribjump_cancel(gribjump_handle_t* gj);
+
 gribjump_error_t gribjump_extract(gribjump_handle_t* handle, gribjump_extraction_request_t** requests,
                                   unsigned long nrequests, const char* ctx, gribjump_extractioniterator_t** iterator);
 
@@ -61,6 +70,48 @@ gribjump_error_t gribjump_extract_single(gribjump_handle_t* handle, const char*
                                          size_t range_arr_size, const char* gridhash, const char* ctx,
                                          gribjump_extractioniterator_t** iterator);
 
+// Extract the same ranges from every field of a multi-valued request, e.g. step=0/to/240/by/6, into a dense
+// [ntimes x npoints] array. Ranges may be in any order and may overlap: each row holds the values of every range, in
+// the order given.
+gribjump_error_t gribjump_extract_timeseries(gribjump_handle_t* handle, const char* request, const size_t* range_arr,
+                                             size_t range_arr_size, const char* gridhash, const char* ctx,
+                                             gribjump_timeseries_t** timeseries);
+
+// ntimes receives the number of fields (rows), npoints the number of values per field (columns).
+gribjump_error_t gribjump_timeseries_shape(gribjump_timeseries_t* timeseries, size_t* ntimes, size_t* npoints);
+
+// Zero-copy access to the row-major values, valid until the time series is deleted. Missing values, and all the
+// values of fields which were not found, are NaN.
+gribjump_error_t gribjump_timeseries_values_view(gribjump_timeseries_t* timeseries, const double** values);
+
+// request receives the canonical request of row i, valid until the time series is deleted.
+gribjump_error_t gribjump_timeseries_request(gribjump_timeseries_t* timeseries, size_t i, const char** request);
+
+gribjump_error_t gribjump_delete_timeseries(gribjump_timeseries_t* timeseries);
+
+// Grid points by coordinates, in the index of the grid built when its fields were scanned (see gridIndex.directory).
+// The nearest grid point to each of npoints points:
+gribjump_error_t gribjump_nearest_points(gribjump_handle_t* handle, const char* gridhash, const double* lats,
+                                         const double* lons, size_t npoints, const char* ctx,
+                                         gribjump_grid_selection_t** selection);
+
+// The grid points inside a bounding box, edges included. west > east selects across the antimeridian.
+gribjump_error_t gribjump_bounding_box(gribjump_handle_t* handle, const char* gridhash, double north, double west,
+                                       double south, double east, const char* ctx,
+                                       gribjump_grid_selection_t** selection);
+
+// range_arr receives nranges (begin, end) pairs, sorted and disjoint, in the layout taken by gribjump_new_request.
+// Valid until the selection is deleted.
+gribjump_error_t gribjump_grid_selection_ranges(gribjump_grid_selection_t* selection, const size_t** range_arr,
+                                                size_t* nranges);
+
+// For gribjump_nearest_points, point i is grid point indices[i], whose value is at positions[i] in the values
+// extracted from the ranges, ranges concatenated. npoints is 0 for bounding boxes.
+gribjump_error_t gribjump_grid_selection_points(gribjump_grid_selection_t* selection, const size_t** indices,
+                                                const size_t** positions, size_t* npoints);
+
+gribjump_error_t gribjump_delete_grid_selection(gribjump_grid_selection_t* selection);
+
 gribjump_error_t gribjump_new_request(gribjump_extraction_request_t** request, const char* reqstr, const size_t* ranges,
                                       size_t n_ranges, const char* gridhash);
 
@@ -82,6 +133,19 @@ gribjump_error_t gribjump_result_mask(gribjump_extraction_result_t* result, unsi
 
 gribjump_error_t gribjump_delete_result(gribjump_extraction_result_t* result);
 
+// Zero-copy access to the storage of a result, valid until the result is deleted.
+// values receives all the values, range after range, and nvalues their number.
+gribjump_error_t gribjump_result_values_view(gribjump_extraction_result_t* result, const double** values,
+                                             size_t* nvalues);
+
+// masks receives all the mask words, range after range, and nmasks their number.
+gribjump_error_t gribjump_result_mask_view(gribjump_extraction_result_t* result, const unsigned long long** masks,
+                                           size_t* nmasks);
+
+// offsets receives nranges + 1 offsets into the values: range i is [offsets[i], offsets[i+1]).
+gribjump_error_t gribjump_result_offsets_view(gribjump_extraction_result_t* result, const size_t** offsets,
+                                              size_t* nranges);
+
 gribjump_error_t gribjump_new_axes(gribjump_handle_t* gj, const char* reqstr, int level, const char* ctx,
                                    gribjump_axes_t** axes);
 
@@ -99,6 +163,13 @@ gribjump_error_t gribjump_extractioniterator_delete(const gribjump_extractionite
 gribjump_iterator_status_t gribjump_extractioniterator_next(gribjump_extractioniterator_t* it,
                                                             gribjump_extraction_result_t** result);
 
+// Copy the values of the remaining results of the iterator into the rows of a preallocated, row-major
+// nrows x ncols array, one result per row, ranges concatenated. Every result must have exactly ncols values, and
+// missing values are NaN. nfilled receives the number of rows written; it is an error if there are more than nrows
+// results. Consumes the iterator, also on error, in which case nothing is written to values or nfilled.
+gribjump_error_t gribjump_extractioniterator_fill(gribjump_extractioniterator_t* it, double* values, size_t nrows,
+                                                  size_t ncols, size_t* nfilled);
+
 const char* gribjump_error_string();
 
 #ifdef __cplusplus
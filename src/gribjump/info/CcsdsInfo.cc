@@ -29,7 +29,6 @@ CcsdsInfo::CcsdsInfo(eckit::DataHandle& handle, const metkit::codes::CodesHandle
 
     // Special case: constant field (no data section)
     if (bitsPerValue_ == 0 || offsetAfterData_ == offsetBeforeData_) {
-        ccsdsOffsets_ = {};
         return;
     }
 
@@ -51,7 +50,7 @@ CcsdsInfo::CcsdsInfo(eckit::DataHandle& handle, const metkit::codes::CodesHandle
         .decimal_scale_factor(decimalScaleFactor_);
     ccsds.n_elems(numberOfValues_);
 
-    ccsdsOffsets_ = ccsds.decode_offsets(buffer);
+    ccsdsOffsets_ = mc::OffsetTable(ccsds.decode_offsets(buffer));
 }
 
 CcsdsInfo::CcsdsInfo(const eckit::message::Message& msg) : JumpInfo(msg) {
@@ -77,14 +76,23 @@ CcsdsInfo::CcsdsInfo(const eckit::message::Message& msg) : JumpInfo(msg) {
     ccsds.n_elems(numberOfValues_);
     ccsds.decode(buffer);
 
-    ccsdsOffsets_ = ccsds.offsets().value();
+    ccsdsOffsets_ = ccsds.release_offset_table();
 }
 
 CcsdsInfo::CcsdsInfo(eckit::Stream& s) : JumpInfo(s) {
     s >> ccsdsFlags_;
     s >> ccsdsBlockSize_;
     s >> ccsdsRsi_;
-    s >> ccsdsOffsets_;
+
+    // Before version 2, offsets were stored in full
+    if (version_ < 2) {
+        std::vector<size_t> offsets;
+        s >> offsets;
+        ccsdsOffsets_ = mc::OffsetTable(offsets);
+    }
+    else {
+        ccsdsOffsets_ = mc::OffsetTable(s);
+    }
 }
 
 void CcsdsInfo::encode(eckit::Stream& s) const {
@@ -92,7 +100,7 @@ void CcsdsInfo::encode(eckit::Stream& s) const {
     s << ccsdsFlags_;
     s << ccsdsBlockSize_;
     s << ccsdsRsi_;
-    s << ccsdsOffsets_;
+    ccsdsOffsets_.encode(s);
 }
 
 void CcsdsInfo::print(std::ostream& s) const {
@@ -104,6 +112,12 @@ void CcsdsInfo::print(std::ostream& s) const {
     s << "ccsdsOffsets.size=" << ccsdsOffsets_.size();
 }
 
+size_t CcsdsInfo::footprint() const {
+    // The offset table itself is part of sizeof(CcsdsInfo): only add what it allocates
+    return JumpInfo::footprint() + (sizeof(CcsdsInfo) - sizeof(JumpInfo)) +
+           (ccsdsOffsets_.footprint() - sizeof(mc::OffsetTable));
+}
+
 bool CcsdsInfo::equals(const JumpInfo& other) const {
 
     if (!JumpInfo::equals(other))
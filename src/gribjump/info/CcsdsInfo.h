@@ -12,6 +12,7 @@
 
 #pragma once
 
+#include "gribjump/compression/OffsetTable.h"
 #include "gribjump/info/JumpInfo.h"
 
 namespace gribjump {
@@ -28,6 +29,8 @@ public:
 
     virtual void print(std::ostream&) const override;
 
+    virtual size_t footprint() const override;
+
     // From Streamable
     virtual std::string className() const override { return "CcsdsInfo"; }
     const eckit::ReanimatorBase& reanimator() const override { return reanimator_; }
@@ -37,7 +40,8 @@ public:
     unsigned long ccsdsFlags() const { return ccsdsFlags_; }
     unsigned long ccsdsBlockSize() const { return ccsdsBlockSize_; }
     unsigned long ccsdsRsi() const { return ccsdsRsi_; }
-    const std::vector<size_t>& ccsdsOffsets() const { return ccsdsOffsets_; }
+    std::vector<size_t> ccsdsOffsets() const { return ccsdsOffsets_.offsets(); }
+    const mc::OffsetTable& ccsdsOffsetTable() const { return ccsdsOffsets_; }
 
 protected:
 
@@ -48,7 +52,7 @@ private:
     unsigned long ccsdsFlags_;
     unsigned long ccsdsBlockSize_;
     unsigned long ccsdsRsi_;
-    std::vector<size_t> ccsdsOffsets_;
+    mc::OffsetTable ccsdsOffsets_;  //< bit offsets of the RSIs in the data section
 
 private:
 
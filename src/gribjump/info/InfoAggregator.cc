@@ -9,11 +9,16 @@
  */
 
 /// @author Caragh Bradley
+#include <chrono>
+#include <utility>
+
 #include "eckit/io/DataHandle.h"
 
 #include "fdb5/database/FieldLocation.h"
 
+#include "gribjump/Config.h"
 #include "gribjump/LibGribJump.h"
+#include "gribjump/MetricsRegistry.h"
 #include "gribjump/info/InfoAggregator.h"
 #include "gribjump/info/InfoCache.h"
 #include "gribjump/info/InfoFactory.h"
@@ -30,19 +35,15 @@ bool isGrib(eckit::DataHandle& handle) {
 
 namespace gribjump {
 
-static const size_t AGGREGATOR_QUEUE_SIZE = 8;
+InfoAggregator::InfoAggregator() :
+    InfoAggregator(ConfigOptions::instance().pluginThreads(), ConfigOptions::instance().pluginQueueSize()) {}
 
-InfoAggregator::InfoAggregator() : futures_(AGGREGATOR_QUEUE_SIZE) {
-    consumer_ = std::thread([this]() {
-        for (;;) {
-            locPair elem;
-            if (futures_.pop(elem) == -1)
-                break;
-            std::shared_ptr<const fdb5::FieldLocation> location = elem.first.get();
-            std::unique_ptr<JumpInfo> info                      = std::move(elem.second);
-            insert(location->fullUri(), std::move(info));
-        }
-    });
+InfoAggregator::InfoAggregator(size_t threads, size_t queueSize) : queueSize_(queueSize), queue_(queueSize) {
+    ASSERT(threads > 0);
+    ASSERT(queueSize > 0);
+    for (size_t i = 0; i < threads; ++i) {
+        workers_.emplace_back([this]() { work(); });
+    }
 }
 
 InfoAggregator::~InfoAggregator() {
@@ -51,6 +52,11 @@ InfoAggregator::~InfoAggregator() {
 
 void InfoAggregator::add(std::future<std::shared_ptr<const fdb5::FieldLocation>> future, eckit::MemoryHandle& handle,
                          eckit::Offset offset) {
+    static Histogram& wait = MetricsRegistry::instance().histogram(
+        "gribjump_plugin_queue_wait_seconds",
+        "Time archiving waited for room in the queue of the FDB plugin, i.e. backpressure from indexing.");
+    static Counter& blocked = MetricsRegistry::instance().counter(
+        "gribjump_plugin_queue_full_total", "Archived messages which found the queue of the FDB plugin full.");
 
     handle.openForRead();
     eckit::AutoClose closer(handle);
@@ -60,17 +66,62 @@ void InfoAggregator::add(std::future<std::shared_ptr<const fdb5::FieldLocation>>
         return;
     }
 
-    // Note: it is important we build the info at this stage (and not in the consumer thread) as we don't want to extend
-    // the lifetime of the data.
-    std::unique_ptr<JumpInfo> info(InfoFactory::instance().build(handle, offset));
-    futures_.emplace(std::move(future), std::move(info));
+    // The data only lives as long as the archive call, so the workers are given a copy of the message: far cheaper
+    // than building the info here, which for CCSDS fields means decoding them in full.
+    eckit::Buffer message(size_t(handle.size()) - size_t(offset));
+    handle.seek(offset);
+    ASSERT(handle.read(message.data(), message.size()) == long(message.size()));
+
+    auto start = std::chrono::steady_clock::now();
+    if (pending_.fetch_add(1) >= queueSize_) {
+        blocked.increment();
+    }
+    queue_.emplace(Job{std::move(future), std::move(message)});
+    wait.observe(std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+}
+
+void InfoAggregator::work() {
+    static Counter& indexed = MetricsRegistry::instance().counter(
+        "gribjump_plugin_messages_total", "Archived messages whose info was built by the FDB plugin.");
+    static Counter& failed = MetricsRegistry::instance().counter(
+        "gribjump_plugin_errors_total", "Archived messages whose info could not be built by the FDB plugin.");
+
+    for (;;) {
+        Job job;
+        if (queue_.pop(job) == -1) {
+            break;
+        }
+        pending_--;
+        try {
+            eckit::MemoryHandle handle(job.message.data(), job.message.size());
+            handle.openForRead();
+            eckit::AutoClose closer(handle);
+            std::unique_ptr<JumpInfo> info(InfoFactory::instance().build(handle, 0));
+
+            std::shared_ptr<const fdb5::FieldLocation> location = job.location.get();
+            insert(location->fullUri(), std::move(info));
+            indexed.increment();
+        }
+        catch (const std::exception& e) {
+            eckit::Log::error() << "Gribjump InfoAggregator failed to index an archived message: " << e.what()
+                                << std::endl;
+            failed.increment();
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (!error_) {
+                error_ = std::current_exception();
+            }
+        }
+    }
 }
 
 void InfoAggregator::insert(const eckit::URI& uri, std::unique_ptr<JumpInfo> info) {
     eckit::Offset offset(std::stoll(uri.fragment()));
     eckit::PathName path = uri.path();
 
-    count_[info->packingType()]++;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        count_[info->packingType()]++;
+    }
 
     InfoCache::instance().insert(path, offset, std::move(info));
 }
@@ -80,7 +131,7 @@ void InfoAggregator::flush() {
     LOG_DEBUG_LIB(LibGribJump) << "InfoAggregator flush" << std::endl;
 
     close();
-    ASSERT(futures_.empty());
+    ASSERT(queue_.empty());
 
     InfoCache::instance().flush(true);
 
@@ -90,12 +141,18 @@ void InfoAggregator::flush() {
             LOG_DEBUG_LIB(LibGribJump) << "  " << value << " " << key << std::endl;
         }
     }
+
+    if (error_) {
+        std::rethrow_exception(std::exchange(error_, nullptr));
+    }
 }
 
 void InfoAggregator::close() {
-    futures_.close();
-    if (consumer_.joinable()) {
-        consumer_.join();
+    queue_.close();
+    for (std::thread& worker : workers_) {
+        if (worker.joinable()) {
+            worker.join();
+        }
     }
 }
 
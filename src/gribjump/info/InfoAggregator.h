@@ -12,8 +12,15 @@
 
 #pragma once
 
+#include <atomic>
+#include <exception>
 #include <future>
+#include <mutex>
+#include <thread>
+#include <vector>
+
 #include "eckit/container/Queue.h"
+#include "eckit/io/Buffer.h"
 #include "eckit/filesystem/URI.h"
 #include "eckit/io/MemoryHandle.h"
 #include "eckit/message/Message.h"
@@ -27,32 +34,47 @@ namespace gribjump {
 
 using Key = std::string;
 
-// NB: This object creates a consumer thread (in ctor) and accepts futures from producers (add(), flush()).
+// NB: This object creates a pool of worker threads (in ctor) and accepts futures from producers (add(), flush()).
 // Note that it *is not* safe to have multiple producers calling add() and/or flush() concurrently.
+//
+// add() only copies the message onto a bounded queue: the workers build the JumpInfo of each message, wait for its
+// location and insert it into the InfoCache, so that indexing does not slow down archival. add() blocks while the
+// queue is full.
 class InfoAggregator {
-    using locPair = std::pair<std::future<std::shared_ptr<const fdb5::FieldLocation>>, std::unique_ptr<JumpInfo>>;
+    struct Job {
+        std::future<std::shared_ptr<const fdb5::FieldLocation>> location;
+        eckit::Buffer message;
+    };
 
 public:
 
-    InfoAggregator();
+    InfoAggregator();  // threads and queue size from ConfigOptions
+    InfoAggregator(size_t threads, size_t queueSize);
     ~InfoAggregator();
 
     void add(std::future<std::shared_ptr<const fdb5::FieldLocation>> future, eckit::MemoryHandle& handle,
              eckit::Offset offset);
 
+    /// Wait for the infos of all the messages added to be built, and write them to the index files. Rethrows the
+    /// first error met by a worker, if any, after the other infos have been written.
     void flush();
 
 private:
 
+    void work();
     void insert(const eckit::URI& uri, std::unique_ptr<JumpInfo> info);
     void close();
 
 private:
 
-    InfoExtractor extractor_;
+    const size_t queueSize_;
+    eckit::Queue<Job> queue_;
+    std::atomic<size_t> pending_{0};  //< messages added but not yet taken by a worker
+    std::vector<std::thread> workers_;
+
+    std::mutex mutex_;  //< protects count_ and error_
     std::map<std::string, size_t> count_;
-    eckit::Queue<locPair> futures_;
-    std::thread consumer_;
+    std::exception_ptr error_;
 };
 
 // Simpler aggregator which does not create a consumer thread. Instead, it blocks in add() while waiting for the future.
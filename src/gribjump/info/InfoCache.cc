@@ -12,16 +12,27 @@
 /// @author Tiago Quintino
 
 
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <exception>
+#include <iterator>
+
 #include "eckit/exception/Exceptions.h"
 #include "eckit/filesystem/PathName.h"
+#include "eckit/io/Buffer.h"
 #include "eckit/io/FileHandle.h"
 #include "eckit/log/Log.h"
 #include "eckit/log/Plural.h"
 #include "eckit/log/TimeStamp.h"
+#include "eckit/serialisation/ResizableMemoryStream.h"
 
 #include "gribjump/Config.h"
 #include "gribjump/GribJumpException.h"
 #include "gribjump/LibGribJump.h"
+#include "gribjump/MetricsRegistry.h"
+#include "gribjump/Task.h"
 #include "gribjump/info/InfoCache.h"
 #include "gribjump/info/InfoExtractor.h"
 #include "gribjump/info/InfoFactory.h"
@@ -34,6 +45,22 @@ namespace {
 std::string cachekey(const eckit::PathName& path, const eckit::Offset& offset) {
     return path.baseName() + std::to_string(offset);
 }
+
+// Memory held by an entry of the in-memory cache, including the list and hash map nodes, both copies of its key, and
+// the control block of its shared_ptr
+size_t footprint(const std::string& key, const JumpInfo& info) {
+    constexpr size_t nodes = 96;
+    return info.footprint() + 2 * (sizeof(std::string) + key.capacity()) + nodes;
+}
+
+Gauge& cacheBytes() {
+    return MetricsRegistry::instance().gauge("gribjump_info_cache_bytes",
+                                             "Approximate memory of the JumpInfos held, with cache.maxMemory.");
+}
+
+Gauge& cacheEntries() {
+    return MetricsRegistry::instance().gauge("gribjump_info_cache_entries", "JumpInfos held in memory.");
+}
 }  // namespace
 
 //----------------------------------------------------------------------------------------------------------------------
@@ -43,12 +70,30 @@ InfoCache& InfoCache::instance() {
     return instance_;
 }
 
-InfoCache::~InfoCache() {}
+InfoCache::~InfoCache() {
+    if (writer_.joinable()) {
+        {
+            std::lock_guard<std::mutex> lock(writeBackMutex_);
+            stopping_ = true;
+        }
+        writeBackCond_.notify_all();
+        writer_.join();
+    }
+}
 
 InfoCache::InfoCache() :
     cacheDir_(eckit::PathName()),
-    infocache_(ConfigOptions::instance().cacheSize()),
-    lazy_(ConfigOptions::instance().cacheLazy()) {
+    maxMemory_(ConfigOptions::instance().cacheMaxMemory()),
+    infocache_(maxMemory_ ? maxMemory_ : ConfigOptions::instance().cacheSize()),
+    lazy_(ConfigOptions::instance().cacheLazy()),
+    missingIndexTTL_(ConfigOptions::instance().cacheMissingIndexTTL()),
+    writeBack_(lazy_ && ConfigOptions::instance().cacheEnabled() && ConfigOptions::instance().cacheWriteBack()) {
+
+    if (writeBack_) {
+        // The writer drains its queue when the cache is destroyed at exit, so the registry must outlive the cache
+        MetricsRegistry::instance();
+        writer_ = std::thread([this] { writeBackLoop(); });
+    }
 
     bool enabled = ConfigOptions::instance().cacheEnabled();
     if (!enabled) {
@@ -119,9 +164,18 @@ std::map<eckit::Offset, std::shared_ptr<JumpInfo>> InfoCache::getCached(const ec
 
 void InfoCache::putCache(const eckit::PathName& path, const eckit::OffsetList& offset,
                          std::vector<std::shared_ptr<JumpInfo>>& infos) {
+    static Counter& evictions = MetricsRegistry::instance().counter(
+        "gribjump_info_cache_evictions_total", "JumpInfos evicted from memory to keep within the cache size.");
+
     std::lock_guard<std::mutex> lock(infomutex_);
     for (size_t i = 0; i < offset.size(); i++) {
-        infocache_.put(cachekey(path, offset[i]), infos[i]);
+        const fileoffset_t key = cachekey(path, offset[i]);
+        const size_t size      = maxMemory_ ? footprint(key, *infos[i]) : 1;
+        evictions.increment(infocache_.put(key, infos[i], size));
+    }
+    cacheEntries().set(infocache_.size());
+    if (maxMemory_) {
+        cacheBytes().set(infocache_.used());
     }
 }
 
@@ -129,6 +183,12 @@ std::vector<std::shared_ptr<JumpInfo>> InfoCache::get(const eckit::PathName& pat
 
     std::map<eckit::Offset, std::shared_ptr<JumpInfo>> result = getCached(path, offsets);
 
+    MetricsRegistry& registry = MetricsRegistry::instance();
+    static Counter& hits   = registry.counter("gribjump_info_cache_hits_total", "JumpInfo lookups served from memory.");
+    static Counter& misses = registry.counter("gribjump_info_cache_misses_total", "JumpInfo lookups not in memory.");
+    hits.increment(result.size());
+    misses.increment(offsets.size() - result.size());
+
     if (result.size() != offsets.size()) {
 
         // Find the missing offsets and read from index file
@@ -139,9 +199,16 @@ std::vector<std::shared_ptr<JumpInfo>> InfoCache::get(const eckit::PathName& pat
             }
         }
 
-        // Open the index file and find the missing offsets
-        std::shared_ptr<IndexFile> indexFile                         = getIndexFile(path);
-        std::map<eckit::Offset, std::shared_ptr<JumpInfo>> fileinfos = indexFile->get(fileOffsets);
+        // Open the index file and find the missing offsets, unless the index file was recently found missing
+        std::map<eckit::Offset, std::shared_ptr<JumpInfo>> fileinfos;
+        const eckit::PathName cachePath = cacheFilePath(path);
+        if (!knownMissing(cachePath)) {
+            std::shared_ptr<IndexFile> indexFile = getIndexFile(path);
+            fileinfos                            = indexFile->get(fileOffsets);
+            if (!indexFile->onDisk()) {
+                markMissing(cachePath);
+            }
+        }
 
         std::vector<eckit::Offset> missingOffsets;
         for (const auto& offset : fileOffsets) {
@@ -159,12 +226,8 @@ std::vector<std::shared_ptr<JumpInfo>> InfoCache::get(const eckit::PathName& pat
                 ss << "Missing JumpInfo for " << eckit::Plural(missingOffsets.size(), "offset") << " in " << path;
                 throw JumpInfoExtractionDisabled(ss.str());
             }
-            InfoExtractor extractor;
-            std::vector<std::unique_ptr<JumpInfo>> uinfos = extractor.extract(path, missingOffsets);
-            for (size_t i = 0; i < uinfos.size(); i++) {
-                std::shared_ptr<JumpInfo> info = std::move(uinfos[i]);
-                ASSERT(info);
-                result[missingOffsets[i]] = info;
+            for (auto& [offset, info] : build(path, missingOffsets)) {
+                result[offset] = std::move(info);
             }
         }
     }
@@ -181,6 +244,185 @@ std::vector<std::shared_ptr<JumpInfo>> InfoCache::get(const eckit::PathName& pat
     return vec;
 }
 
+std::map<eckit::Offset, std::shared_ptr<JumpInfo>> InfoCache::build(const eckit::PathName& path,
+                                                                     const std::vector<eckit::Offset>& offsets) {
+    static Counter& coalesced = MetricsRegistry::instance().counter(
+        "gribjump_info_cache_coalesced_total", "JumpInfos awaited from a build by another request, not built again.");
+
+    // Claim the offsets which no other thread is building, and take the futures of those which one is
+    std::vector<eckit::Offset> owned;
+    std::vector<std::promise<std::shared_ptr<JumpInfo>>> promises;
+    std::vector<std::pair<eckit::Offset, std::shared_future<std::shared_ptr<JumpInfo>>>> awaited;
+    {
+        std::lock_guard<std::mutex> lock(inflightMutex_);
+        for (const auto& offset : offsets) {
+            auto key = std::make_pair(path.asString(), offset);
+            auto it  = inflight_.find(key);
+            if (it != inflight_.end()) {
+                awaited.emplace_back(offset, it->second);
+                continue;
+            }
+            promises.emplace_back();
+            inflight_.emplace(key, promises.back().get_future().share());
+            owned.push_back(offset);
+        }
+    }
+    coalesced.increment(awaited.size());
+
+    std::map<eckit::Offset, std::shared_ptr<JumpInfo>> result;
+    std::exception_ptr error;
+    try {
+        if (!owned.empty()) {
+            InfoExtractor extractor;
+            std::vector<std::unique_ptr<JumpInfo>> infos = extractor.extract(path, owned);
+            ASSERT(infos.size() == owned.size());
+            std::vector<std::shared_ptr<JumpInfo>> built;
+            for (size_t i = 0; i < infos.size(); i++) {
+                ASSERT(infos[i]);
+                built.emplace_back(std::move(infos[i]));
+                result[owned[i]] = built.back();
+            }
+            // Into memory before the build is forgotten, so that later requests find the infos there
+            putCache(path, owned, built);
+        }
+    }
+    catch (...) {
+        error = std::current_exception();
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(inflightMutex_);
+        for (size_t i = 0; i < owned.size(); i++) {
+            if (error) {
+                promises[i].set_exception(error);
+            }
+            else {
+                promises[i].set_value(result[owned[i]]);
+            }
+            inflight_.erase(std::make_pair(path.asString(), owned[i]));
+        }
+    }
+    if (error) {
+        std::rethrow_exception(error);
+    }
+
+    if (writeBack_ && !owned.empty()) {
+        writeBack(path, owned, result);
+    }
+
+    for (auto& [offset, future] : awaited) {
+        result[offset] = future.get();
+    }
+    return result;
+}
+
+void InfoCache::writeBack(const eckit::PathName& path, const std::vector<eckit::Offset>& offsets,
+                          const std::map<eckit::Offset, std::shared_ptr<JumpInfo>>& infos) {
+    const eckit::PathName cachePath = cacheFilePath(path);
+    {
+        std::lock_guard<std::mutex> lock(writeBackMutex_);
+        std::shared_ptr<IndexFile>& index = writeBackFiles_[cachePath];
+        if (!index) {
+            index = std::make_shared<IndexFile>(cachePath, false);
+        }
+        for (const auto& offset : offsets) {
+            index->insert(offset, infos.at(offset));
+        }
+    }
+    writeBackCond_.notify_all();
+}
+
+void InfoCache::writeBackLoop() {
+    static Counter& written = MetricsRegistry::instance().counter(
+        "gribjump_info_cache_written_back_total", "JumpInfos built on cache misses and appended to their index file.");
+    static Counter& failed = MetricsRegistry::instance().counter(
+        "gribjump_info_cache_write_back_errors_total", "Failed appends of infos built on cache misses to index files.");
+
+    std::unique_lock<std::mutex> lock(writeBackMutex_);
+    for (;;) {
+        writeBackCond_.wait(lock, [this] { return stopping_ || !writeBackFiles_.empty(); });
+        if (writeBackFiles_.empty()) {
+            return;
+        }
+
+        std::map<filename_t, std::shared_ptr<IndexFile>> files;
+        std::swap(files, writeBackFiles_);
+        writing_ = true;
+        lock.unlock();
+
+        {
+            // Not concurrently with a flush, which may be appending to the same index files
+            std::lock_guard<std::mutex> flushLock(flushMutex_);
+            for (auto& [filename, index] : files) {
+                const size_t count = index->count();
+                try {
+                    index->flush(true);
+                    forgetMissing(filename);
+                    written.increment(count);
+                }
+                catch (const std::exception& e) {
+                    eckit::Log::warning() << "Could not write back " << eckit::Plural(count, "JumpInfo") << " to "
+                                          << filename << ": " << e.what() << std::endl;
+                    failed.increment();
+                }
+            }
+        }
+
+        lock.lock();
+        writing_ = false;
+        writeBackCond_.notify_all();
+    }
+}
+
+void InfoCache::waitForWriteBack() {
+    std::unique_lock<std::mutex> lock(writeBackMutex_);
+    writeBackCond_.wait(lock, [this] { return writeBackFiles_.empty() && !writing_; });
+}
+
+bool InfoCache::knownMissing(const eckit::PathName& cachePath) {
+    static Counter& skipped = MetricsRegistry::instance().counter(
+        "gribjump_info_cache_missing_index_total", "Lookups of index files skipped as they were recently missing.");
+
+    if (missingIndexTTL_ <= 0) {
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(missingMutex_);
+    auto it = missingIndexes_.find(cachePath);
+    if (it == missingIndexes_.end()) {
+        return false;
+    }
+    if (std::chrono::steady_clock::now() >= it->second) {
+        missingIndexes_.erase(it);
+        return false;
+    }
+    skipped.increment();
+    return true;
+}
+
+void InfoCache::markMissing(const eckit::PathName& cachePath) {
+    if (missingIndexTTL_ <= 0) {
+        return;
+    }
+
+    const auto now = std::chrono::steady_clock::now();
+    std::lock_guard<std::mutex> lock(missingMutex_);
+
+    // Expired entries are otherwise only dropped when looked up again
+    if (missingIndexes_.size() >= 1024) {
+        for (auto it = missingIndexes_.begin(); it != missingIndexes_.end();) {
+            it = now >= it->second ? missingIndexes_.erase(it) : std::next(it);
+        }
+    }
+    const auto ttl = std::chrono::duration<double>(missingIndexTTL_);
+    missingIndexes_[cachePath] = now + std::chrono::duration_cast<std::chrono::steady_clock::duration>(ttl);
+}
+
+void InfoCache::forgetMissing(const eckit::PathName& cachePath) {
+    std::lock_guard<std::mutex> lock(missingMutex_);
+    missingIndexes_.erase(cachePath);
+}
+
 void InfoCache::insert(const eckit::PathName& path, const eckit::Offset offset, std::shared_ptr<JumpInfo> info) {
     LOG_DEBUG_LIB(LibGribJump) << "GribJumpCache inserting " << path << ":" << offset << std::endl;
     std::lock_guard<std::mutex> lock(stageMutex_);
@@ -197,16 +439,62 @@ void InfoCache::insert(const eckit::PathName& path, const eckit::Offset offset,
 }
 
 void InfoCache::flush(bool append) {
-    std::lock_guard<std::mutex> lock(stageMutex_);
-    for (auto& [filename, filecache] : stagedFiles_) {
-        filecache->flush(append);
+    // Serialise flushes, so that two never write to the same index file, but let inserts carry on meanwhile
+    std::lock_guard<std::mutex> flushLock(flushMutex_);
+
+    std::map<filename_t, std::shared_ptr<IndexFile>> staged;
+    {
+        std::lock_guard<std::mutex> lock(stageMutex_);
+        std::swap(staged, stagedFiles_);
+    }
+
+    for (auto& [filename, filecache] : staged) {
+        forgetMissing(filename);
+    }
+
+    try {
+        if (staged.size() <= 1) {
+            for (auto& [filename, filecache] : staged) {
+                filecache->flush(append);
+            }
+            return;
+        }
+
+        LOG_DEBUG_LIB(LibGribJump) << "Flushing " << eckit::Plural(staged.size(), "index file") << std::endl;
+
+        TaskGroup taskGroup;
+        for (auto& [filename, filecache] : staged) {
+            taskGroup.enqueueTask<IndexFlushTask>(filecache, append);
+        }
+        taskGroup.waitForTasks();
+        taskGroup.report().raiseErrors();
+    }
+    catch (...) {
+        // Stage the files which were not flushed again, so that their entries are written by the next flush rather
+        // than lost. A flushed file is cleared, so has no entries left.
+        std::lock_guard<std::mutex> lock(stageMutex_);
+        for (auto& [filename, filecache] : staged) {
+            if (filecache->count() == 0) {
+                continue;
+            }
+            auto [it, inserted] = stagedFiles_.try_emplace(filename, filecache);
+            if (!inserted) {
+                it->second->merge(*filecache);  // entries staged since take precedence
+            }
+        }
+        throw;
     }
-    stagedFiles_.clear();
 }
 
 void InfoCache::clear() {
-    std::lock_guard<std::mutex> lock(infomutex_);
-    infocache_.clear();
+    {
+        std::lock_guard<std::mutex> lock(infomutex_);
+        infocache_.clear();
+        cacheEntries().set(0);
+        cacheBytes().set(0);
+    }
+    std::lock_guard<std::mutex> lock(missingMutex_);
+    missingIndexes_.clear();
 }
 
 size_t InfoCache::scan(const eckit::PathName& fdbpath, const std::vector<eckit::Offset>& offsets) {
@@ -214,17 +502,23 @@ size_t InfoCache::scan(const eckit::PathName& fdbpath, const std::vector<eckit::
     // this will be executed in parallel so we dont lock main mutex_ here
     // we will rely on each method to lock mutex when needed
 
-    LOG_DEBUG_LIB(LibGribJump) << "Scanning " << fdbpath << " at " << eckit::Plural(offsets.size(), "offset")
-                               << std::endl;
-
     std::shared_ptr<IndexFile> filecache = getIndexFile(fdbpath);
     filecache->load();
 
+    return scan(fdbpath, *filecache, offsets, std::nullopt);
+}
+
+size_t InfoCache::scan(const eckit::PathName& fdbpath, IndexFile& filecache, const std::vector<eckit::Offset>& offsets,
+                       std::optional<eckit::Offset> from) {
+
+    LOG_DEBUG_LIB(LibGribJump) << "Scanning " << fdbpath << " at " << eckit::Plural(offsets.size(), "offset")
+                               << std::endl;
+
     // Find which offsets are not already in file cache
     std::vector<eckit::Offset> newOffsets;
 
     for (const auto& offset : offsets) {
-        if (!filecache->find(offset)) {
+        if (!filecache.find(offset)) {
             newOffsets.push_back(offset);
         }
     }
@@ -232,20 +526,33 @@ size_t InfoCache::scan(const eckit::PathName& fdbpath, const std::vector<eckit::
     LOG_DEBUG_LIB(LibGribJump) << "Scanning " << fdbpath << " found " << newOffsets.size()
                                << " new fields not already in cache" << std::endl;
 
-    if (newOffsets.empty()) {
-        LOG_DEBUG_LIB(LibGribJump) << "No new fields to scan in " << fdbpath << std::endl;
-        return 0;
-    }
-
     std::sort(newOffsets.begin(), newOffsets.end());
 
     InfoExtractor extractor;
     std::vector<std::unique_ptr<JumpInfo>> infos = extractor.extract(fdbpath, newOffsets);
 
     for (size_t i = 0; i < infos.size(); i++) {
-        filecache->insert(newOffsets[i], std::move(infos[i]));
+        filecache.insert(newOffsets[i], std::move(infos[i]));
+    }
+
+    bool advanced = false;
+    if (from) {
+        long long end = *from;
+        for (const auto& offset : offsets) {
+            const long long length = filecache.find(offset)->totalLength();
+            end                    = std::max(end, static_cast<long long>(offset) + length);
+        }
+        advanced = end > static_cast<long long>(filecache.watermark());
+        filecache.watermark(end);
+    }
+
+    if (newOffsets.empty() && !advanced) {
+        LOG_DEBUG_LIB(LibGribJump) << "No new fields to scan in " << fdbpath << std::endl;
+        return 0;
     }
-    filecache->write();
+
+    filecache.write();
+    forgetMissing(cacheFilePath(fdbpath));
 
     return infos.size();
 }
@@ -255,7 +562,16 @@ size_t InfoCache::scan(const eckit::PathName& fdbpath, bool mergeExisting) {
     InfoExtractor extractor;
 
     if (mergeExisting) {
-        return scan(fdbpath, extractor.offsets(fdbpath));
+        std::shared_ptr<IndexFile> filecache = getIndexFile(fdbpath);
+        filecache->load();
+
+        eckit::Offset from = filecache->watermark();
+        if (from > eckit::Offset(fdbpath.size())) {
+            eckit::Log::warning() << "Index of " << fdbpath << " covers " << from
+                                  << " bytes, more than the file holds: scanning the whole file" << std::endl;
+            from = 0;
+        }
+        return scan(fdbpath, *filecache, extractor.offsets(fdbpath, from), from);
     }
 
     LOG_DEBUG_LIB(LibGribJump) << "Scanning whole file " << fdbpath << std::endl;
@@ -263,12 +579,17 @@ size_t InfoCache::scan(const eckit::PathName& fdbpath, bool mergeExisting) {
     std::shared_ptr<IndexFile> filecache = getIndexFile(fdbpath);
     filecache->reload();
 
+    long long end = 0;
     std::vector<std::pair<eckit::Offset, std::unique_ptr<JumpInfo>>> infos = extractor.extract(fdbpath);
     for (size_t i = 0; i < infos.size(); i++) {
+        const long long length = infos[i].second->totalLength();
+        end                    = std::max(end, static_cast<long long>(infos[i].first) + length);
         filecache->insert(infos[i].first, std::move(infos[i].second));
     }
+    filecache->watermark(end);
 
     filecache->write();
+    forgetMissing(cacheFilePath(fdbpath));
 
     return infos.size();
 }
@@ -279,9 +600,9 @@ void InfoCache::print(std::ostream& s) const {
     s << "InfoCache[";
     s << "cacheDir=" << cacheDir_ << std::endl;
     s << "cache=" << std::endl;
-    for (const auto& [key, info] : infocache_) {
+    for (const auto& [key, entry] : infocache_) {
         s << "  " << key << ": ";
-        info->print(s);
+        entry.value->print(s);
     }
     s << "]";
 }
@@ -300,7 +621,8 @@ void IndexFile::load() {
     if (loaded())
         return;
 
-    if (path_.exists()) {
+    onDisk_ = path_.exists();
+    if (onDisk_) {
         LOG_DEBUG_LIB(LibGribJump) << "Loading file cache from " << path_ << std::endl;
         fromFile(path_);
     }
@@ -321,6 +643,11 @@ void IndexFile::encode(eckit::Stream& s) const {
     std::lock_guard<std::mutex> lock(mutex_);
 
     s << currentVersion_;
+    s << watermark_;
+    encodeEntries(s);
+}
+
+void IndexFile::encodeEntries(eckit::Stream& s) const {
     for (auto& entry : map_) {
         s.startObject();
         s << entry.first;
@@ -332,7 +659,10 @@ void IndexFile::encode(eckit::Stream& s) const {
 void IndexFile::decode(eckit::Stream& s) {
     std::lock_guard<std::mutex> lock(mutex_);
     s >> version_;
-    ASSERT(version_ == currentVersion_);
+    ASSERT(version_ >= 1 && version_ <= currentVersion_);
+    if (version_ >= 2) {
+        s >> watermark_;
+    }
 
     size_t count = 0;
     while (s.next()) {
@@ -356,21 +686,54 @@ void IndexFile::appendToFile(const eckit::PathName& path) const {
     ASSERT(path.extension() == file_ext);
     // NB: Non-atomic. Gribjump does not support concurrent writes to the same file from different processes.
     if (!path.exists()) {
-        toNewFile(path);
+        // Written aside and moved into place, so that a failed write leaves no partial file to append to later
+        eckit::PathName uniqPath = eckit::PathName::unique(path) + file_ext;
+        try {
+            toNewFile(uniqPath);
+        }
+        catch (...) {
+            if (uniqPath.exists()) {
+                uniqPath.unlink(false);
+            }
+            throw;
+        }
+        eckit::PathName::rename(uniqPath, path);
         return;
     }
 
     LOG_DEBUG_LIB(LibGribJump) << "IndexFile appending to file " << path << std::endl;
     // NB: appending does not re-write version information.
-    std::lock_guard<std::mutex> lock(mutex_);
-    eckit::FileStream s(path, "a");
-    for (auto& entry : map_) {
-        s.startObject();
-        s << entry.first;
-        s << *entry.second;
-        s.endObject();
+    // The entries are serialised up front, and appended in a single write.
+    eckit::Buffer buffer(64 * 1024);
+    size_t size = 0;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        eckit::ResizableMemoryStream s(buffer);
+        encodeEntries(s);
+        size = s.position();
+    }
+
+    // A failed write may leave part of the entries in the file: cut them off again, as the entries are restaged and
+    // appended whole by the next flush.
+    const off_t original = static_cast<long long>(path.size());
+    try {
+        eckit::FileHandle file(path);
+        file.openForAppend(size);
+        eckit::AutoClose closer(file);
+        long written = file.write(buffer.data(), size);
+        if (written != long(size)) {
+            throw eckit::WriteError(path.asString() + ": wrote " + std::to_string(written) + " of " +
+                                        std::to_string(size) + " bytes",
+                                    Here());
+        }
+    }
+    catch (...) {
+        if (::truncate(path.localPath(), original) != 0) {
+            eckit::Log::error() << "Failed to truncate " << path << " back to " << original
+                                << " bytes after a failed append: " << std::strerror(errno) << std::endl;
+        }
+        throw;
     }
-    s.close();
 }
 
 void IndexFile::fromFile(const eckit::PathName& path) {
@@ -415,7 +778,9 @@ void IndexFile::flush(bool append) {
 void IndexFile::clear() {
     std::lock_guard<std::mutex> lock(mutex_);
     map_.clear();
-    loaded_ = false;
+    watermark_ = 0;
+    loaded_    = false;
+    onDisk_    = false;
 }
 
 void IndexFile::insert(eckit::Offset offset, std::shared_ptr<JumpInfo> info) {
@@ -423,6 +788,16 @@ void IndexFile::insert(eckit::Offset offset, std::shared_ptr<JumpInfo> info) {
     map_.insert(std::make_pair(offset, info));
 }
 
+eckit::Offset IndexFile::watermark() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return watermark_;
+}
+
+void IndexFile::watermark(eckit::Offset watermark) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    watermark_ = watermark;
+}
+
 
 std::shared_ptr<JumpInfo> IndexFile::find(eckit::Offset offset) {
     std::lock_guard<std::mutex> lock(mutex_);
@@ -440,7 +815,7 @@ size_t IndexFile::count() {
 
 void IndexFile::print(std::ostream& s) {
     std::lock_guard<std::mutex> lock(mutex_);
-    s << "IndexFile[" << path_ << " (" << map_.size() << " entries)]:" << std::endl;
+    s << "IndexFile[" << path_ << " (" << map_.size() << " entries, watermark=" << watermark_ << ")]:" << std::endl;
     for (auto& entry : map_) {
         s << "  Offset:" << entry.first << " -> " << *entry.second << std::endl;
     }
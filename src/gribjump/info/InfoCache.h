@@ -13,7 +13,12 @@
 
 #pragma once
 
+#include <chrono>
+#include <condition_variable>
+#include <future>
 #include <map>
+#include <optional>
+#include <thread>
 
 #include "eckit/filesystem/URI.h"
 #include "eckit/io/Offset.h"
@@ -44,7 +49,8 @@ public:
     /// @param offsets list of offsets to at which GribInfo should be extracted
     size_t scan(const eckit::PathName& path, const std::vector<eckit::Offset>& offsets);
 
-    // if merge is true, we only generate jumpinfos for offsets that are not already in the cache file
+    // if merge is true, we only generate jumpinfos for offsets that are not already in the cache file, reading only
+    // the part of the file after the watermark of the cache file
     // if merge is false, we generate an entirely new cache file
     size_t scan(const eckit::PathName& path, bool merge = true);  // < scan all fields in a file
 
@@ -65,6 +71,10 @@ public:
     void flush(bool append);
     void clear();
 
+    /// Wait until the infos built on cache misses so far have been written back to their index files (with
+    /// cache.writeBack).
+    void waitForWriteBack();
+
     void print(std::ostream& s) const;
 
 private:  // methods
@@ -77,6 +87,26 @@ private:  // methods
 
     eckit::PathName cacheFilePath(const eckit::PathName& path) const;
 
+    /// Index the messages of fdbpath at offsets which are missing from filecache. If from is set, offsets are all the
+    /// messages of the file from there on, and the watermark of the index is moved to the end of the last.
+    size_t scan(const eckit::PathName& fdbpath, IndexFile& filecache, const std::vector<eckit::Offset>& offsets,
+                std::optional<eckit::Offset> from);
+
+    /// Build the infos of the messages of path at offsets from the data file. A message whose info another thread is
+    /// already building is not built again: its info is awaited instead.
+    std::map<eckit::Offset, std::shared_ptr<JumpInfo>> build(const eckit::PathName& path,
+                                                             const std::vector<eckit::Offset>& offsets);
+
+    /// Queue infos built on cache misses to be appended to their index file by the write-back thread
+    void writeBack(const eckit::PathName& path, const std::vector<eckit::Offset>& offsets,
+                   const std::map<eckit::Offset, std::shared_ptr<JumpInfo>>& infos);
+    void writeBackLoop();
+
+    /// True if the index file at cachePath was found missing less than cache.missingIndexTTL seconds ago
+    bool knownMissing(const eckit::PathName& cachePath);
+    void markMissing(const eckit::PathName& cachePath);
+    void forgetMissing(const eckit::PathName& cachePath);
+
     std::map<eckit::Offset, std::shared_ptr<JumpInfo>> getCached(const eckit::PathName& path,
                                                                  const eckit::OffsetList& offsets);
     void putCache(const eckit::PathName& path, const eckit::OffsetList& offset,
@@ -86,16 +116,35 @@ private:  // members
 
     eckit::PathName cacheDir_;
 
+    std::mutex flushMutex_;          //< serialises flush()
     mutable std::mutex stageMutex_;  //< mutex for stagedFiles_
     std::map<filename_t, std::shared_ptr<IndexFile>>
         stagedFiles_;  ///, Files which we are actively appending to (plugin)
 
     mutable std::mutex infomutex_;
     ;  //< mutex for infocache_
+    const size_t maxMemory_;  //< if non-zero, infocache_ is sized in bytes rather than in infos
     infocache_t infocache_;
 
     bool lazy_;  //< if true, cache.get may construct JumpInfo on the fly
 
+    std::mutex inflightMutex_;  //< mutex for inflight_
+    std::map<std::pair<filename_t, eckit::Offset>, std::shared_future<std::shared_ptr<JumpInfo>>>
+        inflight_;  //< infos being built on the fly, keyed by full path and offset
+
+    const double missingIndexTTL_;
+    std::mutex missingMutex_;  //< mutex for missingIndexes_
+    std::map<filename_t, std::chrono::steady_clock::time_point>
+        missingIndexes_;  //< index files found missing, and until when they are assumed to still be missing
+
+    const bool writeBack_;
+    std::mutex writeBackMutex_;  //< mutex for writeBackFiles_, writing_ and stopping_
+    std::condition_variable writeBackCond_;
+    std::map<filename_t, std::shared_ptr<IndexFile>> writeBackFiles_;  //< infos built on the fly, to be written back
+    bool writing_  = false;
+    bool stopping_ = false;
+    std::thread writer_;
+
     bool shadowCache_ = false;  //< if true, cache files are persisted next to the original data files (e.g. in FDB)
                                 //  This takes precedence over cacheDir_.
 };
@@ -105,6 +154,7 @@ class IndexFile {
 
     using infomap_t = std::map<eckit::Offset, std::shared_ptr<JumpInfo>>;
     friend class InfoCache;
+    friend class IndexFlushTask;
 
 public:
 
@@ -117,14 +167,22 @@ public:
     void print(std::ostream& s);
     bool loaded() const { return loaded_; }
 
+    /// True if load() found the index file on disk
+    bool onDisk() const { return onDisk_; }
+
     // For tests only
     size_t size() const { return map_.size(); }
 
+    /// Every message of the data file starting before the watermark is indexed, as of the last scan. Data files are
+    /// append-only, so a rescan only reads the file from there.
+    eckit::Offset watermark() const;
+
     std::map<eckit::Offset, std::shared_ptr<JumpInfo>> get(const eckit::OffsetList& offsets);
 
 private:  // Methods are only intended to be called from InfoCache
 
     void encode(eckit::Stream& s) const;
+    void encodeEntries(eckit::Stream& s) const;  // requires lock, no version
 
     void decode(eckit::Stream& s);
 
@@ -135,6 +193,7 @@ private:  // Methods are only intended to be called from InfoCache
     void clear();
 
     void insert(eckit::Offset offset, std::shared_ptr<JumpInfo> info);
+    void watermark(eckit::Offset watermark);
 
     void toNewFile(const eckit::PathName& path) const;
     void appendToFile(const eckit::PathName& path) const;
@@ -160,11 +219,14 @@ private:  // Methods are only intended to be called from InfoCache
 
 private:
 
-    static constexpr uint8_t currentVersion_ = 1;
+    /// Version 2 adds the watermark, after the version. Appending entries does not rewrite either.
+    static constexpr uint8_t currentVersion_ = 2;
     uint8_t version_;
+    eckit::Offset watermark_ = 0;
 
     eckit::PathName path_;
     bool loaded_ = false;
+    bool onDisk_ = false;
     mutable std::mutex mutex_;  //< mutex for map_
     infomap_t map_;
 };
@@ -13,14 +13,17 @@
 #include "gribjump/info/InfoExtractor.h"
 
 #include "gribjump/Config.h"
+#include "gribjump/LibGribJump.h"
 #include "gribjump/info/InfoFactory.h"
 #include "gribjump/info/JumpInfo.h"
+#include "gribjump/info/MessageScanner.h"
 
 #include "eccodes.h"
 #include "eckit/exception/Exceptions.h"
 #include "eckit/filesystem/PathName.h"
 #include "eckit/io/FileHandle.h"
 #include "eckit/io/Offset.h"
+#include "eckit/log/Plural.h"
 #include "eckit/message/Message.h"
 
 #include <cstddef>
@@ -28,59 +31,6 @@
 
 namespace gribjump {
 
-namespace {
-
-//@note: Only used when scanning corrupted files (where we cannot rely on eccodes)
-eckit::OffsetList findGRIBOffsets(const std::string& filepath) {
-    const std::string pattern = "GRIB";
-    const size_t plen         = pattern.size();
-    const size_t BUFFER_SIZE  = 1024 * 1024;
-    const size_t OVERLAP      = plen - 1;
-
-    eckit::OffsetList offsets;
-    std::vector<char> buffer(BUFFER_SIZE + OVERLAP);
-    std::vector<char> carryover(OVERLAP, 0);
-    eckit::FileHandle file(filepath);
-    file.openForRead();
-
-    size_t filePos = 0;
-    while (true) {
-
-        std::memcpy(buffer.data(), carryover.data(), OVERLAP);
-        long bytesRead = file.read(buffer.data() + OVERLAP, BUFFER_SIZE);
-        if (bytesRead < 0) {
-            throw eckit::SeriousBug("Error reading file: " + filepath);
-        }
-        if (bytesRead == 0) {
-            break;  // EOF
-        }
-
-        // Search for GRIB in the current buffer
-        for (size_t i = 0; i <= bytesRead + OVERLAP - plen; ++i) {
-            if (std::memcmp(&buffer[i], pattern.data(), plen) == 0) {
-                offsets.push_back(filePos + i - OVERLAP);
-            }
-        }
-
-        filePos += bytesRead;
-        if (bytesRead >= OVERLAP) {
-            std::memcpy(carryover.data(), &buffer[bytesRead], OVERLAP);
-        }
-        else {
-            break;
-        }
-    }
-
-    // Remove the last offset, which we assume is an incomplete GRIB message
-    if (!offsets.empty()) {
-        offsets.pop_back();
-    }
-
-    return offsets;
-}
-}  // namespace
-
-
 InfoExtractor::InfoExtractor() {}
 
 InfoExtractor::~InfoExtractor() {}
@@ -139,6 +89,20 @@ std::unique_ptr<JumpInfo> InfoExtractor::extract(const eckit::message::Message&
 }
 
 eckit::OffsetList InfoExtractor::offsets(const eckit::PathName& path) const {
+    return offsets(path, 0);
+}
+
+eckit::OffsetList InfoExtractor::offsets(const eckit::PathName& path, eckit::Offset from) const {
+    MessageScanner scanner(path);
+    eckit::OffsetList offsets = scanner.walk(from);
+    if (scanner.complete()) {
+        return offsets;
+    }
+
+    // Not a sequence of messages, e.g. padding between messages: let ecCodes find the messages
+    LOG_DEBUG_LIB(LibGribJump) << "Unexpected data after " << eckit::Plural(offsets.size(), "message") << " of "
+                               << path << ", scanning the whole file with ecCodes" << std::endl;
+
     grib_context* c  = nullptr;
     int n            = 0;
     off_t* offsets_c = nullptr;
@@ -150,20 +114,21 @@ eckit::OffsetList InfoExtractor::offsets(const eckit::PathName& path) const {
         eckit::Log::warning() << "Error extracting offsets from " << path
                               << ". Attempting workaround for corrupted files." << std::endl;
         free(offsets_c);
-        return findGRIBOffsets(path);
+        return scanner.search(from);
     }
 
     ASSERT(!err);
 
-    // convert to eckit offsets
-    eckit::OffsetList eckit_offsets;
-    eckit_offsets.reserve(n);
+    // convert to eckit offsets, from offset from
+    offsets.clear();
     for (int i = 0; i < n; i++) {
-        eckit_offsets.push_back(offsets_c[i]);
+        if (offsets_c[i] >= static_cast<long long>(from)) {
+            offsets.push_back(offsets_c[i]);
+        }
     }
 
     free(offsets_c);
-    return eckit_offsets;
+    return offsets;
 }
 
 }  // namespace gribjump
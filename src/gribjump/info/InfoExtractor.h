@@ -41,6 +41,12 @@ public:
     std::unique_ptr<JumpInfo> extract(const eckit::message::Message& msg) const;
 
     eckit::OffsetList offsets(const eckit::PathName& path) const;
+
+    /// Offsets of the complete messages of path starting at or after from, which must be the start of a message or
+    /// the end of the file. Message boundaries are found with a MessageScanner, from the lengths in section 0, and
+    /// with ecCodes only if the file is not a plain sequence of messages. An incomplete last message, e.g. one still
+    /// being written, is left out.
+    eckit::OffsetList offsets(const eckit::PathName& path, eckit::Offset from) const;
 };
 
 }  // namespace gribjump
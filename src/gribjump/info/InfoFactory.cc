@@ -14,6 +14,7 @@
 #include "eckit/io/DataHandle.h"
 #include "metkit/codes/api/CodesAPI.h"
 
+#include "gribjump/GridIndex.h"
 #include "gribjump/info/InfoFactory.h"
 
 namespace gribjump {
@@ -51,6 +52,12 @@ std::unique_ptr<JumpInfo> InfoFactory::build(eckit::DataHandle& h, const eckit::
     // Handle EOF
     ASSERT(codesHandle);
 
+    // The first scan of a field on a grid indexes the grid, for lookups by coordinates
+    GridIndexCache& grids = GridIndexCache::instance();
+    if (grids.enabled()) {
+        grids.learn(codesHandle->getString("md5GridSection"), *codesHandle);
+    }
+
     InfoBuilderBase* builder = get(codesHandle->getString("packingType"));
 
     ASSERT(builder);  // Unrecognised packingTypes use the "unsupported" builder
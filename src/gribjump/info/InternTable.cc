@@ -0,0 +1,105 @@
+/*
+ * (C) Copyright 2023- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+/// @author Caragh Bradley
+
+#include "gribjump/info/InternTable.h"
+
+#include "eckit/exception/Exceptions.h"
+
+namespace gribjump {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+InternTable& InternTable::gridHashes() {
+    static InternTable table;
+    return table;
+}
+
+InternTable& InternTable::packingTypes() {
+    static InternTable table;
+    return table;
+}
+
+InternTable::Id InternTable::intern(const std::string& value) {
+    const Id found = find(value);
+    if (found != none) {
+        return found;
+    }
+
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    auto it = ids_.find(value);
+    if (it != ids_.end()) {
+        return it->second;
+    }
+    ASSERT(values_.size() < none);
+    const Id id = values_.size();
+    values_.push_back(value);
+    ids_.emplace(value, id);
+    return id;
+}
+
+InternTable::Id InternTable::find(const std::string& value) const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    auto it = ids_.find(value);
+    return it == ids_.end() ? none : it->second;
+}
+
+const std::string& InternTable::get(Id id) const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    ASSERT(id < values_.size());
+    return values_[id];
+}
+
+size_t InternTable::size() const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    return values_.size();
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+bool Md5::parse(const std::string& hex, Md5& md5) {
+    if (hex.size() != 32) {
+        return false;
+    }
+    uint64_t words[2] = {0, 0};
+    for (size_t i = 0; i < 32; ++i) {
+        const char c = hex[i];
+        uint64_t digit;
+        if (c >= '0' && c <= '9') {
+            digit = c - '0';
+        }
+        else if (c >= 'a' && c <= 'f') {
+            digit = c - 'a' + 10;
+        }
+        else {
+            // Upper case digits would not be written back the same
+            return false;
+        }
+        words[i / 16] = (words[i / 16] << 4) | digit;
+    }
+    md5.high = words[0];
+    md5.low  = words[1];
+    return true;
+}
+
+std::string Md5::hex() const {
+    static const char* digits = "0123456789abcdef";
+    std::string hex(32, '0');
+    for (size_t i = 0; i < 16; ++i) {
+        hex[i]      = digits[(high >> (60 - 4 * i)) & 0xf];
+        hex[16 + i] = digits[(low >> (60 - 4 * i)) & 0xf];
+    }
+    return hex;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace gribjump
@@ -0,0 +1,80 @@
+/*
+ * (C) Copyright 2023- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+/// @author Caragh Bradley
+
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+
+namespace gribjump {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/// Process-wide table of distinct strings, each given an integer id. JumpInfos hold the ids of their grid hash and
+/// packing type, which only take a handful of values however many infos are cached, and compare them as integers.
+///
+/// Strings are never removed, so ids and the references returned by get() stay valid for the life of the process.
+class InternTable {
+public:
+
+    using Id = uint32_t;
+
+    /// Id of no string: find() of a string never interned
+    static constexpr Id none = UINT32_MAX;
+
+    static InternTable& gridHashes();
+    static InternTable& packingTypes();
+
+    InternTable(const InternTable&)            = delete;
+    InternTable& operator=(const InternTable&) = delete;
+
+    /// Id of value, adding it to the table if it is new
+    Id intern(const std::string& value);
+
+    /// Id of value, or none if it was never interned. Does not add value: e.g. for grid hashes given by requests.
+    Id find(const std::string& value) const;
+
+    const std::string& get(Id id) const;
+
+    size_t size() const;
+
+private:
+
+    InternTable() = default;
+
+private:
+
+    mutable std::shared_mutex mutex_;  //< lookups share it, only adding a string takes it exclusively
+    std::deque<std::string> values_;  //< by id. A deque does not move its elements as it grows.
+    std::unordered_map<std::string, Id> ids_;
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/// The 128 bits of an md5 hash, e.g. md5GridSection, given as 32 hexadecimal digits
+struct Md5 {
+    uint64_t high = 0;
+    uint64_t low  = 0;
+
+    /// False if hex is not 32 hexadecimal digits
+    static bool parse(const std::string& hex, Md5& md5);
+
+    /// The 32 lower case hexadecimal digits, as given by ecCodes
+    std::string hex() const;
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace gribjump
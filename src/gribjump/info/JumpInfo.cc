@@ -28,7 +28,7 @@ namespace gribjump {
 JumpInfo::JumpInfo(const metkit::codes::CodesHandle& h, const eckit::Offset startOffset) : version_(currentVersion_) {
 
     editionNumber_ = h.getLong("editionNumber");
-    packingType_   = h.getString("packingType");
+    packingType_   = InternTable::packingTypes().intern(h.getString("packingType"));
     if (editionNumber_ != 1 && editionNumber_ != 2) {
         std::stringstream ss;
         ss << "Unsupported GRIB edition number: " << editionNumber_;
@@ -45,8 +45,8 @@ JumpInfo::JumpInfo(const metkit::codes::CodesHandle& h, const eckit::Offset star
     numberOfValues_     = h.getLong("numberOfValues");
     sphericalHarmonics_ = h.has("sphericalHarmonics") ? h.getLong("sphericalHarmonics") : 0;
 
-    totalLength_    = h.getLong("totalLength");
-    md5GridSection_ = h.getString("md5GridSection");
+    totalLength_ = h.getLong("totalLength");
+    gridHash_    = InternTable::gridHashes().intern(h.getString("md5GridSection"));
 
     long bitmapPresent_ = h.getLong("bitmapPresent");
 
@@ -63,7 +63,7 @@ JumpInfo::JumpInfo(const metkit::codes::CodesHandle& h, const eckit::Offset star
 JumpInfo::JumpInfo(const eckit::message::Message& msg) : version_(currentVersion_) {
 
     editionNumber_ = msg.getLong("editionNumber");
-    packingType_   = msg.getString("packingType");
+    packingType_   = InternTable::packingTypes().intern(msg.getString("packingType"));
     if (editionNumber_ != 1 && editionNumber_ != 2) {
         std::stringstream ss;
         ss << "Unsupported GRIB edition number: " << editionNumber_;
@@ -73,7 +73,7 @@ JumpInfo::JumpInfo(const eckit::message::Message& msg) : version_(currentVersion
     binaryScaleFactor_  = msg.getLong("binaryScaleFactor");
     decimalScaleFactor_ = msg.getLong("decimalScaleFactor");
     referenceValue_     = msg.getDouble("referenceValue");
-    md5GridSection_     = msg.getString("md5GridSection");
+    gridHash_           = InternTable::gridHashes().intern(msg.getString("md5GridSection"));
 
     // XXX: would use getSize, but it seems to not work correctly? Always returns 1 or 0.
     // Also, the gribaccessor above secretly uses get_long for the unsigned_longs, rather than size as I would have
@@ -112,6 +112,11 @@ JumpInfo::JumpInfo(const eckit::message::Message& msg) : version_(currentVersion
 
 JumpInfo::JumpInfo(eckit::Stream& s) : Streamable(s) {
     s >> version_;
+    if (version_ > currentVersion_) {
+        throw eckit::SeriousBug("Unsupported JumpInfo version " + std::to_string(version_) + ", expected at most " +
+                                    std::to_string(currentVersion_),
+                                Here());
+    }
     s >> referenceValue_;
     s >> binaryScaleFactor_;
     s >> decimalScaleFactor_;
@@ -124,13 +129,31 @@ JumpInfo::JumpInfo(eckit::Stream& s) : Streamable(s) {
     s >> numberOfDataPoints_;
     s >> totalLength_;
     s >> sphericalHarmonics_;
-    s >> md5GridSection_;
-    s >> packingType_;
+
+    std::string md5GridSection;
+    bool binary = false;
+    if (version_ >= 3) {
+        s >> binary;
+    }
+    if (binary) {
+        Md5 md5;
+        s >> md5.high;
+        s >> md5.low;
+        md5GridSection = md5.hex();
+    }
+    else {
+        s >> md5GridSection;
+    }
+    gridHash_ = InternTable::gridHashes().intern(md5GridSection);
+
+    std::string packingType;
+    s >> packingType;
+    packingType_ = InternTable::packingTypes().intern(packingType);
 }
 
 void JumpInfo::encode(eckit::Stream& s) const {
     Streamable::encode(s);
-    s << version_;
+    s << currentVersion_;
     s << referenceValue_;
     s << binaryScaleFactor_;
     s << decimalScaleFactor_;
@@ -143,8 +166,19 @@ void JumpInfo::encode(eckit::Stream& s) const {
     s << numberOfDataPoints_;
     s << totalLength_;
     s << sphericalHarmonics_;
-    s << md5GridSection_;
-    s << packingType_;
+
+    // 16 bytes rather than 32, unless the grid hash is not an md5 as given by ecCodes
+    Md5 md5;
+    const bool binary = Md5::parse(md5GridSection(), md5);
+    s << binary;
+    if (binary) {
+        s << md5.high;
+        s << md5.low;
+    }
+    else {
+        s << md5GridSection();
+    }
+    s << packingType();
 }
 
 std::string JumpInfo::toString() const {
@@ -167,8 +201,13 @@ void JumpInfo::print(std::ostream& s) const {
       << "numberOfDataPoints=" << numberOfDataPoints_ << ","
       << "totalLength=" << totalLength_ << ","
       << "sphericalHarmonics=" << sphericalHarmonics_ << ","
-      << "md5GridSection=" << md5GridSection_ << ","
-      << "packingType=" << packingType_;
+      << "md5GridSection=" << md5GridSection() << ","
+      << "packingType=" << packingType();
+}
+
+size_t JumpInfo::footprint() const {
+    // The grid hash and packing type are shared with the other infos, in their InternTable
+    return sizeof(JumpInfo);
 }
 
 bool JumpInfo::equals(const JumpInfo& rhs) const {
@@ -178,8 +217,8 @@ bool JumpInfo::equals(const JumpInfo& rhs) const {
            offsetBeforeData() == rhs.offsetBeforeData() && offsetAfterData() == rhs.offsetAfterData() &&
            offsetBeforeBitmap() == rhs.offsetBeforeBitmap() && numberOfValues() == rhs.numberOfValues() &&
            numberOfDataPoints() == rhs.numberOfDataPoints() && totalLength() == rhs.totalLength() &&
-           sphericalHarmonics() == rhs.sphericalHarmonics() && md5GridSection() == rhs.md5GridSection() &&
-           packingType() == rhs.packingType();
+           sphericalHarmonics() == rhs.sphericalHarmonics() && gridHashId() == rhs.gridHashId() &&
+           packingTypeId() == rhs.packingTypeId();
 }
 
 // --------------------------------------------------------------------------------------------
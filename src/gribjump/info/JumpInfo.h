@@ -20,6 +20,8 @@
 
 #include "metkit/codes/api/CodesAPI.h"
 
+#include "gribjump/info/InternTable.h"
+
 namespace gribjump {
 class JumpInfo : public eckit::Streamable {
 
@@ -51,8 +53,15 @@ public:
     unsigned long numberOfDataPoints() const { return numberOfDataPoints_; }
     eckit::Length totalLength() const { return totalLength_; }
     long sphericalHarmonics() const { return sphericalHarmonics_; } /* deprecate? can we just check the packing type? */
-    std::string md5GridSection() const { return md5GridSection_; }
-    std::string packingType() const { return packingType_; }
+    const std::string& md5GridSection() const { return InternTable::gridHashes().get(gridHash_); }
+    const std::string& packingType() const { return InternTable::packingTypes().get(packingType_); }
+
+    /// Ids of the grid hash and packing type in their InternTable: infos on the same grid have the same gridHashId
+    InternTable::Id gridHashId() const { return gridHash_; }
+    InternTable::Id packingTypeId() const { return packingType_; }
+
+    /// Approximate memory used, in bytes, by the info and what its members allocate
+    virtual size_t footprint() const;
 
 protected:
 
@@ -69,7 +78,10 @@ private:
 
 protected:
 
-    static constexpr uint8_t currentVersion_ = 1;
+    /// Version of the encoding. Infos of older versions are read, and are always written in the current version.
+    /// 2: compact CCSDS offset tables.
+    /// 3: the grid hash as 128 bits rather than 32 hexadecimal digits.
+    static constexpr uint8_t currentVersion_ = 3;
     uint8_t version_;
     double referenceValue_;
     long binaryScaleFactor_;
@@ -83,8 +95,8 @@ protected:
     unsigned long numberOfDataPoints_;
     eckit::Length totalLength_;
     long sphericalHarmonics_;
-    std::string md5GridSection_;
-    std::string packingType_ = "none";
+    InternTable::Id gridHash_;  //< md5GridSection
+    InternTable::Id packingType_;
 };
 
 }  // namespace gribjump
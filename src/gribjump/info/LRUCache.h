@@ -19,54 +19,87 @@
 namespace gribjump {
 
 // Note: not a thread safe container, use an external lock if needed
+//
+// Each value has a size, 1 by default, and the least recently used values are evicted to keep the total size of the
+// values held within the capacity: e.g. a number of values, or a number of bytes if given the size of each value.
 template <typename K, typename V>
 class LRUCache {
+    struct Entry {
+        V value;
+        size_t size;
+        typename std::list<K>::iterator lru;
+    };
+
 public:
 
     LRUCache(size_t capacity) : capacity_(capacity) {}
 
-    void put(const K& key, const V& value) {
-        if (map_.find(key) == map_.end()) {
-            if (list_.size() == capacity_) {
-                auto last = list_.back();
-                list_.pop_back();
-                map_.erase(last);
-            }
-            list_.push_front(key);
+    /// @return the number of values evicted to make room. A value larger than the capacity is not held.
+    size_t put(const K& key, const V& value, size_t size = 1) {
+        auto it = map_.find(key);
+        if (it != map_.end()) {
+            erase(it);
+        }
+        if (size > capacity_) {
+            return 0;
         }
-        else {
-            list_.remove(key);
-            list_.push_front(key);
+
+        size_t evicted = 0;
+        while (used_ + size > capacity_) {
+            erase(map_.find(list_.back()));
+            evicted++;
         }
-        map_[key] = value;
+        list_.push_front(key);
+        map_.emplace(key, Entry{value, size, list_.begin()});
+        used_ += size;
+        return evicted;
     }
 
 
     V& get(const K& key) {
-        if (map_.find(key) == map_.end()) {
+        auto it = map_.find(key);
+        if (it == map_.end()) {
             throw eckit::BadValue("Key does not exist");
         }
-        list_.remove(key);
-        list_.push_front(key);
-        return map_[key];
+        list_.splice(list_.begin(), list_, it->second.lru);
+        return it->second.value;
     }
 
     bool exists(const K& key) { return map_.find(key) != map_.end(); }
 
-    typename std::unordered_map<K, V>::const_iterator begin() const { return map_.begin(); }
+    /// Iterates over pairs of key and Entry, whose value member is the value
+    typename std::unordered_map<K, Entry>::const_iterator begin() const { return map_.begin(); }
 
-    typename std::unordered_map<K, V>::const_iterator end() const { return map_.end(); }
+    typename std::unordered_map<K, Entry>::const_iterator end() const { return map_.end(); }
 
     void clear() {
         list_.clear();
         map_.clear();
+        used_ = 0;
+    }
+
+    /// Number of values held
+    size_t size() const { return map_.size(); }
+
+    /// Total size of the values held
+    size_t used() const { return used_; }
+
+    size_t capacity() const { return capacity_; }
+
+private:
+
+    void erase(typename std::unordered_map<K, Entry>::iterator it) {
+        used_ -= it->second.size;
+        list_.erase(it->second.lru);
+        map_.erase(it);
     }
 
 private:
 
     size_t capacity_;
-    std::list<K> list_;
-    std::unordered_map<K, V> map_;
+    size_t used_ = 0;
+    std::list<K> list_;  //< keys, most recently used first
+    std::unordered_map<K, Entry> map_;
 };
 
 }  // namespace gribjump
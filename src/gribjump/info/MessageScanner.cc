@@ -0,0 +1,169 @@
+/*
+ * (C) Copyright 2023- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+/// @author Caragh Bradley
+
+#include "gribjump/info/MessageScanner.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "eckit/exception/Exceptions.h"
+
+namespace gribjump {
+
+namespace {
+const char* marker    = "GRIB";
+const char* endMarker = "7777";
+}  // namespace
+
+//----------------------------------------------------------------------------------------------------------------------
+
+MessageScanner::MessageScanner(const eckit::PathName& path) : file_(path), size_(path.size()) {
+    file_.openForRead();
+}
+
+MessageScanner::~MessageScanner() {
+    file_.close();
+}
+
+eckit::OffsetList MessageScanner::walk(eckit::Offset from) {
+    complete_ = true;
+
+    eckit::OffsetList offsets;
+    long long pos = from;
+    while (pos < size_) {
+        long long length = validate(pos);
+        if (length == -2) {
+            break;  // incomplete
+        }
+        if (length <= 0) {
+            complete_ = false;
+            break;
+        }
+        offsets.push_back(pos);
+        pos += length;
+    }
+    return offsets;
+}
+
+eckit::OffsetList MessageScanner::search(eckit::Offset from) {
+    eckit::OffsetList offsets;
+    long long pos = from;
+    while ((pos = find(pos)) >= 0) {
+        long long length = validate(pos);
+        if (length > 0) {
+            offsets.push_back(pos);
+            pos += length;
+        }
+        else if (length == 0) {
+            offsets.push_back(pos);  // GRIB1 over 8MB: cannot be validated, nor skipped
+            pos += 4;
+        }
+        else {
+            pos += 1;
+        }
+    }
+    return offsets;
+}
+
+long long MessageScanner::messageLength(const unsigned char* header) {
+    if (std::memcmp(header, marker, 4) != 0) {
+        return -1;
+    }
+    if (header[7] == 1) {
+        long long length = (static_cast<long long>(header[4]) << 16) | (header[5] << 8) | header[6];
+        return (length & 0x800000) ? 0 : length;
+    }
+    if (header[7] == 2) {
+        unsigned long long length = 0;
+        for (size_t i = 8; i < headerSize_; ++i) {
+            length = (length << 8) | header[i];
+        }
+        return length >> 62 ? -1 : static_cast<long long>(length);
+    }
+    return -1;
+}
+
+long long MessageScanner::validate(long long pos) {
+    unsigned char header[headerSize_];
+    if (!read(pos, header, headerSize_)) {
+        // Near the end of the file: the start of a message still being written, or not a message
+        const size_t n = std::min<long long>(4, size_ - pos);
+        read(pos, header, n);
+        return std::memcmp(header, marker, n) == 0 ? -2 : -1;
+    }
+
+    long long length = messageLength(header);
+    if (length <= 0) {
+        return length;
+    }
+    if (length < static_cast<long long>(headerSize_ + 4)) {
+        return -1;
+    }
+    if (pos + length > size_) {
+        return -2;
+    }
+
+    char end[4];
+    read(pos + length - 4, end, 4);
+    return std::memcmp(end, endMarker, 4) == 0 ? length : -1;
+}
+
+bool MessageScanner::read(long long pos, void* out, size_t n) {
+    const long long end = pos + static_cast<long long>(n);
+    if (end > size_) {
+        return false;
+    }
+    if (pos >= bufferBegin_ && end <= bufferBegin_ + static_cast<long long>(bufferLength_)) {
+        std::memcpy(out, buffer_.data() + (pos - bufferBegin_), n);
+        return true;
+    }
+    file_.seek(pos);
+    ASSERT(file_.read(out, n) == static_cast<long>(n));
+    return true;
+}
+
+long long MessageScanner::find(long long pos) {
+    while (pos + 4 <= size_) {
+        if (pos < bufferBegin_ || pos + 4 > bufferBegin_ + static_cast<long long>(bufferLength_)) {
+            fill(pos);
+        }
+
+        // Search the starts of a marker which fits in the buffer
+        const unsigned char* begin = buffer_.data() + (pos - bufferBegin_);
+        const size_t n             = bufferBegin_ + bufferLength_ - pos - 3;
+        const void* found          = std::memchr(begin, marker[0], n);
+        if (!found) {
+            pos += n;
+            continue;
+        }
+
+        const long long candidate = pos + (static_cast<const unsigned char*>(found) - begin);
+        if (std::memcmp(found, marker, 4) == 0) {
+            return candidate;
+        }
+        pos = candidate + 1;
+    }
+    return -1;
+}
+
+void MessageScanner::fill(long long pos) {
+    buffer_.resize(bufferSize_);
+    file_.seek(pos);
+    long n = file_.read(buffer_.data(), std::min<long long>(bufferSize_, size_ - pos));
+    ASSERT(n >= 4);
+    bufferBegin_  = pos;
+    bufferLength_ = n;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace gribjump
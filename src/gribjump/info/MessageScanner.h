@@ -0,0 +1,84 @@
+/*
+ * (C) Copyright 2023- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+/// @author Caragh Bradley
+
+#pragma once
+
+#include <vector>
+
+#include "eckit/filesystem/PathName.h"
+#include "eckit/io/FileHandle.h"
+#include "eckit/io/Offset.h"
+
+namespace gribjump {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/// Finds the GRIB messages of a file without decoding them. A message is recognised by the "GRIB" marker, the total
+/// length given in its section 0 and the "7777" marker which must end it.
+class MessageScanner {
+public:
+
+    explicit MessageScanner(const eckit::PathName& path);
+    ~MessageScanner();
+
+    MessageScanner(const MessageScanner&)            = delete;
+    MessageScanner& operator=(const MessageScanner&) = delete;
+
+    /// Offsets of the messages from offset from, each starting where the previous one ends, so that only their first
+    /// and last bytes are read. Stops at the end of the file, before an incomplete last message (e.g. one still being
+    /// written), or at anything else, in which case complete() is false.
+    eckit::OffsetList walk(eckit::Offset from);
+
+    /// False if the last walk stopped at something other than a message, an incomplete last message or the end of the
+    /// file: e.g. padding or a corrupted message, or a GRIB1 message over 8MB, whose length section 0 does not give.
+    bool complete() const { return complete_; }
+
+    /// Offsets of all the messages from offset from, searching for "GRIB" markers between them, e.g. in corrupted
+    /// files. The file is read sequentially in large blocks, searched with memchr (which libc vectorises), and
+    /// resumes after the end of each valid message. Markers that do not start a valid message are skipped.
+    eckit::OffsetList search(eckit::Offset from);
+
+private:
+
+    /// Length of the message whose first bytes are header, from its section 0. 0 if the length is not given there,
+    /// -1 if header is not the start of a GRIB message.
+    static long long messageLength(const unsigned char* header);
+
+    /// Length of the message at pos: see messageLength(), with -1 also if the message is incomplete or does not end
+    /// with "7777", and -2 if it extends beyond the end of the file.
+    long long validate(long long pos);
+
+    /// Copy n bytes at pos into out, from the buffer if there. False if they are beyond the end of the file.
+    bool read(long long pos, void* out, size_t n);
+
+    /// Position of the first "GRIB" marker at or after pos, or -1
+    long long find(long long pos);
+
+    void fill(long long pos);
+
+private:
+
+    static constexpr size_t headerSize_ = 16;
+    static constexpr size_t bufferSize_ = 8 * 1024 * 1024;
+
+    eckit::FileHandle file_;
+    const long long size_;
+    bool complete_ = true;
+
+    std::vector<unsigned char> buffer_;  //< allocated by the first search
+    long long bufferBegin_ = 0;          //< offset in the file of the first byte of buffer_
+    size_t bufferLength_   = 0;          //< valid bytes in buffer_
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace gribjump
@@ -25,7 +25,7 @@ CcsdsJumper::CcsdsJumper() : Jumper() {}
 CcsdsJumper::~CcsdsJumper() {}
 
 void CcsdsJumper::readValues(eckit::DataHandle& dh, const eckit::Offset offset, const JumpInfo& info_in,
-                             const std::vector<Interval>& intervals, ExValues& values) {
+                             const std::vector<Interval>& intervals, double* out) {
 
     const CcsdsInfo* pccsds = dynamic_cast<const CcsdsInfo*>(&info_in);
 
@@ -33,7 +33,7 @@ void CcsdsJumper::readValues(eckit::DataHandle& dh, const eckit::Offset offset,
         throw BadJumpInfoException("CcsdsJumper::readValues: info is not of type CcsdsInfo", Here());
 
     const CcsdsInfo& info = *pccsds;
-    ASSERT(info.ccsdsOffsets().size() > 0);
+    ASSERT(!info.ccsdsOffsetTable().empty());
 
     mc::CcsdsDecompressor<double> ccsds{};
     ccsds.flags(info.ccsdsFlags())
@@ -43,7 +43,7 @@ void CcsdsJumper::readValues(eckit::DataHandle& dh, const eckit::Offset offset,
         .reference_value(info.referenceValue())
         .binary_scale_factor(info.binaryScaleFactor())
         .decimal_scale_factor(info.decimalScaleFactor())
-        .offsets(info.ccsdsOffsets());
+        .offsets(info.ccsdsOffsetTable());
 
 
     auto data_range = mc::Block{offset + info.offsetBeforeData(), info.offsetAfterData() - info.offsetBeforeData()};
@@ -52,7 +52,7 @@ void CcsdsJumper::readValues(eckit::DataHandle& dh, const eckit::Offset offset,
     // TODO(maee): Optimize this
     auto ranges = toRanges(intervals);
 
-    ccsds.decode(data_accessor, ranges, values);
+    ccsds.decode(data_accessor, ranges, out);
 
     return;
 }
@@ -0,0 +1,58 @@
+/*
+ * (C) Copyright 2023- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+/// @author Caragh Bradley
+
+#include <algorithm>
+
+#include "gribjump/compression/Range.h"
+#include "gribjump/jumper/DecodePlan.h"
+#include "gribjump/jumper/Jumper.h"
+
+namespace gribjump {
+
+namespace {
+
+bool sortedAndDisjoint(const std::vector<Interval>& intervals) {
+    return std::adjacent_find(intervals.begin(), intervals.end(),
+                              [](const auto& a, const auto& b) { return a.second > b.first; }) == intervals.end();
+}
+
+}  // namespace
+
+// -----------------------------------------------------------------------------
+
+DecodePlan::DecodePlan(const std::vector<Interval>& intervals) : inOrder(sortedAndDisjoint(intervals)) {
+    const mc::Coalesced coalesced = mc::coalesce(toRanges(intervals));
+
+    std::vector<size_t> positions;  // of each span, in the decoded values
+    positions.reserve(coalesced.blocks.size());
+    spans.reserve(coalesced.blocks.size());
+    for (const auto& [begin, count] : coalesced.blocks) {
+        spans.emplace_back(begin, begin + count);
+        positions.push_back(size);
+        size += count;
+    }
+
+    starts.reserve(intervals.size());
+    for (size_t i = 0; i < intervals.size(); ++i) {
+        const size_t b = coalesced.block[i];
+        starts.push_back(positions[b] + intervals[i].first - spans[b].first);
+    }
+}
+
+void DecodePlan::scatter(const double* decoded, ExtractionResult& result) const {
+    for (size_t i = 0; i < starts.size(); ++i) {
+        Span<double> values = result.mutable_values(i);
+        std::copy(decoded + starts[i], decoded + starts[i] + values.size(), values.begin());
+    }
+}
+
+}  // namespace gribjump
@@ -0,0 +1,44 @@
+/*
+ * (C) Copyright 2023- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+/// @author Caragh Bradley
+
+#pragma once
+
+#include <vector>
+
+#include "gribjump/ExtractionData.h"
+#include "gribjump/Types.h"
+
+namespace gribjump {
+
+/// The requested intervals, merged into sorted and disjoint spans that are each decoded once, however many intervals
+/// overlap them.
+///
+/// The spans are decoded one after another. When the intervals are sorted and disjoint, that is exactly the layout of
+/// their values in the result, so the spans are decoded straight into it. Otherwise they are decoded into a buffer,
+/// from which the values of each interval are copied.
+///
+/// The plan depends only on the intervals, so the fields of a time series, which all have the same intervals, share
+/// one plan.
+struct DecodePlan {
+
+    explicit DecodePlan(const std::vector<Interval>& intervals);
+
+    /// Copy the values of each interval from the decoded spans into the result
+    void scatter(const double* decoded, ExtractionResult& result) const;
+
+    const bool inOrder;          // the intervals are sorted and disjoint, i.e. laid out as the spans
+    std::vector<Interval> spans;
+    std::vector<size_t> starts;  // of the values of each interval, in the decoded values
+    size_t size = 0;             // number of values of the spans
+};
+
+}  // namespace gribjump
@@ -13,8 +13,12 @@
 #include "eckit/exception/Exceptions.h"
 #include "eckit/io/DataHandle.h"
 
+#include <algorithm>
 #include <memory>
+#include <optional>
 #include "gribjump/ExtractionItem.h"
+#include "gribjump/MetricsRegistry.h"
+#include "gribjump/jumper/DecodePlan.h"
 #include "gribjump/jumper/Jumper.h"
 
 namespace gribjump {
@@ -24,25 +28,50 @@ namespace gribjump {
 constexpr double MISSING_VALUE = std::numeric_limits<double>::quiet_NaN();
 
 
-//  ----------------------------------------------------------------------------
-// to remove
+namespace {
+
+// Set the mask bits of the first n values
+void setMask(Span<uint64_t> mask, size_t n) {
+    ASSERT(mask.size() == (n + 63) / 64);
+    for (size_t k = 0; k < mask.size(); k++) {
+        size_t bits = std::min<size_t>(64, n - 64 * k);
+        mask[k]     = bits == 64 ? ~uint64_t(0) : (uint64_t(1) << bits) - 1;
+    }
+}
 
-std::vector<std::bitset<64>> toBitset(const Bitmap& bitmap) {
-    const size_t size = bitmap.size();
-    std::vector<std::bitset<64>> masks;
-    for (size_t i = 0; i < (size + 63) / 64; i++) {
-        std::bitset<64> mask64;
-        for (size_t j = 0; j < 64; j++) {
-            if (i * 64 + j < size) {
-                mask64[j] = bitmap[i * 64 + j] > 0;
-            }
+// Set the mask bits of the values of [begin, end) present in the bitmap
+void setMask(Span<uint64_t> mask, const Bitmap& bitmap, size_t begin, size_t end) {
+    ASSERT(mask.size() == (end - begin + 63) / 64);
+    std::fill(mask.begin(), mask.end(), 0);
+    for (size_t j = begin; j < end; j++) {
+        if (bitmap[j]) {
+            mask[(j - begin) / 64] |= uint64_t(1) << ((j - begin) % 64);
         }
-        masks.push_back(mask64);
     }
-    assert(masks.size() == (size + 63) / 64);
-    return masks;
 }
 
+std::vector<size_t> intervalSizes(const std::vector<Interval>& intervals) {
+    std::vector<size_t> sizes;
+    sizes.reserve(intervals.size());
+    for (const auto& [begin, end] : intervals) {
+        sizes.push_back(end - begin);
+    }
+    return sizes;
+}
+
+/// The plan shared by the item, or else one built into local
+const DecodePlan& decodePlan(const ExtractionItem& item, std::optional<DecodePlan>& local) {
+    if (item.plan()) {
+        return *item.plan();
+    }
+    return local.emplace(item.intervals());
+}
+
+}  // namespace
+
+//  ----------------------------------------------------------------------------
+// to remove
+
 // Convert ranges to intervals
 // TODO(maee): Simplification: Switch to intervals or ranges
 std::vector<mc::Block> toRanges(const std::vector<Interval>& intervals) {
@@ -53,15 +82,6 @@ std::vector<mc::Block> toRanges(const std::vector<Interval>& intervals) {
     });
     return ranges;
 }
-
-
-bool checkIntervals(const std::vector<Interval>& intervals) {
-    ASSERT(intervals.size() > 0);
-    std::vector<char> check;
-    std::transform(intervals.begin(), intervals.end() - 1, intervals.begin() + 1, std::back_inserter(check),
-                   [](const auto& a, const auto& b) { return a.second <= b.first; });
-    return std::all_of(check.begin(), check.end(), [](char c) { return c; });
-}
 // -----------------------------------------------------------------------------
 
 
@@ -72,9 +92,17 @@ Jumper::~Jumper() {}
 
 void Jumper::extract(eckit::DataHandle& dh, const eckit::Offset offset, const JumpInfo& info,
                      ExtractionItem& extractionItem) {
-    ASSERT(checkIntervals(extractionItem.intervals()));
+    ASSERT(!extractionItem.intervals().empty());
     ASSERT(!info.sphericalHarmonics());
 
+    // Intervals may be in any order, and may overlap
+    static Counter& valuesDecoded =
+        MetricsRegistry::instance().counter("gribjump_decoded_values_total", "Values extracted from GRIB messages.");
+    for (const Interval& interval : extractionItem.intervals()) {
+        ASSERT(interval.first <= interval.second);
+        valuesDecoded.increment(interval.second - interval.first);
+    }
+
     if (info.bitsPerValue() == 0)
         return extractConstant(info, extractionItem);
 
@@ -88,12 +116,22 @@ void Jumper::extractNoMask(eckit::DataHandle& dh, const eckit::Offset offset, co
                            ExtractionItem& extractionItem) {
 
     const std::vector<Interval>& intervals = extractionItem.intervals();
+    std::optional<DecodePlan> local;
+    const DecodePlan& plan = decodePlan(extractionItem, local);
 
-    auto result = std::make_unique<ExtractionResult>();
-    readValues(dh, offset, info, intervals, result->mutable_values());
+    auto result = std::make_unique<ExtractionResult>(intervalSizes(intervals));
+    if (plan.inOrder) {
+        readValues(dh, offset, info, plan.spans, result->mutable_values().data());
+    }
+    else {
+        std::vector<double> decoded(plan.size);
+        readValues(dh, offset, info, plan.spans, decoded.data());
+        plan.scatter(decoded.data(), *result);
+    }
 
-    std::transform(intervals.begin(), intervals.end(), std::back_inserter(result->mutable_mask()),
-                   [](const auto& interval) { return toBitset(std::vector(interval.second - interval.first, true)); });
+    for (size_t i = 0; i < intervals.size(); ++i) {
+        setMask(result->mutable_mask(i), result->nvalues(i));
+    }
 
     extractionItem.result(std::move(result));
     return;
@@ -102,31 +140,40 @@ void Jumper::extractNoMask(eckit::DataHandle& dh, const eckit::Offset offset, co
 void Jumper::extractMasked(eckit::DataHandle& dh, const eckit::Offset offset, const JumpInfo& info,
                            ExtractionItem& extractionItem) {
 
-    const std::vector<Interval>& old_intervals = extractionItem.intervals();
-    auto fullbitmap                            = readBitmap(dh, offset, info);
-    auto [new_intervals, new_bitmaps]          = calculateMaskedIntervals(old_intervals, fullbitmap);
-
-    // This result object does not have the masked nans.
-    auto decoded = std::make_unique<ExtractionResult>();
-    readValues(dh, offset, info, new_intervals, decoded->mutable_values());
-
-    // This result object will have nans in the masked positions.
-    auto output_result                                   = std::make_unique<ExtractionResult>();
-    std::vector<Values>& out_values                      = output_result->mutable_values();
-    std::vector<std::vector<std::bitset<64>>>& out_masks = output_result->mutable_mask();
-
-    /// @todo: Can we avoid copying the values e.g. resize + modify the vector in place? Possibly not worth it.
-    for (size_t i = 0; i < old_intervals.size(); ++i) {
-        Values values;
-        values.reserve(new_bitmaps[i].size());
-        for (size_t count = 0, j = 0; j < new_bitmaps[i].size(); ++j) {
-            values.push_back(new_bitmaps[i][j] ? decoded->values()[i][count++] : MISSING_VALUE);
+    const std::vector<Interval>& intervals = extractionItem.intervals();
+    std::optional<DecodePlan> local;
+    const DecodePlan& plan = decodePlan(extractionItem, local);
+    const Bitmap bitmap = readBitmap(dh, offset, info);
+
+    // The data section does not contain the missing values: decode the present values of all spans together...
+    const std::vector<Interval> present = presentIntervals(plan.spans, bitmap);
+    size_t npresent                     = 0;
+    for (const auto& [begin, end] : present) {
+        npresent += end - begin;
+    }
+    std::vector<double> decoded(npresent);
+    readValues(dh, offset, info, present, decoded.data());
+
+    // ... then spread them over the spans, with nans in the masked positions.
+    auto result = std::make_unique<ExtractionResult>(intervalSizes(intervals));
+    std::vector<double> expanded(plan.inOrder ? 0 : plan.size);
+    double* out         = plan.inOrder ? result->mutable_values().data() : expanded.data();
+    const double* value = decoded.data();
+    for (const auto& [begin, end] : plan.spans) {
+        for (size_t j = begin; j < end; ++j) {
+            *out++ = bitmap[j] ? *value++ : MISSING_VALUE;
         }
-        out_values.push_back(values);
-        out_masks.push_back(toBitset(new_bitmaps[i]));
+    }
+    ASSERT(value == decoded.data() + decoded.size());
+    if (!plan.inOrder) {
+        plan.scatter(expanded.data(), *result);
+    }
+
+    for (size_t i = 0; i < intervals.size(); ++i) {
+        setMask(result->mutable_mask(i), bitmap, intervals[i].first, intervals[i].second);
     }
 
-    extractionItem.result(std::move(output_result));
+    extractionItem.result(std::move(result));
     return;
 }
 
@@ -138,16 +185,14 @@ void Jumper::extractConstant(const JumpInfo& info, ExtractionItem& extractionIte
 
     const std::vector<Interval>& intervals = extractionItem.intervals();
 
-    auto res            = std::make_unique<ExtractionResult>();
+    auto res            = std::make_unique<ExtractionResult>(intervalSizes(intervals));
     auto referenceValue = info.referenceValue();
 
-    std::transform(intervals.begin(), intervals.end(), std::back_inserter(res->mutable_values()),
-                   [referenceValue](const Interval& interval) {
-                       return Values(interval.second - interval.first, referenceValue);
-                   });
-    std::transform(
-        intervals.begin(), intervals.end(), std::back_inserter(res->mutable_mask()),
-        [](const Interval& interval) { return toBitset(std::vector(interval.second - interval.first, true)); });
+    Span<double> values = res->mutable_values();
+    std::fill(values.begin(), values.end(), referenceValue);
+    for (size_t i = 0; i < intervals.size(); ++i) {
+        setMask(res->mutable_mask(i), res->nvalues(i));
+    }
 
     extractionItem.result(std::move(res));
     return;
@@ -185,66 +230,24 @@ Bitmap Jumper::readBitmap(eckit::DataHandle& dh, const eckit::Offset offset, con
 }
 
 
-// Recalculate intervals using the bitmap
-// This is necessary because data section does not contain missing values
-// Intervals need to be shifted by the number of missing values before the interval
-// TODO(maee): optimization: read only the bitmap for the requested interval
-std::pair<std::vector<Interval>, std::vector<Bitmap>> Jumper::calculateMaskedIntervals(
-    const std::vector<Interval>& intervals_tmp, const Bitmap& bitmap) const {
-    struct ExtendedInterval {
-        enum class Type {
-            GAP,
-            INTERVAL
-        };
-        Type type;           // GAP or INTERVAL
-        size_t begin;        // begin is inclusive
-        size_t end;          // end is exclusive
-        size_t missing_cum;  // number of missing values before the interval
-        size_t missing;      // number of missing values in the interval
-        Bitmap bitmap;       // bitmap for the interval
-
-        ExtendedInterval(Type type, size_t begin, size_t end, const Bitmap& all_bitmap) :
-            type(type),
-            begin(begin),
-            end(end),
-            missing_cum{0},
-            bitmap{all_bitmap.begin() + begin, all_bitmap.begin() + end} {
-            missing = std::count(bitmap.begin(), bitmap.end(), false);
-        }
-    };
-
-    std::vector<ExtendedInterval> intervals;
-    std::transform(
-        intervals_tmp.begin(), intervals_tmp.end(), std::back_inserter(intervals), [&bitmap](const auto& interval) {
-            return ExtendedInterval{ExtendedInterval::Type::INTERVAL, interval.first, interval.second, bitmap};
-        });
-
-    assert(intervals.size() > 0);
-    std::vector<ExtendedInterval> gaps;
-    gaps.push_back(ExtendedInterval{ExtendedInterval::Type::GAP, 0, intervals.front().begin, bitmap});
-    std::transform(intervals.begin(), intervals.end() - 1, intervals.begin() + 1, std::back_inserter(gaps),
-                   [&bitmap](const auto& a, const auto& b) {
-                       return ExtendedInterval{ExtendedInterval::Type::GAP, a.end, b.begin, bitmap};
-                   });
-
-    std::vector<ExtendedInterval> intervals_and_gaps;
-    std::merge(intervals.begin(), intervals.end(), gaps.begin(), gaps.end(), std::back_inserter(intervals_and_gaps),
-               [](const auto& a, const auto& b) { return a.begin < b.begin; });
-
-    for (size_t i = 1; i < intervals_and_gaps.size(); i++) {
-        intervals_and_gaps[i].missing_cum = intervals_and_gaps[i - 1].missing_cum + intervals_and_gaps[i - 1].missing;
+// The intervals of the present values in the data section, which does not contain the missing values: each interval
+// is shifted back by the number of values missing before it, and shrunk by the number missing within it. The intervals
+// must be sorted and disjoint.
+std::vector<Interval> Jumper::presentIntervals(const std::vector<Interval>& intervals, const Bitmap& bitmap) const {
+    std::vector<Interval> present;
+    present.reserve(intervals.size());
+
+    size_t position = 0;  // in the bitmap
+    size_t missing  = 0;  // before position
+    for (const auto& [begin, end] : intervals) {
+        ASSERT(position <= begin && end <= bitmap.size());
+        missing += std::count(bitmap.begin() + position, bitmap.begin() + begin, false);
+        const size_t first = begin - missing;
+        missing += std::count(bitmap.begin() + begin, bitmap.begin() + end, false);
+        present.emplace_back(first, end - missing);
+        position = end;
     }
-
-    std::vector<Interval> new_intervals;
-    std::vector<Bitmap> new_interval_bitmaps;
-    for (const auto& i : intervals_and_gaps) {
-        if (i.type == ExtendedInterval::Type::INTERVAL) {
-            new_intervals.push_back({i.begin - i.missing_cum, i.end - i.missing_cum - i.missing});
-            new_interval_bitmaps.push_back(i.bitmap);
-        }
-    }
-
-    return std::make_pair(new_intervals, new_interval_bitmaps);
+    return present;
 }
 
 
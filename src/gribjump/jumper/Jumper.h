@@ -38,8 +38,9 @@ public:
 
 private:
 
+    /// Decode the values of the intervals into out, one interval after another.
     virtual void readValues(eckit::DataHandle& dh, const eckit::Offset offset, const JumpInfo& info,
-                            const std::vector<Interval>& intervals, ExValues& values) {
+                            const std::vector<Interval>& intervals, double* out) {
         NOTIMP;
     }
     Bitmap readBitmap(eckit::DataHandle& dh, const eckit::Offset offset, const JumpInfo& info) const;
@@ -48,8 +49,7 @@ private:
     void extractNoMask(eckit::DataHandle& dh, const eckit::Offset offset, const JumpInfo& info, ExtractionItem&);
     void extractMasked(eckit::DataHandle& dh, const eckit::Offset offset, const JumpInfo& info, ExtractionItem&);
 
-    std::pair<std::vector<Range>, std::vector<Bitmap>> calculateMaskedIntervals(const std::vector<Interval>& intervals,
-                                                                                const Bitmap& bitmap) const;
+    std::vector<Interval> presentIntervals(const std::vector<Interval>& intervals, const Bitmap& bitmap) const;
 };
 
 // -----------------------------------------------------------------------------------------
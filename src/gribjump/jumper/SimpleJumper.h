@@ -26,7 +26,7 @@ public:
 private:
 
     virtual void readValues(eckit::DataHandle& dh, const eckit::Offset offset, const JumpInfo& info,
-                            const std::vector<Interval>& intervals, ExValues& values) override;
+                            const std::vector<Interval>& intervals, double* out) override;
 };
 
 }  // namespace gribjump
@@ -0,0 +1,102 @@
+/*
+ * (C) Copyright 2023- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+/// @author Caragh Bradley
+
+#include "gribjump/remote/ConnectionMonitor.h"
+
+#include <poll.h>
+#include <sys/socket.h>
+#include <cerrno>
+#include <chrono>
+
+#include "eckit/log/Log.h"
+
+#include "gribjump/Config.h"
+#include "gribjump/LibGribJump.h"
+
+namespace gribjump {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+ConnectionMonitor::ConnectionMonitor(int fd, const CancellationToken& token) :
+    fd_(fd),
+    token_(token),
+    interval_(std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+        std::chrono::duration<double>(ConfigOptions::instance().connectionPollInterval()))) {
+    if (fd_ >= 0 && interval_.count() > 0) {
+        thread_ = std::thread(&ConnectionMonitor::run, this);
+    }
+}
+
+ConnectionMonitor::~ConnectionMonitor() {
+    if (thread_.joinable()) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stop_ = true;
+        }
+        cv_.notify_one();
+        thread_.join();
+    }
+}
+
+void ConnectionMonitor::run() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (!cv_.wait_for(lock, interval_, [this] { return stop_; })) {
+        if (token_.cancelled()) {
+            return;
+        }
+        if (connectionLost(fd_)) {
+            LOG_DEBUG_LIB(LibGribJump) << "ConnectionMonitor: client connection lost" << std::endl;
+            token_.cancel("Client connection lost");
+            return;
+        }
+    }
+}
+
+bool ConnectionMonitor::connectionLost(int fd) {
+    struct pollfd pfd;
+    pfd.fd     = fd;
+    pfd.events = POLLIN;
+#ifdef POLLRDHUP
+    pfd.events |= POLLRDHUP;
+#endif
+    pfd.revents = 0;
+
+    if (::poll(&pfd, 1, 0) <= 0) {
+        return false;  // nothing to report, or interrupted
+    }
+
+    if (pfd.revents & (POLLERR | POLLHUP | POLLNVAL)) {
+        return true;
+    }
+#ifdef POLLRDHUP
+    if (pfd.revents & POLLRDHUP) {
+        return true;
+    }
+#endif
+
+    if (pfd.revents & POLLIN) {
+        // Readable: either unexpected data, or end-of-file if the peer has closed.
+        char c;
+        ssize_t n = ::recv(fd, &c, 1, MSG_PEEK | MSG_DONTWAIT);
+        if (n == 0) {
+            return true;
+        }
+        if (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+            return true;
+        }
+    }
+    return false;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace gribjump
@@ -0,0 +1,66 @@
+/*
+ * (C) Copyright 2023- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+/// @author Caragh Bradley
+
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+#include "gribjump/Cancellation.h"
+
+namespace gribjump {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/// Watches a client connection while its request executes, and cancels the request if the client goes away.
+///
+/// The client sends nothing more once its request is written, so the socket reporting end-of-file or an error means
+/// the client has disconnected (or cancelled) and nobody is waiting for the reply.
+/// Monitoring stops when the ConnectionMonitor is destroyed. A negative fd, or a server.connectionPollInterval of 0,
+/// disables it.
+///
+/// Each monitor runs a thread of its own, which wakes every server.connectionPollInterval seconds for as long as the
+/// request executes: one thread per executing request, in addition to the connection threads.
+class ConnectionMonitor {
+public:
+
+    ConnectionMonitor(int fd, const CancellationToken& token);
+
+    ConnectionMonitor(const ConnectionMonitor&)            = delete;
+    ConnectionMonitor& operator=(const ConnectionMonitor&) = delete;
+
+    ~ConnectionMonitor();
+
+    /// True if the peer of the connected socket fd has closed its end, or the connection has failed.
+    static bool connectionLost(int fd);
+
+private:
+
+    void run();
+
+private:
+
+    int fd_;
+    CancellationToken token_;
+    std::chrono::steady_clock::duration interval_;
+
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    bool stop_ = false;
+    std::thread thread_;
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace gribjump
@@ -12,10 +12,14 @@
 
 #pragma once
 
+#include <memory>
+
 #include "eckit/net/NetService.h"
 #include "eckit/thread/ThreadControler.h"
+#include "gribjump/Config.h"
 #include "gribjump/LogRouter.h"
 #include "gribjump/remote/GribJumpService.h"
+#include "gribjump/remote/MetricsEndpoint.h"
 #include "gribjump/remote/WorkQueue.h"
 
 namespace gribjump {
@@ -35,6 +39,11 @@ public:
 
         WorkQueue::instance();  // start the work queue
         tcsvc_.start();
+
+        if (int metricsPort = ConfigOptions::instance().metricsPort(); metricsPort > 0) {
+            tcmetrics_ = std::make_unique<eckit::ThreadControler>(new MetricsEndpoint(metricsPort));
+            tcmetrics_->start();
+        }
     }
 
     GribJumpServer(const GribJumpServer&)            = delete;
@@ -52,6 +61,7 @@ private:  // members
 
     eckit::net::NetService* svc_;
     eckit::ThreadControler tcsvc_;
+    std::unique_ptr<eckit::ThreadControler> tcmetrics_;  //< null unless the metrics endpoint is enabled
 };
 
 //-------------------------------------------------------------------------------------------------
@@ -11,12 +11,20 @@
 /// @author Caragh Bradley
 /// @author Tiago Quintino
 
+#include <atomic>
 #include <optional>
 
 #include "eckit/log/Timer.h"
 #include "eckit/system/ResourceUsage.h"
 
+#include "gribjump/Cancellation.h"
+#include "gribjump/Config.h"
+#include "gribjump/GribJumpException.h"
 #include "gribjump/LibGribJump.h"
+#include "gribjump/MetricsRegistry.h"
+#include "gribjump/Numa.h"
+#include "gribjump/Tracing.h"
+#include "gribjump/remote/ConnectionMonitor.h"
 #include "gribjump/remote/GribJumpUser.h"
 #include "gribjump/remote/Protocol.h"
 #include "gribjump/remote/RemoteGribJump.h"
@@ -26,6 +34,29 @@
 
 namespace gribjump {
 
+namespace {
+
+std::string requestTypeName(RequestType type) {
+    switch (type) {
+        case RequestType::EXTRACT:
+            return "extract";
+        case RequestType::AXES:
+            return "axes";
+        case RequestType::SCAN:
+            return "scan";
+        case RequestType::FORWARD_EXTRACT:
+            return "forward_extract";
+        case RequestType::FORWARD_SCAN:
+            return "forward_scan";
+        case RequestType::SELECT_POINTS:
+            return "select_points";
+        default:
+            return "unknown";
+    }
+}
+
+}  // namespace
+
 GribJumpUser::GribJumpUser(eckit::net::TCPSocket& protocol) : NetUser(protocol) {}
 
 GribJumpUser::~GribJumpUser() {}
@@ -36,9 +67,18 @@ void GribJumpUser::serve(eckit::Stream& s, std::istream& in, std::ostream& out)
 
     eckit::Log::info() << "Serving new connection" << std::endl;
 
+    // With the NUMA-aware scheduler, connections are spread over the nodes in turn. The connection thread is pinned to
+    // its node, so that the request is received, its tasks are queued and its reply is serialised on that node.
+    const NumaTopology& numa = NumaTopology::instance();
+    const bool pinned        = ConfigOptions::instance().schedulerNuma() && numa.nodes() > 1;
+    if (pinned) {
+        static std::atomic<size_t> nextNode{0};
+        numa.pin(nextNode++ % numa.nodes());
+    }
+
     try {
         eckit::Timer timer("Connection served");
-        dispatchRequest(s);
+        dispatchRequest(s, nullptr, protocol_.socket());
     }
     catch (std::exception& e) {
         eckit::Log::error() << "** " << e.what() << " Caught in " << Here() << std::endl;
@@ -60,58 +100,103 @@ void GribJumpUser::serve(eckit::Stream& s, std::istream& in, std::ostream& out)
     LOG_DEBUG_LIB(LibGribJump) << eckit::system::ResourceUsage() << std::endl;
 
     MetricsManager::instance().report();
+
+    if (pinned) {
+        numa.unpin();
+    }
 }
 
 template <typename RequestT>
-static void processRequest(eckit::Stream& s, EngineIface& engine) {
+static void processRequest(eckit::Stream& s, EngineIface& engine, int clientSocket) {
     eckit::Timer timer("GribJumpUser::processRequest");
+    std::optional<TraceSpan> phase(std::in_place, "receive");
 
     RequestT request(s, engine);
     MetricsManager::instance().set("elapsed_receive", timer.elapsed());
     timer.reset("Request received");
     request.info();
 
-    request.execute();
+    phase.emplace("execute");
+    CancellationToken& token = CancellationToken::current();
+    {
+        ConnectionMonitor monitor(clientSocket, token);
+        request.execute();
+    }
     MetricsManager::instance().set("elapsed_execute", timer.elapsed());
     timer.reset("Request executed");
 
+    // Nobody is waiting for the reply
+    if (token.cancelled()) {
+        throw RequestCancelled(token.reason(), Here());
+    }
+
+    phase.emplace("reply");
     request.reportErrors();
     request.replyToClient();
     MetricsManager::instance().set("elapsed_reply", timer.elapsed());
     timer.reset("Request replied");
 }
 
-void dispatchRequest(eckit::Stream& s, EngineIface* injectedEngine) {
-    RequestType requestType = Protocol::readRequestHeader(s);
-
-    // By default we create an engine, though tests are allowed to
-    // inject one (e.g. a MockEngine) for unit testing.
-    std::optional<Engine> ownedEngine;
-    if (!injectedEngine) {
-        ownedEngine.emplace();
-    }
-    EngineIface& engine = injectedEngine ? *injectedEngine : *ownedEngine;
-
+static void processRequestOfType(eckit::Stream& s, EngineIface& engine, int clientSocket, RequestType requestType) {
     switch (requestType) {
         case RequestType::EXTRACT:
-            processRequest<ExtractRequest>(s, engine);
+            processRequest<ExtractRequest>(s, engine, clientSocket);
             break;
         case RequestType::AXES:
-            processRequest<AxesRequest>(s, engine);
+            processRequest<AxesRequest>(s, engine, clientSocket);
             break;
         case RequestType::SCAN:
-            processRequest<ScanRequest>(s, engine);
+            processRequest<ScanRequest>(s, engine, clientSocket);
             break;
         case RequestType::FORWARD_EXTRACT:
-            processRequest<ForwardedExtractRequest>(s, engine);
+            processRequest<ForwardedExtractRequest>(s, engine, clientSocket);
             break;
         case RequestType::FORWARD_SCAN:
-            processRequest<ForwardedScanRequest>(s, engine);
+            processRequest<ForwardedScanRequest>(s, engine, clientSocket);
+            break;
+        case RequestType::SELECT_POINTS:
+            processRequest<SelectPointsRequest>(s, engine, clientSocket);
             break;
         default:
             throw eckit::SeriousBug("Unknown request type: " + std::to_string(static_cast<uint16_t>(requestType)));
     }
 }
 
+void dispatchRequest(eckit::Stream& s, EngineIface* injectedEngine, int clientSocket) {
+    RequestType requestType = Protocol::readRequestHeader(s);
+
+    // Each request gets its own cancellation token, observed by the tasks it schedules
+    CancellationScope cancellation;
+
+    // By default we create an engine, though tests are allowed to
+    // inject one (e.g. a MockEngine) for unit testing.
+    std::optional<Engine> ownedEngine;
+    if (!injectedEngine) {
+        ownedEngine.emplace();
+    }
+    EngineIface& engine = injectedEngine ? *injectedEngine : *ownedEngine;
+
+    MetricsRegistry& registry = MetricsRegistry::instance();
+    const MetricsRegistry::Label type{"type", requestTypeName(requestType)};
+    Histogram& latency = registry.histogram("gribjump_request_duration_seconds",
+                                            "Time from receiving a request to replying, by request type.", type);
+    registry.counter("gribjump_requests_total", "Requests received, by request type.", type).increment();
+
+    // Parent of the request's spans on this server; a child of the sender's span, if the request carried one
+    TraceSpan span("GribJumpUser::" + type.second);
+
+    eckit::Timer timer;
+    try {
+        processRequestOfType(s, engine, clientSocket, requestType);
+    }
+    catch (...) {
+        latency.observe(timer.elapsed());
+        registry.counter("gribjump_request_errors_total", "Requests that failed or were cancelled, by type.", type)
+            .increment();
+        throw;
+    }
+    latency.observe(timer.elapsed());
+}
+
 
 }  // namespace gribjump
@@ -30,7 +30,10 @@ class EngineIface;
 /// version mismatch or unknown request type.
 ///
 /// Factored out of GribJumpUser so the server protocol logic can unit tested.
-void dispatchRequest(eckit::Stream& s, EngineIface* engine = nullptr);
+///
+/// If clientSocket is given, the connection is watched while the request executes, and the request is cancelled if
+/// the client disconnects.
+void dispatchRequest(eckit::Stream& s, EngineIface* engine = nullptr, int clientSocket = -1);
 
 //----------------------------------------------------------------------------------------------------------------------
 
@@ -0,0 +1,143 @@
+/*
+ * (C) Copyright 2023- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+/// @author Caragh Bradley
+
+#include "gribjump/remote/MetricsEndpoint.h"
+
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <cerrno>
+#include <sstream>
+#include <string>
+
+#include "eckit/exception/Exceptions.h"
+#include "eckit/log/Log.h"
+
+#include "gribjump/MetricsRegistry.h"
+
+namespace gribjump {
+
+namespace {
+
+constexpr size_t maxRequestSize = 8192;
+
+/// Scrapes are served one at a time, so a client that stalls may delay the next ones by at most this long
+constexpr int ioTimeoutSeconds = 5;
+
+void setTimeouts(int fd) {
+    struct timeval tv;
+    tv.tv_sec  = ioTimeoutSeconds;
+    tv.tv_usec = 0;
+    if (::setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv)) != 0 ||
+        ::setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv)) != 0) {
+        throw eckit::FailedSystemCall("setsockopt", Here());
+    }
+}
+
+/// Read until the end of the request headers. Request bodies are not expected, so are ignored.
+std::string readRequest(int fd) {
+    std::string request;
+    char buf[1024];
+    while (request.size() < maxRequestSize && request.find("\r\n\r\n") == std::string::npos) {
+        ssize_t n = ::recv(fd, buf, sizeof(buf), 0);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            break;
+        }
+        request.append(buf, n);
+    }
+    return request;
+}
+
+void writeAll(int fd, const std::string& data) {
+    size_t written = 0;
+    while (written < data.size()) {
+        ssize_t n = ::send(fd, data.data() + written, data.size() - written, MSG_NOSIGNAL);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            return;  // client went away, nothing more to do
+        }
+        written += n;
+    }
+}
+
+std::string response(const std::string& status, const std::string& contentType, const std::string& body) {
+    std::ostringstream oss;
+    oss << "HTTP/1.1 " << status << "\r\n"
+        << "Content-Type: " << contentType << "\r\n"
+        << "Content-Length: " << body.size() << "\r\n"
+        << "Connection: close\r\n"
+        << "\r\n"
+        << body;
+    return oss.str();
+}
+
+}  // namespace
+
+//----------------------------------------------------------------------------------------------------------------------
+
+MetricsEndpoint::MetricsEndpoint(int port) : server_(port) {
+    eckit::Log::info() << "Serving metrics on port " << server_.localPort() << " at /metrics" << std::endl;
+}
+
+void MetricsEndpoint::serve(int fd) {
+    setTimeouts(fd);
+
+    // A timed-out read gives a partial or empty request, answered with an error
+    std::istringstream request(readRequest(fd));
+
+    std::string method;
+    std::string target;
+    request >> method >> target;
+
+    // Ignore any query string
+    target = target.substr(0, target.find('?'));
+
+    if (method != "GET" && method != "HEAD") {
+        writeAll(fd, response("405 Method Not Allowed", "text/plain", "Only GET is supported\n"));
+        return;
+    }
+    if (target != "/metrics") {
+        writeAll(fd, response("404 Not Found", "text/plain", "Metrics are served at /metrics\n"));
+        return;
+    }
+
+    std::ostringstream body;
+    MetricsRegistry::instance().exposition(body);
+
+    std::string reply = response("200 OK", "text/plain; version=0.0.4; charset=utf-8", body.str());
+    if (method == "HEAD") {
+        reply.resize(reply.size() - body.str().size());
+    }
+    writeAll(fd, reply);
+}
+
+void MetricsEndpoint::run() {
+    while (!stopped()) {
+        try {
+            eckit::net::TCPSocket& socket = server_.accept("Waiting for metrics scrape");
+            serve(socket.socket());
+            socket.close();
+        }
+        catch (std::exception& e) {
+            eckit::Log::error() << "** " << e.what() << " Caught in " << Here() << std::endl;
+            eckit::Log::error() << "** Exception is ignored" << std::endl;
+        }
+    }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace gribjump
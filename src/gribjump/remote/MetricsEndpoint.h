@@ -0,0 +1,44 @@
+/*
+ * (C) Copyright 2023- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+/// @author Caragh Bradley
+
+#pragma once
+
+#include "eckit/net/TCPServer.h"
+#include "eckit/thread/Thread.h"
+
+namespace gribjump {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/// Minimal HTTP endpoint serving the MetricsRegistry to Prometheus-style scrapers on GET /metrics.
+///
+/// Connections are served one at a time on this thread, so a scrape never competes with extraction workers.
+class MetricsEndpoint : public eckit::Thread {
+public:
+
+    explicit MetricsEndpoint(int port);
+
+    /// Read one HTTP request from the connected socket fd and write the response. Does not close fd.
+    static void serve(int fd);
+
+private:
+
+    void run() override;
+
+private:
+
+    eckit::net::TCPServer server_;
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace gribjump
@@ -203,6 +203,25 @@ std::map<std::string, std::unordered_set<std::string>> Protocol::decodeAxesReply
     return result;
 }
 
+//----------------------------------------------------------------------------------------------------------------------
+// SELECT_POINTS
+
+void Protocol::encodeSelectPointsRequest(eckit::Stream& stream, const GridQuery& query) {
+    stream << query;
+}
+
+GridQuery Protocol::decodeSelectPointsRequest(eckit::Stream& stream) {
+    return GridQuery(stream);
+}
+
+void Protocol::encodeSelectPointsReply(eckit::Stream& stream, const GridSelection& selection) {
+    stream << selection;
+}
+
+GridSelection Protocol::decodeSelectPointsReply(eckit::Stream& stream) {
+    return GridSelection(stream);
+}
+
 //----------------------------------------------------------------------------------------------------------------------
 // FORWARD_SCAN
 
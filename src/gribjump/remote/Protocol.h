@@ -36,6 +36,7 @@
 
 #include "gribjump/ExtractionData.h"
 #include "gribjump/ExtractionItem.h"
+#include "gribjump/GridSelection.h"
 #include "gribjump/Metrics.h"
 #include "gribjump/Types.h"
 
@@ -49,7 +50,8 @@ enum class RequestType : uint16_t {
     AXES,
     SCAN,
     FORWARD_EXTRACT,
-    FORWARD_SCAN
+    FORWARD_SCAN,
+    SELECT_POINTS
 };
 
 constexpr uint16_t remoteProtocolVersion = 3;
@@ -104,6 +106,14 @@ public:
                                 const std::map<std::string, std::unordered_set<std::string>>& axes);
     static std::map<std::string, std::unordered_set<std::string>> decodeAxesReply(eckit::Stream& stream);
 
+    // -- SELECT_POINTS ------------------------------------------------------------------------------------------------
+
+    static void encodeSelectPointsRequest(eckit::Stream& stream, const GridQuery& query);
+    static GridQuery decodeSelectPointsRequest(eckit::Stream& stream);
+
+    static void encodeSelectPointsReply(eckit::Stream& stream, const GridSelection& selection);
+    static GridSelection decodeSelectPointsReply(eckit::Stream& stream);
+
     // -- FORWARD_SCAN (server-to-server) ------------------------------------------------------------------------------
     // The reply is a bare field count, identical to the SCAN reply; reuse
     // encode/decodeScanReply for it.
@@ -10,16 +10,31 @@
 
 /// @author Caragh Bradley
 
+#include <sys/socket.h>
+
 #include "eckit/log/Log.h"
 #include "eckit/log/Timer.h"
 
+#include "gribjump/Cancellation.h"
 #include "gribjump/GribJumpFactory.h"
 #include "gribjump/LogRouter.h"
+#include "gribjump/Tracing.h"
 #include "gribjump/remote/Protocol.h"
 #include "gribjump/remote/RemoteGribJump.h"
 
 namespace gribjump {
 
+namespace {
+
+/// Shut down the connection if the current operation is cancelled, unblocking any send or receive in progress.
+/// The returned registration must not outlive the client.
+CancellationToken::Registration closeOnCancel(eckit::net::TCPClient& client) {
+    int fd = client.socket();
+    return CancellationToken::current().onCancel([fd] { ::shutdown(fd, SHUT_RDWR); });
+}
+
+}  // namespace
+
 RemoteGribJump::RemoteGribJump() {
     std::string uri = ConfigOptions::instance().remoteURI();
 
@@ -36,15 +51,19 @@ RemoteGribJump::RemoteGribJump(eckit::net::Endpoint endpoint) : host_(endpoint.h
 RemoteGribJump::~RemoteGribJump() {}
 
 void RemoteGribJump::sendHeader(eckit::Stream& stream, RequestType type) {
-    Protocol::writeRequestHeader(stream, type, ContextManager::instance().context());
+    // The request carries the current trace span, so the server's spans join the caller's trace
+    Protocol::writeRequestHeader(stream, type, Tracer::instance().inject(ContextManager::instance().context()));
 }
 
 size_t RemoteGribJump::scan(const std::vector<metkit::mars::MarsRequest>& requests, bool byfiles) {
     eckit::Timer timer("RemoteGribJump::scan()", LogRouter::instance().get("timer"));
+    TraceSpan span("RemoteGribJump::scan");
+    span.attribute("endpoint", host_ + ":" + std::to_string(port_));
 
     // connect to server
     eckit::net::TCPClient client;
     eckit::net::InstantTCPStream stream(client.connect(host_, port_));
+    auto cancellation = closeOnCancel(client);
     timer.report("Connection established");
 
     sendHeader(stream, RequestType::SCAN);
@@ -68,8 +87,11 @@ size_t RemoteGribJump::scan(const std::vector<metkit::mars::MarsRequest>& reques
 size_t RemoteGribJump::forwardScan(const std::map<eckit::PathName, eckit::OffsetList>& map) {
     ///@todo we could probably do the connection logic in the ctor
     eckit::Timer timer("RemoteGribJump::scan()", LogRouter::instance().get("timer"));
+    TraceSpan span("RemoteGribJump::forwardScan");
+    span.attribute("endpoint", host_ + ":" + std::to_string(port_));
     eckit::net::TCPClient client;
     eckit::net::InstantTCPStream stream(client.connect(host_, port_));
+    auto cancellation = closeOnCancel(client);
     timer.report("Connection established");
 
     sendHeader(stream, RequestType::FORWARD_SCAN);
@@ -88,11 +110,14 @@ size_t RemoteGribJump::forwardScan(const std::map<eckit::PathName, eckit::Offset
 
 std::vector<std::unique_ptr<ExtractionResult>> RemoteGribJump::extract(std::vector<ExtractionRequest>& requests) {
     eckit::Timer timer("RemoteGribJump::extract()", LogRouter::instance().get("timer"));
+    TraceSpan span("RemoteGribJump::extract");
+    span.attribute("endpoint", host_ + ":" + std::to_string(port_));
     std::vector<std::unique_ptr<ExtractionResult>> result;
 
     // connect to server
     eckit::net::TCPClient client;
     eckit::net::InstantTCPStream stream(client.connect(host_, port_));
+    auto cancellation = closeOnCancel(client);
     timer.report("Connection established");
 
     sendHeader(stream, RequestType::EXTRACT);
@@ -121,10 +146,13 @@ std::vector<std::unique_ptr<ExtractionResult>> RemoteGribJump::extract(std::vect
 void RemoteGribJump::forwardExtract(filemap_t& filemap) {
 
     eckit::Timer timer("RemoteGribJump::forwardExtract()", LogRouter::instance().get("timer"));
+    TraceSpan span("RemoteGribJump::forwardExtract");
+    span.attribute("endpoint", host_ + ":" + std::to_string(port_));
 
     ///@todo we could probably do the connection logic in the ctor
     eckit::net::TCPClient client;
     eckit::net::InstantTCPStream stream(client.connect(host_, port_));
+    auto cancellation = closeOnCancel(client);
     timer.report("Connection established");
 
     sendHeader(stream, RequestType::FORWARD_EXTRACT);
@@ -144,11 +172,14 @@ void RemoteGribJump::forwardExtract(filemap_t& filemap) {
 
 std::map<std::string, std::unordered_set<std::string>> RemoteGribJump::axes(const std::string& request, int level) {
     eckit::Timer timer("RemoteGribJump::axes()", LogRouter::instance().get("timer"));
+    TraceSpan span("RemoteGribJump::axes");
+    span.attribute("endpoint", host_ + ":" + std::to_string(port_));
     std::map<std::string, std::unordered_set<std::string>> result;
 
     // connect to server
     eckit::net::TCPClient client;
     eckit::net::InstantTCPStream stream(client.connect(host_, port_));
+    auto cancellation = closeOnCancel(client);
     timer.report("Connection established");
 
     sendHeader(stream, RequestType::AXES);
@@ -165,6 +196,31 @@ std::map<std::string, std::unordered_set<std::string>> RemoteGribJump::axes(cons
     return result;
 }
 
+GridSelection RemoteGribJump::selectPoints(const GridQuery& query) {
+    eckit::Timer timer("RemoteGribJump::selectPoints()", LogRouter::instance().get("timer"));
+    TraceSpan span("RemoteGribJump::selectPoints");
+    span.attribute("endpoint", host_ + ":" + std::to_string(port_));
+
+    // connect to server
+    eckit::net::TCPClient client;
+    eckit::net::InstantTCPStream stream(client.connect(host_, port_));
+    auto cancellation = closeOnCancel(client);
+    timer.report("Connection established");
+
+    sendHeader(stream, RequestType::SELECT_POINTS);
+    Protocol::encodeSelectPointsRequest(stream, query);
+    timer.report("Request sent");
+
+    // receive response
+
+    Protocol::decodeErrors(stream);
+
+    GridSelection selection = Protocol::decodeSelectPointsReply(stream);
+    timer.report("Selection received");
+
+    return selection;
+}
+
 static GribJumpBuilder<RemoteGribJump> builder("remote");
 
 }  // namespace gribjump
@@ -46,6 +46,8 @@ public:  // methods
 
     std::map<std::string, std::unordered_set<std::string>> axes(const std::string& request, int level) override;
 
+    GridSelection selectPoints(const GridQuery& query) override;
+
 private:  // methods
 
     void sendHeader(eckit::Stream& stream, RequestType type);
@@ -13,14 +13,22 @@
 
 #include "gribjump/remote/Request.h"
 #include <cstddef>
+#include "gribjump/Config.h"
 #include "gribjump/Engine.h"
+#include "gribjump/GribJumpException.h"
 #include "gribjump/remote/Protocol.h"
+#include "gribjump/tools/Workload.h"
 
 namespace {
 static std::atomic<uint64_t> requestid_{0};
 static uint64_t requestid() {
     return requestid_++;
 }
+
+/// Record the full request in the metrics log, for replay by gribjump-load
+void recordWorkload(const gribjump::WorkloadRequest& request) {
+    gribjump::MetricsManager::instance().set("workload", request.value());
+}
 }  // namespace
 
 namespace gribjump {
@@ -48,6 +56,10 @@ ScanRequest::ScanRequest(eckit::Stream& stream, EngineIface& engine) : Request(s
     LOG_DEBUG_LIB(LibGribJump) << "ScanRequest: numRequests=" << requests_.size() << std::endl;
 
     MetricsManager::instance().set("count_scan_requests", requests_.size());
+
+    if (ConfigOptions::instance().metricsRecordRequests()) {
+        recordWorkload(WorkloadRequest::scan(requests_, byfiles_));
+    }
 }
 
 void ScanRequest::execute() {
@@ -73,6 +85,10 @@ ExtractRequest::ExtractRequest(eckit::Stream& stream, EngineIface& engine) : Req
     requests_ = Protocol::decodeExtractRequest(client_);
 
     MetricsManager::instance().set("count_extraction_requests", requests_.size());
+
+    if (ConfigOptions::instance().metricsRecordRequests()) {
+        recordWorkload(WorkloadRequest::extract(requests_));
+    }
 }
 
 void ExtractRequest::execute() {
@@ -184,6 +200,10 @@ AxesRequest::AxesRequest(eckit::Stream& stream, EngineIface& engine) : Request(s
     MetricsManager::instance().set("action", "axes");
     Protocol::decodeAxesRequest(client_, request_, level_);
     ASSERT(request_.size() > 0);
+
+    if (ConfigOptions::instance().metricsRecordRequests()) {
+        recordWorkload(WorkloadRequest::axes(request_, level_));
+    }
 }
 
 void AxesRequest::execute() {
@@ -210,4 +230,34 @@ void AxesRequest::info() const {
 
 //----------------------------------------------------------------------------------------------------------------------
 
+SelectPointsRequest::SelectPointsRequest(eckit::Stream& stream, EngineIface& engine) :
+    Request(stream, engine), query_(Protocol::decodeSelectPointsRequest(client_)) {
+    MetricsManager::instance().set("action", "select_points");
+}
+
+void SelectPointsRequest::execute() {
+    // A grid which is not indexed is the client's error: report it, rather than drop the connection
+    try {
+        selection_ = engine_.selectPoints(query_);
+    }
+    catch (const eckit::UserError& e) {
+        report_ = TaskReport({e.what()});
+    }
+    catch (const DataNotFoundException& e) {
+        report_ = TaskReport({e.what()});
+    }
+    MetricsManager::instance().set("count_selected_points", selection_.size());
+}
+
+void SelectPointsRequest::replyToClient() {
+    Protocol::encodeSelectPointsReply(client_, selection_);
+}
+
+void SelectPointsRequest::info() const {
+    eckit::Log::status() << "New SelectPointsRequest: grid=" << query_.gridHash()
+                         << ", points=" << query_.points().size() << std::endl;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
 }  // namespace gribjump
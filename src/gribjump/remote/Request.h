@@ -170,4 +170,25 @@ private:
 
 //----------------------------------------------------------------------------------------------------------------------
 
+class SelectPointsRequest : public Request {
+public:
+
+    SelectPointsRequest(eckit::Stream& stream, EngineIface& engine);
+
+    ~SelectPointsRequest() = default;
+
+    void execute() override;
+
+    void replyToClient() override;
+
+    void info() const override;
+
+private:
+
+    GridQuery query_;
+    GridSelection selection_;
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+
 }  // namespace gribjump
@@ -18,7 +18,10 @@
 
 #include "gribjump/Config.h"
 #include "gribjump/LibGribJump.h"
+#include "gribjump/MetricsRegistry.h"
+#include "gribjump/Numa.h"
 #include "gribjump/Task.h"
+#include "gribjump/Tracing.h"
 
 namespace gribjump {
 
@@ -32,7 +35,9 @@ WorkQueue::~WorkQueue() {
         std::lock_guard<std::mutex> lock(mtx_);
         closed_ = true;
     }
-    cv_.notify_all();
+    for (auto& shard : shards_) {
+        shard->cv.notify_all();
+    }
 
     for (auto& w : workers_) {
         w.join();
@@ -40,20 +45,39 @@ WorkQueue::~WorkQueue() {
 }
 
 WorkQueue::WorkQueue() {
+    for (size_t c = 0; c < NPRIORITIES; ++c) {
+        weights_[c] = ConfigOptions::instance().priorityWeight(priorityName(static_cast<Priority>(c)));
+    }
+
+    const NumaTopology& numa = NumaTopology::instance();
+    const size_t nodes       = ConfigOptions::instance().schedulerNuma() ? numa.nodes() : 1;
+    for (size_t n = 0; n < nodes; ++n) {
+        shards_.push_back(std::make_unique<Shard>());
+    }
+
     int nthreads = ConfigOptions::instance().numThreads();
-    eckit::Log::info() << "Starting " << eckit::Plural(nthreads, "thread") << " (round-robin work queue)" << std::endl;
+    eckit::Log::info() << "Starting " << eckit::Plural(nthreads, "thread") << " (round-robin work queue";
+    if (nodes > 1) {
+        eckit::Log::info() << ", " << nodes << " NUMA nodes";
+    }
+    eckit::Log::info() << ")" << std::endl;
     for (int i = 0; i < nthreads; ++i) {
-        workers_.emplace_back([this] { workerLoop(); });
+        workers_.emplace_back([this, node = i % nodes] { workerLoop(node); });
     }
 }
 
-void WorkQueue::workerLoop() {
+void WorkQueue::workerLoop(size_t node) {
     LOG_DEBUG_LIB(LibGribJump) << "Thread " << std::this_thread::get_id() << " starting" << std::endl;
 
+    if (shards_.size() > 1 && NumaTopology::instance().pin(node)) {
+        LOG_DEBUG_LIB(LibGribJump) << "Thread " << std::this_thread::get_id() << " pinned to NUMA node " << node
+                                   << std::endl;
+    }
+
     for (;;) {
         eckit::Log::status() << "Waiting for job" << std::endl;
         WorkItem item;
-        if (!popNext(item)) {
+        if (!popNext(node, item)) {
             LOG_DEBUG_LIB(LibGribJump) << "Thread " << std::this_thread::get_id() << " stopping (queue closed)"
                                        << std::endl;
             break;
@@ -75,35 +99,107 @@ void WorkQueue::workerLoop() {
     }
 }
 
-bool WorkQueue::popNext(WorkItem& item) {
+bool WorkQueue::Shard::empty() const {
+    for (const auto& order : rrOrder) {
+        if (!order.empty()) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool WorkQueue::empty() const {
+    for (const auto& shard : shards_) {
+        if (!shard->empty()) {
+            return false;
+        }
+    }
+    return true;
+}
+
+size_t WorkQueue::nextClass(Shard& shard) {
+    // Smooth weighted round-robin: every class with queued tasks earns its weight in credit, the class with the most
+    // credit is served and pays back the total. Ties go to the higher priority class.
+    long total  = 0;
+    size_t best = NPRIORITIES;
+    for (size_t c = 0; c < NPRIORITIES; ++c) {
+        if (shard.rrOrder[c].empty()) {
+            continue;
+        }
+        shard.credits[c] += weights_[c];
+        total += weights_[c];
+        if (best == NPRIORITIES || shard.credits[c] > shard.credits[best]) {
+            best = c;
+        }
+    }
+    ASSERT(best < NPRIORITIES);
+    shard.credits[best] -= total;
+    return best;
+}
+
+bool WorkQueue::popNext(size_t node, WorkItem& item) {
+    static Counter& stolen = MetricsRegistry::instance().counter(
+        "gribjump_workqueue_stolen_total", "Tasks run by a worker of another NUMA node than their own.");
+
     std::unique_lock<std::mutex> lock(mtx_);
-    cv_.wait(lock, [&] { return closed_ || !rrOrder_.empty(); });
+    Shard& own = *shards_[node];
+    if (!closed_ && empty()) {
+        ++own.idle;
+        own.cv.wait(lock, [&] { return closed_ || !empty(); });
+        --own.idle;
+        if (own.woken > 0) {
+            --own.woken;
+        }
+    }
 
-    if (rrOrder_.empty()) {
+    if (empty()) {
         // closed_ must be true here
         return false;
     }
 
-    // Round-robin: serve the group at the front, then rotate it to the back
+    // Serve the worker's own node first, else the next node with queued tasks
+    Shard* shard = &own;
+    for (size_t n = 1; shard->empty(); ++n) {
+        shard = shards_[(node + n) % shards_.size()].get();
+    }
+    if (shard != &own) {
+        stolen.increment();
+    }
+
+    // Round-robin within the chosen class: serve the group at the front, then rotate it to the back
     // (if it still has tasks) or remove it (if drained).
-    TaskGroup* group = rrOrder_.front();
-    rrOrder_.pop_front();
+    size_t c                       = nextClass(*shard);
+    std::list<TaskGroup*>& rrOrder = shard->rrOrder[c];
 
-    auto it = groupQueues_.find(group);
-    ASSERT(it != groupQueues_.end());
+    TaskGroup* group = rrOrder.front();
+    rrOrder.pop_front();
+
+    auto it = shard->groupQueues.find(group);
+    ASSERT(it != shard->groupQueues.end());
     ASSERT(!it->second.empty());
 
-    Task* task = it->second.front();
+    QueuedTask queued = it->second.front();
     it->second.pop_front();
 
     if (it->second.empty()) {
-        groupQueues_.erase(it);
+        shard->groupQueues.erase(it);
     }
     else {
-        rrOrder_.push_back(group);
+        rrOrder.push_back(group);
+    }
+
+    if (rrOrder.empty()) {
+        shard->credits[c] = 0;  // an idle class does not bank credit
     }
 
-    item = WorkItem(task);
+    lock.unlock();
+
+    // The group outlives its queued tasks, as it waits for all of them to complete.
+    Clock::time_point now = Clock::now();
+    group->recordQueueWait(std::chrono::duration<double>(now - queued.queued).count());
+    Tracer::instance().record("queue_wait", group->trace(), queued.queued, now);
+
+    item = WorkItem(queued.task);
     return true;
 }
 
@@ -111,18 +207,55 @@ void WorkQueue::push(TaskGroup* group, Task* task) {
     ASSERT(group != nullptr);
     ASSERT(task != nullptr);
 
+    std::condition_variable* cv = nullptr;
     {
         std::lock_guard<std::mutex> lock(mtx_);
         ASSERT(!closed_);
 
-        auto [it, inserted] = groupQueues_.try_emplace(group);
+        const size_t node = group->node() % shards_.size();
+        Shard& shard      = *shards_[node];
+
+        auto [it, inserted] = shard.groupQueues.try_emplace(group);
         if (inserted) {
-            rrOrder_.push_back(group);
+            shard.rrOrder[static_cast<size_t>(group->priority())].push_back(group);
+        }
+        it->second.push_back(QueuedTask{task, Clock::now()});
+
+        // Wake a worker of the node, or failing that a waiting worker of another node, which will take the task
+        cv = &shard.cv;
+        for (size_t n = 0; n < shards_.size(); ++n) {
+            Shard& candidate = *shards_[(node + n) % shards_.size()];
+            if (candidate.idle > candidate.woken) {
+                ++candidate.woken;
+                cv = &candidate.cv;
+                break;
+            }
         }
-        it->second.push_back(task);
     }
 
-    cv_.notify_one();
+    cv->notify_one();
+}
+
+size_t WorkQueue::remove(TaskGroup* group) {
+    ASSERT(group != nullptr);
+
+    std::lock_guard<std::mutex> lock(mtx_);
+    for (auto& shard : shards_) {
+        auto it = shard->groupQueues.find(group);
+        if (it == shard->groupQueues.end()) {
+            continue;
+        }
+        const size_t removed = it->second.size();
+        shard->groupQueues.erase(it);
+
+        const size_t c = static_cast<size_t>(group->priority());
+        shard->rrOrder[c].remove(group);
+        if (shard->rrOrder[c].empty()) {
+            shard->credits[c] = 0;
+        }
+        return removed;  // a group is queued on a single shard
+    }
+    return 0;
 }
 
 }  // namespace gribjump
@@ -12,15 +12,19 @@
 
 #pragma once
 
+#include <array>
+#include <chrono>
 #include <condition_variable>
 #include <deque>
 #include <list>
+#include <memory>
 #include <mutex>
 #include <thread>
 #include <unordered_map>
 #include <vector>
 
 #include "gribjump/ExtractionData.h"
+#include "gribjump/Priority.h"
 #include "gribjump/remote/WorkItem.h"
 
 namespace gribjump {
@@ -36,6 +40,17 @@ class TaskGroup;
 /// by visiting the groups in round-robin order, so a single very large
 /// TaskGroup cannot block tasks belonging to other groups.
 ///
+/// Groups are further divided by their Priority class, each with its own
+/// round-robin order. When several classes have queued tasks, workers choose
+/// between them by smooth weighted round-robin, so each class receives a share
+/// of the workers proportional to its configured weight and no class starves.
+///
+/// With scheduler.numa on a machine with several NUMA nodes, the queue is sharded by node. Workers are spread evenly
+/// over the nodes and pinned to them, and the tasks of a group are queued on the node of the thread which created the
+/// group: on the server, the node to which GribJumpUser pins the connection thread of the request. A worker serves
+/// its own node first, and takes tasks from the other nodes when its own has none, so no worker idles while tasks are
+/// queued. Otherwise there is a single shard and workers are not pinned.
+///
 /// The queue is unbounded: tasks are small handles whose payloads are already
 /// allocated by the producer before push() is called, so capping the number
 /// of queued tasks does not cap any meaningful resource. Producers never
@@ -55,32 +70,61 @@ public:
     /// Enqueue a task belonging to the given task group. Never blocks.
     void push(TaskGroup* group, Task* task);
 
+    /// Remove the queued tasks of a cancelled group, which will not be run. Returns the number removed.
+    size_t remove(TaskGroup* group);
+
 protected:
 
     WorkQueue();
 
 private:
 
-    void workerLoop();
+    using Clock = std::chrono::steady_clock;
+
+    struct QueuedTask {
+        Task* task;
+        Clock::time_point queued;
+    };
+
+    /// Queued tasks of one NUMA node, and the workers of that node waiting for them
+    struct Shard {
+        /// Per-group FIFO of pending tasks. A group is only present here while
+        /// it has at least one queued task; it is erased once drained and
+        /// re-added on the next push.
+        std::unordered_map<TaskGroup*, std::deque<QueuedTask>> groupQueues;
+
+        /// Round-robin order of groups with pending tasks, per priority class.
+        /// Each TaskGroup appears at most once. The front is the next group to be served.
+        std::array<std::list<TaskGroup*>, NPRIORITIES> rrOrder;
+
+        std::array<long, NPRIORITIES> credits{};  //< running credit of each class for weighted round-robin
+
+        std::condition_variable cv;  //< signalled when tasks become available or the queue is closed
+        size_t idle  = 0;            //< workers of the node waiting on cv
+        size_t woken = 0;            //< of which notified by push() and not yet running
+
+        bool empty() const;
+    };
+
+    void workerLoop(size_t node);
+
+    /// Pop one task from the next group in round-robin order, from the shard of node if it has any, else from
+    /// another. Returns false if the queue has been closed and is empty.
+    bool popNext(size_t node, WorkItem& item);
+
+    /// Choose the priority class of shard to serve next. Requires the lock and at least one queued task.
+    size_t nextClass(Shard& shard);
 
-    /// Pop one task from the next group in round-robin order.
-    /// Returns false if the queue has been closed and is empty.
-    bool popNext(WorkItem& item);
+    bool empty() const;  // requires lock
 
 private:
 
     mutable std::mutex mtx_;
-    std::condition_variable cv_;  //< signalled when tasks become available or the queue is closed
     bool closed_ = false;
 
-    /// Per-group FIFO of pending tasks. A group is only present here while it
-    /// has at least one queued task; it is erased once drained and re-added on
-    /// the next push.
-    std::unordered_map<TaskGroup*, std::deque<Task*>> groupQueues_;
+    std::vector<std::unique_ptr<Shard>> shards_;  //< one per NUMA node, or a single one
 
-    /// Round-robin order of groups with pending tasks. Each TaskGroup appears
-    /// at most once. The front is the next group to be served.
-    std::list<TaskGroup*> rrOrder_;
+    std::array<long, NPRIORITIES> weights_;  //< share of workers per priority class
 
     std::vector<std::thread> workers_;
 };
@@ -0,0 +1,151 @@
+/*
+ * (C) Copyright 2024- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+/// @author Caragh Bradley
+
+#include "gribjump/tools/SyntheticGrib.h"
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+
+#include "eccodes.h"
+#include "eckit/exception/Exceptions.h"
+#include "eckit/utils/Translator.h"
+
+namespace gribjump {
+
+namespace {
+
+constexpr double MEAN      = 280;
+constexpr double AMPLITUDE = 40;
+constexpr double PERIOD    = 1024;  //< in points
+constexpr double MISSING   = 9999;
+
+void check(int err, const std::string& what) {
+    if (err != CODES_SUCCESS) {
+        throw eckit::SeriousBug("Synthetic GRIB: " + what + ": " + codes_get_error_message(err), Here());
+    }
+}
+
+// Stateless hash of a point, uniform in [0, 1)
+double uniform(size_t field, size_t index) {
+    uint64_t x = (static_cast<uint64_t>(field) << 40) ^ index;
+    x += 0x9e3779b97f4a7c15ULL;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+    x = x ^ (x >> 31);
+    return (x >> 11) * 0x1.0p-53;
+}
+
+}  // namespace
+
+//----------------------------------------------------------------------------------------------------------------------
+
+SyntheticGrib::SyntheticGrib(const SyntheticSpec& spec) : spec_(spec) {
+
+    if (spec_.grid.size() < 2 || spec_.grid[0] != 'O') {
+        throw eckit::UserError("Synthetic GRIB: unsupported grid '" + spec_.grid + "', expected O<N>", Here());
+    }
+    const long N = eckit::Translator<std::string, long>()(spec_.grid.substr(1));
+    if (N < 1 || N > 8000) {
+        throw eckit::UserError("Synthetic GRIB: unsupported grid '" + spec_.grid + "'", Here());
+    }
+    if (spec_.packing != "simple" && spec_.packing != "ccsds") {
+        throw eckit::UserError("Synthetic GRIB: unsupported packing '" + spec_.packing + "', expected simple or ccsds",
+                               Here());
+    }
+    if (spec_.bitsPerValue < 1 || spec_.bitsPerValue > 32) {
+        throw eckit::UserError("Synthetic GRIB: bits per value must be between 1 and 32", Here());
+    }
+    if (!(spec_.bitmapDensity > 0 && spec_.bitmapDensity <= 1)) {
+        throw eckit::UserError("Synthetic GRIB: bitmap density must be in (0, 1]", Here());
+    }
+
+    // Octahedral grid: 20 + 4i points on the i-th latitude from each pole
+    std::vector<long> pl(2 * N);
+    for (long i = 0; i < N; ++i) {
+        pl[i] = pl[2 * N - 1 - i] = 20 + 4 * i;
+        numberOfPoints_ += 2 * pl[i];
+    }
+    std::vector<double> lats(2 * N);
+    check(codes_get_gaussian_latitudes(N, lats.data()), "gaussian latitudes of " + spec_.grid);
+
+    template_ = codes_grib_handle_new_from_samples(nullptr, "reduced_gg_sfc_grib2");
+    if (!template_) {
+        throw eckit::SeriousBug("Synthetic GRIB: cannot load sample reduced_gg_sfc_grib2", Here());
+    }
+
+    check(codes_set_long(template_, "setLocalDefinition", 1), "setLocalDefinition");
+    check(codes_set_long(template_, "N", N), "N");
+    check(codes_set_long(template_, "Nj", 2 * N), "Nj");
+    check(codes_set_long_array(template_, "pl", pl.data(), pl.size()), "pl");
+    check(codes_set_double(template_, "latitudeOfFirstGridPointInDegrees", lats.front()), "first latitude");
+    check(codes_set_double(template_, "longitudeOfFirstGridPointInDegrees", 0), "first longitude");
+    check(codes_set_double(template_, "latitudeOfLastGridPointInDegrees", lats.back()), "last latitude");
+    check(codes_set_double(template_, "longitudeOfLastGridPointInDegrees", 360. - 360. / pl[N - 1]), "last longitude");
+
+    check(codes_set_string(template_, "packingType", ("grid_" + spec_.packing).c_str(), nullptr), "packingType");
+    check(codes_set_long(template_, "bitsPerValue", spec_.bitsPerValue), "bitsPerValue");
+    if (spec_.bitmapDensity < 1) {
+        check(codes_set_double(template_, "missingValue", MISSING), "missingValue");
+        check(codes_set_long(template_, "bitmapPresent", 1), "bitmapPresent");
+    }
+}
+
+SyntheticGrib::~SyntheticGrib() {
+    codes_handle_delete(template_);
+}
+
+double SyntheticGrib::value(size_t field, size_t index) {
+    return MEAN + 10 * (field % 8) + AMPLITUDE * std::sin(2 * M_PI * (index % size_t(PERIOD)) / PERIOD);
+}
+
+bool SyntheticGrib::present(size_t field, size_t index) const {
+    return spec_.bitmapDensity >= 1 || uniform(field, index) < spec_.bitmapDensity;
+}
+
+double SyntheticGrib::tolerance() const {
+    // One packing step over the range of a field, and the single-precision reference value
+    return 2 * AMPLITUDE / (std::ldexp(1.0, spec_.bitsPerValue) - 1) + 1e-5 * (MEAN + 70 + AMPLITUDE);
+}
+
+eckit::Buffer SyntheticGrib::encode(size_t field, const std::map<std::string, std::string>& keys) const {
+
+    std::unique_ptr<codes_handle, decltype(&codes_handle_delete)> h(codes_handle_clone(template_),
+                                                                     &codes_handle_delete);
+    if (!h) {
+        throw eckit::SeriousBug("Synthetic GRIB: cannot clone template", Here());
+    }
+
+    for (const auto& [key, v] : keys) {
+        size_t len = v.size();
+        check(codes_set_string(h.get(), key.c_str(), v.c_str(), &len), "key " + key + "=" + v);
+    }
+
+    std::vector<double> values(numberOfPoints_);
+    for (size_t i = 0; i < numberOfPoints_; ++i) {
+        values[i] = present(field, i) ? value(field, i) : MISSING;
+    }
+    check(codes_set_double_array(h.get(), "values", values.data(), values.size()), "values");
+
+    const void* message = nullptr;
+    size_t size         = 0;
+    check(codes_get_message(h.get(), &message, &size), "message");
+
+    eckit::Buffer buffer(size);
+    std::memcpy(buffer.data(), message, size);
+    return buffer;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace gribjump
@@ -0,0 +1,70 @@
+/*
+ * (C) Copyright 2024- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+/// @author Caragh Bradley
+
+#pragma once
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "eckit/io/Buffer.h"
+
+struct grib_handle;
+
+namespace gribjump {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+struct SyntheticSpec {
+    std::string grid     = "O32";     //< Octahedral reduced Gaussian grid, O<N>
+    std::string packing  = "simple";  //< "simple" or "ccsds"
+    long bitsPerValue    = 16;
+    double bitmapDensity = 1.0;  //< Fraction of points present. Below 1, the fields have a bitmap.
+};
+
+/// Generates GRIB2 fields whose values are an analytical function of the field number and the point index, so that
+/// extractions from grids, packings and bitmaps of any size can be checked without a reference decoder.
+class SyntheticGrib {
+public:
+
+    explicit SyntheticGrib(const SyntheticSpec& spec);
+    ~SyntheticGrib();
+
+    SyntheticGrib(const SyntheticGrib&)            = delete;
+    SyntheticGrib& operator=(const SyntheticGrib&) = delete;
+
+    /// Encode field number `field`, with the given MARS keys (e.g. class=rd, param=167, step=0) as one GRIB message
+    eckit::Buffer encode(size_t field, const std::map<std::string, std::string>& keys) const;
+
+    size_t numberOfPoints() const { return numberOfPoints_; }
+
+    /// Value of point `index` of field `field`, before packing
+    static double value(size_t field, size_t index);
+
+    /// Whether point `index` of field `field` is present in the bitmap
+    bool present(size_t field, size_t index) const;
+
+    /// Largest difference between an unpacked value and value()
+    double tolerance() const;
+
+    const SyntheticSpec& spec() const { return spec_; }
+
+private:
+
+    SyntheticSpec spec_;
+    size_t numberOfPoints_ = 0;
+    grib_handle* template_ = nullptr;  //< Sample with the grid and packing set, cloned for each field
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace gribjump
@@ -0,0 +1,176 @@
+/*
+ * (C) Copyright 2023- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+/// @author Caragh Bradley
+
+#include "gribjump/tools/Workload.h"
+
+#include <sstream>
+
+#include "eckit/exception/Exceptions.h"
+
+#include "metkit/mars/MarsExpansion.h"
+#include "metkit/mars/MarsParser.h"
+
+namespace gribjump {
+
+namespace {
+
+std::string member(const eckit::Value& value, const std::string& key) {
+    if (!value.contains(key)) {
+        throw eckit::BadValue("Workload request has no \"" + key + "\"", Here());
+    }
+    return value[key];
+}
+
+}  // namespace
+
+//----------------------------------------------------------------------------------------------------------------------
+
+WorkloadRequest WorkloadRequest::extract(const std::vector<ExtractionRequest>& requests) {
+    WorkloadRequest w(Action::EXTRACT);
+    w.extractionRequests_ = requests;
+    return w;
+}
+
+WorkloadRequest WorkloadRequest::axes(const std::string& request, int level) {
+    WorkloadRequest w(Action::AXES);
+    w.axesRequest_ = request;
+    w.level_       = level;
+    return w;
+}
+
+WorkloadRequest WorkloadRequest::scan(const std::vector<metkit::mars::MarsRequest>& requests, bool byfiles) {
+    WorkloadRequest w(Action::SCAN);
+    for (const auto& request : requests) {
+        w.scanRequests_.push_back(request.asString());
+    }
+    w.byfiles_ = byfiles;
+    return w;
+}
+
+const std::string& WorkloadRequest::actionName() const {
+    static const std::string names[] = {"extract", "axes", "scan"};
+    return names[static_cast<int>(action_)];
+}
+
+eckit::Value WorkloadRequest::value() const {
+    eckit::ValueMap map;
+    map["action"] = actionName();
+
+    switch (action_) {
+        case Action::EXTRACT: {
+            eckit::ValueList requests;
+            for (const auto& request : extractionRequests_) {
+                eckit::ValueList ranges;
+                for (const auto& [begin, end] : request.ranges()) {
+                    ranges.push_back(eckit::Value(eckit::ValueList{static_cast<long long>(begin),
+                                                                   static_cast<long long>(end)}));
+                }
+                eckit::ValueMap r;
+                r["request"]   = request.requestString();
+                r["ranges"]    = eckit::Value(ranges);
+                r["grid_hash"] = request.gridHash();
+                requests.push_back(eckit::Value(r));
+            }
+            map["requests"] = eckit::Value(requests);
+            break;
+        }
+        case Action::AXES:
+            map["request"] = axesRequest_;
+            map["level"]   = level_;
+            break;
+        case Action::SCAN: {
+            eckit::ValueList requests;
+            for (const auto& request : scanRequests_) {
+                requests.push_back(request);
+            }
+            map["requests"] = eckit::Value(requests);
+            map["byfiles"]  = byfiles_;
+            break;
+        }
+    }
+    return eckit::Value(map);
+}
+
+WorkloadRequest WorkloadRequest::fromValue(const eckit::Value& value) {
+    if (!value.isMap()) {
+        throw eckit::BadValue("Workload request is not a JSON object", Here());
+    }
+
+    std::string action = member(value, "action");
+
+    if (action == "extract") {
+        WorkloadRequest w(Action::EXTRACT);
+        eckit::Value requests = value["requests"];
+        for (size_t i = 0; i < requests.size(); ++i) {
+            eckit::Value r      = requests[static_cast<int>(i)];
+            eckit::Value ranges = r["ranges"];
+            std::vector<Range> rs;
+            for (size_t j = 0; j < ranges.size(); ++j) {
+                eckit::Value range = ranges[static_cast<int>(j)];
+                rs.emplace_back(static_cast<long long>(range[0]), static_cast<long long>(range[1]));
+            }
+            std::string gridHash = r.contains("grid_hash") ? std::string(r["grid_hash"]) : std::string();
+            w.extractionRequests_.emplace_back(std::string(r["request"]), rs, gridHash);
+        }
+        if (w.extractionRequests_.empty()) {
+            throw eckit::BadValue("Workload extract request has no requests", Here());
+        }
+        return w;
+    }
+
+    if (action == "axes") {
+        WorkloadRequest w(Action::AXES);
+        w.axesRequest_ = member(value, "request");
+        w.level_       = value.contains("level") ? static_cast<int>(static_cast<long long>(value["level"])) : 3;
+        return w;
+    }
+
+    if (action == "scan") {
+        WorkloadRequest w(Action::SCAN);
+        eckit::Value requests = value["requests"];
+        for (size_t i = 0; i < requests.size(); ++i) {
+            w.scanRequests_.push_back(std::string(requests[static_cast<int>(i)]));
+        }
+        w.byfiles_ = value.contains("byfiles") && static_cast<bool>(value["byfiles"]);
+        return w;
+    }
+
+    throw eckit::BadValue("Unknown workload action '" + action + "'. Expected extract, axes or scan", Here());
+}
+
+std::vector<metkit::mars::MarsRequest> WorkloadRequest::scanRequests() const {
+    std::vector<metkit::mars::MarsRequest> requests;
+    for (const auto& request : scanRequests_) {
+        requests.push_back(parseRequestString(request));
+    }
+    return requests;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+metkit::mars::MarsRequest parseRequestString(const std::string& request) {
+    // A request without a verb starts with a key=value pair
+    std::string first = request.substr(0, request.find(','));
+    std::istringstream in(first.find('=') == std::string::npos ? request : "retrieve," + request);
+
+    metkit::mars::MarsParser parser(in);
+    metkit::mars::MarsExpansion expand(false, true);
+    std::vector<metkit::mars::MarsRequest> requests = expand.expand(parser.parse());
+    if (requests.size() != 1) {
+        throw eckit::UserError("Expected a single MARS request, got " + std::to_string(requests.size()) + " in '" +
+                                   request + "'",
+                               Here());
+    }
+    return requests[0];
+}
+
+}  // namespace gribjump
@@ -0,0 +1,87 @@
+/*
+ * (C) Copyright 2023- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+/// @author Caragh Bradley
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "eckit/value/Value.h"
+
+#include "gribjump/ExtractionData.h"
+#include "metkit/mars/MarsRequest.h"
+
+namespace gribjump {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/// One request of a workload replayed by gribjump-load: an extract, axes or scan call with its full arguments.
+///
+/// Workloads are stored as JSON lines, one request per line, e.g.
+///   {"action":"extract","requests":[{"request":"class=od,...","ranges":[[0,10],[20,30]],"grid_hash":"..."}]}
+///   {"action":"axes","request":"class=od,expver=0001","level":3}
+///   {"action":"scan","requests":["retrieve,class=od,..."],"byfiles":false}
+/// gribjump-server writes the same objects to its metrics log when server.metrics.recordRequests is set.
+class WorkloadRequest {
+public:
+
+    enum class Action {
+        EXTRACT,
+        AXES,
+        SCAN
+    };
+
+    static WorkloadRequest extract(const std::vector<ExtractionRequest>& requests);
+    static WorkloadRequest axes(const std::string& request, int level);
+    static WorkloadRequest scan(const std::vector<metkit::mars::MarsRequest>& requests, bool byfiles);
+
+    /// Parse the JSON representation. Throws eckit::BadValue if it is not a valid workload request.
+    static WorkloadRequest fromValue(const eckit::Value& value);
+
+    eckit::Value value() const;
+
+    Action action() const { return action_; }
+    const std::string& actionName() const;
+
+    const std::vector<ExtractionRequest>& extractionRequests() const { return extractionRequests_; }
+
+    const std::string& axesRequest() const { return axesRequest_; }
+    int level() const { return level_; }
+
+    /// Parsed scan requests
+    std::vector<metkit::mars::MarsRequest> scanRequests() const;
+    bool byfiles() const { return byfiles_; }
+
+private:
+
+    explicit WorkloadRequest(Action action) : action_(action) {}
+
+private:
+
+    Action action_;
+
+    std::vector<ExtractionRequest> extractionRequests_;
+
+    std::string axesRequest_;
+    int level_ = 3;
+
+    std::vector<std::string> scanRequests_;
+    bool byfiles_ = false;
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/// Parse a single MARS request, e.g. "class=od,expver=0001,param=2t", with or without a leading verb, expanding its
+/// values. Throws eckit::UserError if the string does not hold exactly one request.
+metkit::mars::MarsRequest parseRequestString(const std::string& request);
+
+}  // namespace gribjump
@@ -0,0 +1,267 @@
+/*
+ * (C) Copyright 2024- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+/// @author Caragh Bradley
+
+/// Tool to generate a corpus of synthetic GRIB fields, with a chosen grid, packing, bits per value and bitmap density,
+/// into a file or the configured FDB. Field values are known analytically (see SyntheticGrib), so with --check the
+/// tool extracts ranges of every field with gribjump and verifies them.
+
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <random>
+#include <sstream>
+
+#include "eckit/exception/Exceptions.h"
+#include "eckit/io/FileHandle.h"
+#include "eckit/io/MemoryHandle.h"
+#include "eckit/log/Timer.h"
+#include "eckit/testing/Test.h"
+#include "eckit/utils/StringTools.h"
+#include "fdb5/api/FDB.h"
+
+#include "gribjump/GribJump.h"
+#include "gribjump/tools/GribJumpTool.h"
+#include "gribjump/tools/SyntheticGrib.h"
+#include "gribjump/tools/Workload.h"
+
+namespace gribjump::tool {
+
+class Generate : public GribJumpTool {
+
+    void execute(const eckit::option::CmdArgs& args) override;
+    void usage(const std::string& tool) const override;
+    int numberOfPositionalArguments() const override { return 0; }
+
+public:
+
+    Generate(int argc, char** argv) : GribJumpTool(argc, argv, "gribjump-generate") {
+        options_.push_back(new eckit::option::SimpleOption<std::string>(
+            "grid", "Octahedral reduced Gaussian grid, e.g. O1280 or O2560. Default O32."));
+        options_.push_back(
+            new eckit::option::SimpleOption<std::string>("packing", "simple or ccsds. Default simple."));
+        options_.push_back(new eckit::option::SimpleOption<long>("bits-per-value", "Default 16."));
+        options_.push_back(new eckit::option::SimpleOption<double>(
+            "bitmap-density", "Fraction of points present. Below 1, fields have a bitmap. Default 1."));
+        options_.push_back(new eckit::option::SimpleOption<long>(
+            "fields", "Number of fields, with steps 0 to fields-1. Default 10."));
+        options_.push_back(new eckit::option::SimpleOption<std::string>(
+            "request", "MARS keys of the fields. Default "
+                       "class=rd,expver=xxxx,stream=oper,type=fc,levtype=sfc,param=167,date=20240101,time=1200."));
+        options_.push_back(new eckit::option::SimpleOption<std::string>(
+            "output", "Write the fields to this file. Default synthetic.grib."));
+        options_.push_back(new eckit::option::SimpleOption<bool>(
+            "fdb", "Archive the fields into the FDB given by FDB5_CONFIG_FILE, instead of a file."));
+        options_.push_back(new eckit::option::SimpleOption<bool>(
+            "check", "Extract ranges of every field with gribjump and compare them with the expected values."));
+        options_.push_back(new eckit::option::SimpleOption<long>(
+            "check-ranges", "Number of ranges extracted from each field with --check. Default 16."));
+        options_.push_back(
+            new eckit::option::SimpleOption<long>("seed", "Seed of the ranges extracted with --check. Default 42."));
+    }
+
+private:
+
+    std::vector<Range> randomRanges(size_t npoints, size_t nranges);
+
+    /// Compare the extracted values of field `field` with the expected values. Returns the number of values checked.
+    size_t check(const SyntheticGrib& grib, size_t field, const std::vector<Range>& ranges,
+                 const ExtractionResult& result) const;
+
+private:
+
+    std::mt19937_64 rng_;
+};
+
+void Generate::usage(const std::string& tool) const {
+    eckit::Log::info() << std::endl
+                       << "Usage: " << tool << " [--grid=O1280] [--packing=ccsds] [--bits-per-value=16]"
+                       << " [--bitmap-density=0.5] [--fields=100] [--output=<file> | --fdb] [--check]" << std::endl;
+    GribJumpTool::usage(tool);
+}
+
+std::vector<Range> Generate::randomRanges(size_t npoints, size_t nranges) {
+    // Sorted, disjoint ranges of up to 100 points, always including the first and last points of the field
+    nranges = std::max<size_t>(std::min(nranges, npoints / 2), 2);
+    std::vector<size_t> bounds{0, npoints};
+    std::uniform_int_distribution<size_t> point(1, npoints - 1);
+    while (bounds.size() < 2 * nranges) {
+        bounds.push_back(point(rng_));
+        std::sort(bounds.begin(), bounds.end());
+        bounds.erase(std::unique(bounds.begin(), bounds.end()), bounds.end());
+    }
+
+    std::vector<Range> ranges;
+    for (size_t i = 0; i < bounds.size(); i += 2) {
+        size_t begin = bounds[i];
+        size_t end   = bounds[i + 1];
+        if (i + 2 == bounds.size()) {
+            begin = std::max(begin, end - std::min<size_t>(end - begin, 100));
+        }
+        else {
+            end = std::min(end, begin + 100);
+        }
+        ranges.emplace_back(begin, end);
+    }
+    return ranges;
+}
+
+size_t Generate::check(const SyntheticGrib& grib, size_t field, const std::vector<Range>& ranges,
+                       const ExtractionResult& result) const {
+    ASSERT(result.nrange() == ranges.size());
+
+    size_t count = 0;
+    for (size_t r = 0; r < ranges.size(); ++r) {
+        Span<const double> values  = result.values(r);
+        Span<const uint64_t> masks = result.mask(r);
+        ASSERT(values.size() == ranges[r].second - ranges[r].first);
+
+        for (size_t j = 0; j < values.size(); ++j) {
+            const size_t index   = ranges[r].first + j;
+            const bool present   = grib.present(field, index);
+            const bool extracted = (masks[j / 64] >> (j % 64)) & 1;
+            const double error   = present ? std::abs(values[j] - SyntheticGrib::value(field, index)) : 0;
+
+            if (present != extracted || error > grib.tolerance()) {
+                std::ostringstream msg;
+                msg << "Field " << field << ", point " << index << ": expected "
+                    << (present ? std::to_string(SyntheticGrib::value(field, index)) : "missing") << ", extracted "
+                    << (extracted ? std::to_string(values[j]) : "missing") << " (tolerance " << grib.tolerance()
+                    << ")";
+                throw eckit::SeriousBug(msg.str(), Here());
+            }
+            ++count;
+        }
+    }
+    return count;
+}
+
+void Generate::execute(const eckit::option::CmdArgs& args) {
+
+    SyntheticSpec spec;
+    spec.grid          = args.getString("grid", spec.grid);
+    spec.packing       = args.getString("packing", spec.packing);
+    spec.bitsPerValue  = args.getLong("bits-per-value", spec.bitsPerValue);
+    spec.bitmapDensity = args.getDouble("bitmap-density", spec.bitmapDensity);
+
+    const size_t nfields      = args.getLong("fields", 10);
+    const bool toFDB          = args.getBool("fdb", false);
+    const bool doCheck        = args.getBool("check", false);
+    const size_t nranges      = args.getLong("check-ranges", 16);
+    const std::string output  = args.getString("output", "synthetic.grib");
+    const std::string request = args.getString(
+        "request", "class=rd,expver=xxxx,stream=oper,type=fc,levtype=sfc,param=167,date=20240101,time=1200");
+    rng_.seed(args.getLong("seed", 42));
+
+    std::map<std::string, std::string> keys;
+    for (const std::string& item : eckit::StringTools::split(",", request)) {
+        std::vector<std::string> kv = eckit::StringTools::split("=", item);
+        if (kv.size() != 2) {
+            throw eckit::UserError("Invalid key in --request: '" + item + "'", Here());
+        }
+        keys[kv[0]] = kv[1];
+    }
+
+    SyntheticGrib grib(spec);
+    eckit::Log::info() << "Generating " << nfields << " fields of " << grib.numberOfPoints() << " points ("
+                       << spec.grid << ", " << spec.packing << ", " << spec.bitsPerValue << " bits per value, bitmap "
+                       << "density " << spec.bitmapDensity << ")" << std::endl;
+
+    // Generate and write
+
+    eckit::Timer timer;
+    std::vector<eckit::Offset> offsets;
+    size_t bytes = 0;
+    {
+        std::unique_ptr<fdb5::FDB> fdb;
+        std::unique_ptr<eckit::DataHandle> file;
+        if (toFDB) {
+            fdb = std::make_unique<fdb5::FDB>();
+        }
+        else {
+            file = std::make_unique<eckit::FileHandle>(output);
+            file->openForWrite(0);
+        }
+
+        for (size_t field = 0; field < nfields; ++field) {
+            keys["step"]         = std::to_string(field);
+            eckit::Buffer buffer = grib.encode(field, keys);
+            if (fdb) {
+                eckit::MemoryHandle handle(buffer.data(), buffer.size());
+                fdb->archive(handle);
+            }
+            else {
+                offsets.push_back(bytes);
+                ASSERT(file->write(buffer.data(), buffer.size()) == static_cast<long>(buffer.size()));
+            }
+            bytes += buffer.size();
+        }
+
+        if (fdb) {
+            fdb->flush();
+        }
+        else {
+            file->close();
+        }
+    }
+    eckit::Log::info() << "Wrote " << bytes << " bytes to " << (toFDB ? std::string("the FDB") : output) << " in "
+                       << timer.elapsed() << "s" << std::endl;
+
+    if (!doCheck) {
+        return;
+    }
+
+    // Extract and compare
+
+    timer.start();
+    std::vector<std::vector<Range>> ranges;
+    for (size_t field = 0; field < nfields; ++field) {
+        ranges.push_back(randomRanges(grib.numberOfPoints(), nranges));
+    }
+
+    GribJump gj;
+    size_t checked = 0;
+    if (toFDB) {
+        // Synthetic fields have no grid hash to check against
+        eckit::testing::SetEnv ignoreGrid{"GRIBJUMP_IGNORE_GRID", "1"};
+        std::vector<ExtractionRequest> requests;
+        for (size_t field = 0; field < nfields; ++field) {
+            keys["step"] = std::to_string(field);
+            std::string fieldRequest;
+            for (const auto& [k, v] : keys) {
+                fieldRequest += (fieldRequest.empty() ? "" : ",") + k + "=" + v;
+            }
+            requests.emplace_back(parseRequestString(fieldRequest).asString(), ranges[field]);
+        }
+        ExtractionIterator it = gj.extract(requests, ctx_);
+        for (size_t field = 0; field < nfields; ++field) {
+            ASSERT(it.hasNext());
+            checked += check(grib, field, ranges[field], *it.next());
+        }
+    }
+    else {
+        ExtractionIterator it = gj.extract(eckit::PathName(output), offsets, ranges, ctx_);
+        for (size_t field = 0; field < nfields; ++field) {
+            ASSERT(it.hasNext());
+            checked += check(grib, field, ranges[field], *it.next());
+        }
+    }
+
+    eckit::Log::info() << "Checked " << checked << " values of " << nfields << " fields in " << timer.elapsed()
+                       << "s. All match." << std::endl;
+}
+
+}  // namespace gribjump::tool
+
+int main(int argc, char** argv) {
+    gribjump::tool::Generate app(argc, argv);
+    return app.start();
+}
@@ -0,0 +1,540 @@
+/*
+ * (C) Copyright 2023- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+/// @author Caragh Bradley
+
+/// Load generator: replays a recorded or synthetic mix of extract, axes and scan requests against gribjump, at a fixed
+/// concurrency or arrival rate, and reports throughput, latency percentiles and error rates.
+/// Requests go to whichever gribjump the configuration selects: a gribjump-server (type: remote) or in-process.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <deque>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <thread>
+
+#include "eckit/exception/Exceptions.h"
+#include "eckit/log/JSON.h"
+#include "eckit/parser/JSONParser.h"
+#include "eckit/testing/Test.h"
+#include "eckit/utils/StringTools.h"
+
+#include "gribjump/Config.h"
+#include "gribjump/GribJump.h"
+#include "gribjump/tools/GribJumpTool.h"
+#include "gribjump/tools/ToolUtils.h"
+#include "gribjump/tools/Workload.h"
+
+namespace gribjump::tool {
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+struct Sample {
+    std::string action;
+    double latency;  //< seconds, from the request's scheduled start to its completion
+    size_t values;   //< values extracted
+    std::string error;
+};
+
+/// Nearest-rank percentile of sorted values
+double percentile(const std::vector<double>& sorted, double p) {
+    if (sorted.empty()) {
+        return 0;
+    }
+    size_t rank = static_cast<size_t>(std::ceil(p * sorted.size()));
+    return sorted[std::max<size_t>(rank, 1) - 1];
+}
+
+void latencyJSON(eckit::JSON& j, std::vector<double> latencies) {
+    std::sort(latencies.begin(), latencies.end());
+    double total = 0;
+    for (double l : latencies) {
+        total += l;
+    }
+    j.startObject();
+    j << "mean" << (latencies.empty() ? 0.0 : total / latencies.size());
+    j << "p50" << percentile(latencies, 0.50);
+    j << "p90" << percentile(latencies, 0.90);
+    j << "p99" << percentile(latencies, 0.99);
+    j << "max" << (latencies.empty() ? 0.0 : latencies.back());
+    j.endObject();
+}
+
+/// Requests waiting for a worker, with the time at which each was due to start.
+class ArrivalQueue {
+public:
+
+    void push(size_t index, Clock::time_point due) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        queue_.emplace_back(index, due);
+        cv_.notify_one();
+    }
+
+    void close() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        closed_ = true;
+        cv_.notify_all();
+    }
+
+    /// False once the queue is closed and empty
+    bool pop(size_t& index, Clock::time_point& due) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        cv_.wait(lock, [this] { return closed_ || !queue_.empty(); });
+        if (queue_.empty()) {
+            return false;
+        }
+        std::tie(index, due) = queue_.front();
+        queue_.pop_front();
+        return true;
+    }
+
+private:
+
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::deque<std::pair<size_t, Clock::time_point>> queue_;
+    bool closed_ = false;
+};
+
+}  // namespace
+
+//----------------------------------------------------------------------------------------------------------------------
+
+class Load : public GribJumpTool {
+
+    void execute(const eckit::option::CmdArgs& args) override;
+    void usage(const std::string& tool) const override;
+    int numberOfPositionalArguments() const override { return 0; }
+
+public:
+
+    Load(int argc, char** argv) : GribJumpTool(argc, argv, "gribjump-load") {
+        options_.push_back(new eckit::option::SimpleOption<std::string>(
+            "workload", "Replay the requests of this workload file (JSON lines, e.g. written by --record)."));
+        options_.push_back(new eckit::option::SimpleOption<std::string>(
+            "record", "Write the requests recorded in this server metrics log to --output as a workload, and exit."));
+        options_.push_back(new eckit::option::SimpleOption<std::string>(
+            "request", "Generate a synthetic workload of requests for the fields matching this MARS request."));
+        options_.push_back(new eckit::option::SimpleOption<std::string>(
+            "mix", "Relative weights of the synthetic request types. Default: extract=1,axes=0,scan=0."));
+        options_.push_back(new eckit::option::SimpleOption<long>(
+            "ranges", "Number of ranges of each synthetic extraction. Default 4."));
+        options_.push_back(new eckit::option::SimpleOption<long>(
+            "range-length", "Number of values in each range of a synthetic extraction. Default 10."));
+        options_.push_back(new eckit::option::SimpleOption<long>(
+            "points", "Synthetic ranges are drawn from the first <points> points of each field. Default 1000."));
+        options_.push_back(new eckit::option::SimpleOption<std::string>(
+            "grid-hash", "Grid hash of the synthetic extractions. If unset, grid hashes are not checked locally."));
+        options_.push_back(
+            new eckit::option::SimpleOption<long>("level", "Level of synthetic axes requests. Default 3."));
+        options_.push_back(new eckit::option::SimpleOption<long>(
+            "concurrency", "Number of requests in flight at once (closed loop), or of workers (with --rate). "
+                           "Default 1."));
+        options_.push_back(new eckit::option::SimpleOption<double>(
+            "rate", "Start requests at this mean rate per second, with Poisson arrivals (open loop)."));
+        options_.push_back(new eckit::option::SimpleOption<long>(
+            "count", "Number of requests to send. Default: one pass over the workload, or 100 synthetic requests."));
+        options_.push_back(new eckit::option::SimpleOption<double>(
+            "duration", "Stop sending requests after this many seconds."));
+        options_.push_back(
+            new eckit::option::SimpleOption<long>("seed", "Seed of the synthetic workload and arrivals. Default 42."));
+        options_.push_back(new eckit::option::SimpleOption<std::string>(
+            "output", "Write the report (or, with --record, the workload) to this file instead of stdout."));
+    }
+
+private:
+
+    void record(const std::string& metricsLog, std::ostream& out) const;
+
+    std::vector<WorkloadRequest> readWorkload(const std::string& path) const;
+    std::vector<WorkloadRequest> syntheticWorkload(const eckit::option::CmdArgs& args, size_t count);
+
+    /// Send one request, returning its sample without the latency
+    Sample run(GribJump& gj, const WorkloadRequest& request) const;
+
+    void report(std::ostream& out, const std::vector<Sample>& samples, double elapsed) const;
+
+private:
+
+    size_t concurrency_ = 1;
+    double rate_        = 0;
+    std::mt19937_64 rng_;
+};
+
+void Load::usage(const std::string& tool) const {
+    eckit::Log::info() << std::endl
+                       << "Usage: " << tool << " --workload=<file> [--concurrency=<n> | --rate=<r>] [--count=<n>]"
+                       << " [--duration=<s>]" << std::endl
+                       << "       " << tool << " --request=<mars request> [--mix=extract=8,axes=1,scan=1] ..."
+                       << std::endl
+                       << "       " << tool << " --record=<metrics log> --output=<workload file>" << std::endl;
+    GribJumpTool::usage(tool);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+void Load::record(const std::string& metricsLog, std::ostream& out) const {
+    std::ifstream in(metricsLog);
+    if (!in) {
+        throw eckit::CantOpenFile(metricsLog, Here());
+    }
+
+    size_t recorded = 0;
+    size_t skipped  = 0;
+    std::string line;
+    while (std::getline(in, line)) {
+        // Metrics lines may carry a prefix before the JSON object
+        size_t start = line.find('{');
+        if (start == std::string::npos) {
+            continue;
+        }
+
+        eckit::Value metrics;
+        try {
+            metrics = eckit::JSONParser::decodeString(line.substr(start));
+        }
+        catch (const eckit::Exception&) {
+            ++skipped;
+            continue;
+        }
+
+        if (!metrics.isMap() || !metrics.contains("workload")) {
+            ++skipped;
+            continue;
+        }
+
+        WorkloadRequest request = WorkloadRequest::fromValue(metrics["workload"]);
+        eckit::JSON j(out, false);
+        j << request.value();
+        out << std::endl;
+        ++recorded;
+    }
+
+    eckit::Log::info() << "Recorded " << recorded << " requests from " << metricsLog << ", skipped " << skipped
+                       << " other lines" << std::endl;
+    if (recorded == 0) {
+        throw eckit::UserError("No recorded requests in " + metricsLog +
+                                   ". Recording requires server.metrics.recordRequests (or "
+                                   "GRIBJUMP_METRICS_RECORD_REQUESTS=1) on the server.",
+                               Here());
+    }
+}
+
+std::vector<WorkloadRequest> Load::readWorkload(const std::string& path) const {
+    std::ifstream in(path);
+    if (!in) {
+        throw eckit::CantOpenFile(path, Here());
+    }
+
+    std::vector<WorkloadRequest> workload;
+    std::string line;
+    while (std::getline(in, line)) {
+        if (eckit::StringTools::trim(line).empty()) {
+            continue;
+        }
+        workload.push_back(WorkloadRequest::fromValue(eckit::JSONParser::decodeString(line)));
+    }
+    if (workload.empty()) {
+        throw eckit::UserError("Workload " + path + " contains no requests", Here());
+    }
+    return workload;
+}
+
+std::vector<WorkloadRequest> Load::syntheticWorkload(const eckit::option::CmdArgs& args, size_t count) {
+    std::string request = args.getString("request");
+    if (request.find("retrieve,") == 0) {
+        request = request.substr(9);
+    }
+
+    // Weights of extract, axes and scan
+    std::vector<double> weights = {1, 0, 0};
+    std::string mix             = args.getString("mix", "");
+    for (const std::string& item : eckit::StringTools::split(",", mix)) {
+        std::vector<std::string> kv = eckit::StringTools::split("=", item);
+        if (kv.size() != 2) {
+            throw eckit::UserError("Invalid --mix entry '" + item + "', expected e.g. extract=8", Here());
+        }
+        const std::vector<std::string> names = {"extract", "axes", "scan"};
+        auto it                              = std::find(names.begin(), names.end(), kv[0]);
+        if (it == names.end()) {
+            throw eckit::UserError("Unknown request type '" + kv[0] + "' in --mix", Here());
+        }
+        weights[it - names.begin()] = std::stod(kv[1]);
+    }
+
+    const size_t nranges  = args.getLong("ranges", 4);
+    const size_t length   = args.getLong("range-length", 10);
+    const size_t points   = args.getLong("points", 1000);
+    const int level       = args.getLong("level", 3);
+    std::string gridHash  = args.getString("grid-hash", "");
+    const size_t slotSize = nranges > 0 ? points / nranges : 0;
+    if (nranges == 0 || length == 0 || length > slotSize) {
+        throw eckit::UserError("--ranges of --range-length values must fit in --points", Here());
+    }
+
+    metkit::mars::MarsRequest marsRequest         = parseRequestString(request);
+    std::vector<metkit::mars::MarsRequest> fields = flattenRequest(marsRequest);
+
+    std::discrete_distribution<int> action(weights.begin(), weights.end());
+    std::uniform_int_distribution<size_t> offset(0, slotSize - length);
+
+    std::vector<WorkloadRequest> workload;
+    for (size_t i = 0; i < count; ++i) {
+        switch (static_cast<WorkloadRequest::Action>(action(rng_))) {
+            case WorkloadRequest::Action::EXTRACT: {
+                // One range in each of nranges equal slots, so that ranges are sorted and disjoint
+                std::vector<ExtractionRequest> requests;
+                for (const auto& field : fields) {
+                    std::vector<Range> ranges;
+                    for (size_t r = 0; r < nranges; ++r) {
+                        size_t begin = r * slotSize + offset(rng_);
+                        ranges.emplace_back(begin, begin + length);
+                    }
+                    requests.emplace_back(field.asString(), ranges, gridHash);
+                }
+                workload.push_back(WorkloadRequest::extract(requests));
+                break;
+            }
+            case WorkloadRequest::Action::AXES:
+                workload.push_back(WorkloadRequest::axes(request, level));
+                break;
+            case WorkloadRequest::Action::SCAN:
+                workload.push_back(WorkloadRequest::scan({marsRequest}, false));
+                break;
+        }
+    }
+    return workload;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+Sample Load::run(GribJump& gj, const WorkloadRequest& request) const {
+    Sample sample{request.actionName(), 0, 0, ""};
+    try {
+        switch (request.action()) {
+            case WorkloadRequest::Action::EXTRACT: {
+                std::vector<ExtractionRequest> requests = request.extractionRequests();
+                ExtractionIterator it                   = gj.extract(requests, ctx_);
+                while (it.hasNext()) {
+                    sample.values += it.next()->total_values();
+                }
+                break;
+            }
+            case WorkloadRequest::Action::AXES:
+                gj.axes(request.axesRequest(), request.level(), ctx_);
+                break;
+            case WorkloadRequest::Action::SCAN:
+                gj.scan(request.scanRequests(), request.byfiles(), ctx_);
+                break;
+        }
+    }
+    catch (const std::exception& e) {
+        sample.error = e.what();
+    }
+    return sample;
+}
+
+void Load::report(std::ostream& out, const std::vector<Sample>& samples, double elapsed) const {
+
+    std::map<std::string, std::vector<const Sample*>> byAction;
+    for (const auto& s : samples) {
+        byAction[s.action].push_back(&s);
+    }
+
+    auto summarise = [&](eckit::JSON& j, const std::vector<const Sample*>& group) {
+        std::vector<double> latencies;
+        size_t errors = 0;
+        size_t values = 0;
+        for (const Sample* s : group) {
+            latencies.push_back(s->latency);
+            errors += !s->error.empty();
+            values += s->values;
+        }
+        j << "requests" << static_cast<long long>(group.size());
+        j << "errors" << static_cast<long long>(errors);
+        j << "error_rate" << (group.empty() ? 0.0 : double(errors) / group.size());
+        j << "throughput_rps" << (elapsed > 0 ? group.size() / elapsed : 0.0);
+        j << "values" << static_cast<long long>(values);
+        j << "latency_s";
+        latencyJSON(j, latencies);
+    };
+
+    std::vector<const Sample*> all;
+    std::vector<std::string> errors;
+    for (const auto& s : samples) {
+        all.push_back(&s);
+        if (!s.error.empty() && errors.size() < 5 && std::find(errors.begin(), errors.end(), s.error) == errors.end()) {
+            errors.push_back(s.error);
+        }
+    }
+
+    const ConfigOptions& config = ConfigOptions::instance();
+
+    eckit::JSON j(out, false);
+    j.startObject();
+    j << "target" << (config.configType() == "remote" ? "remote " + config.remoteURI() : config.configType());
+    j << "mode" << (rate_ > 0 ? "open" : "closed");
+    j << "concurrency" << static_cast<long long>(concurrency_);
+    if (rate_ > 0) {
+        j << "rate" << rate_;
+    }
+    j << "elapsed_s" << elapsed;
+    summarise(j, all);
+    j << "actions";
+    j.startObject();
+    for (const auto& [name, group] : byAction) {
+        if (group.empty()) {
+            continue;
+        }
+        j << name;
+        j.startObject();
+        summarise(j, group);
+        j.endObject();
+    }
+    j.endObject();
+    j << "first_errors";
+    j.startList();
+    for (const auto& e : errors) {
+        j << e;
+    }
+    j.endList();
+    j.endObject();
+    out << std::endl;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+void Load::execute(const eckit::option::CmdArgs& args) {
+
+    std::ofstream file;
+    std::string output = args.getString("output", "");
+    if (!output.empty()) {
+        file.open(output);
+        if (!file) {
+            throw eckit::CantOpenFile(output, Here());
+        }
+    }
+    std::ostream& out = output.empty() ? eckit::Log::info() : file;
+
+    if (args.has("record")) {
+        record(args.getString("record"), out);
+        return;
+    }
+
+    concurrency_ = args.getLong("concurrency", 1);
+    rate_        = args.getDouble("rate", 0);
+    rng_.seed(args.getLong("seed", 42));
+    if (concurrency_ == 0) {
+        throw eckit::UserError("--concurrency must be at least 1", Here());
+    }
+
+    const double duration = args.getDouble("duration", 0);
+    const bool hasCount   = args.has("count");
+
+    std::vector<WorkloadRequest> workload;
+    if (args.has("workload")) {
+        workload = readWorkload(args.getString("workload"));
+    }
+    else if (args.has("request")) {
+        workload = syntheticWorkload(args, hasCount ? args.getLong("count") : 100);
+    }
+    else {
+        usage("gribjump-load");
+        throw eckit::UserError("One of --workload, --request or --record is required", Here());
+    }
+
+    // By default, one pass over the workload. A duration without a count runs until the time is up.
+    size_t count = hasCount ? args.getLong("count") : (duration > 0 ? SIZE_MAX : workload.size());
+
+    // Synthetic extractions of unknown grids cannot be checked against their grid hash
+    std::unique_ptr<eckit::testing::SetEnv> ignoreGrid;
+    if (args.has("request") && args.getString("grid-hash", "").empty()) {
+        ignoreGrid = std::make_unique<eckit::testing::SetEnv>("GRIBJUMP_IGNORE_GRID", "1");
+    }
+
+    std::vector<std::vector<Sample>> samples(concurrency_);
+    const Clock::time_point start = Clock::now();
+    const Clock::time_point end =
+        duration > 0 ? start + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(duration))
+                     : Clock::time_point::max();
+
+    ArrivalQueue arrivals;
+    std::atomic<size_t> next{0};
+
+    auto worker = [&](size_t w) {
+        GribJump gj;
+        size_t index;
+        Clock::time_point due;
+        while (true) {
+            if (rate_ > 0) {
+                if (!arrivals.pop(index, due)) {
+                    return;
+                }
+            }
+            else {
+                index = next++;
+                due   = Clock::now();
+                if (index >= count || due >= end) {
+                    return;
+                }
+            }
+            Sample sample  = run(gj, workload[index % workload.size()]);
+            sample.latency = std::chrono::duration<double>(Clock::now() - due).count();
+            samples[w].push_back(std::move(sample));
+        }
+    };
+
+    std::vector<std::thread> workers;
+    for (size_t w = 0; w < concurrency_; ++w) {
+        workers.emplace_back(worker, w);
+    }
+
+    if (rate_ > 0) {
+        // Latency is measured from when each request was due, so that it includes any wait for a free worker
+        std::exponential_distribution<double> interval(rate_);
+        Clock::time_point due = start;
+        for (size_t index = 0; index < count; ++index) {
+            due += std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(interval(rng_)));
+            if (due >= end) {
+                break;
+            }
+            std::this_thread::sleep_until(due);
+            arrivals.push(index, due);
+        }
+        arrivals.close();
+    }
+
+    for (auto& t : workers) {
+        t.join();
+    }
+    double elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+
+    std::vector<Sample> all;
+    for (auto& s : samples) {
+        std::move(s.begin(), s.end(), std::back_inserter(all));
+    }
+    report(out, all, elapsed);
+}
+
+}  // namespace gribjump::tool
+
+int main(int argc, char** argv) {
+    gribjump::tool::Load app(argc, argv);
+    return app.start();
+}
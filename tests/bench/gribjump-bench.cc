@@ -0,0 +1,773 @@
+/*
+ * (C) Copyright 2023- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+/// @author Caragh Bradley
+
+/// Microbenchmarks of the decoders, jumpers and index cache, for tracking performance regressions between releases.
+///
+/// Each benchmark case is written as one JSON object per line, e.g.
+///   {"benchmark":"simple_decode","params":{"bits_per_value":16,"range_length":64,"ranges":16},"items":1024,...}
+/// with the min/median/mean/max time of a repetition in seconds, and the throughput in items per second at the median.
+
+#include <libaec.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <numeric>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "eckit/exception/Exceptions.h"
+#include "eckit/filesystem/LocalPathName.h"
+#include "eckit/filesystem/PathName.h"
+#include "eckit/filesystem/TmpDir.h"
+#include "eckit/io/Buffer.h"
+#include "eckit/io/FileHandle.h"
+#include "eckit/io/MemoryHandle.h"
+#include "eckit/log/JSON.h"
+#include "eckit/serialisation/MemoryStream.h"
+#include "eckit/serialisation/ResizableMemoryStream.h"
+#include "eckit/value/Value.h"
+
+#include "gribjump/Config.h"
+#include "gribjump/ExtractionItem.h"
+#include "gribjump/LibGribJump.h"
+#include "gribjump/Numa.h"
+#include "gribjump/compression/DataAccessor.h"
+#include "gribjump/compression/compressors/Ccsds.h"
+#include "gribjump/compression/compressors/Simple.h"
+#include "gribjump/info/CcsdsInfo.h"
+#include "gribjump/info/InfoCache.h"
+#include "gribjump/info/InfoExtractor.h"
+#include "gribjump/info/LRUCache.h"
+#include "gribjump/info/MessageScanner.h"
+#include "gribjump/info/SimpleInfo.h"
+#include "gribjump/jumper/JumperFactory.h"
+#include "gribjump/tools/GribJumpTool.h"
+#include "gribjump/tools/SyntheticGrib.h"
+
+namespace gribjump::tool {
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+/// Results are accumulated here so that the compiler cannot discard the work being timed.
+volatile double sink = 0;
+
+struct Stats {
+    double min;
+    double median;
+    double mean;
+    double max;
+};
+
+/// Time repetitions calls of f, after one untimed warm-up call.
+template <typename F>
+Stats measure(size_t repetitions, F&& f) {
+    f();
+
+    std::vector<double> seconds;
+    for (size_t i = 0; i < repetitions; ++i) {
+        auto start = Clock::now();
+        f();
+        seconds.push_back(std::chrono::duration<double>(Clock::now() - start).count());
+    }
+    std::sort(seconds.begin(), seconds.end());
+    double total = std::accumulate(seconds.begin(), seconds.end(), 0.0);
+    return {seconds.front(), seconds[seconds.size() / 2], total / seconds.size(), seconds.back()};
+}
+
+/// count ranges of length values, spread evenly over a field of n values. Empty if they do not fit.
+std::vector<Range> spreadRanges(size_t n, size_t count, size_t length) {
+    std::vector<Range> ranges;
+    if (count * length > n) {
+        return ranges;
+    }
+    size_t stride = n / count;
+    for (size_t i = 0; i < count; ++i) {
+        ranges.emplace_back(i * stride, i * stride + length);
+    }
+    return ranges;
+}
+
+std::vector<mc::Block> toBlocks(const std::vector<Range>& ranges) {
+    std::vector<mc::Block> blocks;
+    for (const auto& [begin, end] : ranges) {
+        blocks.emplace_back(begin, end - begin);
+    }
+    return blocks;
+}
+
+eckit::Buffer randomBytes(size_t size, std::mt19937_64& rng) {
+    eckit::Buffer buffer(size);
+    char* bytes = static_cast<char*>(buffer.data());
+    std::uniform_int_distribution<int> byte(0, 255);
+    for (size_t i = 0; i < size; ++i) {
+        bytes[i] = static_cast<char>(byte(rng));
+    }
+    return buffer;
+}
+
+/// A slowly varying field quantised to bitsPerValue bits, packed as the CCSDS decoder expects its samples.
+template <typename T>
+std::vector<T> smoothSamples(size_t n, size_t bitsPerValue, std::mt19937_64& rng) {
+    const double maxValue = double((uint64_t(1) << bitsPerValue) - 1);
+    std::normal_distribution<double> step(0.0, maxValue / 1000);
+    std::vector<T> samples(n);
+    double value = maxValue / 2;
+    for (size_t i = 0; i < n; ++i) {
+        value      = std::clamp(value + step(rng), 0.0, maxValue);
+        samples[i] = static_cast<T>(value);
+    }
+    return samples;
+}
+
+/// Encode n samples of bitsPerValue bits with libaec, as a CCSDS-packed GRIB data section would be.
+eckit::Buffer ccsdsEncode(size_t n, size_t bitsPerValue, unsigned int flags, size_t blockSize, size_t rsi,
+                          std::mt19937_64& rng) {
+    std::vector<uint8_t> in;
+    auto append = [&in](const auto& samples) {
+        const auto* bytes = reinterpret_cast<const uint8_t*>(samples.data());
+        in.assign(bytes, bytes + samples.size() * sizeof(samples[0]));
+    };
+    if (bitsPerValue <= 8) {
+        append(smoothSamples<uint8_t>(n, bitsPerValue, rng));
+    }
+    else if (bitsPerValue <= 16) {
+        append(smoothSamples<uint16_t>(n, bitsPerValue, rng));
+    }
+    else {
+        append(smoothSamples<uint32_t>(n, bitsPerValue, rng));
+    }
+
+    std::vector<uint8_t> out(in.size() * 2 + 1024);
+
+    struct aec_stream strm;
+    strm.bits_per_sample = bitsPerValue;
+    strm.block_size      = blockSize;
+    strm.rsi             = rsi;
+    strm.flags           = flags;
+    strm.next_in         = in.data();
+    strm.avail_in        = in.size();
+    strm.next_out        = out.data();
+    strm.avail_out       = out.size();
+
+    if (int err = aec_buffer_encode(&strm); err != AEC_OK) {
+        throw eckit::FailedLibraryCall("libaec", "aec_buffer_encode", "Error code: " + std::to_string(err), Here());
+    }
+    return eckit::Buffer(out.data(), strm.total_out);
+}
+
+/// Layout of a synthetic grid_simple message: a bitmap (if any) followed by the packed data section.
+struct SyntheticMessage {
+    std::unique_ptr<SimpleInfo> info;
+    eckit::Buffer data;
+};
+
+/// Build a grid_simple message of n points, with a fraction density of them present in its bitmap. Without a bitmap
+/// if density is 1. The JumpInfo is built through its stream constructor, as no GRIB encoder is available here.
+SyntheticMessage syntheticSimpleMessage(size_t n, size_t bitsPerValue, double density, std::mt19937_64& rng) {
+    const bool hasBitmap = density < 1.0;
+
+    std::vector<bool> bitmap(n, true);
+    size_t npresent = n;
+    if (hasBitmap) {
+        std::bernoulli_distribution present(density);
+        npresent = 0;
+        for (size_t i = 0; i < n; ++i) {
+            bitmap[i] = present(rng);
+            npresent += bitmap[i];
+        }
+    }
+
+    const size_t headerBytes = 6;  // so that a bitmap never starts at offset 0, which means "no bitmap"
+    const size_t bitmapBytes = hasBitmap ? (n + 7) / 8 : 0;
+    const size_t dataBytes   = (npresent * bitsPerValue + 7) / 8;
+    const size_t totalBytes  = headerBytes + bitmapBytes + dataBytes;
+
+    eckit::Buffer message(totalBytes);
+    char* bytes = static_cast<char*>(message.data());
+    std::memset(bytes, 0, totalBytes);
+    for (size_t i = 0; hasBitmap && i < n; ++i) {
+        if (bitmap[i]) {
+            bytes[headerBytes + i / 8] |= static_cast<char>(1 << (7 - i % 8));
+        }
+    }
+    eckit::Buffer packed = randomBytes(dataBytes, rng);
+    std::memcpy(bytes + headerBytes + bitmapBytes, packed.data(), dataBytes);
+
+    // Same fields, in the same order, as JumpInfo::encode
+    uint8_t version                  = 1;
+    double referenceValue            = 0;
+    long binaryScaleFactor           = 0;
+    long decimalScaleFactor          = 0;
+    unsigned long editionNumber      = 2;
+    unsigned long bpv                = bitsPerValue;
+    eckit::Offset offsetBeforeData   = headerBytes + bitmapBytes;
+    eckit::Offset offsetAfterData    = totalBytes;
+    eckit::Offset offsetBeforeBitmap = hasBitmap ? headerBytes : 0;
+    unsigned long numberOfValues     = npresent;
+    unsigned long numberOfDataPoints = n;
+    eckit::Length totalLength        = totalBytes;
+    long sphericalHarmonics          = 0;
+    std::string md5GridSection;
+    std::string packingType = "grid_simple";
+
+    eckit::Buffer encoded(4096);
+    eckit::ResizableMemoryStream out(encoded);
+    out << version << referenceValue << binaryScaleFactor << decimalScaleFactor << editionNumber << bpv;
+    out << offsetBeforeData << offsetAfterData << offsetBeforeBitmap << numberOfValues << numberOfDataPoints;
+    out << totalLength << sphericalHarmonics << md5GridSection << packingType;
+
+    eckit::MemoryStream in(encoded.data(), static_cast<size_t>(out.position()));
+    return {std::make_unique<SimpleInfo>(in), std::move(message)};
+}
+
+}  // namespace
+
+//----------------------------------------------------------------------------------------------------------------------
+
+class Bench : public GribJumpTool {
+
+    void execute(const eckit::option::CmdArgs& args) override;
+    void usage(const std::string& tool) const override;
+    int numberOfPositionalArguments() const override { return 0; }
+
+public:
+
+    Bench(int argc, char** argv) : GribJumpTool(argc, argv, "gribjump-bench") {
+        options_.push_back(new eckit::option::SimpleOption<long>(
+            "repetitions", "Number of timed repetitions of each benchmark case. Default 10."));
+        options_.push_back(new eckit::option::SimpleOption<bool>(
+            "quick", "Use small fields and short sweeps, e.g. to check that the benchmarks still run. Default false."));
+        options_.push_back(new eckit::option::SimpleOption<std::string>(
+            "filter", "Only run the benchmarks whose name contains this string."));
+        options_.push_back(new eckit::option::SimpleOption<std::string>(
+            "data", "Directory containing the bundled test GRIB files. Default: current directory."));
+        options_.push_back(new eckit::option::SimpleOption<std::string>(
+            "output", "Append results to this file as JSON lines, instead of writing them to stdout."));
+    }
+
+private:
+
+    bool selected(const std::string& benchmark) const {
+        return filter_.empty() || benchmark.find(filter_) != std::string::npos;
+    }
+
+    void report(const std::string& benchmark, const eckit::ValueMap& params, size_t items, const Stats& stats);
+
+    void benchSimpleDecode();
+    void benchCcsdsDecode();
+    void benchJumperMasked();
+    void benchJumperFiles();
+    void benchCcsdsRanges();
+    void benchMessageOffsets();
+    void benchIndexFile();
+    void benchLRUCache();
+    void benchNumaRead();
+
+private:
+
+    size_t repetitions_ = 10;
+    bool quick_         = false;
+    std::string filter_;
+    eckit::PathName dataDir_ = ".";
+    std::ostream* out_       = &std::cout;
+
+    std::mt19937_64 rng_{42};  // fixed seed, so that each run benchmarks the same data
+};
+
+void Bench::usage(const std::string& tool) const {
+    eckit::Log::info() << std::endl
+                       << "Usage: " << tool << " [--quick] [--repetitions=<n>] [--filter=<name>] [--data=<dir>]"
+                       << " [--output=<file>]" << std::endl;
+
+    GribJumpTool::usage(tool);
+}
+
+void Bench::report(const std::string& benchmark, const eckit::ValueMap& params, size_t items, const Stats& stats) {
+    eckit::JSON j(*out_, false);
+    j.startObject();
+    j << "benchmark" << benchmark;
+    j << "params" << eckit::Value(params);
+    j << "items" << static_cast<long long>(items);
+    j << "repetitions" << static_cast<long long>(repetitions_);
+    j << "min_s" << stats.min;
+    j << "median_s" << stats.median;
+    j << "mean_s" << stats.mean;
+    j << "max_s" << stats.max;
+    j << "items_per_second" << (stats.median > 0 ? items / stats.median : 0.0);
+    j << "gribjump_version" << LibGribJump::instance().version();
+    j << "git_sha1" << LibGribJump::instance().gitsha1(8);
+    j.endObject();
+    *out_ << std::endl;
+}
+
+void Bench::execute(const eckit::option::CmdArgs& args) {
+    repetitions_ = args.getLong("repetitions", 10);
+    quick_       = args.getBool("quick", false);
+    filter_      = args.getString("filter", "");
+    dataDir_     = args.getString("data", ".");
+
+    if (repetitions_ == 0) {
+        throw eckit::UserError("--repetitions must be at least 1", Here());
+    }
+
+    std::ofstream file;
+    std::string output = args.getString("output", "");
+    if (!output.empty()) {
+        file.open(output, std::ios::app);
+        if (!file) {
+            throw eckit::CantOpenFile(output, Here());
+        }
+        out_ = &file;
+    }
+
+    benchSimpleDecode();
+    benchCcsdsDecode();
+    benchJumperMasked();
+    benchJumperFiles();
+    benchCcsdsRanges();
+    benchMessageOffsets();
+    benchIndexFile();
+    benchLRUCache();
+    benchNumaRead();
+
+    out_ = &std::cout;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+void Bench::benchSimpleDecode() {
+    if (!selected("simple_decode")) {
+        return;
+    }
+
+    const size_t n = quick_ ? (1 << 16) : (1 << 22);
+
+    for (size_t bitsPerValue : {8, 12, 16, 24, 32}) {
+        eckit::Buffer packed = randomBytes((n * bitsPerValue + 7) / 8, rng_);
+        std::shared_ptr<mc::DataAccessor> accessor = std::make_shared<mc::MemoryAccessor>(packed);
+
+        mc::SimpleDecompressor<double> simple{};
+        simple.bits_per_value(bitsPerValue).reference_value(0).binary_scale_factor(0).decimal_scale_factor(0);
+
+        for (size_t count : {1, 16, 256}) {
+            for (size_t length : {1, 64, 4096}) {
+                std::vector<mc::Block> blocks = toBlocks(spreadRanges(n, count, length));
+                if (blocks.empty()) {
+                    continue;
+                }
+                std::vector<double> values(count * length);
+
+                Stats stats = measure(repetitions_, [&] {
+                    simple.decode(accessor, blocks, values.data());
+                    sink = sink + values[0];
+                });
+
+                eckit::ValueMap params;
+                params["bits_per_value"] = static_cast<long long>(bitsPerValue);
+                params["ranges"]         = static_cast<long long>(count);
+                params["range_length"]   = static_cast<long long>(length);
+                report("simple_decode", params, values.size(), stats);
+            }
+        }
+    }
+}
+
+void Bench::benchCcsdsDecode() {
+    if (!selected("ccsds_decode")) {
+        return;
+    }
+
+    const size_t n         = quick_ ? (1 << 16) : (1 << 22);
+    const size_t blockSize = 32;
+    const size_t rsi       = 128;
+
+    // The decoder assumes samples in host byte order, stored in 1, 2 or 4 bytes
+    unsigned int flags            = AEC_DATA_PREPROCESS;
+    const unsigned short byteTest = 1;
+    if (reinterpret_cast<const unsigned char*>(&byteTest)[0] == 0) {
+        flags |= AEC_DATA_MSB;
+    }
+
+    for (size_t bitsPerValue : {8, 16, 24}) {
+        eckit::Buffer encoded = ccsdsEncode(n, bitsPerValue, flags, blockSize, rsi, rng_);
+        std::shared_ptr<mc::DataAccessor> accessor = std::make_shared<mc::MemoryAccessor>(encoded);
+
+        mc::CcsdsDecompressor<double> ccsds{};
+        ccsds.flags(flags).bits_per_sample(bitsPerValue).block_size(blockSize).rsi(rsi);
+        ccsds.reference_value(0).binary_scale_factor(0).decimal_scale_factor(0);
+        ccsds.n_elems(n);
+        ccsds.offsets(ccsds.decode_offsets(encoded));
+
+        for (size_t count : {1, 16, 256}) {
+            for (size_t length : {1, 64, 4096}) {
+                std::vector<mc::Block> blocks = toBlocks(spreadRanges(n, count, length));
+                if (blocks.empty()) {
+                    continue;
+                }
+                std::vector<double> values(count * length);
+
+                Stats stats = measure(repetitions_, [&] {
+                    ccsds.decode(accessor, blocks, values.data());
+                    sink = sink + values[0];
+                });
+
+                eckit::ValueMap params;
+                params["bits_per_value"] = static_cast<long long>(bitsPerValue);
+                params["ranges"]         = static_cast<long long>(count);
+                params["range_length"]   = static_cast<long long>(length);
+                params["compression"]    = double(n * ((bitsPerValue + 7) / 8)) / encoded.size();
+                report("ccsds_decode", params, values.size(), stats);
+            }
+        }
+    }
+}
+
+void Bench::benchJumperMasked() {
+    if (!selected("jumper_masked")) {
+        return;
+    }
+
+    const size_t n            = quick_ ? (1 << 16) : (1 << 22);
+    const size_t bitsPerValue = 16;
+
+    std::unique_ptr<Jumper> jumper(JumperFactory::instance().build("grid_simple"));
+
+    for (double density : {0.1, 0.5, 0.9, 1.0}) {
+        SyntheticMessage message = syntheticSimpleMessage(n, bitsPerValue, density, rng_);
+        eckit::MemoryHandle dh(message.data.data(), message.data.size());
+        dh.openForRead();
+
+        for (size_t count : {1, 16, 256}) {
+            for (size_t length : {64, 4096}) {
+                std::vector<Range> ranges = spreadRanges(n, count, length);
+                if (ranges.empty()) {
+                    continue;
+                }
+                ExtractionItem item(ranges);
+
+                Stats stats = measure(repetitions_, [&] { jumper->extract(dh, 0, *message.info, item); });
+
+                eckit::ValueMap params;
+                params["bits_per_value"] = static_cast<long long>(bitsPerValue);
+                params["bitmap_density"] = density;
+                params["ranges"]         = static_cast<long long>(count);
+                params["range_length"]   = static_cast<long long>(length);
+                report("jumper_masked", params, count * length, stats);
+            }
+        }
+        dh.close();
+    }
+}
+
+void Bench::benchJumperFiles() {
+    if (!selected("jumper_file")) {
+        return;
+    }
+
+    std::vector<std::string> files = {"synth11.grib",       "synth12.grib",
+                                      "sl_mask.grib",       "synth11_ccsds_bitmap.grib2",
+                                      "synth11_ccsds_no_bitmap.grib2"};
+    if (!quick_) {
+        files.insert(files.end(), {"2t_O1280.grib", "ceil_O1280.grib"});
+    }
+
+    InfoExtractor extractor;
+
+    for (const std::string& file : files) {
+        eckit::PathName path = dataDir_ / file;
+        if (!path.exists()) {
+            eckit::Log::warning() << "gribjump-bench: skipping " << path << ", which does not exist" << std::endl;
+            continue;
+        }
+
+        std::unique_ptr<JumpInfo> info(extractor.extract(path, 0));
+        std::unique_ptr<Jumper> jumper(JumperFactory::instance().build(*info));
+        const size_t n = info->numberOfDataPoints();
+
+        eckit::FileHandle dh(path);
+        dh.openForRead();
+
+        for (size_t count : {1, 16, 256}) {
+            for (size_t length : {1, 64}) {
+                std::vector<Range> ranges = spreadRanges(n, count, length);
+                if (ranges.empty()) {
+                    continue;
+                }
+                ExtractionItem item(ranges);
+
+                Stats stats = measure(repetitions_, [&] { jumper->extract(dh, 0, *info, item); });
+
+                eckit::ValueMap params;
+                params["file"]           = file;
+                params["packing"]        = info->packingType();
+                params["bits_per_value"] = static_cast<long long>(info->bitsPerValue());
+                params["bitmap"]         = info->offsetBeforeBitmap() != 0;
+                params["ranges"]         = static_cast<long long>(count);
+                params["range_length"]   = static_cast<long long>(length);
+                report("jumper_file", params, count * length, stats);
+            }
+        }
+        dh.close();
+    }
+}
+
+void Bench::benchCcsdsRanges() {
+    if (!selected("ccsds_ranges")) {
+        return;
+    }
+
+    // A large CCSDS field, with tens of thousands of RSIs: the cost per range must not grow with the size of the field
+    const std::string file = quick_ ? "synth11_ccsds_no_bitmap.grib2" : "ceil_O1280.grib";
+    eckit::PathName path   = dataDir_ / file;
+    if (!path.exists()) {
+        eckit::Log::warning() << "gribjump-bench: skipping " << path << ", which does not exist" << std::endl;
+        return;
+    }
+
+    InfoExtractor extractor;
+    std::unique_ptr<JumpInfo> info(extractor.extract(path, 0));
+    std::unique_ptr<Jumper> jumper(JumperFactory::instance().build(*info));
+    const size_t n    = info->numberOfDataPoints();
+    const size_t rsis = dynamic_cast<const CcsdsInfo&>(*info).ccsdsOffsetTable().size();
+
+    eckit::FileHandle dh(path);
+    dh.openForRead();
+
+    for (size_t count : {1, 64, 1024, 4096}) {
+        std::vector<Range> ranges = spreadRanges(n, count, 1);
+        if (ranges.empty()) {
+            continue;
+        }
+        ExtractionItem item(ranges);
+
+        Stats stats = measure(repetitions_, [&] { jumper->extract(dh, 0, *info, item); });
+
+        eckit::ValueMap params;
+        params["file"]   = file;
+        params["rsis"]   = static_cast<long long>(rsis);
+        params["ranges"] = static_cast<long long>(count);
+        report("ccsds_ranges", params, count, stats);
+    }
+    dh.close();
+}
+
+void Bench::benchMessageOffsets() {
+    if (!selected("message_walk") && !selected("message_search")) {
+        return;
+    }
+
+    std::string cwd = eckit::LocalPathName::cwd();
+    eckit::TmpDir tmpdir(cwd.c_str());
+    tmpdir.mkdir();
+
+    SyntheticSpec spec;
+    spec.grid = quick_ ? "O32" : "O320";
+    SyntheticGrib grib(spec);
+    const eckit::Buffer message = grib.encode(0, {{"class", "rd"}, {"expver", "xxxx"}, {"param", "167"}});
+
+    for (size_t fields : {10, 1000}) {
+        eckit::PathName path = tmpdir / ("messages" + std::to_string(fields) + ".grib");
+        eckit::FileHandle file(path);
+        file.openForWrite(0);
+        for (size_t i = 0; i < fields; ++i) {
+            file.write(message.data(), message.size());
+        }
+        file.close();
+
+        eckit::ValueMap params;
+        params["grid"]   = spec.grid;
+        params["fields"] = static_cast<long long>(fields);
+
+        if (selected("message_walk")) {
+            InfoExtractor extractor;
+            Stats stats = measure(repetitions_, [&] { sink = sink + extractor.offsets(path).size(); });
+            report("message_walk", params, fields, stats);
+        }
+
+        if (selected("message_search")) {
+            Stats stats = measure(repetitions_, [&] { sink = sink + MessageScanner(path).search(0).size(); });
+            report("message_search", params, fields, stats);
+        }
+
+        path.unlink();
+    }
+}
+
+void Bench::benchIndexFile() {
+    if (!selected("index_load") && !selected("index_lookup")) {
+        return;
+    }
+
+    std::string cwd = eckit::LocalPathName::cwd();
+    eckit::TmpDir tmpdir(cwd.c_str());
+    tmpdir.mkdir();
+
+    std::vector<size_t> sizes = {100, 1000};
+    if (!quick_) {
+        sizes.push_back(10000);
+    }
+
+    SyntheticMessage message = syntheticSimpleMessage(1024, 16, 0.5, rng_);
+    std::shared_ptr<JumpInfo> info(std::move(message.info));
+
+    for (size_t entries : sizes) {
+        eckit::PathName path = tmpdir / ("bench" + std::to_string(entries) + ".grib");
+
+        eckit::OffsetList offsets;
+        for (size_t i = 0; i < entries; ++i) {
+            offsets.push_back(eckit::Offset(i * info->totalLength()));
+            InfoCache::instance().insert(path, offsets.back(), info);
+        }
+        InfoCache::instance().flush(false);
+        InfoCache::instance().clear();
+
+        // Written by InfoCache::flush next to the data file, or in the configured cache directory
+        const ConfigOptions& config = ConfigOptions::instance();
+        eckit::PathName indexPath   = config.cacheShadowFdb()
+                                          ? path + ".gribjump"
+                                          : eckit::PathName(config.cacheDirectory()) / path.baseName() + ".gribjump";
+        if (!indexPath.exists()) {
+            throw eckit::UserError("Index file " + indexPath + " was not written. Is the cache enabled?", Here());
+        }
+
+        eckit::ValueMap params;
+        params["entries"] = static_cast<long long>(entries);
+
+        if (selected("index_load")) {
+            Stats stats = measure(repetitions_, [&] {
+                IndexFile index(indexPath, false);
+                index.load();
+                sink = sink + index.size();
+            });
+            report("index_load", params, entries, stats);
+        }
+
+        if (selected("index_lookup")) {
+            IndexFile index(indexPath);
+            Stats stats = measure(repetitions_, [&] { sink = sink + index.get(offsets).size(); });
+            report("index_lookup", params, entries, stats);
+        }
+
+        indexPath.unlink();
+    }
+}
+
+void Bench::benchLRUCache() {
+    if (!selected("lru_put") && !selected("lru_get") && !selected("lru_exists")) {
+        return;
+    }
+
+    SyntheticMessage message = syntheticSimpleMessage(1024, 16, 1.0, rng_);
+    std::shared_ptr<JumpInfo> info(std::move(message.info));
+
+    // Keys as InfoCache builds them: file basename and offset
+    auto key = [](size_t i) { return "20240101.0000.data" + std::to_string(i * 123456); };
+
+    for (size_t capacity : {64, 1024}) {
+        std::vector<std::string> keys;
+        for (size_t i = 0; i < 2 * capacity; ++i) {
+            keys.push_back(key(i));
+        }
+
+        eckit::ValueMap params;
+        params["capacity"] = static_cast<long long>(capacity);
+
+        if (selected("lru_put")) {
+            // Twice as many keys as fit, so that half of the puts evict an entry
+            Stats stats = measure(repetitions_, [&] {
+                LRUCache<std::string, std::shared_ptr<JumpInfo>> cache(capacity);
+                for (const auto& k : keys) {
+                    cache.put(k, info);
+                }
+            });
+            report("lru_put", params, keys.size(), stats);
+        }
+
+        if (selected("lru_get")) {
+            LRUCache<std::string, std::shared_ptr<JumpInfo>> cache(capacity);
+            for (size_t i = 0; i < capacity; ++i) {
+                cache.put(keys[i], info);
+            }
+            Stats stats = measure(repetitions_, [&] {
+                for (size_t i = 0; i < capacity; ++i) {
+                    sink = sink + cache.get(keys[i])->numberOfDataPoints();
+                }
+            });
+            report("lru_get", params, capacity, stats);
+        }
+
+        if (selected("lru_exists")) {
+            LRUCache<std::string, std::shared_ptr<JumpInfo>> cache(capacity);
+            for (size_t i = 0; i < capacity; ++i) {
+                cache.put(keys[i], info);
+            }
+            // Half hits, half misses
+            Stats stats = measure(repetitions_, [&] {
+                size_t found = 0;
+                for (const auto& k : keys) {
+                    found += cache.exists(k);
+                }
+                sink = sink + found;
+            });
+            report("lru_exists", params, keys.size(), stats);
+        }
+    }
+}
+
+void Bench::benchNumaRead() {
+    if (!selected("numa_read")) {
+        return;
+    }
+
+    // Larger than the last level cache, so that values are read from memory
+    const NumaTopology& numa = NumaTopology::instance();
+    const size_t n           = (quick_ ? 8 : 64) * 1024 * 1024 / sizeof(double);
+
+    for (size_t memoryNode = 0; memoryNode < numa.nodes(); ++memoryNode) {
+        // Pages are allocated on the node of the thread which first writes them
+        std::vector<double> values;
+        std::thread([&] {
+            numa.pin(memoryNode);
+            values.assign(n, 1.0);
+        }).join();
+
+        for (size_t workerNode = 0; workerNode < numa.nodes(); ++workerNode) {
+            numa.pin(workerNode);
+
+            eckit::ValueMap params;
+            params["memory_node"] = static_cast<long long>(memoryNode);
+            params["worker_node"] = static_cast<long long>(workerNode);
+
+            Stats stats =
+                measure(repetitions_, [&] { sink = sink + std::accumulate(values.begin(), values.end(), 0.0); });
+            report("numa_read", params, n, stats);
+        }
+        numa.unpin();
+    }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace gribjump::tool
+
+int main(int argc, char** argv) {
+    gribjump::tool::Bench app(argc, argv);
+    return app.start();
+}
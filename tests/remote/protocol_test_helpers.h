@@ -94,6 +94,19 @@ public:
         return makeReport();
     }
 
+    GridSelection selectPoints(const GridQuery& query) override {
+        lastGridHash  = query.gridHash();
+        lastGridQuery = query.type();
+        if (query.type() == GridQuery::Type::NEAREST) {
+            std::vector<size_t> indices;
+            for (size_t i = 0; i < query.points().size(); ++i) {
+                indices.push_back(10 * i);
+            }
+            return GridSelection::fromIndices(std::move(indices));
+        }
+        return GridSelection({{0, 2}, {5, 6}});
+    }
+
     // Recorded inputs / configurable outputs
     size_t scanNFields         = 42;
     size_t lastExtractRequests = 0;
@@ -105,6 +118,8 @@ public:
     size_t lastFilemapItems    = 0;
     std::string lastAxesRequest;
     int lastAxesLevel = -1;
+    std::string lastGridHash;
+    GridQuery::Type lastGridQuery = GridQuery::Type::NEAREST;
 
     // When non-empty, execute() reports these as server-side errors.
     std::vector<std::string> errors;
@@ -85,6 +85,29 @@ CASE("Server AXES: parse, execute (mock), reply") {
     EXPECT_EQUAL(axes["levtype"].size(), 1);
 }
 
+CASE("Server SELECT_POINTS: parse, execute (mock), reply") {
+    GridQuery query = GridQuery::nearest("33c7d6025995e1b4913811e77d38ec50", {{51.5, -0.1}, {48.9, 2.4}});
+
+    auto reqBytes = encodeRequest([&](eckit::Stream& s) {
+        writeHeader(s, RequestType::SELECT_POINTS);
+        Protocol::encodeSelectPointsRequest(s, query);
+    });
+
+    DuplexTestStream stream(reqBytes);
+    MockEngine engine;
+    dispatchRequest(stream, &engine);
+
+    EXPECT_EQUAL(engine.lastGridHash, query.gridHash());
+    EXPECT(engine.lastGridQuery == GridQuery::Type::NEAREST);
+
+    eckit::MemoryStream reply(stream.written().data(), stream.written().size());
+    EXPECT(!Protocol::decodeErrors(reply));
+    GridSelection selection = Protocol::decodeSelectPointsReply(reply);
+    EXPECT(selection.ranges() == std::vector<Range>({{0, 1}, {10, 11}}));
+    EXPECT(selection.indices() == std::vector<size_t>({0, 10}));
+    EXPECT(selection.positions() == std::vector<size_t>({0, 1}));
+}
+
 CASE("Server SCAN: parse, execute (mock), reply") {
     metkit::mars::MarsRequest mr("retrieve");
     mr.setValue("class", "rd");
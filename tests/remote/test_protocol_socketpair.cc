@@ -16,6 +16,9 @@
 /// and reads the reply over eckit's InstantTCPStream.
 
 #include <sys/socket.h>
+#include <unistd.h>
+#include <chrono>
+#include <string>
 #include <thread>
 
 #include "eckit/net/TCPSocket.h"
@@ -24,7 +27,11 @@
 
 #include "metkit/mars/MarsRequest.h"
 
+#include "gribjump/Cancellation.h"
+#include "gribjump/MetricsRegistry.h"
+#include "gribjump/remote/ConnectionMonitor.h"
 #include "gribjump/remote/GribJumpUser.h"
+#include "gribjump/remote/MetricsEndpoint.h"
 #include "gribjump/remote/Protocol.h"
 
 #include "protocol_test_helpers.h"
@@ -128,6 +135,66 @@ CASE("Socketpair: SCAN round-trips over a kernel socket") {
     EXPECT_EQUAL(engine.lastByfiles, true);
 }
 
+CASE("Socketpair: ConnectionMonitor cancels the request when the client disconnects") {
+    int fds[2];
+    EXPECT(::socketpair(AF_UNIX, SOCK_STREAM, 0, fds) == 0);
+
+    CancellationToken token;
+    {
+        ConnectionMonitor monitor(fds[0], token);
+
+        EXPECT(!ConnectionMonitor::connectionLost(fds[0]));
+        std::this_thread::sleep_for(std::chrono::milliseconds(250));
+        EXPECT(!token.cancelled());
+
+        ::close(fds[1]);
+        EXPECT(ConnectionMonitor::connectionLost(fds[0]));
+
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+        while (!token.cancelled() && std::chrono::steady_clock::now() < deadline) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+        EXPECT(token.cancelled());
+        EXPECT_EQUAL(token.reason(), "Client connection lost");
+    }
+
+    ::close(fds[0]);
+}
+
+//-----------------------------------------------------------------------------
+
+// Send an HTTP request to MetricsEndpoint::serve over a socketpair and return the raw response.
+static std::string scrape(const std::string& request) {
+    int fds[2];
+    EXPECT(::socketpair(AF_UNIX, SOCK_STREAM, 0, fds) == 0);
+    EXPECT(::send(fds[1], request.data(), request.size(), 0) == static_cast<ssize_t>(request.size()));
+
+    MetricsEndpoint::serve(fds[0]);
+    ::close(fds[0]);
+
+    std::string response;
+    char buf[4096];
+    ssize_t n;
+    while ((n = ::recv(fds[1], buf, sizeof(buf), 0)) > 0) {
+        response.append(buf, n);
+    }
+    ::close(fds[1]);
+    return response;
+}
+
+CASE("Socketpair: MetricsEndpoint serves the registry on GET /metrics") {
+    MetricsRegistry::instance().counter("gribjump_test_scrapes_total", "Test counter.").increment(3);
+
+    std::string response = scrape("GET /metrics HTTP/1.1\r\nHost: localhost\r\n\r\n");
+    EXPECT(response.rfind("HTTP/1.1 200 OK\r\n", 0) == 0);
+    EXPECT(response.find("Content-Type: text/plain; version=0.0.4") != std::string::npos);
+    EXPECT(response.find("\r\n\r\n# HELP ") != std::string::npos);
+    EXPECT(response.find("\ngribjump_test_scrapes_total 3\n") != std::string::npos);
+
+    EXPECT(scrape("GET / HTTP/1.1\r\n\r\n").rfind("HTTP/1.1 404", 0) == 0);
+    EXPECT(scrape("POST /metrics HTTP/1.1\r\n\r\n").rfind("HTTP/1.1 405", 0) == 0);
+}
+
 }  // namespace test
 }  // namespace gribjump
 
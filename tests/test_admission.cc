@@ -0,0 +1,212 @@
+/*
+ * (C) Copyright 2024- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation
+ * nor does it submit to any jurisdiction.
+ */
+
+/// Unit tests for the server-side AdmissionController.
+///
+/// These tests construct controllers with explicit limits rather than using the
+/// configured singleton, so they do not depend on any FDB or server setup.
+
+#include <atomic>
+#include <bitset>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "eckit/testing/Test.h"
+
+#include "gribjump/AdmissionController.h"
+#include "gribjump/ExtractionItem.h"
+#include "gribjump/GribJumpException.h"
+
+using namespace eckit::testing;
+
+namespace gribjump {
+namespace test {
+
+//-----------------------------------------------------------------------------
+
+static AdmissionCost cost(size_t bytes) {
+    AdmissionCost c;
+    c.nFields = 1;
+    c.nValues = bytes / sizeof(double);
+    c.bytes   = bytes;
+    return c;
+}
+
+/// Spin until the predicate holds, or fail after a generous timeout.
+template <typename Pred>
+static bool waitFor(Pred&& pred) {
+    for (int i = 0; i < 2000; ++i) {
+        if (pred()) {
+            return true;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return false;
+}
+
+//-----------------------------------------------------------------------------
+
+CASE("cost estimate from filemap") {
+    ExtractionItem a(Ranges{{0, 10}, {20, 30}});
+    ExtractionItem b(Ranges{{0, 100}});
+    ExtractionItem c(Ranges{{5, 5}});
+
+    filemap_t filemap;
+    filemap["file1"] = {&a, &b};
+    filemap["file2"] = {&c};
+
+    AdmissionCost estimate = AdmissionCost::estimate(filemap);
+    EXPECT_EQUAL(estimate.nFields, 3);
+    EXPECT_EQUAL(estimate.nValues, 120);
+
+    // values + one 64-bit mask word per started block of 64 values, per range
+    size_t expected = 120 * sizeof(double) + (1 + 1 + 2) * sizeof(std::bitset<64>);
+    EXPECT_EQUAL(estimate.bytes, expected);
+}
+
+CASE("unlimited controller admits everything") {
+    AdmissionController controller(AdmissionLimits{});
+    EXPECT(!controller.enabled());
+
+    AdmissionTicket t1 = controller.admit(cost(1 << 30));
+    AdmissionTicket t2 = controller.admit(cost(1 << 30));
+    EXPECT_EQUAL(controller.inFlightRequests(), 0);
+}
+
+CASE("tickets account and release in-flight resources") {
+    AdmissionLimits limits;
+    limits.maxRequests = 4;
+    limits.maxMemory   = 1000;
+    AdmissionController controller(limits);
+
+    {
+        AdmissionTicket t1 = controller.admit(cost(400));
+        EXPECT_EQUAL(controller.inFlightRequests(), 1);
+        EXPECT_EQUAL(controller.inFlightBytes(), 400);
+        {
+            AdmissionTicket t2 = controller.admit(cost(600));
+            EXPECT_EQUAL(controller.inFlightRequests(), 2);
+            EXPECT_EQUAL(controller.inFlightBytes(), 1000);
+        }
+        EXPECT_EQUAL(controller.inFlightBytes(), 400);
+
+        // Moving a ticket transfers ownership, it does not release twice
+        AdmissionTicket t3 = std::move(t1);
+        EXPECT_EQUAL(controller.inFlightRequests(), 1);
+    }
+    EXPECT_EQUAL(controller.inFlightRequests(), 0);
+    EXPECT_EQUAL(controller.inFlightBytes(), 0);
+    EXPECT_EQUAL(controller.admitted(), 2);
+}
+
+CASE("requests larger than the budget are rejected outright") {
+    AdmissionLimits limits;
+    limits.maxMemory = 1000;
+    limits.timeout   = 10;
+    AdmissionController controller(limits);
+
+    EXPECT_THROWS_AS(controller.admit(cost(1001)), AdmissionRejected);
+    EXPECT_EQUAL(controller.rejected(), 1);
+    EXPECT_EQUAL(controller.inFlightRequests(), 0);
+}
+
+CASE("at capacity with zero timeout rejects immediately") {
+    AdmissionLimits limits;
+    limits.maxRequests = 1;
+    limits.timeout     = 0;
+    AdmissionController controller(limits);
+
+    AdmissionTicket t1 = controller.admit(cost(10));
+    EXPECT_THROWS_AS(controller.admit(cost(10)), AdmissionRejected);
+    t1.release();
+    AdmissionTicket t2 = controller.admit(cost(10));
+    EXPECT_EQUAL(controller.admitted(), 2);
+    EXPECT_EQUAL(controller.rejected(), 1);
+}
+
+CASE("queued request times out") {
+    AdmissionLimits limits;
+    limits.maxRequests = 1;
+    limits.timeout     = 0.05;
+    AdmissionController controller(limits);
+
+    AdmissionTicket t1 = controller.admit(cost(10));
+    EXPECT_THROWS_AS(controller.admit(cost(10)), AdmissionRejected);
+    EXPECT_EQUAL(controller.queueDepth(), 0);
+}
+
+CASE("full queue rejects new requests") {
+    AdmissionLimits limits;
+    limits.maxRequests = 1;
+    limits.maxQueued   = 1;
+    limits.timeout     = 10;
+    AdmissionController controller(limits);
+
+    auto t1 = std::make_unique<AdmissionTicket>(controller.admit(cost(10)));
+
+    std::thread waiter([&] { AdmissionTicket t = controller.admit(cost(10)); });
+    EXPECT(waitFor([&] { return controller.queueDepth() == 1; }));
+
+    EXPECT_THROWS_AS(controller.admit(cost(10)), AdmissionRejected);
+
+    t1.reset();
+    waiter.join();
+    EXPECT_EQUAL(controller.admitted(), 2);
+    EXPECT_EQUAL(controller.rejected(), 1);
+}
+
+CASE("queued requests are admitted in arrival order") {
+    AdmissionLimits limits;
+    limits.maxMemory = 1000;
+    limits.timeout   = 10;
+    AdmissionController controller(limits);
+
+    auto holder = std::make_unique<AdmissionTicket>(controller.admit(cost(900)));
+
+    std::mutex m;
+    std::vector<int> order;
+
+    // A large request queues first, then a smaller one. Once the holder completes either could be admitted, but the
+    // smaller one must not overtake the large one.
+    std::thread large([&] {
+        AdmissionTicket t = controller.admit(cost(800));
+        std::lock_guard<std::mutex> lock(m);
+        order.push_back(1);
+    });
+    EXPECT(waitFor([&] { return controller.queueDepth() == 1; }));
+
+    std::thread small([&] {
+        AdmissionTicket t = controller.admit(cost(250));
+        std::lock_guard<std::mutex> lock(m);
+        order.push_back(2);
+    });
+    EXPECT(waitFor([&] { return controller.queueDepth() == 2; }));
+
+    holder.reset();
+    large.join();
+    small.join();
+
+    EXPECT_EQUAL(order.size(), 2);
+    EXPECT_EQUAL(order[0], 1);
+    EXPECT_EQUAL(order[1], 2);
+    EXPECT_EQUAL(controller.inFlightRequests(), 0);
+}
+
+//-----------------------------------------------------------------------------
+
+}  // namespace test
+}  // namespace gribjump
+
+int main(int argc, char** argv) {
+    return run_tests(argc, argv);
+}
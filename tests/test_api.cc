@@ -194,6 +194,41 @@ CASE("test_gribjump_api_extract") {
     }
     compareValues(expectedValues2, output2, 15 * 3);
 
+    // Test 2.b: Same request as a time series: one row per step, in the order of the request
+    TimeSeriesResult series = gj.extractTimeSeries(req, ranges, gridHash);
+    EXPECT_EQUAL(series.ntimes(), 3);
+    EXPECT_EQUAL(series.npoints(), 15);
+    for (size_t t = 0; t < series.ntimes(); t++) {
+        EXPECT(series.found(t));
+        Span<const double> row      = series.row(t);
+        Span<const double> expected = output2[t]->allValues();
+        for (size_t i = 0; i < row.size(); i++) {
+            EXPECT(row[i] == expected[i] || (std::isnan(row[i]) && std::isnan(expected[i])));
+        }
+    }
+
+    // Ranges may be in any order and may overlap, but must not be empty
+    std::vector<Interval> unsorted = {std::make_pair(20, 30), std::make_pair(0, 5), std::make_pair(2, 4)};
+    series                         = gj.extractTimeSeries(req, unsorted, gridHash);
+    EXPECT_EQUAL(series.npoints(), 17);
+    for (size_t t = 0; t < series.ntimes(); t++) {
+        Span<const double> row      = series.row(t);
+        Span<const double> expected = output2[t]->allValues();
+        // The first two ranges are those of the extraction above, swapped; the third is within the first
+        for (size_t i = 0; i < 10; i++) {
+            EXPECT(row[i] == expected[5 + i] || (std::isnan(row[i]) && std::isnan(expected[5 + i])));
+        }
+        for (size_t i = 0; i < 5; i++) {
+            EXPECT(row[10 + i] == expected[i] || (std::isnan(row[10 + i]) && std::isnan(expected[i])));
+        }
+        for (size_t i = 0; i < 2; i++) {
+            EXPECT(row[15 + i] == expected[2 + i] || (std::isnan(row[15 + i]) && std::isnan(expected[2 + i])));
+        }
+    }
+    std::vector<Interval> badRanges = {std::make_pair(0, 5), std::make_pair(10, 10)};
+    EXPECT_THROWS_AS(gj.extractTimeSeries(req, badRanges, gridHash), eckit::UserError);
+    EXPECT_THROWS_AS(gj.extractTimeSeries(req, {}, gridHash), eckit::UserError);
+
     // --------------------------------------------------------------------------------------------
     ranges = {std::make_pair(0, 5), std::make_pair(20, 30)};  // 15 values
 
@@ -150,6 +150,28 @@ CASE("Extract") {
             EXPECT_EQUAL(mask[i], expectedMask[i]);
         }
 
+        // zero-copy views see the same data
+        const double* valuesView = nullptr;
+        size_t nvaluesView       = 0;
+        test_success(gribjump_result_values_view(result, &valuesView, &nvaluesView));
+        EXPECT_EQUAL(nvaluesView, n_total_values);
+        for (size_t i = 0; i < n_total_values; i++) {
+            EXPECT(std::isnan(values[i]) ? std::isnan(valuesView[i]) : valuesView[i] == values[i]);
+        }
+
+        const unsigned long long* maskView = nullptr;
+        size_t nmasksView                  = 0;
+        test_success(gribjump_result_mask_view(result, &maskView, &nmasksView));
+        EXPECT_EQUAL(nmasksView, nmasks);
+        EXPECT_EQUAL(maskView[1], expectedMask[1]);
+
+        const size_t* offsetsView = nullptr;
+        size_t nranges            = 0;
+        test_success(gribjump_result_offsets_view(result, &offsetsView, &nranges));
+        EXPECT_EQUAL(nranges, 2);
+        EXPECT_EQUAL(offsetsView[1], 5);
+        EXPECT_EQUAL(offsetsView[2], n_total_values);
+
         // cleanup
         test_success(gribjump_delete_result(result));
         delete[] values;
@@ -159,6 +181,20 @@ CASE("Extract") {
     EXPECT_EQUAL(status, GRIBJUMP_ITERATOR_COMPLETE);
     EXPECT_EQUAL(count, requests.size());
 
+    // batch API: fill one row per result
+    std::vector<double> rows(paths.size() * n_total_values, -1);
+    size_t nfilled = 0;
+    test_success(gribjump_extractioniterator_fill(iterator_from_paths, rows.data(), paths.size(), n_total_values,
+                                                  &nfilled));
+    EXPECT_EQUAL(nfilled, paths.size());
+    for (size_t r = 0; r < nfilled; r++) {
+        for (size_t i = 0; i < n_total_values; i++) {
+            double v = rows[r * n_total_values + i];
+            EXPECT(std::isnan(expectedValues[i]) ? std::isnan(v) : v == expectedValues[i]);
+        }
+    }
+    test_success(gribjump_extractioniterator_delete(iterator_from_paths));
+
     // Cleanup
     test_success(gribjump_extractioniterator_delete(iterator));
     for (size_t i = 0; i < requests.size(); i++) {
@@ -12,12 +12,15 @@
 
 #include "eckit/filesystem/LocalPathName.h"
 #include "eckit/filesystem/TmpDir.h"
+#include "eckit/io/Buffer.h"
+#include "eckit/io/FileHandle.h"
 #include "eckit/testing/Test.h"
 
 #include "gribjump/GribJump.h"
 #include "gribjump/info/InfoCache.h"
 #include "gribjump/info/InfoExtractor.h"
 #include "gribjump/info/JumpInfo.h"
+#include "gribjump/info/MessageScanner.h"
 
 #include "metkit/mars/MarsExpansion.h"
 #include "metkit/mars/MarsParser.h"
@@ -71,6 +74,139 @@ CASE("test_cache") {
         EXPECT(info);
         EXPECT(*info == *offsetInfos[i].second);
     }
+
+    // Test 3: Flush the entries of several files, created then appended to in two flushes. With the default
+    // configuration, the index files shadow the data files.
+
+    const size_t nfiles = 4;
+    const size_t half   = offsetInfos.size() / 2;
+    for (const auto& [begin, end] : {std::make_pair(size_t(0), half), std::make_pair(half, offsetInfos.size())}) {
+        for (size_t f = 0; f < nfiles; f++) {
+            eckit::PathName copy = tmpdir / ("copy" + std::to_string(f) + ".grib");
+            for (size_t i = begin; i < end; i++) {
+                InfoCache::instance().insert(copy, offsetInfos[i].first, extractor.extract(path, offsetInfos[i].first));
+            }
+        }
+        InfoCache::instance().flush(true);
+    }
+
+    for (size_t f = 0; f < nfiles; f++) {
+        IndexFile index(tmpdir / ("copy" + std::to_string(f) + ".grib.gribjump"));
+        EXPECT_EQUAL(index.size(), offsetInfos.size());
+
+        eckit::OffsetList offsets;
+        for (const auto& entry : offsetInfos) {
+            offsets.push_back(entry.first);
+        }
+        std::map<eckit::Offset, std::shared_ptr<JumpInfo>> infos = index.get(offsets);
+        for (const auto& [offset, info] : offsetInfos) {
+            EXPECT(*infos[offset] == *info);
+        }
+    }
+}
+
+// Append length bytes of source, from offset, to target
+void append(const eckit::PathName& target, const eckit::PathName& source, eckit::Offset offset, size_t length) {
+    eckit::Buffer buffer(length);
+    eckit::FileHandle in(source);
+    in.openForRead();
+    in.seek(offset);
+    EXPECT_EQUAL(in.read(buffer.data(), length), long(length));
+    in.close();
+
+    eckit::FileHandle out(target);
+    out.openForAppend(length);
+    EXPECT_EQUAL(out.write(buffer.data(), length), long(length));
+    out.close();
+}
+
+// Append text to target
+void append(const eckit::PathName& target, const std::string& text) {
+    eckit::FileHandle out(target);
+    out.openForAppend(text.size());
+    EXPECT_EQUAL(out.write(text.data(), text.size()), long(text.size()));
+    out.close();
+}
+
+CASE("test_message_scanner") {
+    std::string s = eckit::LocalPathName::cwd();
+    eckit::TmpDir tmpdir(s.c_str());
+    tmpdir.mkdir();
+
+    eckit::PathName path = "extract_ranges.grib";
+    InfoExtractor extractor;
+    std::vector<std::pair<eckit::Offset, std::unique_ptr<JumpInfo>>> offsetInfos = extractor.extract(path);
+    EXPECT_EQUAL(offsetInfos.size(), 3);
+    std::vector<long long> lengths;
+    for (const auto& [offset, info] : offsetInfos) {
+        lengths.push_back(info->totalLength());
+    }
+
+    // Messages with padding before, between and after them, with false markers, and an incomplete last message
+    eckit::PathName data = tmpdir / "padded.grib";
+    append(data, "padGRIBpad");
+    append(data, path, offsetInfos[0].first, lengths[0]);
+    append(data, path, offsetInfos[1].first, lengths[1]);
+    append(data, "xGRIBxx");
+    append(data, path, offsetInfos[2].first, lengths[2]);
+    append(data, path, offsetInfos[0].first, lengths[0] / 2);
+
+    const long long first = 10;
+    const eckit::OffsetList expected{first, first + lengths[0], first + lengths[0] + lengths[1] + 7};
+
+    MessageScanner scanner(data);
+    EXPECT(scanner.search(0) == expected);
+    EXPECT(scanner.search(expected[1]) == eckit::OffsetList(expected.begin() + 1, expected.end()));
+
+    EXPECT(scanner.walk(0).empty());
+    EXPECT(!scanner.complete());
+    EXPECT(scanner.walk(first) == eckit::OffsetList(expected.begin(), expected.begin() + 2));
+    EXPECT(!scanner.complete());
+    EXPECT(scanner.walk(expected[2]) == eckit::OffsetList{expected[2]});
+    EXPECT(scanner.complete());  // the incomplete message is not an error
+}
+
+CASE("test_incremental_scan") {
+    std::string s = eckit::LocalPathName::cwd();
+    eckit::TmpDir tmpdir(s.c_str());
+    tmpdir.mkdir();
+
+    eckit::PathName path = "extract_ranges.grib";
+    InfoExtractor extractor;
+    std::vector<std::pair<eckit::Offset, std::unique_ptr<JumpInfo>>> offsetInfos = extractor.extract(path);
+    EXPECT_EQUAL(offsetInfos.size(), 3);
+    std::vector<size_t> lengths;
+    for (const auto& [offset, info] : offsetInfos) {
+        lengths.push_back(info->totalLength());
+    }
+
+    // A data file growing one message at a time, the last one written in two goes
+    eckit::PathName data = tmpdir / "data.grib";
+    eckit::PathName indexPath(data + ".gribjump");
+
+    append(data, path, offsetInfos[0].first, lengths[0]);
+    EXPECT_EQUAL(InfoCache::instance().scan(data), 1);
+    EXPECT_EQUAL(IndexFile(indexPath).watermark(), eckit::Offset(lengths[0]));
+
+    append(data, path, offsetInfos[1].first, lengths[1]);
+    append(data, path, offsetInfos[2].first, lengths[2] / 2);
+    EXPECT_EQUAL(InfoCache::instance().scan(data), 1);  // the incomplete message is left for later
+    EXPECT_EQUAL(IndexFile(indexPath).watermark(), eckit::Offset(lengths[0] + lengths[1]));
+
+    const long long middle = static_cast<long long>(offsetInfos[2].first) + lengths[2] / 2;
+    append(data, path, middle, lengths[2] - lengths[2] / 2);
+    EXPECT_EQUAL(InfoCache::instance().scan(data), 1);
+    EXPECT_EQUAL(InfoCache::instance().scan(data), 0);
+
+    IndexFile index(indexPath);
+    EXPECT_EQUAL(index.size(), 3);
+    EXPECT_EQUAL(index.watermark(), eckit::Offset(data.size()));
+
+    eckit::OffsetList offsets{0, eckit::Offset(lengths[0]), eckit::Offset(lengths[0] + lengths[1])};
+    std::map<eckit::Offset, std::shared_ptr<JumpInfo>> infos = index.get(offsets);
+    for (size_t i = 0; i < offsets.size(); i++) {
+        EXPECT(*infos[offsets[i]] == *offsetInfos[i].second);
+    }
 }
 //-----------------------------------------------------------------------------
 
@@ -27,6 +27,7 @@
 #include "gribjump/Engine.h"
 #include "gribjump/ExtractionItem.h"
 #include "gribjump/LibGribJump.h"
+#include "gribjump/info/CcsdsInfo.h"
 #include "gribjump/info/InfoFactory.h"
 #include "gribjump/jumper/CcsdsJumper.h"
 #include "gribjump/jumper/JumperFactory.h"
@@ -96,6 +97,101 @@ CASE("test_reanimate_info") {
 
 //-----------------------------------------------------------------------------
 
+// Writes a CcsdsInfo as version 1 did, with the offsets of the RSIs in full
+class LegacyCcsdsInfo : public CcsdsInfo {
+public:
+
+    explicit LegacyCcsdsInfo(const CcsdsInfo& info) : CcsdsInfo(info) {}
+
+    void encode(eckit::Stream& s) const override {
+        Streamable::encode(s);
+        s << uint8_t(1);
+        s << referenceValue();
+        s << binaryScaleFactor();
+        s << decimalScaleFactor();
+        s << editionNumber();
+        s << bitsPerValue();
+        s << offsetBeforeData();
+        s << offsetAfterData();
+        s << offsetBeforeBitmap();
+        s << numberOfValues();
+        s << numberOfDataPoints();
+        s << totalLength();
+        s << sphericalHarmonics();
+        s << md5GridSection();
+        s << packingType();
+        s << ccsdsFlags();
+        s << ccsdsBlockSize();
+        s << ccsdsRsi();
+        s << ccsdsOffsets();
+    }
+};
+
+CASE("test_reanimate_info_version_1") {
+    eckit::FileHandle fh("ceil_O1280.grib");
+    fh.openForRead();
+    std::unique_ptr<JumpInfo> info(InfoFactory::instance().build(fh, 0));
+    fh.close();
+    const CcsdsInfo& ccsdsInfo = dynamic_cast<const CcsdsInfo&>(*info);
+
+    eckit::PathName filename = "info_version_1";
+    {
+        eckit::FileStream sout(filename.asString().c_str(), "w");
+        auto c = eckit::closer(sout);
+        sout << LegacyCcsdsInfo(ccsdsInfo);
+    }
+
+    std::unique_ptr<JumpInfo> legacy;
+    {
+        eckit::FileStream sin(filename.asString().c_str(), "r");
+        auto c = eckit::closer(sin);
+        legacy.reset(eckit::Reanimator<JumpInfo>::reanimate(sin));
+    }
+    EXPECT_EQUAL(legacy->version(), 1);
+    EXPECT(dynamic_cast<const CcsdsInfo&>(*legacy).ccsdsOffsets() == ccsdsInfo.ccsdsOffsets());
+
+    // Written back in the current version
+    {
+        eckit::FileStream sout(filename.asString().c_str(), "w");
+        auto c = eckit::closer(sout);
+        sout << *legacy;
+    }
+    {
+        eckit::FileStream sin(filename.asString().c_str(), "r");
+        auto c = eckit::closer(sin);
+        std::unique_ptr<JumpInfo> info_in(eckit::Reanimator<JumpInfo>::reanimate(sin));
+        EXPECT(*info_in == *info);
+    }
+
+    filename.unlink();
+}
+
+CASE("test_info_footprint") {
+    auto build = [](const eckit::PathName& file) {
+        eckit::FileHandle fh(file);
+        fh.openForRead();
+        std::unique_ptr<JumpInfo> info(InfoFactory::instance().build(fh, 0));
+        fh.close();
+        return info;
+    };
+    std::unique_ptr<JumpInfo> simple = build("2t_O1280.grib");
+    std::unique_ptr<JumpInfo> ccsds  = build("ceil_O1280.grib");
+
+    EXPECT(simple->footprint() < 1024);
+
+    // Both fields are on the O1280 grid: they share its hash
+    EXPECT_EQUAL(simple->gridHashId(), ccsds->gridHashId());
+    EXPECT(&simple->md5GridSection() == &ccsds->md5GridSection());
+    EXPECT(simple->packingTypeId() != ccsds->packingTypeId());
+
+    const mc::OffsetTable& table = dynamic_cast<const CcsdsInfo&>(*ccsds).ccsdsOffsetTable();
+    EXPECT(table.size() > 1000);
+    EXPECT(ccsds->footprint() >= sizeof(CcsdsInfo) + table.footprint() - sizeof(mc::OffsetTable));
+    EXPECT(ccsds->footprint() > simple->footprint() + table.size());
+}
+
+//-----------------------------------------------------------------------------
+
 CASE("test_build_from_message") {
 
     // Build from an eckit message, compare with the same info built from a file
@@ -0,0 +1,254 @@
+/*
+ * (C) Copyright 2024- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation
+ * nor does it submit to any jurisdiction.
+ */
+
+#include <cmath>
+#include <limits>
+
+#include "eckit/filesystem/PathName.h"
+#include "eckit/io/Buffer.h"
+#include "eckit/io/FileHandle.h"
+#include "eckit/serialisation/MemoryStream.h"
+#include "eckit/serialisation/ResizableMemoryStream.h"
+#include "eckit/testing/Test.h"
+
+#include "gribjump/GribJump.h"
+#include "gribjump/GribJumpException.h"
+#include "gribjump/GridIndex.h"
+#include "gribjump/info/InfoExtractor.h"
+#include "gribjump/tools/SyntheticGrib.h"
+
+using namespace eckit::testing;
+
+namespace gribjump {
+namespace test {
+
+//-----------------------------------------------------------------------------
+
+struct Grid {
+    std::vector<double> lats;
+    std::vector<double> lons;
+};
+
+// Octahedral O<N>: 2N rows of 20 + 4i points, equally spaced in latitude (the exact Gaussian latitudes do not matter)
+Grid octahedral(size_t N) {
+    Grid grid;
+    for (size_t row = 0; row < 2 * N; ++row) {
+        const double lat = 90. - (row + 0.5) * 90. / N;
+        const size_t i   = row < N ? row : 2 * N - 1 - row;
+        const size_t pl  = 20 + 4 * i;
+        for (size_t k = 0; k < pl; ++k) {
+            grid.lats.push_back(lat);
+            grid.lons.push_back(k * 360. / pl);
+        }
+    }
+    return grid;
+}
+
+// Regional lat/lon grid, south to north, crossing the Greenwich meridian
+Grid regional() {
+    Grid grid;
+    for (double lat = 40; lat <= 50; lat += 0.5) {
+        for (double lon = -10; lon <= 10; lon += 0.25) {
+            grid.lats.push_back(lat);
+            grid.lons.push_back(lon);
+        }
+    }
+    return grid;
+}
+
+double distance(double lat1, double lon1, double lat2, double lon2) {
+    const double deg   = M_PI / 180.;
+    const double sdlat = std::sin((lat2 - lat1) * deg / 2);
+    const double sdlon = std::sin((lon2 - lon1) * deg / 2);
+    const double h     = sdlat * sdlat + std::cos(lat1 * deg) * std::cos(lat2 * deg) * sdlon * sdlon;
+    return 2 * std::asin(std::sqrt(std::min(1., h)));
+}
+
+void checkNearest(const Grid& grid, const GridIndex& index, double lat, double lon) {
+    double best = std::numeric_limits<double>::infinity();
+    for (size_t i = 0; i < grid.lats.size(); ++i) {
+        best = std::min(best, distance(lat, lon, grid.lats[i], grid.lons[i]));
+    }
+    // Ties may be broken either way: compare distances
+    size_t found = index.nearest(lat, lon);
+    EXPECT(std::abs(distance(lat, lon, grid.lats[found], grid.lons[found]) - best) < 1e-12);
+}
+
+void checkBoundingBox(const Grid& grid, const GridIndex& index, double north, double west, double south, double east) {
+    std::vector<bool> expected(grid.lats.size());
+    const double width = std::fmod(std::fmod(east - west, 360.) + 360., 360.);
+    for (size_t i = 0; i < grid.lats.size(); ++i) {
+        const double offset = std::fmod(std::fmod(grid.lons[i] - west, 360.) + 360., 360.);
+        expected[i]         = grid.lats[i] <= north && grid.lats[i] >= south && offset <= width;
+    }
+
+    std::vector<bool> selected(grid.lats.size());
+    for (const auto& range : index.boundingBox(north, west, south, east)) {
+        for (size_t i = range.first; i < range.second; ++i) {
+            selected[i] = true;
+        }
+    }
+    EXPECT(selected == expected);
+}
+
+//-----------------------------------------------------------------------------
+
+CASE("test_grid_index_nearest") {
+    Grid grid = octahedral(16);
+    GridIndex index(grid.lats, grid.lons);
+    EXPECT_EQUAL(index.numberOfPoints(), 4 * 16 * (16 + 9));
+    EXPECT_EQUAL(index.numberOfRows(), 32);
+
+    for (double lat : {90., 89.9, 45.3, 2.7, 0., -33.3, -88.8, -90.}) {
+        for (double lon : {0., 0.1, 59.9, 180., 271.3, 359.9, -0.1, -179.5, 721.}) {
+            checkNearest(grid, index, lat, lon);
+        }
+    }
+
+    Grid box = regional();
+    GridIndex regionalIndex(box.lats, box.lons);
+    for (double lat : {60., 50.1, 44.2, 39.}) {
+        for (double lon : {-20., -9.9, 0.1, 9.9, 30., 185.}) {
+            checkNearest(box, regionalIndex, lat, lon);
+        }
+    }
+}
+
+CASE("test_grid_index_bounding_box") {
+    Grid grid = octahedral(16);
+    GridIndex index(grid.lats, grid.lons);
+
+    checkBoundingBox(grid, index, 60.3, 10.1, 30.7, 50.9);
+    checkBoundingBox(grid, index, 60.3, 350.1, 30.7, 20.9);  // across the antimeridian of the grid
+    checkBoundingBox(grid, index, 60.3, -9.9, 30.7, 20.9);
+    checkBoundingBox(grid, index, 90, 0, -90, 359.99);
+    checkBoundingBox(grid, index, 1, 0, -1, 10);  // between two rows
+
+    // The whole grid is one range
+    std::vector<Range> all = index.boundingBox(90, -180, -90, 180);
+    EXPECT_EQUAL(all.size(), 1);
+    EXPECT(all[0] == Range(0, index.numberOfPoints()));
+
+    Grid box = regional();
+    GridIndex regionalIndex(box.lats, box.lons);
+    checkBoundingBox(box, regionalIndex, 45.1, -5.1, 42.9, 3.3);
+    checkBoundingBox(box, regionalIndex, 45, -5, 43, 3);  // edges on grid points
+    checkBoundingBox(box, regionalIndex, 45.1, 170, 42.9, 190);
+}
+
+CASE("test_grid_index_invalid_grids") {
+    EXPECT_THROWS_AS(GridIndex({}, {}), eckit::UserError);
+
+    // Longitudes not equally spaced
+    EXPECT_THROWS_AS(GridIndex({10, 10, 10}, {0, 1, 3}), eckit::UserError);
+
+    // Rows not monotonic in latitude
+    EXPECT_THROWS_AS(GridIndex({10, 10, 0, 0, 20, 20}, {0, 1, 0, 1, 0, 1}), eckit::UserError);
+}
+
+CASE("test_grid_index_encode") {
+    Grid grid = octahedral(16);
+    GridIndex index(grid.lats, grid.lons);
+
+    eckit::Buffer buffer(1024 * 1024);
+    eckit::ResizableMemoryStream out(buffer);
+    index.encode(out);
+
+    eckit::MemoryStream in(buffer.data(), out.position());
+    GridIndex decoded(in);
+    EXPECT_EQUAL(decoded.numberOfPoints(), index.numberOfPoints());
+    EXPECT_EQUAL(decoded.numberOfRows(), index.numberOfRows());
+    EXPECT_EQUAL(decoded.nearest(45.3, 271.3), index.nearest(45.3, 271.3));
+    EXPECT(decoded.boundingBox(60.3, 350.1, 30.7, 20.9) == index.boundingBox(60.3, 350.1, 30.7, 20.9));
+}
+
+CASE("test_grid_index_decode_corrupt") {
+    // version, numberOfPoints, descending, nrows, then lat, lon0, dlon, first, count of each row
+    auto decode = [](size_t numberOfPoints, double dlon, size_t count) {
+        eckit::Buffer buffer(1024);
+        eckit::ResizableMemoryStream out(buffer);
+        out << uint16_t(1) << numberOfPoints << true << size_t(1);
+        out << 0. << 0. << dlon << size_t(0) << count;
+        eckit::MemoryStream in(buffer.data(), out.position());
+        return GridIndex(in);
+    };
+
+    EXPECT_EQUAL(decode(4, 90, 4).numberOfPoints(), 4);
+    EXPECT_THROWS_AS(decode(4, 0, 4), eckit::SeriousBug);
+    EXPECT_THROWS_AS(decode(5, 90, 4), eckit::SeriousBug);
+    EXPECT_THROWS_AS(decode(0, 90, 0), eckit::SeriousBug);
+}
+
+CASE("test_grid_selection") {
+    // Repeated and unsorted points: one value per distinct grid point
+    GridSelection selection = GridSelection::fromIndices({7, 3, 4, 7, 10});
+    EXPECT(selection.ranges() == std::vector<Range>({{3, 5}, {7, 8}, {10, 11}}));
+    EXPECT(selection.positions() == std::vector<size_t>({2, 0, 1, 2, 3}));
+    EXPECT_EQUAL(selection.size(), 4);
+
+    GridSelection merged(std::vector<Range>{{5, 8}, {0, 2}, {2, 3}, {6, 10}});
+    EXPECT(merged.ranges() == std::vector<Range>({{0, 3}, {5, 10}}));
+
+    EXPECT_THROWS_AS(GridQuery::nearest("", {{0, 0}}), eckit::UserError);
+    EXPECT_THROWS_AS(GridQuery::nearest("hash", {}), eckit::UserError);
+    EXPECT_THROWS_AS(GridQuery::nearest("hash", {{91, 0}}), eckit::UserError);
+    EXPECT_THROWS_AS(GridQuery::boundingBox("hash", 10, 0, 20, 10), eckit::UserError);
+}
+
+// GRIBJUMP_GRID_INDEX_DIR is set by the test environment
+CASE("test_grid_index_from_scan") {
+    SyntheticSpec spec;
+    spec.grid = "O16";
+    SyntheticGrib grib(spec);
+
+    eckit::PathName path = "grid_index_O16.grib";
+    {
+        eckit::Buffer buffer = grib.encode(0, {{"class", "rd"}, {"expver", "xxxx"}, {"param", "167"}});
+        eckit::FileHandle file(path);
+        file.openForWrite(0);
+        file.write(buffer.data(), buffer.size());
+        file.close();
+    }
+
+    // Scanning a field indexes its grid
+    const std::string hash = InfoExtractor().extract(path, eckit::Offset(0))->md5GridSection();
+    GridIndexCache::instance().clear();
+
+    GribJump gj;
+    GridSelection north = gj.nearestPoints(hash, {{90, 0}, {90, 0.1}});
+    EXPECT(north.ranges() == std::vector<Range>({{0, 1}}));
+    EXPECT(north.positions() == std::vector<size_t>({0, 0}));
+
+    GridSelection all = gj.boundingBox(hash, 90, 0, -90, 360);
+    EXPECT(all.ranges() == std::vector<Range>({{0, grib.numberOfPoints()}}));
+
+    // Selections can be extracted as they are
+    std::vector<eckit::Offset> offsets = {eckit::Offset(0)};
+    std::vector<std::unique_ptr<ExtractionResult>> results = gj.extract(path, offsets, {north.ranges()}).dumpVector();
+    EXPECT_EQUAL(results[0]->total_values(), 1);
+
+    EXPECT_THROWS_AS(gj.nearestPoints(std::string(32, '0'), {{0, 0}}), DataNotFoundException);
+
+    // Hashes name files in the index directory: anything but an md5 is rejected before touching it
+    EXPECT_THROWS_AS(gj.nearestPoints("unknown", {{0, 0}}), eckit::UserError);
+    EXPECT_THROWS_AS(gj.nearestPoints("../" + hash.substr(3), {{0, 0}}), eckit::UserError);
+    EXPECT_THROWS_AS(GridIndexCache::instance().get("../../etc/passwd"), eckit::UserError);
+
+    path.unlink();
+}
+
+//-----------------------------------------------------------------------------
+
+}  // namespace test
+}  // namespace gribjump
+
+int main(int argc, char** argv) {
+    return run_tests(argc, argv);
+}
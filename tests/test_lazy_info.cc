@@ -0,0 +1,139 @@
+/*
+ * (C) Copyright 2024- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation
+ * nor does it submit to any jurisdiction.
+ */
+
+/// Tests of the infos built on cache misses (cache.lazy), written back to the index files.
+///
+/// Run with GRIBJUMP_CACHE_WRITE_BACK set, as the InfoCache reads its configuration once.
+
+#include <map>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "eckit/filesystem/LocalPathName.h"
+#include "eckit/filesystem/TmpDir.h"
+#include "eckit/io/Buffer.h"
+#include "eckit/io/FileHandle.h"
+#include "eckit/testing/Test.h"
+
+#include "gribjump/info/InfoCache.h"
+#include "gribjump/info/InfoExtractor.h"
+#include "gribjump/info/JumpInfo.h"
+
+using namespace eckit::testing;
+
+namespace gribjump {
+namespace test {
+
+//-----------------------------------------------------------------------------
+
+void copy(const eckit::PathName& source, const eckit::PathName& target) {
+    eckit::Buffer buffer(size_t(source.size()));
+    eckit::FileHandle in(source);
+    in.openForRead();
+    EXPECT_EQUAL(in.read(buffer.data(), buffer.size()), long(buffer.size()));
+    in.close();
+
+    eckit::FileHandle out(target);
+    out.openForWrite(buffer.size());
+    EXPECT_EQUAL(out.write(buffer.data(), buffer.size()), long(buffer.size()));
+    out.close();
+}
+
+CASE("concurrent misses are built once and written back") {
+    std::string cwd = eckit::LocalPathName::cwd();
+    eckit::TmpDir tmpdir(cwd.c_str());
+    tmpdir.mkdir();
+
+    // With the default configuration, the index file shadows the data file
+    eckit::PathName data = tmpdir / "data.grib";
+    copy("extract_ranges.grib", data);
+    eckit::PathName indexPath(data + ".gribjump");
+
+    InfoExtractor extractor;
+    std::vector<std::pair<eckit::Offset, std::unique_ptr<JumpInfo>>> expected = extractor.extract(data);
+    eckit::OffsetList offsets;
+    for (const auto& [offset, info] : expected) {
+        offsets.push_back(offset);
+    }
+
+    const size_t nthreads = 8;
+    std::vector<std::vector<std::shared_ptr<JumpInfo>>> results(nthreads);
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < nthreads; t++) {
+        threads.emplace_back([&, t] { results[t] = InfoCache::instance().get(data, offsets); });
+    }
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+
+    for (const auto& infos : results) {
+        EXPECT_EQUAL(infos.size(), expected.size());
+        for (size_t i = 0; i < infos.size(); i++) {
+            EXPECT(infos[i]);
+            EXPECT(*infos[i] == *expected[i].second);
+        }
+    }
+
+    InfoCache::instance().waitForWriteBack();
+    EXPECT(indexPath.exists());
+
+    IndexFile index(indexPath);
+    EXPECT_EQUAL(index.size(), expected.size());
+    std::map<eckit::Offset, std::shared_ptr<JumpInfo>> indexed = index.get(offsets);
+    for (const auto& [offset, info] : expected) {
+        EXPECT(*indexed[offset] == *info);
+    }
+
+    // Served from the index file once out of memory
+    InfoCache::instance().clear();
+    std::vector<std::shared_ptr<JumpInfo>> infos = InfoCache::instance().get(data, offsets);
+    for (size_t i = 0; i < infos.size(); i++) {
+        EXPECT(*infos[i] == *expected[i].second);
+    }
+}
+
+CASE("missing index files are looked for again once written") {
+    std::string cwd = eckit::LocalPathName::cwd();
+    eckit::TmpDir tmpdir(cwd.c_str());
+    tmpdir.mkdir();
+
+    eckit::PathName data = tmpdir / "data.grib";
+    copy("extract_ranges.grib", data);
+    eckit::PathName indexPath(data + ".gribjump");
+
+    InfoExtractor extractor;
+    std::vector<std::pair<eckit::Offset, std::unique_ptr<JumpInfo>>> expected = extractor.extract(data);
+
+    // The first message is built lazily, which finds the index file missing, then written back
+    EXPECT(InfoCache::instance().get(data, expected[0].first));
+    InfoCache::instance().waitForWriteBack();
+    EXPECT_EQUAL(IndexFile(indexPath).size(), 1);
+
+    // Once written, the index file is read again at once: the second message is found there, not built and
+    // appended to it again
+    InfoCache::instance().insert(data, expected[1].first, std::move(expected[1].second));
+    InfoCache::instance().flush(true);
+    const eckit::Length length = indexPath.size();
+    EXPECT_EQUAL(IndexFile(indexPath).size(), 2);
+
+    EXPECT(InfoCache::instance().get(data, expected[1].first));
+    InfoCache::instance().waitForWriteBack();
+    EXPECT_EQUAL(indexPath.size(), length);
+}
+
+//-----------------------------------------------------------------------------
+
+}  // namespace test
+}  // namespace gribjump
+
+int main(int argc, char** argv) {
+    return run_tests(argc, argv);
+}
@@ -10,10 +10,29 @@
 
 #include <cmath>
 #include <fstream>
+#include <iterator>
+#include <sstream>
+#include <thread>
+#include <vector>
 
+#include "eckit/exception/Exceptions.h"
+#include "eckit/filesystem/PathName.h"
+#include "eckit/io/Buffer.h"
+#include "eckit/parser/JSONParser.h"
+#include "eckit/serialisation/MemoryStream.h"
+#include "eckit/serialisation/ResizableMemoryStream.h"
 #include "eckit/testing/Test.h"
+#include "gribjump/Cancellation.h"
+#include "gribjump/ExtractionData.h"
+#include "gribjump/Metrics.h"
+#include "gribjump/MetricsRegistry.h"
+#include "gribjump/Numa.h"
+#include "gribjump/Tracing.h"
 #include "gribjump/compression/NumericCompressor.h"
+#include "gribjump/compression/OffsetTable.h"
+#include "gribjump/info/InternTable.h"
 #include "gribjump/info/LRUCache.h"
+#include "gribjump/jumper/DecodePlan.h"
 
 
 #include "metkit/mars/MarsExpansion.h"
@@ -58,6 +77,68 @@ CASE("test_lru") {
     EXPECT_THROWS_AS(cache.get("z"), eckit::BadValue);
 }
 
+CASE("test_lru_sized") {
+
+    LRUCache<std::string, int> cache(100);
+
+    EXPECT_EQUAL(cache.put("a", 1, 40), 0);
+    EXPECT_EQUAL(cache.put("b", 2, 40), 0);
+    EXPECT_EQUAL(cache.used(), 80);
+
+    // b is now the least recently used, and evicted to make room for c
+    EXPECT(cache.get("a") == 1);
+    EXPECT_EQUAL(cache.put("c", 3, 50), 1);
+    EXPECT(!cache.exists("b"));
+    EXPECT_EQUAL(cache.used(), 90);
+
+    // Replacing a value replaces its size
+    EXPECT_EQUAL(cache.put("a", 4, 10), 0);
+    EXPECT_EQUAL(cache.used(), 60);
+    EXPECT_EQUAL(cache.size(), 2);
+
+    // Larger than the capacity: not held, and nothing is evicted
+    EXPECT_EQUAL(cache.put("d", 5, 101), 0);
+    EXPECT(!cache.exists("d"));
+    EXPECT_EQUAL(cache.size(), 2);
+
+    EXPECT_EQUAL(cache.put("e", 6, 100), 2);
+    EXPECT_EQUAL(cache.size(), 1);
+    EXPECT_EQUAL(cache.used(), 100);
+}
+
+CASE("test_intern_table") {
+    InternTable& table = InternTable::packingTypes();
+
+    const InternTable::Id a = table.intern("test_packing_a");
+    const InternTable::Id b = table.intern("test_packing_b");
+    EXPECT(a != b);
+    EXPECT_EQUAL(table.intern(std::string("test_packing_a")), a);
+    EXPECT_EQUAL(table.find("test_packing_b"), b);
+    EXPECT_EQUAL(table.find("test_packing_c"), InternTable::none);
+    EXPECT_EQUAL(table.get(a), "test_packing_a");
+
+    // References stay valid as the table grows
+    const std::string& value = table.get(a);
+    for (size_t i = 0; i < 1000; ++i) {
+        table.intern("test_packing_" + std::to_string(i));
+    }
+    EXPECT(&table.get(a) == &value);
+}
+
+CASE("test_md5") {
+    const std::string hex = "0123456789abcdeffedcba9876543210";
+    Md5 md5;
+    EXPECT(Md5::parse(hex, md5));
+    EXPECT_EQUAL(md5.high, 0x0123456789abcdefull);
+    EXPECT_EQUAL(md5.low, 0xfedcba9876543210ull);
+    EXPECT_EQUAL(md5.hex(), hex);
+
+    EXPECT(!Md5::parse("", md5));
+    EXPECT(!Md5::parse("hash", md5));
+    EXPECT(!Md5::parse("0123456789ABCDEFFEDCBA9876543210", md5));
+    EXPECT(!Md5::parse("0123456789abcdeffedcba987654321g", md5));
+}
+
 //-----------------------------------------------------------------------------
 CASE("test buckets") {
     using namespace gribjump::mc;
@@ -99,6 +180,320 @@ CASE("test buckets") {
     EXPECT_EQUAL(buckets[0].first.second, 2000);
 }
 
+//-----------------------------------------------------------------------------
+CASE("test coalesce") {
+    using namespace gribjump::mc;
+
+    // Unsorted, overlapping, adjacent, repeated and contained ranges
+    std::vector<Block> ranges = {{50, 10}, {0, 5}, {5, 1}, {55, 2}, {20, 1}, {0, 5}, {58, 10}, {30, 0}};
+    Coalesced coalesced       = coalesce(ranges);
+
+    EXPECT(coalesced.blocks == std::vector<Block>({{0, 6}, {20, 1}, {30, 0}, {50, 18}}));
+    EXPECT(coalesced.block == std::vector<size_t>({3, 0, 0, 3, 1, 0, 3, 2}));
+
+    // Single-point ranges, as produced from a list of indices, merge into one block per contiguous region
+    ranges.clear();
+    for (size_t i : {9, 3, 4, 5, 100, 6, 7, 8, 101}) {
+        ranges.push_back({i, 1});
+    }
+    coalesced = coalesce(ranges);
+    EXPECT(coalesced.blocks == std::vector<Block>({{3, 7}, {100, 2}}));
+}
+
+CASE("test decode plan") {
+    // Unsorted and overlapping intervals decode each value once, from the merged spans
+    const std::vector<Interval> intervals = {{50, 53}, {0, 2}, {51, 55}};
+    const DecodePlan plan(intervals);
+
+    EXPECT(!plan.inOrder);
+    EXPECT(plan.spans == std::vector<Interval>({{0, 2}, {50, 55}}));
+    EXPECT(plan.starts == std::vector<size_t>({2, 0, 3}));
+    EXPECT(plan.size == 7);
+
+    const std::vector<double> decoded = {0, 1, 50, 51, 52, 53, 54};
+    ExtractionResult result(std::vector<size_t>{3, 2, 4});
+    plan.scatter(decoded.data(), result);
+    EXPECT(result.values(0).toVector() == std::vector<double>({50, 51, 52}));
+    EXPECT(result.values(1).toVector() == std::vector<double>({0, 1}));
+    EXPECT(result.values(2).toVector() == std::vector<double>({51, 52, 53, 54}));
+
+    EXPECT(DecodePlan(std::vector<Interval>{{0, 2}, {2, 4}, {10, 11}}).inOrder);
+}
+
+//-----------------------------------------------------------------------------
+CASE("test offset table") {
+    using namespace gribjump::mc;
+
+    // Increasing offsets of irregular steps, over several blocks, beyond 32 bits
+    std::vector<size_t> offsets;
+    size_t offset = (size_t(1) << 40) + 3;
+    for (size_t i = 0; i < 1000; ++i) {
+        offsets.push_back(offset);
+        offset += 50000 + (i * 7919) % 20000;
+    }
+
+    OffsetTable table(offsets);
+    EXPECT_EQUAL(table.size(), offsets.size());
+    for (size_t i : {0, 1, 63, 64, 65, 500, 999}) {
+        EXPECT_EQUAL(table[i], offsets[i]);
+    }
+    EXPECT(table.offsets() == offsets);
+    EXPECT(table.footprint() < offsets.size() * sizeof(size_t) / 2);
+
+    eckit::Buffer buffer(64 * 1024);
+    eckit::ResizableMemoryStream out(buffer);
+    table.encode(out);
+    eckit::MemoryStream in(buffer.data(), out.position());
+    EXPECT(OffsetTable(in) == table);
+
+    // Equal steps pack in no bits at all; empty and single offsets
+    OffsetTable regular(std::vector<size_t>{8, 108, 208, 308});
+    EXPECT(regular.offsets() == std::vector<size_t>({8, 108, 208, 308}));
+    EXPECT(OffsetTable(std::vector<size_t>{}).empty());
+    EXPECT_EQUAL(OffsetTable(std::vector<size_t>{42})[0], 42);
+}
+
+//-----------------------------------------------------------------------------
+CASE("test_extraction_result_layout") {
+    ExtractionResult result(std::vector<size_t>{3, 0, 70});
+    EXPECT_EQUAL(result.nrange(), 3);
+    EXPECT_EQUAL(result.total_values(), 73);
+    EXPECT_EQUAL(result.nvalues(1), 0);
+    EXPECT_EQUAL(result.mask(0).size(), 1);
+    EXPECT_EQUAL(result.mask(1).size(), 0);
+    EXPECT_EQUAL(result.mask(2).size(), 2);
+
+    // Ranges are laid out one after another in a single buffer
+    EXPECT(result.values(2).data() == result.values(0).data() + 3);
+    EXPECT(result.mask(2).data() == result.mask(0).data() + 1);
+
+    for (size_t i = 0; i < result.nrange(); i++) {
+        Span<double> values = result.mutable_values(i);
+        for (size_t j = 0; j < values.size(); j++) {
+            values[j] = 100 * i + j;
+        }
+    }
+    result.mutable_mask(2)[1] = 0x3f;
+
+    // The compatibility accessors see the same data
+    const auto& values = result.values();
+    const auto& mask   = result.mask();
+    EXPECT_EQUAL(values.size(), 3);
+    EXPECT(values[0] == std::vector<double>({0, 1, 2}));
+    EXPECT(values[1].empty());
+    EXPECT_EQUAL(values[2].size(), 70);
+    EXPECT_EQUAL(values[2][69], 269);
+    EXPECT_EQUAL(mask[2].size(), 2);
+    EXPECT_EQUAL(mask[2][1].to_ullong(), 0x3f);
+
+    // Writes after a copy was made are seen by the next call
+    result.mutable_values(0)[0] = -1;
+    result.mutable_mask(0)[0]   = 0x5;
+    EXPECT_EQUAL(result.values()[0][0], -1);
+    EXPECT_EQUAL(result.mask()[0][0].to_ullong(), 0x5);
+
+    // And construction from nested vectors gives the same layout
+    std::vector<std::vector<double>> nested              = {{1, 2}, {3}};
+    std::vector<std::vector<std::bitset<64>>> nestedMask = {{std::bitset<64>(3)}, {std::bitset<64>(1)}};
+    ExtractionResult fromNested(std::move(nested), std::move(nestedMask));
+    EXPECT_EQUAL(fromNested.nrange(), 2);
+    EXPECT_EQUAL(fromNested.values(1)[0], 3);
+    EXPECT_EQUAL(fromNested.allValues().size(), 3);
+    EXPECT_EQUAL(fromNested.allMasks()[1], 1);
+}
+
+//-----------------------------------------------------------------------------
+CASE("test_cancellation_token") {
+    CancellationToken token;
+    CancellationToken copy = token;
+    EXPECT(copy == token);
+
+    int called  = 0;
+    int removed = 0;
+    auto reg    = token.onCancel([&] { ++called; });
+    {
+        auto tmp = token.onCancel([&] { ++removed; });
+    }
+
+    EXPECT(!token.cancelled());
+    copy.cancel("first");
+    copy.cancel("second");
+
+    EXPECT(token.cancelled());
+    EXPECT_EQUAL(token.reason(), "first");
+    EXPECT_EQUAL(called, 1);
+    EXPECT_EQUAL(removed, 0);
+
+    // Registering on a cancelled token runs the callback straight away
+    auto late = token.onCancel([&] { ++called; });
+    EXPECT_EQUAL(called, 2);
+
+    // Callbacks run without the token's lock, so they may query the token
+    CancellationToken other;
+    std::string seen;
+    auto query = other.onCancel([&] { seen = other.reason(); });
+    other.cancel("queried");
+    EXPECT_EQUAL(seen, "queried");
+}
+
+CASE("test_cancellation_scope") {
+    CancellationToken outer = CancellationToken::current();
+    {
+        CancellationScope scope;
+        EXPECT(CancellationToken::current() == scope.token());
+        EXPECT(!(CancellationToken::current() == outer));
+    }
+    EXPECT(CancellationToken::current() == outer);
+}
+
+//-----------------------------------------------------------------------------
+
+CASE("test_numa_cpu_list") {
+    EXPECT(NumaTopology::parseList("") == std::vector<int>{});
+    EXPECT(NumaTopology::parseList("3\n") == std::vector<int>{3});
+    EXPECT((NumaTopology::parseList("0-3,8,10-11") == std::vector<int>{0, 1, 2, 3, 8, 10, 11}));
+    EXPECT_THROWS_AS(NumaTopology::parseList("4-2"), eckit::BadValue);
+
+    // Whatever the machine, there is at least one node, and pinning to it leaves the thread runnable
+    const NumaTopology& numa = NumaTopology::instance();
+    EXPECT(numa.nodes() >= 1);
+    EXPECT(numa.currentNode() < numa.nodes());
+    numa.pin(numa.nodes() - 1);
+    EXPECT_EQUAL(numa.currentNode(), numa.nodes() - 1);
+    numa.unpin();
+}
+
+//-----------------------------------------------------------------------------
+
+CASE("test_metrics_registry") {
+    MetricsRegistry& registry = MetricsRegistry::instance();
+
+    Histogram& histogram = registry.histogram("gribjump_test_seconds", "Test histogram.", {"stage", "a"});
+    EXPECT(&histogram == &registry.histogram("gribjump_test_seconds", "Test histogram.", {"stage", "a"}));
+    EXPECT(&histogram != &registry.histogram("gribjump_test_seconds", "Test histogram.", {"stage", "b"}));
+    EXPECT_THROWS_AS(registry.counter("gribjump_test_seconds", "Test histogram.", {"stage", "a"}), eckit::BadParameter);
+
+    histogram.observe(0.0005);  // bucket bounds are inclusive
+    histogram.observe(0.003);
+    histogram.observe(1000);  // overflow bucket
+    EXPECT_EQUAL(histogram.count(), 3);
+    EXPECT_EQUAL(histogram.bucket(0), 1);
+    EXPECT_EQUAL(histogram.bucket(3), 1);
+    EXPECT_EQUAL(histogram.bucket(Histogram::nBounds), 1);
+    EXPECT(std::abs(histogram.sum() - 1000.0035) < 1e-9);
+
+    Counter& counter = registry.counter("gribjump_test_total", "Test counter.");
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < 4; ++i) {
+        threads.emplace_back([&registry]() {
+            for (size_t j = 0; j < 1000; ++j) {
+                registry.counter("gribjump_test_total", "Test counter.").increment();
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    EXPECT_EQUAL(counter.value(), 4000);
+
+    Gauge& gauge = registry.gauge("gribjump_test_bytes", "Test gauge.");
+    gauge.add(100);
+    gauge.add(-40);
+    EXPECT_EQUAL(gauge.value(), 60);
+    EXPECT_THROWS_AS(registry.counter("gribjump_test_bytes", "Test gauge."), eckit::BadParameter);
+
+    std::ostringstream out;
+    registry.exposition(out);
+    std::string text = out.str();
+    EXPECT(text.find("# TYPE gribjump_test_seconds histogram\n") != std::string::npos);
+    EXPECT(text.find("gribjump_test_seconds_bucket{stage=\"a\",le=\"0.005\"} 2\n") != std::string::npos);
+    EXPECT(text.find("gribjump_test_seconds_bucket{stage=\"a\",le=\"+Inf\"} 3\n") != std::string::npos);
+    EXPECT(text.find("gribjump_test_seconds_count{stage=\"a\"} 3\n") != std::string::npos);
+    EXPECT(text.find("# TYPE gribjump_test_total counter\ngribjump_test_total 4000\n") != std::string::npos);
+    EXPECT(text.find("# TYPE gribjump_test_bytes gauge\ngribjump_test_bytes 60\n") != std::string::npos);
+}
+
+CASE("test_metrics_stage_timings") {
+    // elapsed_* metrics of a request are also aggregated into the stage histogram
+    Histogram& stage = MetricsRegistry::instance().histogram("gribjump_stage_duration_seconds", "",
+                                                             {"stage", "test_stage"});
+    EXPECT_EQUAL(stage.count(), 0);
+    MetricsManager::instance().set("elapsed_test_stage", 0.02);
+    MetricsManager::instance().set("count_test_stage", 7);
+    EXPECT_EQUAL(stage.count(), 1);
+    EXPECT_EQUAL(stage.bucket(5), 1);
+}
+
+//-----------------------------------------------------------------------------
+
+CASE("test_tracing") {
+    Tracer& tracer = Tracer::instance();
+    eckit::PathName path("test_misc_units_trace.json");
+    if (path.exists()) {
+        path.unlink();
+    }
+
+    tracer.open(path, Tracer::Format::CHROME);
+    EXPECT(tracer.enabled());
+
+    TraceContext outer;
+    TraceContext inner;
+    {
+        TraceSpan span("outer");
+        outer = span.context();
+        EXPECT_EQUAL(outer.traceId.size(), 32);
+        EXPECT_EQUAL(outer.spanId.size(), 16);
+        {
+            TraceSpan child("inner");
+            child.attribute("file", "a.grib");
+            inner = child.context();
+            EXPECT(tracer.current().spanId == inner.spanId);
+        }
+        EXPECT(tracer.current().spanId == outer.spanId);
+
+        // Requests sent from within a span carry it to the server...
+        LogContext sent = tracer.inject(LogContext("{\"user\": \"test\"}"));
+        EXPECT_EQUAL(std::string(sent.value()["user"]), "test");
+        EXPECT_EQUAL(std::string(sent.value()["trace"]["span_id"]), outer.spanId);
+
+        // ... where spans with no parent on the thread continue the sender's trace
+        std::string serverTraceId;
+        std::thread server([&]() {
+            ContextManager::instance().set(sent);
+            TraceSpan request("request");
+            serverTraceId = request.context().traceId;
+        });
+        server.join();
+        EXPECT_EQUAL(serverTraceId, outer.traceId);
+    }
+    EXPECT(tracer.current().empty());
+    tracer.record("queued", outer, Tracer::Clock::now(), Tracer::Clock::now());
+    tracer.open("", Tracer::Format::CHROME);
+    EXPECT(!tracer.enabled());
+
+    // The closing bracket is optional in Chrome traces; add it to parse the file
+    std::ifstream in(path.asString());
+    std::string text((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    text = text.substr(0, text.rfind(',')) + "]";
+    eckit::Value events = eckit::JSONParser::decodeString(text);
+    EXPECT_EQUAL(events.size(), 4);
+
+    eckit::Value first = events[0];
+    EXPECT_EQUAL(std::string(first["name"]), "inner");
+    EXPECT_EQUAL(std::string(first["ph"]), "X");
+    EXPECT_EQUAL(std::string(first["args"]["span_id"]), inner.spanId);
+    EXPECT_EQUAL(std::string(first["args"]["parent_span_id"]), outer.spanId);
+    EXPECT_EQUAL(std::string(first["args"]["file"]), "a.grib");
+    EXPECT_EQUAL(std::string(events[3]["name"]), "queued");
+    EXPECT_EQUAL(std::string(events[3]["args"]["parent_span_id"]), outer.spanId);
+
+    path.unlink();
+
+    // Spans are not recorded when tracing is disabled
+    TraceSpan disabled("disabled");
+    EXPECT(disabled.context().empty());
+}
+
 }  // namespace test
 }  // namespace gribjump
 
@@ -46,6 +46,8 @@ CASE("test_plugin") {
         << "  shadowfdb: true\n"
         << "plugin:\n"
         << "  select: expver=(xxx*),step=(1|2)\n"
+        << "  threads: 4\n"
+        << "  queueSize: 1\n"  // archiving waits for the workers
         << std::endl;
     ofs.close();
     ::setenv("GRIBJUMP_CONFIG_FILE", configPath.asString().c_str(), 1);
@@ -0,0 +1,162 @@
+/*
+ * (C) Copyright 2024- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation
+ * nor does it submit to any jurisdiction.
+ */
+
+/// Unit tests for the server-side ResultCache.
+///
+/// These tests construct caches with explicit limits rather than using the
+/// configured singleton, so they do not depend on any FDB or server setup.
+
+#include <chrono>
+#include <memory>
+#include <thread>
+
+#include "eckit/testing/Test.h"
+
+#include "gribjump/ExtractionItem.h"
+#include "gribjump/ResultCache.h"
+
+using namespace eckit::testing;
+
+namespace gribjump {
+namespace test {
+
+//-----------------------------------------------------------------------------
+
+static std::unique_ptr<ExtractionItem> item(const std::string& path, size_t offset, const Ranges& ranges,
+                                            const std::string& gridHash = "hash") {
+    auto it = std::make_unique<ExtractionItem>(std::make_unique<ExtractionRequest>("", ranges, gridHash));
+    eckit::URI uri("file", eckit::PathName(path));
+    uri.fragment(std::to_string(offset));
+    it->URI(uri);
+    return it;
+}
+
+// One range of n values, value i = base + i, all present
+static ExtractionResult result(size_t n, double base) {
+    std::vector<double> values(n);
+    for (size_t i = 0; i < n; ++i) {
+        values[i] = base + i;
+    }
+    std::vector<std::bitset<64>> mask((n + 63) / 64);
+    for (auto& word : mask) {
+        word.set();
+    }
+    return ExtractionResult({std::move(values)}, {std::move(mask)});
+}
+
+//-----------------------------------------------------------------------------
+
+CASE("disabled cache stores nothing") {
+    ResultCache cache(ResultCacheLimits{});
+    EXPECT(!cache.enabled());
+
+    auto a = item("/data/a.grib", 0, {{0, 10}});
+    cache.put(*a, result(10, 0), 0.1);
+    EXPECT_EQUAL(cache.size(), 0);
+    EXPECT(!cache.get(*a));
+}
+
+CASE("hit returns a copy of the cached result") {
+    ResultCache cache(ResultCacheLimits{1024 * 1024, 60});
+
+    auto a = item("/data/a.grib", 0, {{0, 10}});
+    cache.put(*a, result(10, 100), 0.1);
+    EXPECT_EQUAL(cache.size(), 1);
+
+    auto same = item("/data/a.grib", 0, {{0, 10}});
+    std::unique_ptr<ExtractionResult> hit = cache.get(*same);
+    EXPECT(hit);
+    EXPECT_EQUAL(hit->nrange(), 1);
+    EXPECT_EQUAL(hit->total_values(), 10);
+    EXPECT_EQUAL(hit->values(0)[3], 103.0);
+    EXPECT_EQUAL(hit->mask(0)[0] & 0x3ff, 0x3ffull);
+}
+
+CASE("different field, ranges or grid hash miss") {
+    ResultCache cache(ResultCacheLimits{1024 * 1024, 60});
+    cache.put(*item("/data/a.grib", 0, {{0, 10}}), result(10, 0), 0.1);
+
+    EXPECT(!cache.get(*item("/data/a.grib", 1024, {{0, 10}})));  // field replaced: new location
+    EXPECT(!cache.get(*item("/data/b.grib", 0, {{0, 10}})));
+    EXPECT(!cache.get(*item("/data/a.grib", 0, {{0, 11}})));
+    EXPECT(!cache.get(*item("/data/a.grib", 0, {{0, 5}, {5, 10}})));
+    EXPECT(!cache.get(*item("/data/a.grib", 0, {{0, 10}}, "otherhash")));
+    EXPECT(cache.get(*item("/data/a.grib", 0, {{0, 10}})));
+}
+
+CASE("results expire after the ttl") {
+    ResultCache cache(ResultCacheLimits{1024 * 1024, 0.05});
+    auto a = item("/data/a.grib", 0, {{0, 10}});
+    cache.put(*a, result(10, 0), 0.1);
+    EXPECT(cache.get(*a));
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    EXPECT(!cache.get(*a));
+    EXPECT_EQUAL(cache.size(), 0);
+    EXPECT_EQUAL(cache.bytes(), 0);
+}
+
+CASE("least recently used results are evicted to stay within the memory budget") {
+    // Each result holds 100 values: a little over 800 bytes. Room for two.
+    ResultCache cache(ResultCacheLimits{2000, 60});
+
+    auto a = item("/data/a.grib", 0, {{0, 100}});
+    auto b = item("/data/a.grib", 1, {{0, 100}});
+    auto c = item("/data/a.grib", 2, {{0, 100}});
+
+    cache.put(*a, result(100, 0), 0.1);
+    cache.put(*b, result(100, 0), 0.1);
+    EXPECT(cache.get(*a));  // a is now more recent than b
+
+    cache.put(*c, result(100, 0), 0.1);
+    EXPECT_EQUAL(cache.size(), 2);
+    EXPECT(cache.bytes() <= 2000);
+    EXPECT(cache.get(*a));
+    EXPECT(!cache.get(*b));
+    EXPECT(cache.get(*c));
+
+    // Larger than the whole budget: not cached
+    auto big = item("/data/a.grib", 3, {{0, 1000}});
+    cache.put(*big, result(1000, 0), 0.1);
+    EXPECT(!cache.get(*big));
+    EXPECT_EQUAL(cache.size(), 2);
+}
+
+CASE("lookup serves hits and returns the misses") {
+    ResultCache cache(ResultCacheLimits{1024 * 1024, 60});
+
+    auto a = item("/data/a.grib", 0, {{0, 10}});
+    auto b = item("/data/a.grib", 1, {{0, 10}});
+    auto c = item("/data/b.grib", 0, {{0, 10}});
+    cache.put(*a, result(10, 42), 0.1);
+
+    filemap_t filemap;
+    filemap["/data/a.grib"] = {a.get(), b.get()};
+    filemap["/data/b.grib"] = {c.get()};
+
+    size_t hits      = 0;
+    filemap_t misses = cache.lookup(filemap, hits);
+    EXPECT_EQUAL(hits, 1);
+    EXPECT_EQUAL(misses.size(), 2);
+    EXPECT(misses["/data/a.grib"] == ExtractionItems{b.get()});
+    EXPECT(misses["/data/b.grib"] == ExtractionItems{c.get()});
+
+    std::unique_ptr<ExtractionResult> served = a->result();
+    EXPECT_EQUAL(served->values(0)[0], 42.0);
+}
+
+//-----------------------------------------------------------------------------
+
+}  // namespace test
+}  // namespace gribjump
+
+int main(int argc, char** argv) {
+    return run_tests(argc, argv);
+}
@@ -0,0 +1,167 @@
+/*
+ * (C) Copyright 2024- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation
+ * nor does it submit to any jurisdiction.
+ */
+
+#include <cmath>
+
+#include "eckit/filesystem/PathName.h"
+#include "eckit/io/FileHandle.h"
+#include "eckit/testing/Test.h"
+
+#include "gribjump/GribJump.h"
+#include "gribjump/tools/SyntheticGrib.h"
+
+using namespace eckit::testing;
+
+namespace gribjump {
+namespace test {
+
+//-----------------------------------------------------------------------------
+
+// Write `nfields` synthetic fields to `path`, extract the given ranges of each, and compare with the analytical values
+void checkSynthetic(const SyntheticSpec& spec, const std::vector<Range>& ranges, size_t nfields = 3) {
+
+    SyntheticGrib grib(spec);
+    const std::map<std::string, std::string> keys = {{"class", "rd"}, {"expver", "xxxx"}, {"param", "167"}};
+
+    eckit::PathName path = "synthetic_" + spec.packing + "_" + std::to_string(spec.bitsPerValue) + ".grib";
+    std::vector<eckit::Offset> offsets;
+    {
+        eckit::FileHandle file(path);
+        file.openForWrite(0);
+        size_t offset = 0;
+        for (size_t field = 0; field < nfields; ++field) {
+            eckit::Buffer buffer = grib.encode(field, keys);
+            offsets.push_back(offset);
+            file.write(buffer.data(), buffer.size());
+            offset += buffer.size();
+        }
+        file.close();
+    }
+
+    GribJump gj;
+    std::vector<std::vector<Range>> allRanges(nfields, ranges);
+    std::vector<std::unique_ptr<ExtractionResult>> results = gj.extract(path, offsets, allRanges).dumpVector();
+    EXPECT_EQUAL(results.size(), nfields);
+
+    size_t missing = 0;
+    for (size_t field = 0; field < nfields; ++field) {
+        for (size_t r = 0; r < ranges.size(); ++r) {
+            Span<const double> values  = results[field]->values(r);
+            Span<const uint64_t> masks = results[field]->mask(r);
+            EXPECT_EQUAL(values.size(), ranges[r].second - ranges[r].first);
+            for (size_t j = 0; j < values.size(); ++j) {
+                size_t index = ranges[r].first + j;
+                bool present = grib.present(field, index);
+                EXPECT_EQUAL(present, bool((masks[j / 64] >> (j % 64)) & 1));
+                if (present) {
+                    EXPECT(std::abs(values[j] - SyntheticGrib::value(field, index)) <= grib.tolerance());
+                }
+                else {
+                    EXPECT(std::isnan(values[j]));
+                    ++missing;
+                }
+            }
+        }
+    }
+    EXPECT_EQUAL(missing > 0, spec.bitmapDensity < 1);
+
+    path.unlink();
+}
+
+CASE("test_synthetic_grid") {
+    SyntheticSpec spec;
+    spec.grid = "O16";
+    EXPECT_EQUAL(SyntheticGrib(spec).numberOfPoints(), 4 * 16 * (16 + 9));
+
+    spec.grid = "N16";
+    EXPECT_THROWS_AS(SyntheticGrib{spec}, eckit::UserError);
+    spec.grid    = "O16";
+    spec.packing = "complex";
+    EXPECT_THROWS_AS(SyntheticGrib{spec}, eckit::UserError);
+}
+
+CASE("test_synthetic_bitmap_density") {
+    SyntheticSpec spec;
+    spec.grid          = "O16";
+    spec.bitmapDensity = 0.25;
+    SyntheticGrib grib(spec);
+
+    size_t present = 0;
+    for (size_t i = 0; i < grib.numberOfPoints(); ++i) {
+        present += grib.present(0, i);
+    }
+    double density = double(present) / grib.numberOfPoints();
+    EXPECT(density > 0.2 && density < 0.3);
+}
+
+CASE("test_synthetic_extract") {
+    // Ranges include the first and last points of an O16 field (1600 points), and cross 64-bit mask words
+    const std::vector<Range> ranges = {{0, 1}, {10, 200}, {1023, 1025}, {1500, 1600}};
+
+    for (const std::string& packing : {"simple", "ccsds"}) {
+        for (long bpv : {8, 16, 24}) {
+            for (double density : {1.0, 0.5}) {
+                SyntheticSpec spec;
+                spec.grid          = "O16";
+                spec.packing       = packing;
+                spec.bitsPerValue  = bpv;
+                spec.bitmapDensity = density;
+                checkSynthetic(spec, ranges);
+            }
+        }
+    }
+}
+
+CASE("test_synthetic_extract_unsorted_ranges") {
+    // Unsorted, overlapping and repeated ranges, and single points as produced from a list of indices
+    std::vector<Range> ranges = {{1500, 1600}, {10, 200}, {100, 120}, {0, 1}, {1550, 1551}, {10, 200}, {199, 300}};
+    for (size_t i : {1024, 1023, 7, 1025, 6, 5, 1599}) {
+        ranges.emplace_back(i, i + 1);
+    }
+
+    for (const std::string& packing : {"simple", "ccsds"}) {
+        for (double density : {1.0, 0.5}) {
+            SyntheticSpec spec;
+            spec.grid          = "O16";
+            spec.packing       = packing;
+            spec.bitmapDensity = density;
+            checkSynthetic(spec, ranges);
+        }
+    }
+}
+
+CASE("test_synthetic_extract_ccsds_rsi") {
+    // An O64 field has 18688 points, over several RSIs (reference sample intervals) of 128 blocks of 32 samples. Many
+    // ranges in the same RSI, ranges across RSI boundaries, and the last, partial RSI.
+    std::vector<Range> ranges = {{4090, 4100}, {8192, 8193}, {16384, 18688}, {18687, 18688}, {4000, 4200}};
+    for (size_t i : {9000, 3, 9001, 100, 8999, 4095, 4096, 12000}) {
+        ranges.emplace_back(i, i + 1);
+    }
+
+    for (long bpv : {8, 16, 24}) {
+        for (double density : {1.0, 0.5}) {
+            SyntheticSpec spec;
+            spec.grid          = "O64";
+            spec.packing       = "ccsds";
+            spec.bitsPerValue  = bpv;
+            spec.bitmapDensity = density;
+            checkSynthetic(spec, ranges, 2);
+        }
+    }
+}
+
+//-----------------------------------------------------------------------------
+
+}  // namespace test
+}  // namespace gribjump
+
+int main(int argc, char** argv) {
+    return run_tests(argc, argv);
+}
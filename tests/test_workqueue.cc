@@ -12,7 +12,9 @@
 ///
 /// These tests verify that the WorkQueue dispatches tasks fairly across
 /// TaskGroups in round-robin order, and in particular that a large
-/// TaskGroup cannot block a smaller one from making progress.
+/// TaskGroup cannot block a smaller one from making progress. They also
+/// cover weighting between priority classes, and cancellation by deadline or
+/// by the request's CancellationToken.
 ///
 /// The tests rely on running with a single worker thread so that the
 /// dispatch order is deterministic; this is enforced via the
@@ -22,6 +24,7 @@
 #include <condition_variable>
 #include <cstddef>
 #include <functional>
+#include <memory>
 #include <mutex>
 #include <string>
 #include <thread>
@@ -30,6 +33,7 @@
 
 #include "eckit/testing/Test.h"
 
+#include "gribjump/Cancellation.h"
 #include "gribjump/Task.h"
 
 using namespace eckit::testing;
@@ -106,6 +110,26 @@ private:
     bool& release_;
 };
 
+/// Task that always fails, to trigger cancellation of the rest of its group.
+class FailingTask : public Task {
+public:
+
+    FailingTask(TaskGroup& g, size_t id) : Task(g, id) {}
+
+    void executeImpl() override { throw eckit::Exception("FailingTask failed"); }
+
+    void info() const override {}
+};
+
+/// RAII helper: sets the thread's LogContext for TaskGroups created in its scope.
+class ScopedContext {
+public:
+
+    explicit ScopedContext(const std::string& ctx) { ContextManager::instance().set(LogContext(ctx)); }
+
+    ~ScopedContext() { ContextManager::instance().set(LogContext()); }
+};
+
 /// RAII helper: enqueues a BlockerTask on its own TaskGroup, waits for it to
 /// start executing (occupying the worker), and releases it on destruction
 /// (or via release()). While the blocker is held, the caller can freely
@@ -316,6 +340,145 @@ CASE("group_drains_and_is_readmitted") {
     }
 }
 
+CASE("priority_classes_share_workers_by_weight") {
+    // Three groups of different priority classes, pushed lowest priority
+    // first. With the default weights (high=8, normal=4, low=1), every 13
+    // dispatches serve 8 high, 4 normal and 1 low task, interleaved smoothly.
+
+    DispatchLog log;
+    std::unique_ptr<TaskGroup> groupH;
+    std::unique_ptr<TaskGroup> groupN;
+    std::unique_ptr<TaskGroup> groupL;
+    {
+        ScopedContext ctx(R"({"priority": "high"})");
+        groupH = std::make_unique<TaskGroup>();
+    }
+    {
+        ScopedContext ctx(R"({"priority": "low"})");
+        groupL = std::make_unique<TaskGroup>();
+    }
+    groupN = std::make_unique<TaskGroup>();
+
+    EXPECT(groupH->priority() == Priority::HIGH);
+    EXPECT(groupN->priority() == Priority::NORMAL);
+    EXPECT(groupL->priority() == Priority::LOW);
+
+    const size_t N = 13;
+    {
+        WorkerGate gate;
+        for (size_t i = 0; i < N; ++i)
+            groupL->enqueueTask<DummyTask>(std::string("L"), i, std::ref(log));
+        for (size_t i = 0; i < N; ++i)
+            groupN->enqueueTask<DummyTask>(std::string("N"), i, std::ref(log));
+        for (size_t i = 0; i < N; ++i)
+            groupH->enqueueTask<DummyTask>(std::string("H"), i, std::ref(log));
+    }
+
+    groupH->waitForTasks();
+    groupN->waitForTasks();
+    groupL->waitForTasks();
+
+    EXPECT_EQUAL(log.entries.size(), 3 * N);
+
+    const std::string expected = "HNHHNHLHNHHNH";
+    std::string actual;
+    for (size_t i = 0; i < expected.size(); ++i) {
+        actual += log.entries[i].first;
+    }
+    EXPECT_EQUAL(actual, expected);
+}
+
+CASE("unknown_priority_is_rejected") {
+    ScopedContext ctx(R"({"priority": "urgent"})");
+    EXPECT_THROWS_AS(TaskGroup(), eckit::BadValue);
+}
+
+CASE("expired_deadline_cancels_queued_tasks") {
+    DispatchLog log;
+    std::unique_ptr<TaskGroup> group;
+    {
+        ScopedContext ctx(R"({"deadline": 0})");
+        group = std::make_unique<TaskGroup>();
+    }
+
+    {
+        WorkerGate gate;
+        for (size_t i = 0; i < 3; ++i) {
+            group->enqueueTask<DummyTask>(std::string("A"), i, std::ref(log));
+        }
+    }
+
+    // Must not hang: cancelled tasks still count towards completion.
+    group->waitForTasks();
+
+    EXPECT_EQUAL(log.size(), 0);
+    EXPECT_EQUAL(group->nErrors(), 1);
+}
+
+CASE("error_cancels_remaining_tasks_without_hanging") {
+    DispatchLog log;
+    TaskGroup group;
+
+    {
+        WorkerGate gate;
+        group.enqueueTask<FailingTask>();
+        for (size_t i = 0; i < 3; ++i) {
+            group.enqueueTask<DummyTask>(std::string("A"), i, std::ref(log));
+        }
+    }
+
+    group.waitForTasks();
+
+    EXPECT_EQUAL(log.size(), 0);
+    EXPECT_EQUAL(group.nErrors(), 1);
+}
+
+CASE("cancelled_token_skips_queued_tasks") {
+    DispatchLog log;
+    CancellationToken token;
+    std::unique_ptr<TaskGroup> group;
+    {
+        CancellationScope cancellation(token);
+        group = std::make_unique<TaskGroup>();
+    }
+
+    {
+        WorkerGate gate;
+        for (size_t i = 0; i < 3; ++i) {
+            group->enqueueTask<DummyTask>(std::string("A"), i, std::ref(log));
+        }
+        token.cancel("Cancelled by test");
+    }
+
+    group->waitForTasks();
+
+    EXPECT_EQUAL(log.size(), 0);
+    EXPECT_EQUAL(group->nErrors(), 1);
+    EXPECT(group->cancelled());
+}
+
+CASE("cancelled_token_does_not_wait_for_busy_workers") {
+    DispatchLog log;
+    CancellationToken token;
+    std::unique_ptr<TaskGroup> group;
+    {
+        CancellationScope cancellation(token);
+        group = std::make_unique<TaskGroup>();
+    }
+
+    // The only worker stays busy with another group until after the cancelled group has finished waiting
+    WorkerGate gate;
+    for (size_t i = 0; i < 3; ++i) {
+        group->enqueueTask<DummyTask>(std::string("A"), i, std::ref(log));
+    }
+    token.cancel("Cancelled by test");
+
+    group->waitForTasks();
+    group.reset();
+
+    EXPECT_EQUAL(log.size(), 0);
+}
+
 }  // namespace test
 }  // namespace gribjump
 